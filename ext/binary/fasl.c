@@ -0,0 +1,746 @@
+/*
+ * fasl.c - Binary serialization of Scheme data
+ *
+ *   Copyright (c) 2025  Shiro Kawai  <shiro@acm.org>
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *   3. Neither the name of the authors nor the names of its contributors
+ *      may be used to endorse or promote products derived from this
+ *      software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ *   TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <gauche.h>
+#include <gauche/priv/configP.h>
+#include <gauche/extend.h>
+#include <gauche/priv/bytesP.h>
+#include <gauche/priv/bignumP.h>
+#include <gauche/priv/portP.h>
+#include "fasl.h"
+
+/*
+ * Format
+ *
+ *   Each datum begins with a two-byte header, FASL_MAGIC and
+ *   SCM_FASL_VERSION, followed by a tagged object.  Integer counts
+ *   are written in unsigned LEB128 ('varint'); fixnums and characters
+ *   are zigzag-encoded varints.  Multibyte binary numbers are
+ *   little-endian.
+ *
+ *   Strings, symbols, keywords, pairs, vectors, uvectors, hash tables
+ *   and instances are numbered in the order they first appear, and
+ *   subsequent occurrences are written as FASL_REF with the number.
+ *   This preserves shared and circular structures, and at the same time
+ *   works as a per-datum symbol table.
+ *
+ *   A proper or dotted list is written as FASL_LIST, the number of
+ *   pairs N, N cars, and the tail.  The spine is cut at a pair that
+ *   has already been seen, which becomes the tail.
+ */
+
+#define FASL_MAGIC   0xfa
+
+enum {
+    FASL_FALSE     = 0x00,
+    FASL_TRUE      = 0x01,
+    FASL_NIL       = 0x02,
+    FASL_EOF       = 0x03,
+    FASL_UNDEFINED = 0x04,
+    FASL_UNBOUND   = 0x05,
+
+    FASL_FIXNUM    = 0x08,      /* zigzag varint */
+    FASL_BIGNUM    = 0x09,      /* sign, nbytes, magnitude */
+    FASL_FLONUM    = 0x0a,      /* 8 bytes */
+    FASL_RATNUM    = 0x0b,      /* numerator, denominator */
+    FASL_COMPNUM   = 0x0c,      /* real, imag (8 bytes each) */
+
+    FASL_CHAR      = 0x10,      /* varint */
+    FASL_STRING    = 0x11,      /* size, bytes */
+    FASL_ISTRING   = 0x12,      /* incomplete string: size, bytes */
+    FASL_SYMBOL    = 0x13,      /* size, bytes */
+    FASL_USYMBOL   = 0x14,      /* uninterned symbol: size, bytes */
+    FASL_KEYWORD   = 0x15,      /* size, bytes (without colon) */
+
+    FASL_LIST      = 0x18,      /* npairs, cars, tail */
+    FASL_VECTOR    = 0x19,      /* size, elements */
+    FASL_UVECTOR   = 0x1a,      /* type, size, raw elements */
+    FASL_HASHTABLE = 0x1b,      /* type, count, key/value */
+    FASL_INSTANCE  = 0x1c,      /* module, class name, nslots, slots */
+
+    FASL_REF       = 0x20       /* index */
+};
+
+/* We write everything in little endian. */
+#if defined(DOUBLE_ARMENDIAN)
+#define FASL_SWAP_D(v)   SWAP_ARM2LE(v)
+#elif WORDS_BIGENDIAN
+#define FASL_SWAP_D(v)   SWAP_8(v)
+#else
+#define FASL_SWAP_D(v)   /*nothing*/
+#endif
+
+/*=============================================================
+ * Writer
+ */
+
+#define FASL_WBUFSIZ 4096
+
+typedef struct fasl_writer_rec {
+    ScmPort *port;
+    ScmHashCore seen;           /* obj -> index+1 */
+    ScmSmallInt count;          /* # of numbered objects */
+    int bufcnt;
+    unsigned char buf[FASL_WBUFSIZ];
+} fasl_writer;
+
+static void w_flush(fasl_writer *w)
+{
+    if (w->bufcnt > 0) {
+        Scm_PutzUnsafe((const char*)w->buf, w->bufcnt, w->port);
+        w->bufcnt = 0;
+    }
+}
+
+static inline void w_byte(fasl_writer *w, int b)
+{
+    if (w->bufcnt >= FASL_WBUFSIZ) w_flush(w);
+    w->buf[w->bufcnt++] = (unsigned char)b;
+}
+
+static void w_bytes(fasl_writer *w, const void *p, ScmSize n)
+{
+    if (n > FASL_WBUFSIZ - w->bufcnt) {
+        w_flush(w);
+        if (n >= FASL_WBUFSIZ) {
+            Scm_PutzUnsafe((const char*)p, n, w->port);
+            return;
+        }
+    }
+    memcpy(w->buf + w->bufcnt, p, n);
+    w->bufcnt += (int)n;
+}
+
+static void w_uint(fasl_writer *w, uint64_t v)
+{
+    while (v >= 0x80) {
+        w_byte(w, (int)(v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    w_byte(w, (int)v);
+}
+
+static void w_sint(fasl_writer *w, int64_t v)
+{
+    w_uint(w, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+static void w_double(fasl_writer *w, double d)
+{
+    swap_f64_t v;
+    v.val = d;
+    FASL_SWAP_D(v);
+    w_bytes(w, v.buf, 8);
+}
+
+static void w_sized(fasl_writer *w, int tag, const ScmStringBody *b)
+{
+    w_byte(w, tag);
+    w_uint(w, SCM_STRING_BODY_SIZE(b));
+    w_bytes(w, SCM_STRING_BODY_START(b), SCM_STRING_BODY_SIZE(b));
+}
+
+/* Numbers OBJ if it hasn't been seen, and returns -1.  If OBJ has
+   already been seen, returns its index. */
+static ScmSmallInt w_register(fasl_writer *w, ScmObj obj)
+{
+    ScmDictEntry *e = Scm_HashCoreSearch(&w->seen, (intptr_t)obj,
+                                         SCM_DICT_CREATE);
+    if (e->value) return (ScmSmallInt)e->value - 1;
+    e->value = (intptr_t)++w->count;
+    return -1;
+}
+
+static void w_bignum(fasl_writer *w, ScmBignum *b)
+{
+    ScmSize size = SCM_BIGNUM_SIZE(b);
+    w_byte(w, FASL_BIGNUM);
+    w_byte(w, SCM_BIGNUM_SIGN(b) < 0);
+    w_uint(w, size * SIZEOF_LONG);
+    for (ScmSize i=0; i<size; i++) {
+        u_long v = b->values[i];
+        for (int j=0; j<SIZEOF_LONG; j++, v >>= 8) w_byte(w, (int)(v & 0xff));
+    }
+}
+
+static void w_obj(fasl_writer *w, ScmObj obj);
+
+static void w_list(fasl_writer *w, ScmObj obj)
+{
+    ScmSmallInt n = 1;
+    ScmObj p = SCM_CDR(obj);
+    /* OBJ itself has been registered by the caller. */
+    while (SCM_PAIRP(p) && w_register(w, p) < 0) {
+        n++;
+        p = SCM_CDR(p);
+    }
+    w_byte(w, FASL_LIST);
+    w_uint(w, n);
+    p = obj;
+    for (ScmSmallInt i=0; i<n; i++, p = SCM_CDR(p)) {
+        w_obj(w, SCM_CAR(p));
+    }
+    w_obj(w, p);
+}
+
+static void w_hashtable(fasl_writer *w, ScmHashTable *ht)
+{
+    ScmHashType type = Scm_HashTableType(ht);
+    if (type != SCM_HASH_EQ && type != SCM_HASH_EQV
+        && type != SCM_HASH_EQUAL && type != SCM_HASH_STRING) {
+        Scm_Error("fasl-write: can't serialize a hash table with "
+                  "a custom comparator: %S", SCM_OBJ(ht));
+    }
+    ScmHashCore *core = SCM_HASH_TABLE_CORE(ht);
+    w_byte(w, FASL_HASHTABLE);
+    w_byte(w, (int)type);
+    w_uint(w, Scm_HashCoreNumEntries(core));
+    ScmHashIter iter;
+    Scm_HashIterInit(&iter, core);
+    ScmDictEntry *e;
+    while ((e = Scm_HashIterNext(&iter)) != NULL) {
+        w_obj(w, SCM_DICT_KEY(e));
+        w_obj(w, SCM_DICT_VALUE(e));
+    }
+}
+
+static void w_uvector(fasl_writer *w, ScmUVector *uv)
+{
+    ScmClass *k = SCM_CLASS_OF(uv);
+    int esize = Scm_UVectorElementSize(k);
+    ScmSize n = SCM_UVECTOR_SIZE(uv);
+    w_byte(w, FASL_UVECTOR);
+    w_byte(w, (int)Scm_UVectorType(k));
+    w_uint(w, n);
+#if WORDS_BIGENDIAN || defined(DOUBLE_ARMENDIAN)
+    /* Element-wise swap.  Complex elements are swapped per component. */
+    {
+        const char *p = (const char*)SCM_UVECTOR_ELEMENTS(uv);
+        int csize = (SCM_UVECTOR_C32 <= Scm_UVectorType(k))? esize/2 : esize;
+        int dbl = (Scm_UVectorType(k) == SCM_UVECTOR_F64
+                   || Scm_UVectorType(k) == SCM_UVECTOR_C128);
+        for (ScmSize i=0; i<n*esize; i+=csize) {
+            swap_u64_t v;
+            memcpy(v.buf, p+i, csize);
+            if (dbl) {
+                swap_f64_t d;
+                memcpy(d.buf, v.buf, 8);
+                FASL_SWAP_D(d);
+                memcpy(v.buf, d.buf, 8);
+            } else {
+#if WORDS_BIGENDIAN
+                switch (csize) {
+                case 2: { swap_u16_t s; memcpy(s.buf, v.buf, 2); SWAP_2(s);
+                          memcpy(v.buf, s.buf, 2); break; }
+                case 4: { swap_u32_t s; memcpy(s.buf, v.buf, 4); SWAP_4(s);
+                          memcpy(v.buf, s.buf, 4); break; }
+                case 8: SWAP_8(v); break;
+                }
+#endif /*WORDS_BIGENDIAN*/
+            }
+            w_bytes(w, v.buf, csize);
+        }
+    }
+#else  /* little endian */
+    w_bytes(w, SCM_UVECTOR_ELEMENTS(uv), n * esize);
+#endif /* little endian */
+}
+
+static void w_instance(fasl_writer *w, ScmObj obj)
+{
+    ScmClass *k = SCM_CLASS_OF(obj);
+    if (!SCM_PAIRP(k->modules) || !SCM_SYMBOLP(k->name)) {
+        Scm_Error("fasl-write: can't serialize an instance of "
+                  "an anonymous class: %S", obj);
+    }
+    w_byte(w, FASL_INSTANCE);
+    w_obj(w, SCM_OBJ(SCM_MODULE(SCM_CAR(k->modules))->name));
+    w_obj(w, k->name);
+    w_uint(w, k->numInstanceSlots);
+    for (int i=0; i<k->numInstanceSlots; i++) {
+        w_obj(w, SCM_INSTANCE_SLOTS(obj)[i]);
+    }
+}
+
+static void w_obj(fasl_writer *w, ScmObj obj)
+{
+    /* Immediate objects and numbers */
+    if (SCM_FALSEP(obj))      { w_byte(w, FASL_FALSE); return; }
+    if (SCM_TRUEP(obj))       { w_byte(w, FASL_TRUE); return; }
+    if (SCM_NULLP(obj))       { w_byte(w, FASL_NIL); return; }
+    if (SCM_EOFP(obj))        { w_byte(w, FASL_EOF); return; }
+    if (SCM_UNDEFINEDP(obj))  { w_byte(w, FASL_UNDEFINED); return; }
+    if (SCM_UNBOUNDP(obj))    { w_byte(w, FASL_UNBOUND); return; }
+    if (SCM_INTP(obj)) {
+        w_byte(w, FASL_FIXNUM);
+        w_sint(w, SCM_INT_VALUE(obj));
+        return;
+    }
+    if (SCM_CHARP(obj)) {
+        w_byte(w, FASL_CHAR);
+        w_uint(w, SCM_CHAR_VALUE(obj));
+        return;
+    }
+    if (SCM_FLONUMP(obj)) {
+        w_byte(w, FASL_FLONUM);
+        w_double(w, SCM_FLONUM_VALUE(obj));
+        return;
+    }
+    if (SCM_BIGNUMP(obj)) { w_bignum(w, SCM_BIGNUM(obj)); return; }
+    if (SCM_RATNUMP(obj)) {
+        w_byte(w, FASL_RATNUM);
+        w_obj(w, SCM_RATNUM_NUMER(obj));
+        w_obj(w, SCM_RATNUM_DENOM(obj));
+        return;
+    }
+    if (SCM_COMPNUMP(obj)) {
+        w_byte(w, FASL_COMPNUM);
+        w_double(w, SCM_COMPNUM_REAL(obj));
+        w_double(w, SCM_COMPNUM_IMAG(obj));
+        return;
+    }
+
+    /* Objects that are numbered */
+    if (!(SCM_PAIRP(obj) || SCM_STRINGP(obj) || SCM_SYMBOLP(obj)
+          || SCM_VECTORP(obj) || SCM_UVECTORP(obj) || SCM_HASH_TABLE_P(obj)
+          || (SCM_CLASS_CATEGORY(SCM_CLASS_OF(obj)) == SCM_CLASS_SCHEME
+              && SCM_CLASS_OF(obj)->coreSize == sizeof(ScmInstance)))) {
+        Scm_Error("fasl-write: unserializable object: %S", obj);
+    }
+    ScmSmallInt ref = w_register(w, obj);
+    if (ref >= 0) {
+        w_byte(w, FASL_REF);
+        w_uint(w, ref);
+        return;
+    }
+
+    if (SCM_PAIRP(obj)) {
+        w_list(w, obj);
+    } else if (SCM_STRINGP(obj)) {
+        const ScmStringBody *b = SCM_STRING_BODY(obj);
+        w_sized(w, SCM_STRING_BODY_INCOMPLETE_P(b)? FASL_ISTRING:FASL_STRING,
+                b);
+    } else if (SCM_KEYWORDP(obj)) {
+        ScmObj name = Scm_KeywordToString(SCM_KEYWORD(obj));
+        w_sized(w, FASL_KEYWORD, SCM_STRING_BODY(name));
+    } else if (SCM_SYMBOLP(obj)) {
+        w_sized(w, SCM_SYMBOL_INTERNED(obj)? FASL_SYMBOL : FASL_USYMBOL,
+                SCM_STRING_BODY(SCM_SYMBOL_NAME(obj)));
+    } else if (SCM_VECTORP(obj)) {
+        ScmSmallInt n = SCM_VECTOR_SIZE(obj);
+        w_byte(w, FASL_VECTOR);
+        w_uint(w, n);
+        for (ScmSmallInt i=0; i<n; i++) w_obj(w, SCM_VECTOR_ELEMENT(obj, i));
+    } else if (SCM_UVECTORP(obj)) {
+        w_uvector(w, SCM_UVECTOR(obj));
+    } else if (SCM_HASH_TABLE_P(obj)) {
+        w_hashtable(w, SCM_HASH_TABLE(obj));
+    } else {
+        w_instance(w, obj);
+    }
+}
+
+static void fasl_write(fasl_writer *w, ScmObj obj)
+{
+    w_byte(w, FASL_MAGIC);
+    w_byte(w, SCM_FASL_VERSION);
+    w_obj(w, obj);
+    w_flush(w);
+}
+
+void Scm_FaslWrite(ScmObj obj, ScmPort *port)
+{
+    fasl_writer w;
+    ScmVM *vm = Scm_VM();
+
+    if (!SCM_OPORTP(port)) Scm_Error("output port required, but got %S", port);
+    w.port = port;
+    w.count = 0;
+    w.bufcnt = 0;
+    Scm_HashCoreInitSimple(&w.seen, SCM_HASH_EQ, 0, NULL);
+
+    /* The whole datum is written while holding the port lock, so that
+       concurrent writers can't interleave their output with ours. */
+    PORT_LOCK(port, vm);
+    PORT_SAFE_CALL(port, fasl_write(&w, obj), /*no cleanup*/);
+    PORT_UNLOCK(port);
+}
+
+/*=============================================================
+ * Reader
+ */
+
+typedef struct fasl_reader_rec {
+    ScmPort *port;
+    ScmObj *objs;               /* numbered objects */
+    ScmSmallInt count;
+    ScmSmallInt size;
+} fasl_reader;
+
+static void r_error(fasl_reader *r, const char *msg)
+{
+    Scm_Error("fasl-read: %s (port: %S)", msg, r->port);
+}
+
+static int r_byte(fasl_reader *r)
+{
+    int b = Scm_GetbUnsafe(r->port);
+    if (b == EOF) r_error(r, "premature end of input");
+    return b;
+}
+
+/* Reads exactly N bytes into BUF. */
+static void r_bytes(fasl_reader *r, void *buf, ScmSize n)
+{
+    char *p = (char*)buf;
+    while (n > 0) {
+        ScmSize k = Scm_GetzUnsafe(p, n, r->port);
+        if (k <= 0) r_error(r, "premature end of input");
+        p += k;
+        n -= k;
+    }
+}
+
+static uint64_t r_uint(fasl_reader *r)
+{
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int b = r_byte(r);
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    r_error(r, "malformed varint");
+    return 0;                   /* dummy */
+}
+
+static int64_t r_sint(fasl_reader *r)
+{
+    uint64_t u = r_uint(r);
+    return (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+}
+
+static ScmSmallInt r_size(fasl_reader *r)
+{
+    uint64_t u = r_uint(r);
+    if (u > SCM_SMALL_INT_MAX) r_error(r, "size too large");
+    return (ScmSmallInt)u;
+}
+
+static double r_double(fasl_reader *r)
+{
+    swap_f64_t v;
+    r_bytes(r, v.buf, 8);
+    FASL_SWAP_D(v);
+    return v.val;
+}
+
+static ScmSmallInt r_reserve(fasl_reader *r)
+{
+    if (r->count >= r->size) {
+        ScmSmallInt newsize = r->size * 2;
+        ScmObj *newobjs = SCM_NEW_ARRAY(ScmObj, newsize);
+        memcpy(newobjs, r->objs, r->count * sizeof(ScmObj));
+        r->objs = newobjs;
+        r->size = newsize;
+    }
+    r->objs[r->count] = SCM_UNDEFINED;
+    return r->count++;
+}
+
+static ScmObj r_register(fasl_reader *r, ScmObj obj)
+{
+    r->objs[r_reserve(r)] = obj;
+    return obj;
+}
+
+static ScmObj r_string(fasl_reader *r, int flags)
+{
+    ScmSmallInt size = r_size(r);
+    char *buf = SCM_NEW_ATOMIC2(char*, size+1);
+    r_bytes(r, buf, size);
+    buf[size] = '\0';
+    ScmObj s = Scm_MakeString(buf, size, -1, flags);
+    if (!(flags & SCM_STRING_INCOMPLETE)
+        && SCM_STRING_BODY_INCOMPLETE_P(SCM_STRING_BODY(s))) {
+        r_error(r, "invalid string encoding");
+    }
+    return s;
+}
+
+static ScmObj r_bignum(fasl_reader *r)
+{
+    int neg = r_byte(r);
+    ScmSmallInt nbytes = r_size(r);
+    ScmSmallInt nwords = (nbytes + SIZEOF_LONG - 1) / SIZEOF_LONG;
+    if (nwords == 0) return SCM_MAKE_INT(0);
+    if (nwords > INT_MAX) r_error(r, "bignum too large");
+
+    unsigned char *buf = SCM_NEW_ATOMIC2(unsigned char*, nbytes);
+    u_long *vals = SCM_NEW_ATOMIC_ARRAY(u_long, nwords);
+    r_bytes(r, buf, nbytes);
+    for (ScmSmallInt i=0; i<nwords; i++) vals[i] = 0;
+    for (ScmSmallInt i=0; i<nbytes; i++) {
+        vals[i/SIZEOF_LONG] |= (u_long)buf[i] << (8*(i%SIZEOF_LONG));
+    }
+    ScmObj b = Scm_MakeBignumFromUIArray(neg? -1 : 1, vals, (int)nwords);
+    return Scm_NormalizeBignum(SCM_BIGNUM(b));
+}
+
+static ScmObj r_obj(fasl_reader *r);
+
+static ScmObj r_list(fasl_reader *r)
+{
+    ScmSmallInt n = r_size(r);
+    if (n == 0) r_error(r, "malformed list");
+    /* Allocate and number the spine first, for the cars may refer to it. */
+    ScmObj head = SCM_NIL, tail = SCM_NIL;
+    for (ScmSmallInt i=0; i<n; i++) {
+        ScmObj p = Scm_Cons(SCM_UNDEFINED, SCM_NIL);
+        r_register(r, p);
+        if (SCM_NULLP(head)) head = p;
+        else SCM_SET_CDR_UNCHECKED(tail, p);
+        tail = p;
+    }
+    ScmObj p = head;
+    for (ScmSmallInt i=0; i<n; i++, p = SCM_CDR(p)) {
+        SCM_SET_CAR_UNCHECKED(p, r_obj(r));
+    }
+    SCM_SET_CDR_UNCHECKED(tail, r_obj(r));
+    return head;
+}
+
+static ScmObj r_uvector(fasl_reader *r)
+{
+    static ScmClass *classes[] = {
+        SCM_CLASS_S8VECTOR, SCM_CLASS_U8VECTOR,
+        SCM_CLASS_S16VECTOR, SCM_CLASS_U16VECTOR,
+        SCM_CLASS_S32VECTOR, SCM_CLASS_U32VECTOR,
+        SCM_CLASS_S64VECTOR, SCM_CLASS_U64VECTOR,
+        SCM_CLASS_F16VECTOR, SCM_CLASS_F32VECTOR, SCM_CLASS_F64VECTOR,
+        SCM_CLASS_C32VECTOR, SCM_CLASS_C64VECTOR, SCM_CLASS_C128VECTOR,
+    };
+    int type = r_byte(r);
+    ScmClass *k = NULL;
+    for (size_t i=0; i<sizeof(classes)/sizeof(classes[0]); i++) {
+        if ((int)Scm_UVectorType(classes[i]) == type) {
+            k = classes[i];
+            break;
+        }
+    }
+    if (k == NULL) r_error(r, "unknown uvector type");
+
+    ScmSmallInt n = r_size(r);
+    int esize = Scm_UVectorElementSize(k);
+    if (n > SCM_SMALL_INT_MAX / esize) r_error(r, "uvector too large");
+    ScmObj uv = Scm_MakeUVector(k, n, NULL);
+    /* Read the payload directly into the uvector's storage. */
+    r_bytes(r, SCM_UVECTOR_ELEMENTS(uv), n * esize);
+#if WORDS_BIGENDIAN || defined(DOUBLE_ARMENDIAN)
+    {
+        char *p = (char*)SCM_UVECTOR_ELEMENTS(uv);
+        int csize = (SCM_UVECTOR_C32 <= type)? esize/2 : esize;
+        int dbl = (type == SCM_UVECTOR_F64 || type == SCM_UVECTOR_C128);
+        for (ScmSmallInt i=0; i<n*esize; i+=csize) {
+            if (dbl) {
+                swap_f64_t d;
+                memcpy(d.buf, p+i, 8);
+                FASL_SWAP_D(d);
+                memcpy(p+i, d.buf, 8);
+            } else {
+#if WORDS_BIGENDIAN
+                switch (csize) {
+                case 2: { swap_u16_t s; memcpy(s.buf, p+i, 2); SWAP_2(s);
+                          memcpy(p+i, s.buf, 2); break; }
+                case 4: { swap_u32_t s; memcpy(s.buf, p+i, 4); SWAP_4(s);
+                          memcpy(p+i, s.buf, 4); break; }
+                case 8: { swap_u64_t s; memcpy(s.buf, p+i, 8); SWAP_8(s);
+                          memcpy(p+i, s.buf, 8); break; }
+                }
+#endif /*WORDS_BIGENDIAN*/
+            }
+        }
+    }
+#endif /* WORDS_BIGENDIAN || DOUBLE_ARMENDIAN */
+    return uv;
+}
+
+static ScmObj r_hashtable(fasl_reader *r)
+{
+    int type = r_byte(r);
+    if (type != SCM_HASH_EQ && type != SCM_HASH_EQV
+        && type != SCM_HASH_EQUAL && type != SCM_HASH_STRING) {
+        r_error(r, "unknown hash table type");
+    }
+    ScmSmallInt n = r_size(r);
+    ScmObj ht = Scm_MakeHashTableSimple((ScmHashType)type, 0);
+    r_register(r, ht);
+    for (ScmSmallInt i=0; i<n; i++) {
+        ScmObj key = r_obj(r);
+        ScmObj val = r_obj(r);
+        Scm_HashTableSet(SCM_HASH_TABLE(ht), key, val, 0);
+    }
+    return ht;
+}
+
+static ScmObj r_instance(fasl_reader *r)
+{
+    ScmSmallInt index = r_reserve(r);
+    ScmObj modname = r_obj(r);
+    ScmObj name = r_obj(r);
+    ScmSmallInt nslots = r_size(r);
+    if (!SCM_SYMBOLP(modname) || !SCM_SYMBOLP(name)) {
+        r_error(r, "malformed instance");
+    }
+    ScmModule *m = Scm_FindModule(SCM_SYMBOL(modname), SCM_FIND_MODULE_QUIET);
+    if (m == NULL) {
+        Scm_Error("fasl-read: module %S not found for class %S",
+                  modname, name);
+    }
+    ScmObj k = Scm_GlobalVariableRef(m, SCM_SYMBOL(name), 0);
+    if (!SCM_CLASSP(k)
+        || SCM_CLASS_CATEGORY(k) != SCM_CLASS_SCHEME
+        || SCM_CLASS(k)->coreSize != sizeof(ScmInstance)) {
+        Scm_Error("fasl-read: %S in module %S isn't a serializable class",
+                  name, modname);
+    }
+    if (SCM_CLASS_NUM_INSTANCE_SLOTS(k) != nslots) {
+        Scm_Error("fasl-read: class %S has %d slots, but the data has %ld",
+                  k, SCM_CLASS_NUM_INSTANCE_SLOTS(k), nslots);
+    }
+    ScmObj obj = Scm_NewInstance(SCM_CLASS(k), sizeof(ScmInstance));
+    r->objs[index] = obj;
+    for (ScmSmallInt i=0; i<nslots; i++) {
+        SCM_INSTANCE_SLOTS(obj)[i] = r_obj(r);
+    }
+    return obj;
+}
+
+static ScmObj r_obj(fasl_reader *r)
+{
+    int tag = r_byte(r);
+    switch (tag) {
+    case FASL_FALSE:     return SCM_FALSE;
+    case FASL_TRUE:      return SCM_TRUE;
+    case FASL_NIL:       return SCM_NIL;
+    case FASL_EOF:       return SCM_EOF;
+    case FASL_UNDEFINED: return SCM_UNDEFINED;
+    case FASL_UNBOUND:   return SCM_UNBOUND;
+    case FASL_FIXNUM:    return Scm_MakeInteger64(r_sint(r));
+    case FASL_BIGNUM:    return r_bignum(r);
+    case FASL_FLONUM:    return Scm_MakeFlonum(r_double(r));
+    case FASL_RATNUM: {
+        ScmObj numer = r_obj(r);
+        ScmObj denom = r_obj(r);
+        if (!SCM_INTEGERP(numer) || !SCM_INTEGERP(denom)) {
+            r_error(r, "malformed rational");
+        }
+        return Scm_MakeRational(numer, denom);
+    }
+    case FASL_COMPNUM: {
+        double re = r_double(r);
+        double im = r_double(r);
+        return Scm_MakeCompnum(re, im);
+    }
+    case FASL_CHAR: {
+        uint64_t c = r_uint(r);
+        if (c > 0x10ffff) r_error(r, "invalid character");
+        return SCM_MAKE_CHAR((ScmChar)c);
+    }
+    case FASL_STRING:
+        return r_register(r, r_string(r, SCM_STRING_COPYING));
+    case FASL_ISTRING:
+        return r_register(r, r_string(r, SCM_STRING_INCOMPLETE));
+    case FASL_SYMBOL:
+        return r_register(r, Scm_MakeSymbol(SCM_STRING(r_string(r, 0)),
+                                            TRUE));
+    case FASL_USYMBOL:
+        return r_register(r, Scm_MakeSymbol(SCM_STRING(r_string(r, 0)),
+                                            FALSE));
+    case FASL_KEYWORD:
+        return r_register(r, Scm_MakeKeyword(SCM_STRING(r_string(r, 0))));
+    case FASL_LIST:
+        return r_list(r);
+    case FASL_VECTOR: {
+        ScmSmallInt n = r_size(r);
+        ScmObj v = r_register(r, Scm_MakeVector(n, SCM_FALSE));
+        for (ScmSmallInt i=0; i<n; i++) SCM_VECTOR_ELEMENT(v, i) = r_obj(r);
+        return v;
+    }
+    case FASL_UVECTOR:
+        return r_register(r, r_uvector(r));
+    case FASL_HASHTABLE:
+        return r_hashtable(r);
+    case FASL_INSTANCE:
+        return r_instance(r);
+    case FASL_REF: {
+        uint64_t index = r_uint(r);
+        if (index >= (uint64_t)r->count) r_error(r, "invalid reference");
+        return r->objs[index];
+    }
+    default:
+        Scm_Error("fasl-read: unknown tag 0x%02x (port: %S)", tag, r->port);
+        return SCM_UNDEFINED;   /* dummy */
+    }
+}
+
+static ScmObj fasl_read(fasl_reader *r)
+{
+    int b = Scm_GetbUnsafe(r->port);
+    if (b == EOF) return SCM_EOF;
+    if (b != FASL_MAGIC) r_error(r, "not a fasl data");
+    int version = r_byte(r);
+    if (version != SCM_FASL_VERSION) {
+        Scm_Error("fasl-read: unsupported fasl version %d (port: %S)",
+                  version, r->port);
+    }
+    return r_obj(r);
+}
+
+ScmObj Scm_FaslRead(ScmPort *port)
+{
+    fasl_reader r;
+    ScmVM *vm = Scm_VM();
+    ScmObj result = SCM_UNDEFINED;
+
+    if (!SCM_IPORTP(port)) Scm_Error("input port required, but got %S", port);
+    r.port = port;
+    r.count = 0;
+    r.size = 32;
+    r.objs = SCM_NEW_ARRAY(ScmObj, r.size);
+
+    PORT_LOCK(port, vm);
+    PORT_SAFE_CALL(port, result = fasl_read(&r), /*no cleanup*/);
+    PORT_UNLOCK(port);
+    return result;
+}
@@ -1000,4 +1000,110 @@
                   \x01\x01\x01\x01\
                   \x01\x01\x01\x01"))
 
+;;----------------------------------------------------------
+(test-section "binary.fasl")
+
+(use binary.fasl)
+(test-module 'binary.fasl)
+
+(define (fasl-roundtrip obj)
+  (u8vector->fasl (fasl->u8vector obj)))
+
+(let ()
+  (define (t obj)
+    (test* (format "fasl roundtrip ~s" obj) obj (fasl-roundtrip obj)))
+  (for-each t
+            `(#f #t () 0 1 -1 ,(greatest-fixnum) ,(least-fixnum)
+              ,(expt 2 100) ,(- (expt 3 80)) 1/3 -22/7
+              1.5 -0.0 +inf.0 1.0e-300 1+2i #\a #\x3bb
+              "" "abc" "\u3042\u3044\u3046" #*"\xff\x00"
+              foo |a b| :key (1 2 3) (1 2 . 3) #(1 "a" #(b))
+              #u8(1 2 255) #s16(-1 0 1) #u32(#xffffffff)
+              #s64(-9223372036854775808) #f32(1.5 -2.0) #f64(0.1 1e300)
+              #c64(1+2i) #c128(-1.5+0.5i)
+              ((a . b) (c . d)) ,(iota 5000))))
+
+(test* "fasl nan" #t (nan? (fasl-roundtrip +nan.0)))
+(test* "fasl incomplete string" #t
+       (string-incomplete? (fasl-roundtrip #*"abc")))
+
+(test* "fasl uninterned symbol" '(#f #t)
+       (let* ([s (string->uninterned-symbol "foo")]
+              [r (fasl-roundtrip (list s s))])
+         (list (symbol-interned? (car r))
+               (eq? (car r) (cadr r)))))
+
+(test* "fasl sharing" '(#t #t)
+       (let* ([s (list 1 2)]
+              [r (fasl-roundtrip (vector s s "x"))])
+         (list (eq? (vector-ref r 0) (vector-ref r 1))
+               (equal? (vector-ref r 0) s))))
+
+(test* "fasl shared tail" #t
+       (let* ([tail (list 3 4)]
+              [r (fasl-roundtrip (list (cons 1 tail) (cons 2 tail)))])
+         (eq? (cdr (car r)) (cdr (cadr r)))))
+
+(test* "fasl circular list" '(1 2 3 1 2 3)
+       (let* ([c (list 1 2 3)])
+         (set-cdr! (cddr c) c)
+         (let1 r (fasl-roundtrip c)
+           (take r 6))))
+
+(test* "fasl circular vector" #t
+       (let* ([v (vector 1 #f)])
+         (vector-set! v 1 v)
+         (let1 r (fasl-roundtrip v)
+           (eq? r (vector-ref r 1)))))
+
+(test* "fasl hash table" '(equal? 1 2 (x))
+       (let1 h (make-hash-table 'equal?)
+         (hash-table-put! h "a" 1)
+         (hash-table-put! h '(b) 2)
+         (hash-table-put! h 'c '(x))
+         (let1 r (fasl-roundtrip h)
+           (list (hash-table-type r)
+                 (hash-table-get r "a")
+                 (hash-table-get r '(b))
+                 (hash-table-get r 'c)))))
+
+(define-class <fasl-test> ()
+  ((a :init-keyword :a)
+   (b :init-keyword :b)))
+
+(test* "fasl instance" '(1 (2 3) #t)
+       (let* ([o (make <fasl-test> :a 1 :b '(2 3))]
+              [r (fasl-roundtrip (list o o))])
+         (list (~ (car r) 'a) (~ (car r) 'b)
+               (eq? (car r) (cadr r)))))
+
+(test* "fasl unbound slot" #f
+       (slot-bound? (fasl-roundtrip (make <fasl-test> :a 1)) 'b))
+
+(test* "fasl unserializable" (test-error)
+       (fasl->u8vector (list car)))
+
+(test* "fasl stream" '((1 2) "abc" #(x) eof)
+       (let1 out (open-output-string)
+         (fasl-write '(1 2) out)
+         (fasl-write "abc" out)
+         (fasl-write '#(x) out)
+         (let1 in (open-input-string (get-output-string out))
+           (list (fasl-read in) (fasl-read in) (fasl-read in)
+                 (if (eof-object? (fasl-read in)) 'eof 'not-eof)))))
+
+(test* "fasl truncated" (test-error)
+       (let1 v (fasl->u8vector '(1 2 3 "abcdef"))
+         (u8vector->fasl (u8vector-copy v 0 (- (u8vector-length v) 2)))))
+
+(test* "fasl bad header" (test-error)
+       (u8vector->fasl '#u8(1 2 3)))
+
+(use gauche.serializer)
+(use gauche.serializer.fasl)
+(test* "fasl serializer" '(a "b" #(1 2.0))
+       (read-from-string-with-serializer
+        <fasl-serializer>
+        (write-to-string-with-serializer <fasl-serializer> '(a "b" #(1 2.0)))))
+
 (test-end)
@@ -0,0 +1,537 @@
+;;;
+;;; control.fiber - lightweight threads
+;;;
+;;;   Copyright (c) 2026  Shiro Kawai  <shiro@acm.org>
+;;;
+;;;   Redistribution and use in source and binary forms, with or without
+;;;   modification, are permitted provided that the following conditions
+;;;   are met:
+;;;
+;;;   1. Redistributions of source code must retain the above copyright
+;;;      notice, this list of conditions and the following disclaimer.
+;;;
+;;;   2. Redistributions in binary form must reproduce the above copyright
+;;;      notice, this list of conditions and the following disclaimer in the
+;;;      documentation and/or other materials provided with the distribution.
+;;;
+;;;   3. Neither the name of the authors nor the names of its contributors
+;;;      may be used to endorse or promote products derived from this
+;;;      software without specific prior written permission.
+;;;
+;;;   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+;;;   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+;;;   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+;;;   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+;;;   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+;;;   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+;;;   TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+;;;   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+;;;   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+;;;   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+;;;   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+;;;
+
+;; A fiber is a computation that runs on one of a small number of
+;; threads (carriers) owned by a fiber scheduler.  When a fiber needs
+;; to wait---for a file descriptor to become ready, for a timer, or
+;; for another fiber---it captures its partial continuation and
+;; returns the carrier to the scheduler.  The reactor thread of the
+;; scheduler waits on all such file descriptors and timers at once,
+;; using epoll when available and select otherwise, and puts the
+;; fiber back to the run queue when the event arrives.  The fiber
+;; may be resumed on a different carrier.
+
+(define-module control.fiber
+  (use gauche.threads)
+  (use gauche.partcont)
+  (use gauche.atomic)
+  (use data.queue)
+  (use data.heap)
+  (use scheme.list)
+  (export <fiber> <fiber-scheduler>
+          make-fiber-scheduler fiber-scheduler? default-fiber-scheduler
+          fiber-scheduler-shutdown!
+          spawn-fiber fiber? fiber-name fiber-state fiber-join
+          current-fiber fiber-yield fiber-sleep
+          fiber-wait-readable fiber-wait-writable))
+(select-module control.fiber)
+
+;;;
+;;; Readiness notification
+;;;
+
+;; We only use one-shot notification: Once an event is reported on
+;; a descriptor, it is disarmed until it is armed again.  EVENTS is
+;; a bitmask, 1 for readable and 2 for writable.  Errors and hangups
+;; are reported as both.
+
+(inline-stub
+ (.include <gauche/priv/configP.h>)
+
+ (define-cproc %epoll-available? () ::<boolean>
+   (.if (defined HAVE_SYS_EPOLL_H)
+     (return TRUE)
+     (return FALSE)))
+
+ (.when (defined HAVE_SYS_EPOLL_H)
+   (.include <sys/epoll.h>)
+
+   (define-cproc %epoll-create () ::<int>
+     (let* ([fd::int (epoll_create1 EPOLL_CLOEXEC)])
+       (when (< fd 0) (Scm_SysError "epoll_create1 failed"))
+       (return fd)))
+
+   (define-cproc %epoll-close (epfd::<int>) ::<void>
+     (close epfd))
+
+   (define-cproc %epoll-arm (epfd::<int> fd::<int> events::<int>) ::<void>
+     (let* ([ev::(struct epoll_event)] [r::int 0])
+       (set! (ref ev events) EPOLLONESHOT
+             (ref ev data fd) fd)
+       (when (logand events 1)
+         (logior= (ref ev events) (logior EPOLLIN EPOLLRDHUP)))
+       (when (logand events 2)
+         (logior= (ref ev events) EPOLLOUT))
+       (set! r (epoll_ctl epfd EPOLL_CTL_MOD fd (& ev)))
+       (when (and (< r 0) (== errno ENOENT))
+         (set! r (epoll_ctl epfd EPOLL_CTL_ADD fd (& ev))))
+       (when (< r 0)
+         (Scm_SysError "epoll_ctl failed on file descriptor %d" fd))))
+
+   ;; Returns a list of (fd . events).  TIMEOUT-MS < 0 waits indefinitely.
+   (define-cproc %epoll-wait (epfd::<int> timeout-ms::<int>)
+     (let* ([evs::(.array (struct epoll_event) (64))]
+            [n::int 0]
+            [h SCM_NIL] [t SCM_NIL])
+       (SCM_SYSCALL n (epoll_wait epfd evs 64 timeout-ms))
+       (when (< n 0) (Scm_SysError "epoll_wait failed"))
+       (dotimes [i n]
+         (let* ([e::uint32_t (ref (aref evs i) events)]
+                [bits::int 0])
+           (when (logand e (logior EPOLLIN EPOLLRDHUP EPOLLHUP EPOLLERR))
+             (logior= bits 1))
+           (when (logand e (logior EPOLLOUT EPOLLHUP EPOLLERR))
+             (logior= bits 2))
+           (SCM_APPEND1 h t (Scm_Cons (SCM_MAKE_INT (ref (aref evs i) data fd))
+                                      (SCM_MAKE_INT bits)))))
+       (return h)))
+   ) ;; defined(HAVE_SYS_EPOLL_H)
+ )
+
+;;;
+;;; Data structures
+;;;
+
+(define-record-type <fiber>
+  (%make-fiber name scheduler resume cont state result error? joiners)
+  fiber?
+  (name      fiber-name)
+  (scheduler fiber-scheduler)
+  (resume    fiber-resume fiber-resume-set!)   ; thunk to run next
+  (cont      fiber-cont fiber-cont-set!)       ; partial continuation
+  (state     fiber-state fiber-state-set!)     ; runnable, running, waiting, done
+  (result    fiber-result fiber-result-set!)   ; list of values, or condition
+  (error?    fiber-error? fiber-error?-set!)
+  (joiners   fiber-joiners fiber-joiners-set!)) ; list of <waiter>s
+
+(define-method write-object ((f <fiber>) port)
+  (format port "#<fiber ~s ~a>" (fiber-name f) (fiber-state f)))
+
+;; A waiter is a suspended fiber waiting for some events.  The same
+;; waiter can be registered to more than one event sources (e.g. a
+;; descriptor and a timer); whichever fires first wins.
+(define-record-type <waiter>
+  (%make-waiter fiber flag fired?)
+  waiter?
+  (fiber  waiter-fiber)
+  (flag   waiter-flag)
+  (fired? waiter-fired? waiter-fired?-set!))  ; hint for pruning
+
+(define (make-waiter fiber) (%make-waiter fiber (make-atomic-flag) #f))
+
+;; Returns #t iff we're the first one to fire W.
+(define (claim! w)
+  (and (not (atomic-flag-test-and-set! (waiter-flag w)))
+       (begin (waiter-fired?-set! w #t) #t)))
+
+(define-record-type <fiber-scheduler>
+  (%make-scheduler run-queue carriers lock cv closed?
+                   epfd wake-in wake-out poked? reactor fds timers)
+  fiber-scheduler?
+  (run-queue sched-run-queue)           ; <mpmc-queue> of runnable fibers
+  (carriers  sched-carriers sched-carriers-set!)
+  ;; The rest are protected by the lock.
+  (lock      sched-lock)
+  (cv        sched-cv)                  ; signaled when a fiber finishes
+  (closed?   sched-closed? sched-closed?-set!)
+  (epfd      sched-epfd)                ; epoll fd, or #f to use select
+  (wake-in   sched-wake-in)             ; self-pipe to wake up the reactor
+  (wake-out  sched-wake-out)
+  (poked?    sched-poked? sched-poked?-set!)
+  (reactor   sched-reactor sched-reactor-set!)
+  (fds       sched-fds)                 ; fd -> (readers . writers)
+  (timers    sched-timers))             ; heap of (deadline waiter . fd)
+
+(define-method write-object ((s <fiber-scheduler>) port)
+  (format port "#<fiber-scheduler ~a carriers~a>"
+          (length (sched-carriers s))
+          (if (sched-closed? s) " (shut down)" "")))
+
+(define (now)
+  (receive (sec nsec) (sys-clock-gettime-monotonic)
+    (if sec
+      (+ sec (* nsec 1e-9))
+      (time->seconds (current-time)))))
+
+;;;
+;;; Running fibers
+;;;
+
+(define %current-fiber (make-thread-local #f))
+
+(define (current-fiber) (tlref %current-fiber))
+
+;; Each carrier runs a fiber until it finishes or suspends.  The result
+;; of the reset is a thunk to be executed after the fiber leaves the
+;; carrier; it finishes the fiber, or registers it to wake up.
+(define (carrier-loop s)
+  (let loop ()
+    (let1 f (dequeue/wait! (sched-run-queue s))
+      (when (fiber? f)
+        (let1 resume (fiber-resume f)
+          (fiber-resume-set! f #f)
+          (fiber-state-set! f 'running)
+          (tlset! %current-fiber f)
+          (let1 next (guard (e [else (^[] (finish! f e #t))])
+                       (reset (resume)))
+            (tlset! %current-fiber #f)
+            (next)))
+        (loop)))))
+
+(define (finish! f result error?)
+  (let1 s (fiber-scheduler f)
+    (with-locking-mutex (sched-lock s)
+      (^[]
+        (fiber-result-set! f result)
+        (fiber-error?-set! f error?)
+        (fiber-state-set! f 'done)
+        (dolist [w (fiber-joiners f)] (wakeup! w #t))
+        (fiber-joiners-set! f '())
+        (condition-variable-broadcast! (sched-cv s))))))
+
+;; Suspends the current fiber F.  REGISTER is called after F leaves the
+;; carrier; it should arrange F to be resumed by resume-with!.
+;; Returns the value F is resumed with.
+(define (suspend! f register)
+  ((call/pc (^k
+             (fiber-cont-set! f k)
+             (fiber-state-set! f 'waiting)
+             register))))
+
+;; THUNK is called in F when it is resumed.
+(define (resume-with! f thunk)
+  (let1 k (fiber-cont f)
+    (fiber-cont-set! f #f)
+    (fiber-resume-set! f (^[] (k thunk)))
+    (fiber-state-set! f 'runnable)
+    (enqueue! (sched-run-queue (fiber-scheduler f)) f)))
+
+;; Returns #t iff W hasn't been fired and we're the one to wake it up.
+(define (wakeup! w val)
+  (and (claim! w)
+       (begin (resume-with! (waiter-fiber w) (^[] val)) #t)))
+
+(define (wakeup-with-error! w e)
+  (and (claim! w)
+       (begin (resume-with! (waiter-fiber w) (^[] (raise e))) #t)))
+
+;;;
+;;; Reactor
+;;;
+
+;; Must be called with the lock held.
+(define (poke! s)
+  (unless (sched-poked? s)
+    (sched-poked?-set! s #t)
+    (write-u8 0 (sched-wake-out s))))
+
+(define (drain-wakeup! s)
+  (let1 in (sched-wake-in s)
+    (let loop ()
+      (when (byte-ready? in)
+        (read-u8 in)
+        (loop)))
+    (and-let1 epfd (sched-epfd s)
+      (%epoll-arm epfd (port-file-number in) 1))))
+
+;; Must be called with the lock held.  Arms FD according to the live
+;; waiters in ENTRY, or forgets FD if there's none.
+(define (arm-fd! s fd entry)
+  (let ([rs (remove waiter-fired? (car entry))]
+        [ws (remove waiter-fired? (cdr entry))])
+    (if (and (null? rs) (null? ws))
+      (hash-table-delete! (sched-fds s) fd)
+      (let1 bits (logior (if (null? rs) 0 1) (if (null? ws) 0 2))
+        (if-let1 epfd (sched-epfd s)
+          (%epoll-arm epfd fd bits)
+          (unless (eq? (current-thread) (sched-reactor s))
+            (poke! s)))
+        (set-car! entry rs)
+        (set-cdr! entry ws)
+        (hash-table-put! (sched-fds s) fd entry)))))
+
+;; Must be called with the lock held.
+(define (add-timer! s seconds w fd)
+  (let ([h (sched-timers s)]
+        [deadline (+ (now) seconds)])
+    (when (or (binary-heap-empty? h)
+              (< deadline (car (binary-heap-find-min h))))
+      (poke! s))
+    (binary-heap-push! h (list* deadline w fd))))
+
+(define (next-timeout s)
+  (let1 h (sched-timers s)
+    (and (not (binary-heap-empty? h))
+         (max 0 (- (car (binary-heap-find-min h)) (now))))))
+
+(define (fire-timers! s)
+  (let ([h (sched-timers s)]
+        [t (now)])
+    (let loop ()
+      (unless (binary-heap-empty? h)
+        (let1 e (binary-heap-find-min h)
+          (when (<= (car e) t)
+            (binary-heap-pop-min! h)
+            (when (and (wakeup! (cadr e) #f) (cddr e))
+              (and-let1 entry (hash-table-get (sched-fds s) (cddr e) #f)
+                (arm-fd! s (cddr e) entry)))
+            (loop)))))))
+
+(define (dispatch-fd! s fd bits)
+  (if (eqv? fd (port-file-number (sched-wake-in s)))
+    (drain-wakeup! s)
+    (and-let1 entry (hash-table-get (sched-fds s) fd #f)
+      (when (logtest bits 1)
+        (dolist [w (car entry)] (wakeup! w #t))
+        (set-car! entry '()))
+      (when (logtest bits 2)
+        (dolist [w (cdr entry)] (wakeup! w #t))
+        (set-cdr! entry '()))
+      (arm-fd! s fd entry))))
+
+;; Fallback when epoll isn't available.
+(define (select-events s timeout)
+  (let ([r (make <sys-fdset>)]
+        [w (make <sys-fdset>)])
+    (set! (sys-fdset-ref r (sched-wake-in s)) #t)
+    (with-locking-mutex (sched-lock s)
+      (^[]
+        (hash-table-for-each (sched-fds s)
+                             (^[fd entry]
+                               (unless (null? (car entry))
+                                 (set! (sys-fdset-ref r fd) #t))
+                               (unless (null? (cdr entry))
+                                 (set! (sys-fdset-ref w fd) #t))))))
+    (let1 maxfd (max (sys-fdset-max-fd r) (sys-fdset-max-fd w))
+      (receive (n rr ww _)
+          (sys-select r w #f (and timeout (ceiling->exact (* timeout 1e6))))
+        (if (<= n 0)
+          '()
+          (filter-map (^[fd]
+                        (let1 bits (logior (if (sys-fdset-ref rr fd) 1 0)
+                                           (if (sys-fdset-ref ww fd) 2 0))
+                          (and (> bits 0) (cons fd bits))))
+                      (iota (+ maxfd 1))))))))
+
+(define (reactor-loop s)
+  (let loop ()
+    (let1 timeout (with-locking-mutex (sched-lock s)
+                    (^[]
+                      (sched-poked?-set! s #f)
+                      (next-timeout s)))
+      (let1 events
+          (if-let1 epfd (sched-epfd s)
+            (%epoll-wait epfd (if timeout
+                                (min (ceiling->exact (* timeout 1000))
+                                     1000000000)
+                                -1))
+            (select-events s timeout))
+        (with-locking-mutex (sched-lock s)
+          (^[]
+            (dolist [ev events] (dispatch-fd! s (car ev) (cdr ev)))
+            (fire-timers! s)))
+        (unless (sched-closed? s) (loop))))))
+
+;;;
+;;; Scheduler
+;;;
+
+(define (make-fiber-scheduler :key (num-carriers (sys-available-processors)))
+  (assume (and (exact-integer? num-carriers) (positive? num-carriers))
+          "num-carriers must be a positive exact integer, but got:"
+          num-carriers)
+  (receive (in out) (sys-pipe :buffering :none)
+    (rlet1 s (%make-scheduler (make-mpmc-queue) '()
+                              (make-mutex) (make-condition-variable) #f
+                              (and (%epoll-available?) (%epoll-create))
+                              in out #f #f
+                              (make-hash-table eqv-comparator)
+                              (make-binary-heap :key car))
+      (and-let1 epfd (sched-epfd s)
+        (%epoll-arm epfd (port-file-number in) 1))
+      (sched-reactor-set! s (thread-start!
+                             (make-thread (^[] (reactor-loop s))
+                                          'fiber-reactor)))
+      (sched-carriers-set! s (list-tabulate
+                              num-carriers
+                              (^i (thread-start!
+                                   (make-thread (^[] (carrier-loop s))
+                                                'fiber-carrier))))))))
+
+(define *default-scheduler* #f)
+(define *default-scheduler-lock* (make-mutex))
+
+(define (default-fiber-scheduler)
+  (with-locking-mutex *default-scheduler-lock*
+    (^[]
+      (or *default-scheduler*
+          (rlet1 s (make-fiber-scheduler)
+            (set! *default-scheduler* s))))))
+
+;; Fibers that haven't finished are abandoned.
+(define (fiber-scheduler-shutdown! s)
+  (when (and-let1 f (current-fiber) (eq? (fiber-scheduler f) s))
+    (error "Can't shut down the scheduler from its own fiber:" s))
+  (unless (with-locking-mutex (sched-lock s)
+            (^[]
+              (begin0 (sched-closed? s)
+                (sched-closed?-set! s #t)
+                (poke! s))))
+    (dolist [_ (sched-carriers s)] (enqueue! (sched-run-queue s) #f))
+    (for-each thread-join! (sched-carriers s))
+    (thread-join! (sched-reactor s))
+    (and-let1 epfd (sched-epfd s) (%epoll-close epfd))
+    (close-port (sched-wake-in s))
+    (close-port (sched-wake-out s))
+    (with-locking-mutex *default-scheduler-lock*
+      (^[] (when (eq? *default-scheduler* s)
+             (set! *default-scheduler* #f))))))
+
+;;;
+;;; Fiber API
+;;;
+
+(define (spawn-fiber thunk :key (name #f) (scheduler #f))
+  (let* ([s (or scheduler
+                (and-let1 f (current-fiber) (fiber-scheduler f))
+                (default-fiber-scheduler))]
+         [f (%make-fiber name s #f #f 'runnable #f #f '())])
+    (when (sched-closed? s)
+      (error "Fiber scheduler is already shut down:" s))
+    (fiber-resume-set! f (^[]
+                           (receive vals (thunk)
+                             (^[] (finish! f vals #f)))))
+    (enqueue! (sched-run-queue s) f)
+    f))
+
+(define (fiber-yield)
+  (if-let1 f (current-fiber)
+    (suspend! f (^[] (resume-with! f (^[] #t))))
+    (thread-yield!))
+  (undefined))
+
+(define (fiber-sleep seconds)
+  (if-let1 f (current-fiber)
+    (let ([s (fiber-scheduler f)]
+          [w (make-waiter f)])
+      (suspend! f (^[] (with-locking-mutex (sched-lock s)
+                         (^[] (add-timer! s seconds w #f))))))
+    (thread-sleep! seconds))
+  (undefined))
+
+(define (fiber-join f :optional (timeout #f) (timeout-val #f))
+  (define (result)
+    (if (fiber-error? f)
+      (raise (fiber-result f))
+      (apply values (fiber-result f))))
+  (let ([s (fiber-scheduler f)]
+        [self (current-fiber)])
+    (cond
+     [(eq? f self) (error "A fiber can't join itself:" f)]
+     [self
+      (let1 w (make-waiter self)
+        (if (suspend! self
+                      (^[]
+                        (with-locking-mutex (sched-lock s)
+                          (^[]
+                            (if (eq? (fiber-state f) 'done)
+                              (wakeup! w #t)
+                              (fiber-joiners-set! f (cons w (fiber-joiners f))))))
+                        (when timeout
+                          (let1 s2 (fiber-scheduler self)
+                            (with-locking-mutex (sched-lock s2)
+                              (^[] (add-timer! s2 timeout w #f)))))))
+          (result)
+          timeout-val))]
+     [else
+      (let ([m (sched-lock s)]
+            [deadline (and timeout
+                           (seconds->time (+ (time->seconds (current-time))
+                                             timeout)))])
+        (let loop ()
+          (mutex-lock! m)
+          (cond [(eq? (fiber-state f) 'done) (mutex-unlock! m) (result)]
+                [(mutex-unlock! m (sched-cv s) deadline) (loop)]
+                [else timeout-val])))])))
+
+(define (->fd port-or-fd)
+  (cond [(exact-integer? port-or-fd) port-or-fd]
+        [(port-file-number port-or-fd)]
+        [else (error "Port doesn't have a file descriptor:" port-or-fd)]))
+
+;; DIR is 1 for read, 2 for write.
+(define (wait-fd port-or-fd dir timeout)
+  (let1 fd (->fd port-or-fd)
+    (cond
+     [(and (= dir 1) (input-port? port-or-fd) (byte-ready? port-or-fd)) #t]
+     [(current-fiber)
+      => (^[f]
+           (let ([s (fiber-scheduler f)]
+                 [w (make-waiter f)])
+             (suspend! f
+                       (^[]
+                         ;; epoll refuses regular files, which are
+                         ;; always ready.
+                         (guard (e [(and (<system-error> e)
+                                         (eqv? (~ e'errno) EPERM))
+                                    (wakeup! w #t)]
+                                   [else (wakeup-with-error! w e)])
+                           (with-locking-mutex (sched-lock s)
+                             (^[]
+                               (let1 entry (or (hash-table-get (sched-fds s)
+                                                               fd #f)
+                                               (cons '() '()))
+                                 (arm-fd! s fd
+                                          (if (= dir 1)
+                                            (cons (cons w (car entry))
+                                                  (cdr entry))
+                                            (cons (car entry)
+                                                  (cons w (cdr entry)))))
+                                 (when timeout
+                                   (add-timer! s timeout w fd))))))))))]
+     [else
+      (let1 fds (make <sys-fdset>)
+        (set! (sys-fdset-ref fds fd) #t)
+        (receive (n . _)
+            (if (= dir 1)
+              (sys-select fds #f #f
+                          (and timeout (ceiling->exact (* timeout 1e6))))
+              (sys-select #f fds #f
+                          (and timeout (ceiling->exact (* timeout 1e6)))))
+          (> n 0)))])))
+
+(define (fiber-wait-readable port-or-fd :optional (timeout #f))
+  (wait-fd port-or-fd 1 timeout))
+
+(define (fiber-wait-writable port-or-fd :optional (timeout #f))
+  (wait-fd port-or-fd 2 timeout))
@@ -0,0 +1,146 @@
+;;
+;; testing control.* extensions
+;;
+
+(use gauche.test)
+(use gauche.threads)
+
+(test-start "control.* extensions")
+
+;;-----------------------------------------------
+(test-section "control.fiber")
+(use control.fiber)
+(test-module 'control.fiber)
+
+(define sched (make-fiber-scheduler :num-carriers 2))
+
+(test* "spawn and join" '(3 4)
+       (let ([a (spawn-fiber (^[] (+ 1 2)) :scheduler sched)]
+             [b (spawn-fiber (^[] (values 4 'x)) :scheduler sched)])
+         (list (fiber-join a)
+               (receive (x y) (fiber-join b) x))))
+
+(test* "join error" '(caught "boom")
+       (let1 f (spawn-fiber (^[] (error "boom")) :scheduler sched)
+         (guard (e [(error? e) (list 'caught (condition-message e))])
+           (fiber-join f))))
+
+;; The error is raised from a resumed continuation, after the fiber has
+;; been suspended once.
+(test* "join error after resumption" '((caught "boom yield")
+                                       (caught "boom sleep"))
+       (let ([fy (spawn-fiber (^[] (fiber-yield) (fiber-yield)
+                                (error "boom yield"))
+                              :scheduler sched)]
+             [fs (spawn-fiber (^[] (fiber-sleep 0.05) (error "boom sleep"))
+                              :scheduler sched)])
+         (map (^f (guard (e [(error? e) (list 'caught (condition-message e))])
+                    (fiber-join f)))
+              (list fy fs))))
+
+(test* "current-fiber" '(#f #t)
+       (list (current-fiber)
+             (let1 f (spawn-fiber (^[] (current-fiber)) :scheduler sched)
+               (eq? f (fiber-join f)))))
+
+(test* "yield interleaving" #t
+       (let* ([log '()]
+              [go #f]
+              [s1 (make-fiber-scheduler :num-carriers 1)]
+              ;; With a single carrier, fibers take turns at each yield.
+              [body (^[tag] (^[]
+                              (until go (fiber-yield))
+                              (dotimes [3] (push! log tag) (fiber-yield))))]
+              [fa (spawn-fiber (body 'a) :scheduler s1)]
+              [fb (spawn-fiber (body 'b) :scheduler s1)])
+         (set! go #t)
+         (fiber-join fa)
+         (fiber-join fb)
+         (fiber-scheduler-shutdown! s1)
+         (boolean (member log '((a b a b a b) (b a b a b a))))))
+
+(test* "sleep" #t
+       (let* ([t0 (current-microseconds)]
+              [fs (map (^_ (spawn-fiber (^[] (fiber-sleep 0.1)) :scheduler sched))
+                       (iota 50))])
+         (for-each fiber-join fs)
+         ;; 50 sleeping fibers on two carriers don't take 50*0.1 secs.
+         (< (- (current-microseconds) t0) 2000000)))
+
+(test* "fiber joins fiber" 55
+       (letrec ([fib (^n (if (< n 2)
+                           n
+                           (let ([a (spawn-fiber (^[] (fib (- n 1))))]
+                                 [b (spawn-fiber (^[] (fib (- n 2))))])
+                             (+ (fiber-join a) (fiber-join b)))))])
+         (fiber-join (spawn-fiber (^[] (fib 10)) :scheduler sched))))
+
+(test* "join timeout" '(timeout done)
+       (let* ([slow (spawn-fiber (^[] (fiber-sleep 0.5) 'done) :scheduler sched)]
+              [r (fiber-join (spawn-fiber (^[] (fiber-join slow 0.05 'timeout))
+                                          :scheduler sched))])
+         (list r (fiber-join slow))))
+
+(test* "thread join timeout" 'timeout
+       (fiber-join (spawn-fiber (^[] (fiber-sleep 0.5)) :scheduler sched)
+                   0.05 'timeout))
+
+(test* "wait readable" '("hello" "world")
+       (receive (in out) (sys-pipe)
+         (let1 f (spawn-fiber (^[]
+                                (let loop ([r '()])
+                                  (fiber-wait-readable in)
+                                  (let1 line (read-line in)
+                                    (if (eof-object? line)
+                                      (reverse r)
+                                      (loop (cons line r))))))
+                              :scheduler sched)
+           (fiber-sleep 0.05)
+           (display "hello\n" out) (flush out)
+           (fiber-sleep 0.05)
+           (display "world\n" out)
+           (close-port out)
+           (begin0 (fiber-join f)
+             (close-port in)))))
+
+(test* "wait readable timeout" #f
+       (receive (in out) (sys-pipe)
+         (begin0
+             (fiber-join (spawn-fiber (^[] (fiber-wait-readable in 0.05))
+                                      :scheduler sched))
+           (close-port in)
+           (close-port out))))
+
+(test* "wait writable" #t
+       (receive (in out) (sys-pipe)
+         (begin0
+             (fiber-join (spawn-fiber (^[] (fiber-wait-writable out))
+                                      :scheduler sched))
+           (close-port in)
+           (close-port out))))
+
+(test* "many fibers over pipes" (* 100 4950)
+       (let* ([n 100]
+              [pipes (map (^_ (receive (in out) (sys-pipe) (cons in out)))
+                          (iota n))]
+              [readers
+               (map (^p (spawn-fiber
+                         (^[] (let loop ([sum 0])
+                                (fiber-wait-readable (car p))
+                                (let1 x (read (car p))
+                                  (if (eof-object? x)
+                                    sum
+                                    (loop (+ sum x))))))
+                         :scheduler sched))
+                    pipes)])
+         (dotimes [i n]
+           (dolist [p pipes] (write i (cdr p)) (newline (cdr p)) (flush (cdr p))))
+         (dolist [p pipes] (close-port (cdr p)))
+         (begin0 (apply + (map fiber-join readers))
+           (dolist [p pipes] (close-port (car p))))))
+
+(test* "spawn after shutdown" (test-error)
+       (begin (fiber-scheduler-shutdown! sched)
+              (spawn-fiber (^[] 1) :scheduler sched)))
+
+(test-end)
@@ -0,0 +1,437 @@
+/*
+ * mpmc.c - lock-free multi-producer multi-consumer queue
+ *
+ *   Copyright (c) 2025  Shiro Kawai  <shiro@acm.org>
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *   3. Neither the name of the authors nor the names of its contributors
+ *      may be used to endorse or promote products derived from this
+ *      software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ *   TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <gauche.h>
+#include <gauche/extend.h>
+#include <gauche/priv/configP.h>
+#include <gauche/priv/atomicP.h>
+#include "mpmc.h"
+
+/* <mpmc-queue> comes in two flavors.
+
+   A bounded queue is a ring buffer of cells, each of which has a
+   sequence number telling whether the cell is ready to be written or
+   to be read at the current lap (D. Vyukov's bounded MPMC queue).
+   Producers and consumers only contend on enqPos and deqPos, which
+   are advanced by CAS.
+
+   An unbounded queue is a linked list of fixed-size segments.  A
+   producer claims a slot by advancing the tail segment's enq counter,
+   and appends a new segment when the tail one is full.  A consumer
+   claims a slot by advancing the head segment's deq counter, and
+   moves the head forward when the segment is used up.  A consumer may
+   claim a slot whose producer hasn't stored the item yet; it spins
+   until the item appears, which is only a few instructions unless the
+   producer is preempted.  Since segments are reclaimed by GC, we
+   don't need to worry about ABA problems.
+
+   Threads only block on the mutex and condition variables when the
+   queue is empty (readers) or full (writers).  A blocking thread
+   increments numReaders/numWriters before retrying the operation
+   with the mutex held, and the other side checks the counter after
+   its operation, so that a wakeup is never lost.
+*/
+
+#define MPMC_SEGMENT_SIZE  256
+#define MPMC_CACHE_LINE    64
+
+typedef struct mpmc_cell_rec {
+    ScmAtomicVar seq;
+    ScmAtomicVar data;
+} mpmc_cell;
+
+typedef struct mpmc_segment_rec {
+    ScmAtomicVar next;          /* mpmc_segment*, or 0 */
+    ScmAtomicVar enq;           /* # of slots claimed by producers */
+    ScmAtomicVar deq;           /* # of slots claimed by consumers */
+    ScmAtomicVar slots[MPMC_SEGMENT_SIZE]; /* 0 if not stored yet */
+} mpmc_segment;
+
+struct ScmMpmcQueueRec {
+    SCM_HEADER;
+    ScmSmallInt maxlen;         /* negative if unbounded */
+    mpmc_cell *cells;           /* bounded queue */
+    ScmAtomicVar enqPos;        /* bounded: next position to write
+                                   unbounded: tail segment */
+    char pad1[MPMC_CACHE_LINE - sizeof(ScmAtomicVar)];
+    ScmAtomicVar deqPos;        /* bounded: next position to read
+                                   unbounded: head segment */
+    char pad2[MPMC_CACHE_LINE - sizeof(ScmAtomicVar)];
+    ScmAtomicVar numReaders;    /* # of blocking readers */
+    ScmAtomicVar numWriters;    /* # of blocking writers */
+    ScmInternalMutex mutex;
+    ScmInternalCond readerWait;
+    ScmInternalCond writerWait;
+};
+
+static void mpmc_print(ScmObj obj, ScmPort *port, ScmWriteContext *ctx);
+
+SCM_DEFINE_BUILTIN_CLASS_SIMPLE(Scm_MpmcQueueClass, mpmc_print);
+
+static void atomic_add(ScmAtomicVar *var, ScmAtomicWord delta)
+{
+    ScmAtomicWord v = Scm_AtomicLoad(var);
+    while (!Scm_AtomicCompareExchange(var, &v, v + delta))
+        ;
+}
+
+static mpmc_segment *make_segment(void)
+{
+    mpmc_segment *s = SCM_NEW(mpmc_segment);
+    Scm_AtomicStore(&s->next, 0);
+    Scm_AtomicStore(&s->enq, 0);
+    Scm_AtomicStore(&s->deq, 0);
+    for (int i=0; i<MPMC_SEGMENT_SIZE; i++) Scm_AtomicStore(&s->slots[i], 0);
+    return s;
+}
+
+ScmObj Scm_MakeMpmcQueue(ScmSmallInt maxlen)
+{
+    if (maxlen == 0) {
+        Scm_Error("max-length of <mpmc-queue> must be positive or #f");
+    }
+    ScmMpmcQueue *q = SCM_NEW(ScmMpmcQueue);
+    SCM_SET_CLASS(q, SCM_CLASS_MPMC_QUEUE);
+    q->maxlen = maxlen;
+    if (maxlen > 0) {
+        q->cells = SCM_NEW_ARRAY(mpmc_cell, maxlen);
+        for (ScmSmallInt i=0; i<maxlen; i++) {
+            Scm_AtomicStore(&q->cells[i].seq, i);
+            Scm_AtomicStore(&q->cells[i].data, 0);
+        }
+        Scm_AtomicStore(&q->enqPos, 0);
+        Scm_AtomicStore(&q->deqPos, 0);
+    } else {
+        mpmc_segment *s = make_segment();
+        q->cells = NULL;
+        Scm_AtomicStore(&q->enqPos, (ScmAtomicWord)s);
+        Scm_AtomicStore(&q->deqPos, (ScmAtomicWord)s);
+    }
+    Scm_AtomicStore(&q->numReaders, 0);
+    Scm_AtomicStore(&q->numWriters, 0);
+    SCM_INTERNAL_MUTEX_INIT(q->mutex);
+    SCM_INTERNAL_COND_INIT(q->readerWait);
+    SCM_INTERNAL_COND_INIT(q->writerWait);
+    return SCM_OBJ(q);
+}
+
+/*
+ * Bounded queue
+ */
+
+static int bounded_enqueue(ScmMpmcQueue *q, ScmObj obj)
+{
+    ScmAtomicWord pos = Scm_AtomicLoad(&q->enqPos);
+    for (;;) {
+        mpmc_cell *c = &q->cells[pos % q->maxlen];
+        ScmAtomicWord seq = Scm_AtomicLoad(&c->seq);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            if (Scm_AtomicCompareExchange(&q->enqPos, &pos, pos+1)) {
+                Scm_AtomicStore(&c->data, (ScmAtomicWord)obj);
+                Scm_AtomicStore(&c->seq, pos+1);
+                return TRUE;
+            }
+            /* pos is updated by the failed CAS */
+        } else if (dif < 0) {
+            return FALSE;       /* full */
+        } else {
+            pos = Scm_AtomicLoad(&q->enqPos);
+        }
+    }
+}
+
+/* Enqueue N objects in the list OBJS at once.  We claim N consecutive
+   positions by a single CAS, only when all of their cells are ready
+   at the current lap; so either all objects are enqueued, or none. */
+static int bounded_enqueue_n(ScmMpmcQueue *q, ScmObj objs, ScmSmallInt n)
+{
+    if (n > q->maxlen) return FALSE;
+    ScmAtomicWord pos = Scm_AtomicLoad(&q->enqPos);
+    for (;;) {
+        int retry = FALSE;
+        for (ScmSmallInt k=0; k<n; k++) {
+            mpmc_cell *c = &q->cells[(pos+k) % q->maxlen];
+            intptr_t dif = (intptr_t)Scm_AtomicLoad(&c->seq) - (intptr_t)(pos+k);
+            if (dif < 0) return FALSE; /* not enough room */
+            if (dif > 0) { retry = TRUE; break; }
+        }
+        if (retry) {
+            pos = Scm_AtomicLoad(&q->enqPos);
+            continue;
+        }
+        if (Scm_AtomicCompareExchange(&q->enqPos, &pos, pos+n)) {
+            for (ScmSmallInt k=0; k<n; k++, objs = SCM_CDR(objs)) {
+                mpmc_cell *c = &q->cells[(pos+k) % q->maxlen];
+                Scm_AtomicStore(&c->data, (ScmAtomicWord)SCM_CAR(objs));
+                Scm_AtomicStore(&c->seq, pos+k+1);
+            }
+            return TRUE;
+        }
+        /* pos is updated by the failed CAS */
+    }
+}
+
+static int bounded_dequeue(ScmMpmcQueue *q, ScmObj *result)
+{
+    ScmAtomicWord pos = Scm_AtomicLoad(&q->deqPos);
+    for (;;) {
+        mpmc_cell *c = &q->cells[pos % q->maxlen];
+        ScmAtomicWord seq = Scm_AtomicLoad(&c->seq);
+        intptr_t dif = (intptr_t)seq - (intptr_t)(pos+1);
+        if (dif == 0) {
+            if (Scm_AtomicCompareExchange(&q->deqPos, &pos, pos+1)) {
+                *result = SCM_OBJ(Scm_AtomicLoad(&c->data));
+                Scm_AtomicStore(&c->data, 0); /* be friendly to GC */
+                Scm_AtomicStore(&c->seq, pos + q->maxlen);
+                return TRUE;
+            }
+        } else if (dif < 0) {
+            return FALSE;       /* empty */
+        } else {
+            pos = Scm_AtomicLoad(&q->deqPos);
+        }
+    }
+}
+
+/*
+ * Unbounded queue
+ */
+
+static void segmented_enqueue(ScmMpmcQueue *q, ScmObj obj)
+{
+    for (;;) {
+        ScmAtomicWord tw = Scm_AtomicLoad(&q->enqPos);
+        mpmc_segment *t = (mpmc_segment*)tw;
+        ScmAtomicWord i = Scm_AtomicLoad(&t->enq);
+        if (i < MPMC_SEGMENT_SIZE) {
+            if (Scm_AtomicCompareExchange(&t->enq, &i, i+1)) {
+                Scm_AtomicStore(&t->slots[i], (ScmAtomicWord)obj);
+                return;
+            }
+            continue;
+        }
+        /* The tail segment is full. */
+        ScmAtomicWord next = Scm_AtomicLoad(&t->next);
+        if (next == 0) {
+            mpmc_segment *s = make_segment();
+            Scm_AtomicStore(&s->slots[0], (ScmAtomicWord)obj);
+            Scm_AtomicStore(&s->enq, 1);
+            if (Scm_AtomicCompareExchange(&t->next, &next, (ScmAtomicWord)s)) {
+                (void)Scm_AtomicCompareExchange(&q->enqPos, &tw,
+                                                (ScmAtomicWord)s);
+                return;
+            }
+            /* Someone else appended a segment; next is updated. */
+        }
+        (void)Scm_AtomicCompareExchange(&q->enqPos, &tw, next);
+    }
+}
+
+static int segmented_dequeue(ScmMpmcQueue *q, ScmObj *result)
+{
+    for (;;) {
+        ScmAtomicWord hw = Scm_AtomicLoad(&q->deqPos);
+        mpmc_segment *h = (mpmc_segment*)hw;
+        ScmAtomicWord i = Scm_AtomicLoad(&h->deq);
+        if (i >= MPMC_SEGMENT_SIZE) {
+            ScmAtomicWord next = Scm_AtomicLoad(&h->next);
+            if (next == 0) return FALSE;
+            (void)Scm_AtomicCompareExchange(&q->deqPos, &hw, next);
+            continue;
+        }
+        if (i >= Scm_AtomicLoad(&h->enq)) return FALSE;
+        if (Scm_AtomicCompareExchange(&h->deq, &i, i+1)) {
+            ScmAtomicWord v;
+            while ((v = Scm_AtomicLoad(&h->slots[i])) == 0) {
+                Scm_YieldCPU();
+            }
+            Scm_AtomicStore(&h->slots[i], 0);
+            *result = SCM_OBJ(v);
+            return TRUE;
+        }
+    }
+}
+
+/*
+ * Operations
+ */
+
+static void notify(ScmMpmcQueue *q, ScmAtomicVar *count, ScmInternalCond *cv)
+{
+    if (Scm_AtomicLoad(count) > 0) {
+        SCM_INTERNAL_MUTEX_LOCK(q->mutex);
+        SCM_INTERNAL_COND_BROADCAST(*cv);
+        SCM_INTERNAL_MUTEX_UNLOCK(q->mutex);
+    }
+}
+
+static int try_enqueue(ScmMpmcQueue *q, ScmObj obj)
+{
+    if (q->maxlen > 0) return bounded_enqueue(q, obj);
+    segmented_enqueue(q, obj);
+    return TRUE;
+}
+
+static int try_dequeue(ScmMpmcQueue *q, ScmObj *result)
+{
+    if (q->maxlen > 0) return bounded_dequeue(q, result);
+    return segmented_dequeue(q, result);
+}
+
+int Scm_MpmcQueueEnqueue(ScmMpmcQueue *q, ScmObj obj)
+{
+    if (!try_enqueue(q, obj)) return FALSE;
+    notify(q, &q->numReaders, &q->readerWait);
+    return TRUE;
+}
+
+int Scm_MpmcQueueEnqueueList(ScmMpmcQueue *q, ScmObj objs)
+{
+    ScmSmallInt n = Scm_Length(objs);
+    if (n < 0) Scm_Error("proper list required, but got: %S", objs);
+    if (n == 0) return TRUE;
+    if (q->maxlen > 0) {
+        if (!bounded_enqueue_n(q, objs, n)) return FALSE;
+    } else {
+        ScmObj cp;
+        SCM_FOR_EACH(cp, objs) segmented_enqueue(q, SCM_CAR(cp));
+    }
+    notify(q, &q->numReaders, &q->readerWait);
+    return TRUE;
+}
+
+int Scm_MpmcQueueDequeue(ScmMpmcQueue *q, ScmObj *result)
+{
+    if (!try_dequeue(q, result)) return FALSE;
+    if (q->maxlen > 0) notify(q, &q->numWriters, &q->writerWait);
+    return TRUE;
+}
+
+/* Common wait loop.  Returns TRUE if OP succeeded, FALSE on timeout. */
+#define MPMC_WAIT(q, count, cv, op, pts, ok)                            \
+    do {                                                                \
+        int intr__ = FALSE;                                             \
+        SCM_INTERNAL_MUTEX_SAFE_LOCK_BEGIN((q)->mutex);                 \
+        atomic_add(count, 1);                                           \
+        for (;;) {                                                      \
+            if (op) { ok = TRUE; break; }                               \
+            if (pts) {                                                  \
+                int r__ = SCM_INTERNAL_COND_TIMEDWAIT(cv, (q)->mutex, pts); \
+                if (r__ == SCM_INTERNAL_COND_TIMEDOUT) break;           \
+                if (r__ == SCM_INTERNAL_COND_INTR) { intr__ = TRUE; break; } \
+            } else {                                                    \
+                SCM_INTERNAL_COND_WAIT(cv, (q)->mutex);                 \
+            }                                                           \
+        }                                                               \
+        atomic_add(count, (ScmAtomicWord)-1);                           \
+        SCM_INTERNAL_MUTEX_SAFE_LOCK_END();                             \
+        if (!intr__) break;                                             \
+        Scm_SigCheck(Scm_VM());                                         \
+    } while (1)
+
+ScmObj Scm_MpmcQueueEnqueueWait(ScmMpmcQueue *q, ScmObj obj,
+                                ScmObj timeout, ScmObj timeout_val)
+{
+    if (!try_enqueue(q, obj)) {
+        ScmTimeSpec ts;
+        ScmTimeSpec *pts = Scm_GetTimeSpec(timeout, &ts);
+        int ok = FALSE;
+        MPMC_WAIT(q, &q->numWriters, q->writerWait,
+                  try_enqueue(q, obj), pts, ok);
+        if (!ok) return timeout_val;
+    }
+    notify(q, &q->numReaders, &q->readerWait);
+    return SCM_TRUE;
+}
+
+ScmObj Scm_MpmcQueueDequeueWait(ScmMpmcQueue *q,
+                                ScmObj timeout, ScmObj timeout_val)
+{
+    ScmObj r = SCM_UNDEFINED;
+    if (!try_dequeue(q, &r)) {
+        ScmTimeSpec ts;
+        ScmTimeSpec *pts = Scm_GetTimeSpec(timeout, &ts);
+        int ok = FALSE;
+        MPMC_WAIT(q, &q->numReaders, q->readerWait,
+                  try_dequeue(q, &r), pts, ok);
+        if (!ok) return timeout_val;
+    }
+    if (q->maxlen > 0) notify(q, &q->numWriters, &q->writerWait);
+    return r;
+}
+
+ScmSize Scm_MpmcQueueLength(ScmMpmcQueue *q)
+{
+    if (q->maxlen > 0) {
+        ScmAtomicWord d = Scm_AtomicLoad(&q->deqPos);
+        ScmAtomicWord e = Scm_AtomicLoad(&q->enqPos);
+        if (e <= d) return 0;
+        return (e - d > (ScmAtomicWord)q->maxlen) ? q->maxlen : (ScmSize)(e - d);
+    } else {
+        ScmSize n = 0;
+        mpmc_segment *s = (mpmc_segment*)Scm_AtomicLoad(&q->deqPos);
+        while (s) {
+            ScmAtomicWord d = Scm_AtomicLoad(&s->deq);
+            ScmAtomicWord e = Scm_AtomicLoad(&s->enq);
+            if (e > MPMC_SEGMENT_SIZE) e = MPMC_SEGMENT_SIZE;
+            if (e > d) n += e - d;
+            s = (mpmc_segment*)Scm_AtomicLoad(&s->next);
+        }
+        return n;
+    }
+}
+
+ScmSmallInt Scm_MpmcQueueMaxLength(ScmMpmcQueue *q)
+{
+    return q->maxlen;
+}
+
+int Scm_MpmcQueueNumWaitingReaders(ScmMpmcQueue *q)
+{
+    return (int)Scm_AtomicLoad(&q->numReaders);
+}
+
+static void mpmc_print(ScmObj obj, ScmPort *port,
+                       ScmWriteContext *ctx SCM_UNUSED)
+{
+    ScmMpmcQueue *q = SCM_MPMC_QUEUE(obj);
+    Scm_Printf(port, "#<mpmc-queue %ld @%p>",
+               (long)Scm_MpmcQueueLength(q), q);
+}
+
+void Scm_Init_mpmc(ScmModule *mod)
+{
+    Scm_InitStaticClass(&Scm_MpmcQueueClass, "<mpmc-queue>", mod, NULL, 0);
+}
@@ -0,0 +1,75 @@
+/*
+ * mpmc.h - lock-free multi-producer multi-consumer queue
+ *
+ *   Copyright (c) 2025  Shiro Kawai  <shiro@acm.org>
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *   3. Neither the name of the authors nor the names of its contributors
+ *      may be used to endorse or promote products derived from this
+ *      software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ *   TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef GAUCHE_DATA_MPMC_H
+#define GAUCHE_DATA_MPMC_H
+
+#include <gauche.h>
+
+typedef struct ScmMpmcQueueRec ScmMpmcQueue;
+
+SCM_CLASS_DECL(Scm_MpmcQueueClass);
+#define SCM_CLASS_MPMC_QUEUE   (&Scm_MpmcQueueClass)
+#define SCM_MPMC_QUEUE(obj)    ((ScmMpmcQueue*)(obj))
+#define SCM_MPMC_QUEUE_P(obj)  SCM_XTYPEP(obj, SCM_CLASS_MPMC_QUEUE)
+
+/* MAXLEN must be positive for a bounded queue, or negative for
+   an unbounded queue. */
+extern ScmObj Scm_MakeMpmcQueue(ScmSmallInt maxlen);
+
+/* Non-blocking operations.  Enqueue returns FALSE if the queue is full,
+   and Dequeue returns FALSE if the queue is empty. */
+extern int    Scm_MpmcQueueEnqueue(ScmMpmcQueue *q, ScmObj obj);
+extern int    Scm_MpmcQueueDequeue(ScmMpmcQueue *q, ScmObj *result);
+
+/* Enqueues all objects in the list OBJS.  If a bounded queue doesn't
+   have room for all of them, nothing is enqueued and FALSE is returned. */
+extern int    Scm_MpmcQueueEnqueueList(ScmMpmcQueue *q, ScmObj objs);
+
+/* Blocking operations.  They return TIMEOUT_VAL when timed out.
+   EnqueueWait returns #t on success. */
+extern ScmObj Scm_MpmcQueueEnqueueWait(ScmMpmcQueue *q, ScmObj obj,
+                                       ScmObj timeout, ScmObj timeout_val);
+extern ScmObj Scm_MpmcQueueDequeueWait(ScmMpmcQueue *q,
+                                       ScmObj timeout, ScmObj timeout_val);
+
+/* These are snapshots; they can be outdated when other threads are
+   operating on the queue. */
+extern ScmSize     Scm_MpmcQueueLength(ScmMpmcQueue *q);
+extern ScmSmallInt Scm_MpmcQueueMaxLength(ScmMpmcQueue *q);
+extern int         Scm_MpmcQueueNumWaitingReaders(ScmMpmcQueue *q);
+
+extern void   Scm_Init_mpmc(ScmModule *mod);
+
+#endif /*GAUCHE_DATA_MPMC_H*/
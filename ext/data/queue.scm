@@ -60,7 +60,9 @@
           any-in-queue every-in-queue
 
           enqueue/wait! queue-push/wait! dequeue/wait! queue-pop/wait!
-          mtqueue-close!)
+          mtqueue-close!
+
+          <mpmc-queue> make-mpmc-queue mpmc-queue?)
   )
 (select-module data.queue)
 
@@ -69,6 +71,7 @@
 ;;;
 (inline-stub
  (.include <gauche/priv/configP.h>)
+ (.include "mpmc.h")
 
  ;;
  ;; <queue>
@@ -173,6 +176,17 @@
    (c-predicate "MTQP")
    (unboxer "MTQ"))
 
+ ;;
+ ;; <mpmc-queue>
+ ;;
+ ;; Lock-free queue, implemented in mpmc.c.  It isn't a subclass of
+ ;; <queue>; enqueue!, dequeue!, enqueue/wait!, dequeue/wait!,
+ ;; queue-empty?, queue-length and mtqueue-* queries dispatch on it.
+ (declare-stub-type <mpmc-queue> "ScmMpmcQueue*" "mpmc queue"
+   "SCM_MPMC_QUEUE_P" "SCM_MPMC_QUEUE")
+
+ (initcode "Scm_Init_mpmc(Scm_CurrentModule());")
+
  ;; lock macros
  (define-cise-expr big-locked?
    [(_ q) `(and (SCM_VMP (MTQ_LOCKER ,q))
@@ -293,6 +307,12 @@
                     (?: (SCM_UINTP max-length)
                         (SCM_INT_VALUE max-length)
                         -1))))
+ (define-cproc make-mpmc-queue (:key (max-length #f))
+   (cond [(SCM_FALSEP max-length) (return (Scm_MakeMpmcQueue -1))]
+         [(and (SCM_INTP max-length) (> (SCM_INT_VALUE max-length) 0))
+          (return (Scm_MakeMpmcQueue (SCM_INT_VALUE max-length)))]
+         [else (SCM_TYPE_ERROR max-length "positive fixnum or #f")
+               (return SCM_UNDEFINED)]))
 
  ;; caller must hold lock
  (define-cproc %queue-set-content! (q::<queue> list last-pair) ::<void>
@@ -321,7 +341,10 @@
 ;;; Predicates
 ;;;
 (inline-stub
- (define-cproc queue-empty? (q::<queue>) ::<boolean>
+ (define-cproc queue-empty? (q) ::<boolean>
+   (when (SCM_MPMC_QUEUE_P q)
+     (return (== (Scm_MpmcQueueLength (SCM_MPMC_QUEUE q)) 0)))
+   (unless (QP q) (SCM_TYPE_ERROR q "<queue>"))
    (if (MTQP q)
      (let* ([r::int FALSE])
        (with-mtq-light-lock q (set! r (Q_EMPTY_P q)))
@@ -331,6 +354,7 @@
 
 (define-inline (queue? q)   (is-a? q <queue>))
 (define-inline (mtqueue? q) (is-a? q <mtqueue>))
+(define-inline (mpmc-queue? q) (is-a? q <mpmc-queue>))
 
 ;;;
 ;;; Queries
@@ -342,20 +366,36 @@
           (> (+ ,cnt (%qlength (Q ,q))) (MTQ_MAXLEN ,q)))])
 
  ;; API
- (define-cproc queue-length (q::<queue>) ::<int> %qlength)
- (define-cproc mtqueue-max-length (q::<mtqueue>)
-   (return (?: (>= (MTQ_MAXLEN q) 0) (SCM_MAKE_INT (MTQ_MAXLEN q)) '#f)))
+ (define-cproc queue-length (q) ::<int>
+   (cond [(SCM_MPMC_QUEUE_P q)
+          (return (Scm_MpmcQueueLength (SCM_MPMC_QUEUE q)))]
+         [(QP q) (return (%qlength (Q q)))]
+         [else (SCM_TYPE_ERROR q "<queue>") (return 0)]))
+ (define-cproc mtqueue-max-length (q)
+   (cond [(SCM_MPMC_QUEUE_P q)
+          (let* ([m::ScmSmallInt (Scm_MpmcQueueMaxLength (SCM_MPMC_QUEUE q))])
+            (return (?: (> m 0) (SCM_MAKE_INT m) '#f)))]
+         [(MTQP q)
+          (return (?: (>= (MTQ_MAXLEN q) 0) (SCM_MAKE_INT (MTQ_MAXLEN q)) '#f))]
+         [else (SCM_TYPE_ERROR q "<mtqueue>") (return SCM_UNDEFINED)]))
 
  ;; caller must hold lock
  (define-cproc %mtqueue-overflow? (q::<mtqueue> cnt::<int>) ::<boolean>
    (return (mtq-overflows q cnt)))
 
  ;; API
- (define-cproc mtqueue-room (q::<mtqueue>) ::<number>
+ (define-cproc mtqueue-room (q) ::<number>
    (let* ([room::ScmSmallInt -1])
-     (with-mtq-light-lock q
-       (when (>= (MTQ_MAXLEN q) 0)
-         (set! room (- (MTQ_MAXLEN q) (%qlength (Q q))))))
+     (cond [(SCM_MPMC_QUEUE_P q)
+            (let* ([mq::ScmMpmcQueue* (SCM_MPMC_QUEUE q)]
+                   [m::ScmSmallInt (Scm_MpmcQueueMaxLength mq)])
+              (when (> m 0)
+                (set! room (- m (Scm_MpmcQueueLength mq)))))]
+           [(MTQP q)
+            (with-mtq-light-lock q
+              (when (>= (MTQ_MAXLEN q) 0)
+                (set! room (- (MTQ_MAXLEN q) (%qlength (Q q))))))]
+           [else (SCM_TYPE_ERROR q "<mtqueue>")])
      (if (>= room 0)
        (return (SCM_MAKE_INT room))
        (return SCM_POSITIVE_INFINITY))))
@@ -456,10 +496,20 @@
          (when ovf (Scm_Error "queue is full: %S" ,q)))
        (,op ,q ,cnt ,head ,tail))])
 
+ ;; Like <mtqueue>, enqueuing multiple objects into a bounded
+ ;; <mpmc-queue> is all-or-nothing.
+ (define-cfn mpmc-enqueue-all (q objs) ::void :static
+   (unless (Scm_MpmcQueueEnqueueList (SCM_MPMC_QUEUE q) objs)
+     (Scm_Error "queue is full: %S" q)))
+
  ;; API
- (define-cproc enqueue! (q::<queue> obj :rest more-objs)
+ (define-cproc enqueue! (q obj :rest more-objs)
+   (when (SCM_MPMC_QUEUE_P q)
+     (mpmc-enqueue-all q (Scm_Cons obj more-objs))
+     (return q))
+   (unless (QP q) (SCM_TYPE_ERROR q "<queue>"))
    (let* ([head (Scm_Cons obj more-objs)] [tail] [cnt::ScmSmallInt]
-          [qq::(Queue* volatile) q])
+          [qq::(Queue* volatile) (Q q)])
      (if (SCM_NULLP more-objs)
        (set! tail head cnt 1)
        (set! tail (Scm_LastPair more-objs) cnt (Scm_Length head)))
@@ -467,11 +517,16 @@
      (return (SCM_OBJ qq))))
 
  ;; API
- (define-cproc enqueue/wait! (q::<mtqueue> obj
-                                           :optional (timeout #f)
-                                                     (timeout-val #f)
-                                                     (close::<boolean> #f))
-   (let* ([cell (SCM_LIST1 obj)] [retval (SCM_OBJ q)])
+ (define-cproc enqueue/wait! (qq obj
+                                    :optional (timeout #f)
+                                              (timeout-val #f)
+                                              (close::<boolean> #f))
+   (when (SCM_MPMC_QUEUE_P qq)
+     (when close (Scm_Error "<mpmc-queue> can't be closed: %S" qq))
+     (return (Scm_MpmcQueueEnqueueWait (SCM_MPMC_QUEUE qq) obj
+                                       timeout timeout-val)))
+   (unless (MTQP qq) (SCM_TYPE_ERROR qq "<mtqueue>"))
+   (let* ([q::MtQueue* (MTQ qq)] [cell (SCM_LIST1 obj)] [retval (SCM_OBJ q)])
      (do-with-timeout q retval timeout timeout-val writerWait
                       (when (MTQ_CLOSED q)
                         (set! err "queue is closed"))
@@ -577,11 +632,19 @@
        (set! (* result) r)
        (return FALSE))))
 
- (define-cproc dequeue! (q::<queue> :optional fallback)
+ (define-cproc dequeue! (q :optional fallback)
    (let* ([empty::int FALSE] [fb::(volatile ScmObj) fallback] [r SCM_UNDEFINED])
+     (cond [(SCM_MPMC_QUEUE_P q)
+            (set! empty (not (Scm_MpmcQueueDequeue (SCM_MPMC_QUEUE q) (& r))))
+            (when empty
+              (if (SCM_UNBOUNDP fb)
+                (Scm_Error "queue is empty: %S" q)
+                (set! r fb)))
+            (return r)]
+           [(not (QP q)) (SCM_TYPE_ERROR q "<queue>")])
      (if (not (MTQP q))
-       (set! empty (dequeue-int q (& r)))
-       (with-mtq-light-lock q (set! empty (dequeue-int q (& r)))))
+       (set! empty (dequeue-int (Q q) (& r)))
+       (with-mtq-light-lock q (set! empty (dequeue-int (Q q) (& r)))))
      (if empty
        (if (SCM_UNBOUNDP fb)
          (Scm_Error "queue is empty: %S" q)
@@ -589,10 +652,15 @@
        (when (MTQP q) (notify-writers q)))
      (return r)))
 
- (define-cproc dequeue/wait! (q::<mtqueue> :optional (timeout #f)
-                                                     (timeout-val #f)
-                                                     (close::<boolean> #f))
-   (let* ([retval SCM_UNDEFINED])
+ (define-cproc dequeue/wait! (qq :optional (timeout #f)
+                                         (timeout-val #f)
+                                         (close::<boolean> #f))
+   (when (SCM_MPMC_QUEUE_P qq)
+     (when close (Scm_Error "<mpmc-queue> can't be closed: %S" qq))
+     (return (Scm_MpmcQueueDequeueWait (SCM_MPMC_QUEUE qq)
+                                       timeout timeout-val)))
+   (unless (MTQP qq) (SCM_TYPE_ERROR qq "<mtqueue>"))
+   (let* ([q::MtQueue* (MTQ qq)] [retval SCM_UNDEFINED])
      (do-with-timeout q retval timeout timeout-val readerWait
                       ;; init
                       (begin (post++ (MTQ_READER_SEM q))
@@ -633,7 +701,10 @@
 ;; change at any moment after returning this procedure, so for meaningful
 ;; operation the caller need another mutex to prevent new items
 ;; from being inserted into the mtq.
-(define-cproc mtqueue-num-waiting-readers (q::<mtqueue>) ::<int>
+(define-cproc mtqueue-num-waiting-readers (q) ::<int>
+  (when (SCM_MPMC_QUEUE_P q)
+    (return (Scm_MpmcQueueNumWaitingReaders (SCM_MPMC_QUEUE q))))
+  (unless (MTQP q) (SCM_TYPE_ERROR q "<mtqueue>"))
   (let* ([n::int 0])
     (with-mtq-light-lock q (set! n (MTQ_READER_SEM q)))
     (return n)))
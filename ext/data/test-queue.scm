@@ -200,6 +200,50 @@
 
 (test* "mtqueue room" +inf.0 (mtqueue-room (make-mtqueue)))
 
+(let1 q (make-mpmc-queue)
+  (test* "mpmc-queue" #t (mpmc-queue? q))
+  (test* "mpmc-queue (not a <queue>)" #f (queue? q))
+  (test* "mpmc-queue empty" #t (queue-empty? q))
+  (test* "mpmc-queue dequeue! fallback" 'none (dequeue! q 'none))
+  (test* "mpmc-queue dequeue! empty" (test-error) (dequeue! q))
+  (test* "mpmc-queue fifo" (iota 1000)
+         (begin (dolist [n (iota 1000)] (enqueue! q n))
+                (list-tabulate 1000 (^_ (dequeue! q)))))
+  (test* "mpmc-queue multiarg" '(3 a b c)
+         (begin (enqueue! q 'a 'b 'c)
+                (let1 n (queue-length q)
+                  (cons n (list-tabulate 3 (^_ (dequeue! q)))))))
+  (test* "mpmc-queue length across segments" 600
+         (begin (dotimes [n 700] (enqueue! q n))
+                (dotimes [n 100] (dequeue! q))
+                (queue-length q)))
+  (test* "mpmc-queue max-length" #f (mtqueue-max-length q))
+  (test* "mpmc-queue room" +inf.0 (mtqueue-room q))
+  (test* "mpmc-queue unsupported op" (test-error) (queue-push! q 'x)))
+
+(let1 q (make-mpmc-queue :max-length 3)
+  (test* "mpmc-queue bounded" '(a b c)
+         (begin (enqueue! q 'a 'b 'c)
+                (list (dequeue! q) (dequeue! q) (dequeue! q))))
+  (test* "mpmc-queue bounded wrap around" '(d e f 0)
+         (begin (enqueue! q 'd 'e 'f)
+                (list (dequeue! q) (dequeue! q) (dequeue! q)
+                      (queue-length q))))
+  (test* "mpmc-queue bounded overflow" (test-error)
+         (enqueue! q 'a 'b 'c 'd))
+  (test* "mpmc-queue bounded overflow unchanged" '(0 3)
+         (list (queue-length q) (mtqueue-room q)))
+  (test* "mpmc-queue bounded partial overflow" (test-error)
+         (begin (enqueue! q 'x)
+                (enqueue! q 'y 'z 'w)))
+  (test* "mpmc-queue bounded partial overflow unchanged" '(1 x)
+         (list (queue-length q) (dequeue! q)))
+  (test* "mpmc-queue bounded room 0" 0
+         (begin (enqueue! q 'a 'b 'c)
+                (mtqueue-room q)))
+  (test* "mpmc-queue bounded max-length" 3 (mtqueue-max-length q))
+  (test* "mpmc-queue zero length" (test-error) (make-mpmc-queue :max-length 0)))
+
 ;; Note: */wait! APIs are tested in test/thread.scm instead of here,
 ;; since we need threads working.
 
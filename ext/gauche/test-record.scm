@@ -556,4 +556,24 @@
          [(@ m0 (x a) (y b) (z c))
           (list a b c)]))
 
+;;--------------------------------------------------------------------
+(test-section "serialization")
+
+(use binary.fasl)
+
+(test* "fasl roundtrip of inherited record"
+       '(#t (1 2 3 4 5 6 7) #t)
+       (let* ([r (make-m2 1 2 3 4 5 6 7)]
+              [rr (u8vector->fasl (fasl->u8vector (list r r)))])
+         (list (m2? (car rr))
+               (match (car rr)
+                 [($ m2 a b c d e f g) (list a b c d e f g)])
+               (eq? (car rr) (cadr rr)))))
+
+(test* "fasl roundtrip of circular record" '(#t #t 2 #f)
+       (let1 k (kons #f 2)
+         (set-kar! k k)
+         (let1 kk (u8vector->fasl (fasl->u8vector k))
+           (list (pare? kk) (eq? (kar kk) kk) (kdr kk) (eq? k kk)))))
+
 (test-end)
@@ -59,6 +59,10 @@
 #include <math.h>
 #include "mt-random.h"
 
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
 /* Period parameters */
 #define M 397
 #define MATRIX_A 0x9908b0dfUL   /* constant vector a */
@@ -169,46 +173,90 @@ void Scm_MTSetSeed(ScmMersenneTwister *mt, ScmObj seed)
     UNLOCK(mt);
 }
 
-/* internal.  caller holds the lock */
-static u_long genrand_u32(ScmMersenneTwister *mt)
+/* Recomputes the entire state vector.  caller holds the lock.
+   Each loop is written so that the compiler can vectorize it: the
+   per-word feedback only refers to words ahead of kk (first loop) or
+   words already updated more than a vector width behind (second loop),
+   and the conditional xor by MATRIX_A is done by masking instead of
+   the table lookup of the original code.  The first loop is split at
+   a multiple of 8 so that a fixed-count vector loop is generated
+   without the cost of a runtime trip-count check. */
+#define REGEN_SPLIT ((N-M)&~7)
+
+static void regenerate(ScmMersenneTwister *mt)
 {
-    unsigned long y;
-    int mti = mt->mti;
-    static unsigned long mag01[2]={0x0UL, MATRIX_A};
-    /* mag01[x] = x * MATRIX_A  for x=0,1 */
-
-    if (mti >= N) { /* generate N words at one time */
-        int kk;
-
-        if (mti == N+1) {   /* if init_by_ui() has not been called, */
-            init_by_ui(mt, 5489UL); /* a default initial seed is used */
-        }
-
-        for (kk=0;kk<N-M;kk++) {
-            y = (mt->mt[kk]&UPPER_MASK)|(mt->mt[kk+1]&LOWER_MASK);
-            mt->mt[kk] = mt->mt[kk+M] ^ (y >> 1) ^ mag01[y & 0x1UL];
-        }
-        for (;kk<N-1;kk++) {
-            y = (mt->mt[kk]&UPPER_MASK)|(mt->mt[kk+1]&LOWER_MASK);
-            mt->mt[kk] = mt->mt[kk+(M-N)] ^ (y >> 1) ^ mag01[y & 0x1UL];
-        }
-        y = (mt->mt[N-1]&UPPER_MASK)|(mt->mt[0]&LOWER_MASK);
-        mt->mt[N-1] = mt->mt[M-1] ^ (y >> 1) ^ mag01[y & 0x1UL];
+    uint32_t *s = mt->mt;
+    uint32_t y;
+    int kk;
 
-        mti = 0;
+    for (kk=0;kk<REGEN_SPLIT;kk++) {
+        y = (s[kk]&UPPER_MASK)|(s[kk+1]&LOWER_MASK);
+        s[kk] = s[kk+M] ^ (y >> 1) ^ (-(y & 0x1U) & MATRIX_A);
     }
+    for (;kk<N-M;kk++) {
+        y = (s[kk]&UPPER_MASK)|(s[kk+1]&LOWER_MASK);
+        s[kk] = s[kk+M] ^ (y >> 1) ^ (-(y & 0x1U) & MATRIX_A);
+    }
+    for (;kk<N-1;kk++) {
+        y = (s[kk]&UPPER_MASK)|(s[kk+1]&LOWER_MASK);
+        s[kk] = s[kk+(M-N)] ^ (y >> 1) ^ (-(y & 0x1U) & MATRIX_A);
+    }
+    y = (s[N-1]&UPPER_MASK)|(s[0]&LOWER_MASK);
+    s[N-1] = s[M-1] ^ (y >> 1) ^ (-(y & 0x1U) & MATRIX_A);
+}
 
-    y = mt->mt[mti++];
-
-    /* Tempering */
+static inline uint32_t temper(uint32_t y)
+{
     y ^= (y >> 11);
     y ^= (y << 7) & 0x9d2c5680UL;
     y ^= (y << 15) & 0xefc60000UL;
     y ^= (y >> 18);
+    return y;
+}
 
-    mt->mti = mti;
+static inline void ensure_state(ScmMersenneTwister *mt)
+{
+    if (mt->mti >= N) { /* generate N words at one time */
+        if (mt->mti == N+1) {   /* if init_by_ui() has not been called, */
+            init_by_ui(mt, 5489UL); /* a default initial seed is used */
+        }
+        regenerate(mt);
+        mt->mti = 0;
+    }
+}
 
-    return y;
+/* internal.  caller holds the lock */
+static u_long genrand_u32(ScmMersenneTwister *mt)
+{
+    ensure_state(mt);
+    return temper(mt->mt[mt->mti++]);
+}
+
+/* internal.  caller holds the lock.
+   Stores next n tempered words to buf.  This yields exactly the same
+   sequence as calling genrand_u32 n times, but tempers a run of the
+   state vector at once. */
+static void genrand_block(ScmMersenneTwister *mt, uint32_t *restrict buf,
+                          size_t n)
+{
+    while (n > 0) {
+        ensure_state(mt);
+        if (mt->mti == 0 && n >= N) {
+            /* whole state vector; fixed count for the vectorizer */
+            for (int i = 0; i < N; i++) buf[i] = temper(mt->mt[i]);
+            mt->mti = N;
+            buf += N;
+            n -= N;
+            continue;
+        }
+        size_t k = N - mt->mti;
+        if (k > n) k = n;
+        const uint32_t *s = mt->mt + mt->mti;
+        for (size_t i = 0; i < k; i++) buf[i] = temper(s[i]);
+        mt->mti += (int)k;
+        buf += k;
+        n -= k;
+    }
 }
 
 ScmObj Scm_MTGetState(ScmMersenneTwister *mt)
@@ -373,30 +421,188 @@ ScmObj Scm_MTGenrandInt(ScmMersenneTwister *mt, ScmObj n)
     return SCM_UNDEFINED; /*dummy*/
 }
 
+/*
+ * Bulk fill
+ *
+ *  Words are drawn from the generator in chunks of at most WORDBUF,
+ *  never more than the remaining elements can consume; an element that
+ *  is rejected (0.0 for reals, out of the unbiased range for integers)
+ *  takes the following words, running over to genrand_u32 when the
+ *  chunk is exhausted.  So after a fill the generator is in the same
+ *  state, and the vector has the same contents, as if the elements
+ *  were drawn one at a time by the corresponding scalar procedure.
+ */
+
+#define WORDBUF 512
+
+typedef struct wordbuf_rec {
+    uint32_t buf[WORDBUF];
+    size_t pos;
+    size_t len;
+} wordbuf;
+
+static inline void wordbuf_fill(ScmMersenneTwister *mt, wordbuf *w, size_t n)
+{
+    genrand_block(mt, w->buf, n);
+    w->pos = 0;
+    w->len = n;
+}
+
+static inline uint32_t wordbuf_take(ScmMersenneTwister *mt, wordbuf *w)
+{
+    if (w->pos < w->len) return w->buf[w->pos++];
+    return (uint32_t)genrand_u32(mt);
+}
+
+static inline float word_to_f32(uint32_t w)
+{
+    return (float)(w*(1.0/4294967296.0));
+}
+
+static inline double words_to_f64(uint32_t a, uint32_t b)
+{
+    return ((a>>5)*67108864.0+(b>>6))*(1.0/9007199254740992.0);
+}
+
+/* caller holds the lock */
+static void fill_f32(ScmMersenneTwister *mt, float *d, size_t size)
+{
+    wordbuf w;
+    for (size_t i = 0; i < size; ) {
+        size_t c = (size - i < WORDBUF)? size - i : WORDBUF;
+        wordbuf_fill(mt, &w, c);
+        for (size_t j = 0; j < c; j++, i++) {
+            float r;
+            while ((r = word_to_f32(wordbuf_take(mt, &w))) == 0.0)
+                ;
+            d[i] = r;
+        }
+    }
+}
+
+/* caller holds the lock */
+static void fill_f64(ScmMersenneTwister *mt, double *d, size_t size)
+{
+    wordbuf w;
+    for (size_t i = 0; i < size; ) {
+        size_t c = (size - i < WORDBUF/2)? size - i : WORDBUF/2;
+        wordbuf_fill(mt, &w, c*2);
+        for (size_t j = 0; j < c; j++, i++) {
+            double r;
+            do {
+                uint32_t a = wordbuf_take(mt, &w);
+                r = words_to_f64(a, wordbuf_take(mt, &w));
+            } while (r == 0.0);
+            d[i] = r;
+        }
+    }
+}
+
 ScmObj Scm_MTFillUvector(ScmMersenneTwister *mt, ScmObj v)
 {
     if (SCM_U32VECTORP(v)) {
         LOCK(mt);
-        for (int i = 0; i < SCM_U32VECTOR_SIZE(v); i++) {
-            SCM_U32VECTOR_ELEMENT(v, i) = genrand_u32(mt);
-        }
+        genrand_block(mt, SCM_U32VECTOR_ELEMENTS(v), SCM_U32VECTOR_SIZE(v));
         UNLOCK(mt);
     } else if (SCM_F32VECTORP(v)) {
         LOCK(mt);
-        for (int i = 0; i < SCM_F32VECTOR_SIZE(v); i++) {
-            SCM_F32VECTOR_ELEMENT(v, i) = genrand_f32(mt, TRUE);
-        }
+        fill_f32(mt, SCM_F32VECTOR_ELEMENTS(v), SCM_F32VECTOR_SIZE(v));
         UNLOCK(mt);
     } else if (SCM_F64VECTORP(v)) {
         LOCK(mt);
-        for (int i = 0; i < SCM_F64VECTOR_SIZE(v); i++) {
-            SCM_F64VECTOR_ELEMENT(v, i) = genrand_f64(mt, TRUE);
+        fill_f64(mt, SCM_F64VECTOR_ELEMENTS(v), SCM_F64VECTOR_SIZE(v));
+        UNLOCK(mt);
+    }
+    return v;
+}
+
+/* Fills u32vector V with integers in [0, n-1], 0 < n <= 2^32, without
+   modulo bias.  The same method as genrand_int_small is used, so the
+   result matches the successive calls of mt-random-integer. */
+ScmObj Scm_MTFillUvectorRange(ScmMersenneTwister *mt, ScmObj v, ScmObj n)
+{
+    uint64_t range = 0;
+    if (SCM_INTP(n) && SCM_INT_VALUE(n) > 0) {
+        range = (uint64_t)SCM_INT_VALUE(n);
+    } else if (SCM_BIGNUMP(n) && SCM_BIGNUM_SIGN(n) > 0) {
+        int oor = FALSE;
+        range = Scm_GetIntegerU64Clamp(n, SCM_CLAMP_NONE, &oor);
+        if (oor) range = 0;
+    }
+    if (range == 0 || range > ((uint64_t)1<<32)) {
+        Scm_Error("bad type of argument for n: positive exact integer up to 2^32 is required, but got %S", n);
+    }
+    if (!SCM_U32VECTORP(v)) {
+        Scm_TypeError("v", "u32vector", v);
+    }
+    SCM_UVECTOR_CHECK_MUTABLE(v);
+
+    uint32_t *d = SCM_U32VECTOR_ELEMENTS(v);
+    size_t size = SCM_U32VECTOR_SIZE(v);
+
+    if (range == 1) {
+        /* genrand_int_small doesn't consume the generator in this case */
+        for (size_t i = 0; i < size; i++) d[i] = 0;
+    } else if ((range & (range-1)) == 0) {
+        int shift = 32;
+        while (range > 1) { range >>= 1; shift--; }
+        LOCK(mt);
+        genrand_block(mt, d, size);
+        UNLOCK(mt);
+        if (shift > 0) {
+            for (size_t i = 0; i < size; i++) d[i] >>= shift;
+        }
+    } else {
+        uint32_t q = (uint32_t)(0xffffffffUL / range);
+        uint32_t qn = (uint32_t)(q * range);
+        wordbuf w;
+        LOCK(mt);
+        for (size_t i = 0; i < size; ) {
+            size_t c = (size - i < WORDBUF)? size - i : WORDBUF;
+            wordbuf_fill(mt, &w, c);
+            for (size_t j = 0; j < c; j++, i++) {
+                uint32_t r;
+                while ((r = wordbuf_take(mt, &w)) >= qn)
+                    ;
+                d[i] = r / q;
+            }
         }
         UNLOCK(mt);
     }
     return v;
 }
 
+/* Fills f64vector V with normal deviates, by Box-Muller transform.
+   Each pair of elements takes two uniform deviates in (0,1) as
+   mt-random-real; if the vector has odd length, the last element still
+   takes a pair and the other deviate is discarded. */
+ScmObj Scm_MTFillNormal(ScmMersenneTwister *mt, ScmObj v,
+                        double mean, double stddev)
+{
+    double u[WORDBUF/2];
+    if (!SCM_F64VECTORP(v)) {
+        Scm_TypeError("v", "f64vector", v);
+    }
+    SCM_UVECTOR_CHECK_MUTABLE(v);
+
+    double *d = SCM_F64VECTOR_ELEMENTS(v);
+    size_t size = SCM_F64VECTOR_SIZE(v);
+    LOCK(mt);
+    for (size_t i = 0; i < size; ) {
+        size_t npairs = (size - i + 1)/2;
+        if (npairs > WORDBUF/4) npairs = WORDBUF/4;
+        fill_f64(mt, u, npairs*2);
+        for (size_t k = 0; k < npairs; k++, i += 2) {
+            double rad = stddev * sqrt(-2.0 * log(u[k*2]));
+            double theta = 2.0 * M_PI * u[k*2+1];
+            d[i] = mean + rad * cos(theta);
+            if (i+1 < size) d[i+1] = mean + rad * sin(theta);
+        }
+    }
+    UNLOCK(mt);
+    return v;
+}
+
 /*
  * Gauche specific stuff
  */
@@ -61,7 +61,7 @@
 
 typedef struct ScmMersenneTwisterRec {
     SCM_HEADER;
-    unsigned long mt[N]; /* the array for the state vector  */
+    uint32_t mt[N];      /* the array for the state vector  */
     int mti;             /* index into the state vector.
                             new integer random number is computed from
                             mt[mti], incrementing mti; once it exceeds N,
@@ -101,5 +101,8 @@ extern double Scm_MTGenrandF64(ScmMersenneTwister *, int);
 extern ScmObj Scm_MTGenrandInt(ScmMersenneTwister *mt, ScmObj n);
 
 extern ScmObj Scm_MTFillUvector(ScmMersenneTwister *, ScmObj);
+extern ScmObj Scm_MTFillUvectorRange(ScmMersenneTwister *, ScmObj, ScmObj n);
+extern ScmObj Scm_MTFillNormal(ScmMersenneTwister *, ScmObj,
+                               double mean, double stddev);
 
 extern void   Scm_Init_mt_random(void);
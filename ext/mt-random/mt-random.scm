@@ -43,7 +43,8 @@
           mt-random-integer
           mt-random-fill-u32vector!
           mt-random-fill-f32vector!
-          mt-random-fill-f64vector!)
+          mt-random-fill-f64vector!
+          mt-random-fill-normal-f64vector!)
   )
 (select-module math.mt-random)
 
@@ -95,14 +96,23 @@
  (define-cproc %mt-random-uint32 (mt::<mersenne-twister>) ::<ulong>
    Scm_MTGenrandU32)
 
- (define-cproc mt-random-fill-u32vector! (mt::<mersenne-twister> v::<u32vector>)
-   (return (Scm_MTFillUvector mt (SCM_OBJ v))))
+ (define-cproc mt-random-fill-u32vector! (mt::<mersenne-twister> v::<u32vector>
+                                          :optional (range #f))
+   (if (SCM_FALSEP range)
+     (return (Scm_MTFillUvector mt (SCM_OBJ v)))
+     (return (Scm_MTFillUvectorRange mt (SCM_OBJ v) range))))
 
  (define-cproc mt-random-fill-f32vector! (mt::<mersenne-twister> v::<f32vector>)
    (return (Scm_MTFillUvector mt (SCM_OBJ v))))
 
  (define-cproc mt-random-fill-f64vector! (mt::<mersenne-twister> v::<f64vector>)
    (return (Scm_MTFillUvector mt (SCM_OBJ v))))
+
+ (define-cproc mt-random-fill-normal-f64vector! (mt::<mersenne-twister>
+                                                 v::<f64vector>
+                                                 :optional (mean::<double> 0.0)
+                                                           (stddev::<double> 1.0))
+   (return (Scm_MTFillNormal mt (SCM_OBJ v) mean stddev)))
  )
 
 (define (%get-nword-random-int mt n)
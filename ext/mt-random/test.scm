@@ -108,6 +108,60 @@
                      (rlet1 v (make-f64vector 100 0)
                        (mt-random-fill-f64vector! m1 v))))))
 
+(test "u32vector (large)" #t
+      (^[] (let ([m0 (make <mersenne-twister> :seed 7)]
+                 [m1 (make <mersenne-twister> :seed 7)])
+             (mt-random-real m0)
+             (mt-random-real m1)
+             (and (equal? (make-random-sequence <u32vector> 2000
+                                                (^[] (mt-random-integer m0 (expt 2 32))))
+                          (rlet1 v (make-u32vector 2000 0)
+                            (mt-random-fill-u32vector! m1 v)))
+                  (= (mt-random-real m0) (mt-random-real m1))))))
+
+(dolist [range '(1 2 7 113 1048576 3000000000 4294967295 4294967296)]
+  (test #"u32vector range ~range" #t
+        (^[] (let ([m0 (make <mersenne-twister> :seed 3)]
+                   [m1 (make <mersenne-twister> :seed 3)])
+               (and (equal? (make-random-sequence <u32vector> 1000
+                                                  (^[] (mt-random-integer m0 range)))
+                            (rlet1 v (make-u32vector 1000 0)
+                              (mt-random-fill-u32vector! m1 v range)))
+                    (= (mt-random-real m0) (mt-random-real m1)))))))
+
+(test "u32vector range error" (test-error)
+      (^[] (mt-random-fill-u32vector! m (make-u32vector 3) 0)))
+(test "u32vector range error" (test-error)
+      (^[] (mt-random-fill-u32vector! m (make-u32vector 3) (+ (expt 2 32) 1))))
+
+(test "f32vector" #t
+      (^[] (let ([m0 (make <mersenne-twister> :seed 1)]
+                 [m1 (make <mersenne-twister> :seed 1)]
+                 [v (make-f32vector 1500 0)])
+             (mt-random-fill-f32vector! m0 v)
+             (mt-random-fill-f32vector! m1 v)
+             (and (every (^n (< 0 n 1)) (f32vector->list v))
+                  (= (mt-random-real m0) (mt-random-real m1))))))
+
+(test "normal f64vector" '(#t #t)
+      (^[] (let ([m0 (make <mersenne-twister> :seed 1)]
+                 [v (make-f64vector 10001 0)])
+             (mt-random-fill-normal-f64vector! m0 v 3.0 2.0)
+             (let* ([n (f64vector-length v)]
+                    [mean (/ (f64vector-dot v (make-f64vector n 1.0)) n)]
+                    [var (- (/ (f64vector-dot v v) n) (* mean mean))])
+               (list (< (abs (- mean 3.0)) 0.1)
+                     (< (abs (- var 4.0)) 0.3))))))
+
+(test "normal f64vector seed" #t
+      (^[] (let ([m0 (make <mersenne-twister> :seed 5)]
+                 [m1 (make <mersenne-twister> :seed 5)]
+                 [v0 (make-f64vector 101 0)]
+                 [v1 (make-f64vector 101 0)])
+             (mt-random-fill-normal-f64vector! m0 v0)
+             (mt-random-fill-normal-f64vector! m1 v1)
+             (equal? v0 v1))))
+
 (test "state" #t
       (^[] (let ([s  (mt-random-get-state m)]
                  [m2 (make <mersenne-twister> :seed 9324)])
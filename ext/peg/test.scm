@@ -1180,6 +1180,61 @@
        (parameterize ((json-nesting-depth-limit 1))
          (parse-json-string "{\"x\":123}")))
 
+;; native reader specifics
+(test* "long string across buffer" (make-string 100000 #\a)
+       (call-with-input-string
+           (string-append "\"" (make-string 100000 #\a) "\"")
+         parse-json))
+(test* "long string with escapes across buffer"
+       (string-append (make-string 50000 #\a) "\n\u3042" (make-string 50000 #\b))
+       (call-with-input-string
+           (string-append "\"" (make-string 50000 #\a) "\\n\\u3042"
+                          (make-string 50000 #\b) "\"")
+         parse-json))
+(test* "bignum and flonum" '#(123456789012345678901234567890 -1.5e300 0)
+       (parse-json-string "[123456789012345678901234567890, -1.5e300, -0]"))
+(test* "invalid number" (test-error <json-parse-error>)
+       (parse-json-string "[1.]"))
+(test* "stops after one value" '(#(1) " [2]")
+       (call-with-input-string "[1] [2]"
+         (^p (let1 v (parse-json p)
+               (list v (read-string 10 p))))))
+(test* "line count" 4
+       (call-with-input-string "{\"a\":\n[1,\n2],\n\"b\\nc\":\"x\"}\n"
+         (^p (parse-json p) (port-current-line p))))
+(test* "empty input" #t
+       (eof-object? (parse-json-string "  ")))
+(let1 n 300000
+  (define (depth v)
+    (let loop ([v v] [d 0])
+      (if (and (vector? v) (= (vector-length v) 1))
+        (loop (vector-ref v 0) (+ d 1))
+        d)))
+  (test* "deep nesting" (- n 1)
+         (depth (parse-json-string
+                 (string-append (make-string n #\[) (make-string n #\])))))
+  (test* "deep nesting, truncated" (test-error <json-parse-error>)
+         (parse-json-string (make-string n #\[)))
+  (test* "deep nesting of objects" (test-error <json-parse-error>)
+         (parse-json-string
+          (string-concatenate (make-list n "{\"a\":")))))
+
+(test* "json-token-generator"
+       '(array-start object-start "a" #\: array-start 1 #\, 2 array-end
+         #\, "b" #\: null object-end #\, "c" array-end)
+       (call-with-input-string "[{\"a\": [1, 2], \"b\": null}, \"c\"]"
+         (^p (generator->list (json-token-generator p)))))
+
+(test* "writing specials and numbers" "[true,false,null,1,-2.5,0.5,12345678901234567890]"
+       (construct-json-string '#(#t #f null 1 -2.5 1/2 12345678901234567890)))
+(test* "writing keys" "{\"a\":1,\"b\":2,\"3\":3}"
+       (construct-json-string '((a . 1) ("b" . 2) (3 . 3))))
+(test* "writing escapes" "\"a\\\"\\\\\\u0001\\u007f\\u00e9\\ud83d\\ude00\""
+       (construct-json-string "a\"\\\x01;\x7f;\xe9;\x1f600;"))
+(test* "writing long array" 200000
+       (vector-length
+        (parse-json-string (construct-json-string (make-vector 200000 "x")))))
+
 (include "test-srfi-180")
 
 (test-end)
@@ -0,0 +1,696 @@
+/*
+ * json.c - native JSON reader and writer
+ *
+ *   Copyright (c) 2025  Shiro Kawai  <shiro@acm.org>
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *   3. Neither the name of the authors nor the names of its contributors
+ *      may be used to endorse or promote products derived from this
+ *      software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ *   TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gauche.h>
+#include <gauche/extend.h>
+#include <gauche/priv/portP.h>
+#include "json.h"
+
+/* The parser reads directly from the input port's buffer when possible
+   (see Scm__PortPeekBuffered), and falls back to byte-wise operations
+   at the buffer boundary.  The writer accumulates the output in a
+   DString and flushes it to the port in large chunks.
+
+   The grammar accepted is the same as the PEG-based json-parser:
+   numbers may have a '+' sign and leading zeros, and strings may
+   contain raw control characters. */
+
+static ScmObj sym_true  = SCM_UNBOUND;
+static ScmObj sym_false = SCM_UNBOUND;
+static ScmObj sym_null  = SCM_UNBOUND;
+static ScmObj sym_array_start  = SCM_UNBOUND;
+static ScmObj sym_array_end    = SCM_UNBOUND;
+static ScmObj sym_object_start = SCM_UNBOUND;
+static ScmObj sym_object_end   = SCM_UNBOUND;
+
+static ScmModule *json_module(void)
+{
+    static ScmModule *mod = NULL;
+    if (mod == NULL) mod = SCM_FIND_MODULE("rfc.json", 0);
+    return mod;
+}
+
+/*=============================================================
+ * Reader
+ */
+
+typedef struct json_reader_rec {
+    ScmPort *port;
+    ScmObj array_handler;       /* #f for list->vector */
+    ScmObj object_handler;      /* #f for identity */
+    ScmObj special_handler;     /* #f for identity */
+    ScmSmallInt depth;
+    ScmSmallInt depth_limit;    /* negative for unlimited */
+    ScmDString ds;              /* scratch buffer */
+} json_reader;
+
+#define JSON_WS_P(b) ((b) == ' ' || (b) == '\t' || (b) == '\n' || (b) == '\r')
+#define JSON_DIGIT_P(b) ((b) >= '0' && (b) <= '9')
+
+static void j_error(json_reader *r, const char *fmt, ...)
+{
+    static ScmObj parse_error_proc = SCM_UNDEFINED;
+    SCM_BIND_PROC(parse_error_proc, "%json-parse-error", json_module());
+    va_list ap;
+    va_start(ap, fmt);
+    ScmObj msg = Scm_Vsprintf(fmt, ap, TRUE);
+    va_end(ap);
+    Scm_ApplyRec2(parse_error_proc, Scm_MakeInteger(Scm_PortBytes(r->port)),
+                  msg);
+}
+
+static void j_unexpected(json_reader *r, int b, const char *expected)
+{
+    if (b == EOF) {
+        j_error(r, "premature end of input; expecting %s", expected);
+    } else {
+        j_error(r, "unexpected character %S; expecting %s",
+                SCM_MAKE_CHAR(b), expected);
+    }
+}
+
+/* Skips whitespaces, and returns the next byte without consuming it,
+   or EOF. */
+static int j_peek_nonws(json_reader *r)
+{
+    ScmPort *p = r->port;
+    for (;;) {
+        const char *s, *e;
+        if (Scm__PortPeekBuffered(p, &s, &e)) {
+            const char *q = s;
+            ScmSize nl = 0;
+            for (; q < e && JSON_WS_P(*q); q++) {
+                if (*q == '\n') nl++;
+            }
+            Scm__PortConsumeBuffered(p, q - s);
+            Scm__PortAddLines(p, nl);
+            if (q < e) return (unsigned char)*q;
+            continue;
+        }
+        int b = Scm_PeekbUnsafe(p);
+        if (b == EOF || !JSON_WS_P(b)) return b;
+        (void)Scm_GetbUnsafe(p);
+    }
+}
+
+/* Reads exactly four hex digits. */
+static int j_hex4(json_reader *r)
+{
+    int v = 0;
+    for (int i=0; i<4; i++) {
+        int b = Scm_GetbUnsafe(r->port);
+        int d = (b == EOF)? -1 : Scm_DigitToInt(b, 16, FALSE);
+        if (d < 0) j_unexpected(r, b, "a hexadecimal digit");
+        v = v*16 + d;
+    }
+    return v;
+}
+
+/* After a backslash in a string. */
+static void j_escape(json_reader *r)
+{
+    int b = Scm_GetbUnsafe(r->port);
+    switch (b) {
+    case '"': case '\\': case '/':
+        SCM_DSTRING_PUTB(&r->ds, b); return;
+    case 'b': SCM_DSTRING_PUTB(&r->ds, '\b'); return;
+    case 'f': SCM_DSTRING_PUTB(&r->ds, '\f'); return;
+    case 'n': SCM_DSTRING_PUTB(&r->ds, '\n'); return;
+    case 'r': SCM_DSTRING_PUTB(&r->ds, '\r'); return;
+    case 't': SCM_DSTRING_PUTB(&r->ds, '\t'); return;
+    case 'u': {
+        int c = j_hex4(r);
+        if (c >= 0xd800 && c <= 0xdbff) {
+            int c2 = -1;
+            if (Scm_PeekbUnsafe(r->port) == '\\') {
+                (void)Scm_GetbUnsafe(r->port);
+                if (Scm_GetbUnsafe(r->port) == 'u') c2 = j_hex4(r);
+            }
+            if (c2 < 0xdc00 || c2 > 0xdfff) {
+                j_error(r, "unpaired high surrogate: \\u%04x", c);
+            }
+            c = 0x10000 + ((c - 0xd800) << 10) + (c2 - 0xdc00);
+        } else if (c >= 0xdc00 && c <= 0xdfff) {
+            j_error(r, "unpaired low surrogate: \\u%04x", c);
+        }
+        ScmChar ch = Scm_UcsToChar(c);
+        if (ch == SCM_CHAR_INVALID) {
+            j_error(r, "character \\u%04x can't be represented", c);
+        }
+        Scm_DStringPutc(&r->ds, ch);
+        return;
+    }
+    default:
+        j_unexpected(r, b, "an escape character");
+    }
+}
+
+/* After the opening double quote. */
+static ScmObj j_string(json_reader *r)
+{
+    ScmPort *p = r->port;
+    int pending = FALSE;        /* TRUE if ds has content */
+
+    Scm_DStringTruncate(&r->ds, 0);
+    for (;;) {
+        const char *s, *e;
+        if (Scm__PortPeekBuffered(p, &s, &e)) {
+            const char *q = s;
+            ScmSize nl = 0;
+            for (; q < e && *q != '"' && *q != '\\'; q++) {
+                if (*q == '\n') nl++;
+            }
+            if (q < e && *q == '"' && !pending) {
+                /* Fast path: the whole string is in the buffer without
+                   escapes. */
+                ScmObj str = Scm_MakeString(s, q - s, -1, SCM_STRING_COPYING);
+                Scm__PortConsumeBuffered(p, q - s + 1);
+                Scm__PortAddLines(p, nl);
+                return str;
+            }
+            if (q > s) {
+                Scm_DStringPutz(&r->ds, s, q - s);
+                Scm__PortConsumeBuffered(p, q - s);
+                Scm__PortAddLines(p, nl);
+                pending = TRUE;
+            }
+        }
+        int b = Scm_GetbUnsafe(p);
+        if (b == EOF) j_unexpected(r, b, "'\"'");
+        if (b == '"') break;
+        if (b == '\\') j_escape(r);
+        else SCM_DSTRING_PUTB(&r->ds, b);
+        pending = TRUE;
+    }
+    return Scm_DStringGet(&r->ds, 0);
+}
+
+static int j_digits(json_reader *r, int64_t *val, int *ndigits)
+{
+    ScmPort *p = r->port;
+    int b = Scm_PeekbUnsafe(p);
+    if (!JSON_DIGIT_P(b)) j_unexpected(r, b, "a digit");
+    do {
+        (void)Scm_GetbUnsafe(p);
+        SCM_DSTRING_PUTB(&r->ds, b);
+        if (val) {
+            if (*ndigits < 18) *val = *val * 10 + (b - '0');
+            (*ndigits)++;
+        }
+        b = Scm_PeekbUnsafe(p);
+    } while (JSON_DIGIT_P(b));
+    return b;
+}
+
+static ScmObj j_number(json_reader *r)
+{
+    ScmPort *p = r->port;
+    int64_t ival = 0;
+    int ndigits = 0, neg = FALSE, simple = TRUE;
+
+    Scm_DStringTruncate(&r->ds, 0);
+    int b = Scm_PeekbUnsafe(p);
+    if (b == '-' || b == '+') {
+        neg = (b == '-');
+        SCM_DSTRING_PUTB(&r->ds, b);
+        (void)Scm_GetbUnsafe(p);
+    }
+    b = j_digits(r, &ival, &ndigits);
+    if (b == '.') {
+        simple = FALSE;
+        SCM_DSTRING_PUTB(&r->ds, b);
+        (void)Scm_GetbUnsafe(p);
+        b = j_digits(r, NULL, NULL);
+    }
+    if (b == 'e' || b == 'E') {
+        simple = FALSE;
+        SCM_DSTRING_PUTB(&r->ds, b);
+        (void)Scm_GetbUnsafe(p);
+        b = Scm_PeekbUnsafe(p);
+        if (b == '-' || b == '+') {
+            SCM_DSTRING_PUTB(&r->ds, b);
+            (void)Scm_GetbUnsafe(p);
+        }
+        b = j_digits(r, NULL, NULL);
+    }
+    if (simple && ndigits <= 18) {
+        return Scm_MakeInteger64(neg? -ival : ival);
+    }
+    ScmObj s = Scm_DStringGet(&r->ds, 0);
+    ScmObj n = Scm_StringToNumber(SCM_STRING(s), 10, 0);
+    if (SCM_FALSEP(n)) j_error(r, "invalid number: %S", s);
+    return n;
+}
+
+static ScmObj j_special(json_reader *r, const char *word, ScmObj sym)
+{
+    for (const char *w = word; *w; w++) {
+        int b = Scm_GetbUnsafe(r->port);
+        if (b != *w) j_error(r, "invalid literal; expecting %s", word);
+    }
+    if (SCM_FALSEP(r->special_handler)) return sym;
+    return Scm_ApplyRec1(r->special_handler, sym);
+}
+
+/* Scalars: strings, numbers and specials. */
+static ScmObj j_scalar(json_reader *r, int b)
+{
+    switch (b) {
+    case '"':
+        (void)Scm_GetbUnsafe(r->port);
+        return j_string(r);
+    case 't': return j_special(r, "true", sym_true);
+    case 'f': return j_special(r, "false", sym_false);
+    case 'n': return j_special(r, "null", sym_null);
+    case '-': case '+':
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+        return j_number(r);
+    default:
+        j_unexpected(r, b, "a JSON value");
+        return SCM_UNDEFINED;   /* dummy */
+    }
+}
+
+/* Arrays and objects are read iteratively, keeping the open containers
+   in an explicit stack, so that deeply nested input won't overflow the
+   C stack.  The stack is allocated in the heap and grown as needed. */
+typedef struct j_frame_rec {
+    int close;                  /* ']' or '}' */
+    ScmObj h, t;                /* elements read so far */
+    ScmObj key;                 /* key of the object member being read */
+} j_frame;
+
+#define J_STACK_INIT_SIZE 16
+
+/* Reads an object key and the following colon. */
+static void j_key(json_reader *r, j_frame *f)
+{
+    int b = j_peek_nonws(r);
+    if (b != '"') j_unexpected(r, b, "a string");
+    (void)Scm_GetbUnsafe(r->port);
+    f->key = j_string(r);
+    b = j_peek_nonws(r);
+    if (b != ':') j_unexpected(r, b, "':'");
+    (void)Scm_GetbUnsafe(r->port);
+}
+
+static ScmObj j_close(json_reader *r, j_frame *f)
+{
+    if (f->close == ']') {
+        if (SCM_FALSEP(r->array_handler)) {
+            return Scm_ListToVector(f->h, 0, -1);
+        }
+        return Scm_ApplyRec1(r->array_handler, f->h);
+    } else {
+        if (SCM_FALSEP(r->object_handler)) return f->h;
+        return Scm_ApplyRec1(r->object_handler, f->h);
+    }
+}
+
+static ScmObj j_value(json_reader *r)
+{
+    j_frame *stack = SCM_NEW_ARRAY(j_frame, J_STACK_INIT_SIZE);
+    ScmSmallInt size = J_STACK_INIT_SIZE, sp = 0;
+
+    for (;;) {
+        /* Here we're at the beginning of a value. */
+        ScmObj v;
+        int b = j_peek_nonws(r);
+        /* For the compatibility with the PEG parser, the nesting depth is
+           checked before reading any value other than true/false/null. */
+        if (r->depth_limit >= 0 && r->depth >= r->depth_limit
+            && b != 't' && b != 'f' && b != 'n') {
+            j_error(r, "Input JSON nesting is too deep.");
+        }
+        if (b == '[' || b == '{') {
+            if (sp == size) {
+                j_frame *ns = SCM_NEW_ARRAY(j_frame, size*2);
+                memcpy(ns, stack, sizeof(j_frame)*size);
+                stack = ns;
+                size *= 2;
+            }
+            j_frame *f = &stack[sp++];
+            f->close = (b == '[')? ']' : '}';
+            f->h = f->t = SCM_NIL;
+            f->key = SCM_FALSE;
+            r->depth++;
+            (void)Scm_GetbUnsafe(r->port);
+            if (j_peek_nonws(r) != f->close) {
+                if (f->close == '}') j_key(r, f);
+                continue;
+            }
+            (void)Scm_GetbUnsafe(r->port);
+            sp--;
+            r->depth--;
+            v = j_close(r, f);
+        } else {
+            v = j_scalar(r, b);
+        }
+
+        /* We've got a complete value V.  Add it to the innermost
+           container, closing containers as they end. */
+        for (;;) {
+            if (sp == 0) return v;
+            j_frame *f = &stack[sp-1];
+            if (f->close == ']') {
+                SCM_APPEND1(f->h, f->t, v);
+            } else {
+                SCM_APPEND1(f->h, f->t, Scm_Cons(f->key, v));
+            }
+            b = j_peek_nonws(r);
+            if (b != ',' && b != f->close) {
+                j_unexpected(r, b, (f->close == ']')? "',' or ']'"
+                                                    : "',' or '}'");
+            }
+            (void)Scm_GetbUnsafe(r->port);
+            if (b == ',') {
+                if (f->close == '}') j_key(r, f);
+                break;
+            }
+            sp--;
+            r->depth--;
+            v = j_close(r, f);
+        }
+    }
+}
+
+static void j_init(json_reader *r, ScmPort *port)
+{
+    r->port = port;
+    r->array_handler = SCM_FALSE;
+    r->object_handler = SCM_FALSE;
+    r->special_handler = SCM_FALSE;
+    r->depth = 0;
+    r->depth_limit = -1;
+    Scm_DStringInit(&r->ds);
+}
+
+static ScmObj j_read_toplevel(json_reader *r)
+{
+    if (j_peek_nonws(r) == EOF) return SCM_EOF;
+    return j_value(r);
+}
+
+ScmObj Scm_JsonRead(ScmPort *port,
+                    ScmObj array_handler,
+                    ScmObj object_handler,
+                    ScmObj special_handler,
+                    ScmSmallInt depth_limit)
+{
+    json_reader r;
+    ScmVM *vm = Scm_VM();
+    ScmObj result = SCM_UNDEFINED;
+
+    j_init(&r, port);
+    r.array_handler = array_handler;
+    r.object_handler = object_handler;
+    r.special_handler = special_handler;
+    r.depth_limit = depth_limit;
+
+    PORT_LOCK(port, vm);
+    PORT_SAFE_CALL(port, result = j_read_toplevel(&r), /*no cleanup*/);
+    PORT_UNLOCK(port);
+    return result;
+}
+
+static ScmObj j_read_token(json_reader *r)
+{
+    int b = j_peek_nonws(r);
+    ScmObj tok;
+    switch (b) {
+    case EOF: return SCM_EOF;
+    case '[': tok = sym_array_start; break;
+    case ']': tok = sym_array_end; break;
+    case '{': tok = sym_object_start; break;
+    case '}': tok = sym_object_end; break;
+    case ':': case ',': tok = SCM_MAKE_CHAR(b); break;
+    default:  return j_scalar(r, b);
+    }
+    (void)Scm_GetbUnsafe(r->port);
+    return tok;
+}
+
+/* Returns the next token, as json-tokenizer does.  The caller is
+   responsible to check the structure. */
+ScmObj Scm_JsonReadToken(ScmPort *port, ScmObj special_handler)
+{
+    json_reader r;
+    ScmVM *vm = Scm_VM();
+    ScmObj result = SCM_UNDEFINED;
+
+    j_init(&r, port);
+    r.special_handler = special_handler;
+
+    PORT_LOCK(port, vm);
+    PORT_SAFE_CALL(port, result = j_read_token(&r), /*no cleanup*/);
+    PORT_UNLOCK(port);
+    return result;
+}
+
+/*=============================================================
+ * Writer
+ */
+
+typedef struct json_writer_rec {
+    ScmPort *port;
+    ScmDString ds;
+} json_writer;
+
+/* We hand the accumulated output to the port when it grows beyond this. */
+#define JSON_FLUSH_THRESHOLD 65536
+
+static void w_flush(json_writer *w)
+{
+    ScmSmallInt size = Scm_DStringSize(&w->ds);
+    if (size > 0) {
+        Scm_Putz(Scm_DStringGetz(&w->ds), size, w->port);
+        Scm_DStringTruncate(&w->ds, 0);
+    }
+}
+
+static void w_maybe_flush(json_writer *w)
+{
+    if (Scm_DStringSize(&w->ds) >= JSON_FLUSH_THRESHOLD) w_flush(w);
+}
+
+static void w_error(ScmObj obj, const char *msg)
+{
+    static ScmObj construct_error_proc = SCM_UNDEFINED;
+    SCM_BIND_PROC(construct_error_proc, "%json-construct-error",
+                  json_module());
+    Scm_ApplyRec2(construct_error_proc, obj, SCM_MAKE_STR(msg));
+}
+
+static void w_uescape(json_writer *w, int code)
+{
+    char buf[8];
+    snprintf(buf, sizeof(buf), "\\u%04x", code);
+    Scm_DStringPutz(&w->ds, buf, 6);
+}
+
+static void w_string(json_writer *w, ScmString *str)
+{
+    const ScmStringBody *b = SCM_STRING_BODY(str);
+    const char *p = SCM_STRING_BODY_START(b);
+    const char *e = p + SCM_STRING_BODY_SIZE(b);
+
+    SCM_DSTRING_PUTB(&w->ds, '"');
+    while (p < e) {
+        /* Copy a run of characters that don't need escaping at once. */
+        const char *q = p;
+        while (q < e) {
+            unsigned char c = (unsigned char)*q;
+            if (c < 0x20 || c >= 0x7f || c == '"' || c == '\\') break;
+            q++;
+        }
+        if (q > p) Scm_DStringPutz(&w->ds, p, q - p);
+        if (q >= e) break;
+
+        unsigned char c = (unsigned char)*q;
+        if (c < 0x80) {
+            switch (c) {
+            case '"':  Scm_DStringPutz(&w->ds, "\\\"", 2); break;
+            case '\\': Scm_DStringPutz(&w->ds, "\\\\", 2); break;
+            case '\b': Scm_DStringPutz(&w->ds, "\\b", 2); break;
+            case '\f': Scm_DStringPutz(&w->ds, "\\f", 2); break;
+            case '\n': Scm_DStringPutz(&w->ds, "\\n", 2); break;
+            case '\r': Scm_DStringPutz(&w->ds, "\\r", 2); break;
+            case '\t': Scm_DStringPutz(&w->ds, "\\t", 2); break;
+            default:   w_uescape(w, c); break;
+            }
+            p = q + 1;
+            continue;
+        }
+        int nb = SCM_CHAR_NFOLLOWS(c) + 1;
+        ScmChar ch = SCM_CHAR_INVALID;
+        if (q + nb <= e) SCM_CHAR_GET(q, ch);
+        if (ch == SCM_CHAR_INVALID) {
+            w_uescape(w, c);    /* stray byte */
+            p = q + 1;
+            continue;
+        }
+        int ucs = Scm_CharToUcs(ch);
+        if (ucs >= 0x10000) {
+            ucs -= 0x10000;
+            w_uescape(w, 0xd800 + (ucs >> 10));
+            w_uescape(w, 0xdc00 + (ucs & 0x3ff));
+        } else {
+            w_uescape(w, ucs);
+        }
+        p = q + nb;
+    }
+    SCM_DSTRING_PUTB(&w->ds, '"');
+}
+
+static void w_number(json_writer *w, ScmObj obj)
+{
+    if (SCM_INTP(obj)) {
+        char buf[32];
+        int n = snprintf(buf, sizeof(buf), "%ld", (long)SCM_INT_VALUE(obj));
+        Scm_DStringPutz(&w->ds, buf, n);
+    } else if (SCM_BIGNUMP(obj)) {
+        Scm_DStringAdd(&w->ds, SCM_STRING(Scm_NumberToString(obj, 10, 0)));
+    } else if (SCM_FLONUMP(obj) || SCM_RATNUMP(obj)) {
+        double d = Scm_GetDouble(obj);
+        if (!isfinite(d)) w_error(obj, "json cannot represent a number");
+        Scm_DStringPutDouble(&w->ds, d, NULL);
+    } else {
+        w_error(obj, "json cannot represent a number");
+    }
+}
+
+static void w_value(json_writer *w, ScmObj obj);
+
+static void w_key(json_writer *w, ScmObj key)
+{
+    if (SCM_STRINGP(key)) {
+        w_string(w, SCM_STRING(key));
+    } else if (SCM_SYMBOLP(key) && !SCM_KEYWORDP(key)) {
+        w_string(w, SCM_SYMBOL_NAME(key));
+    } else {
+        static ScmObj x_to_string_proc = SCM_UNDEFINED;
+        SCM_BIND_PROC(x_to_string_proc, "x->string", Scm_GaucheModule());
+        ScmObj s = Scm_ApplyRec1(x_to_string_proc, key);
+        if (!SCM_STRINGP(s)) w_error(key, "can't convert to a key:");
+        w_string(w, SCM_STRING(s));
+    }
+}
+
+/* OBJ is a proper list */
+static void w_object(json_writer *w, ScmObj obj)
+{
+    ScmObj cp;
+    SCM_DSTRING_PUTB(&w->ds, '{');
+    SCM_FOR_EACH(cp, obj) {
+        ScmObj attr = SCM_CAR(cp);
+        if (!SCM_PAIRP(attr)) {
+            w_error(obj, "construct-json needs an assoc list or dictionary, "
+                    "but got:");
+        }
+        if (!SCM_EQ(cp, obj)) SCM_DSTRING_PUTB(&w->ds, ',');
+        w_key(w, SCM_CAR(attr));
+        SCM_DSTRING_PUTB(&w->ds, ':');
+        w_value(w, SCM_CDR(attr));
+        w_maybe_flush(w);
+    }
+    SCM_DSTRING_PUTB(&w->ds, '}');
+}
+
+static void w_array(json_writer *w, ScmObj vec)
+{
+    ScmSmallInt n = SCM_VECTOR_SIZE(vec);
+    SCM_DSTRING_PUTB(&w->ds, '[');
+    for (ScmSmallInt i=0; i<n; i++) {
+        if (i > 0) SCM_DSTRING_PUTB(&w->ds, ',');
+        w_value(w, SCM_VECTOR_ELEMENT(vec, i));
+        w_maybe_flush(w);
+    }
+    SCM_DSTRING_PUTB(&w->ds, ']');
+}
+
+static void w_value(json_writer *w, ScmObj obj)
+{
+    if (SCM_FALSEP(obj) || SCM_EQ(obj, sym_false)) {
+        Scm_DStringPutz(&w->ds, "false", 5);
+    } else if (SCM_TRUEP(obj) || SCM_EQ(obj, sym_true)) {
+        Scm_DStringPutz(&w->ds, "true", 4);
+    } else if (SCM_EQ(obj, sym_null)) {
+        Scm_DStringPutz(&w->ds, "null", 4);
+    } else if (SCM_NULLP(obj) || (SCM_PAIRP(obj) && Scm_Length(obj) >= 0)) {
+        w_object(w, obj);
+    } else if (SCM_STRINGP(obj)) {
+        w_string(w, SCM_STRING(obj));
+    } else if (SCM_NUMBERP(obj)) {
+        w_number(w, obj);
+    } else if (SCM_VECTORP(obj)) {
+        w_array(w, obj);
+    } else {
+        /* Dictionaries, other sequences and <json-mixin> instances are
+           converted to an alist or a vector in Scheme. */
+        static ScmObj convert_proc = SCM_UNDEFINED;
+        SCM_BIND_PROC(convert_proc, "%json-convert", json_module());
+        ScmObj v = Scm_ApplyRec1(convert_proc, obj);
+        if (SCM_VECTORP(v)) {
+            w_array(w, v);
+        } else if (SCM_NULLP(v) || (SCM_PAIRP(v) && Scm_Length(v) >= 0)) {
+            w_object(w, v);
+        } else {
+            w_error(obj, "can't convert Scheme object to json:");
+        }
+    }
+}
+
+void Scm_JsonWrite(ScmObj obj, ScmPort *port)
+{
+    json_writer w;
+    w.port = port;
+    Scm_DStringInit(&w.ds);
+    w_value(&w, obj);
+    w_flush(&w);
+}
+
+/*=============================================================
+ * Initialization
+ */
+
+void Scm_Init_json(void)
+{
+    sym_true  = SCM_INTERN("true");
+    sym_false = SCM_INTERN("false");
+    sym_null  = SCM_INTERN("null");
+    sym_array_start  = SCM_INTERN("array-start");
+    sym_array_end    = SCM_INTERN("array-end");
+    sym_object_start = SCM_INTERN("object-start");
+    sym_object_end   = SCM_INTERN("object-end");
+}
@@ -51,7 +51,7 @@
           json-array-handler json-object-handler json-special-handler
           json-nesting-depth-limit
 
-          json-parser json-tokenizer
+          json-parser json-tokenizer json-token-generator
           ))
 (select-module rfc.json)
 
@@ -86,7 +86,73 @@
 
 
 ;;;============================================================
-;;; Parser
+;;; Native reader and writer
+;;;
+
+;; The workhorse of parse-json, parse-json* and construct-json is in
+;; json.c.  The PEG parsers below (json-parser, json-tokenizer) are kept
+;; for the programs that combine them with other parser.peg parsers.
+
+(inline-stub
+ (declcode
+  (.include "json.h"))
+
+ (define-cproc %json-read (port::<input-port> array-handler object-handler
+                           special-handler depth-limit::<fixnum>)
+   Scm_JsonRead)
+ (define-cproc %json-read-token (port::<input-port> special-handler)
+   Scm_JsonReadToken)
+ (define-cproc %json-write (obj port::<output-port>) ::<void>
+   Scm_JsonWrite)
+
+ (initcode (Scm_Init_json))
+ )
+
+;; The native routines use the builtin behavior when a handler is #f.
+(define (%handler param default)
+  (let1 h (param)
+    (if (eq? h default) #f h)))
+
+(define (%depth-limit)
+  (let1 lim (json-nesting-depth-limit)
+    (if (and (real? lim) (finite? lim))
+      (max 0 (exact (ceiling lim)))
+      -1)))
+
+(define (%read-json port)
+  (%json-read port
+              (%handler json-array-handler list->vector)
+              (%handler json-object-handler identity)
+              (%handler json-special-handler identity)
+              (%depth-limit)))
+
+;; Called from json.c
+(define (%json-parse-error pos msg)
+  (error <json-parse-error> :position pos :objects '() msg))
+
+(define (%json-construct-error obj msg)
+  (error <json-construct-error> :object obj msg obj))
+
+;; Called from json.c for objects it doesn't know how to write.
+;; Returns an alist or a vector.
+(define (%json-convert obj)
+  (cond [(is-a? obj <dictionary>) (coerce-to <list> obj)]
+        [(is-a? obj <sequence>)   (coerce-to <vector> obj)]
+        [(is-a? obj <json-mixin>) (json-mixin->alist obj)]
+        [else (%json-construct-error obj "can't convert Scheme object to json:")]))
+
+(define (json-mixin->alist obj)
+  (filter-map (^[slot]
+                (if-let1 json-name (slot-definition-option slot :json-name #f)
+                  (cons (if (eqv? json-name #t)
+                          (x->string (slot-definition-name slot))
+                          (x->string json-name))
+                        (slot-ref obj (slot-definition-name slot)))
+                  #f))
+              (class-slots (class-of obj))))
+
+;;;============================================================
+;;; PEG Parser
 ;;;
 (define %ws ($many_ ($. #[ \t\r\n])))
 
@@ -194,113 +260,31 @@
 
 ;; entry point
 (define (parse-json :optional (port (current-input-port)))
-  (guard (e [(<parse-error> e)
-             ;; not to expose parser.peg's <parse-error>.
-             (error <json-parse-error>
-                    :position (~ e'position) :objects (~ e'objects)
-                    :message (condition-message e e))])
-    (peg-parse-port json-parser port)))
+  (%read-json port))
 
 (define (parse-json-string str)
   (call-with-input-string str (cut parse-json <>)))
 
 (define (parse-json* :optional (port (current-input-port)))
-  (guard (e [(<parse-error> e)
-             ;; not to expose parser.peg's <parse-error>.
-             (error <json-parse-error>
-                    :position (~ e'position) :objects (~ e'objects)
-                    :message (~ e'message))])
-    (generator->list (peg-parser->generator json-parser port))))
+  (let loop ([r '()])
+    (let1 v (%read-json port)
+      (if (eof-object? v)
+        (reverse r)
+        (loop (cons v r))))))
+
+;; Streaming.  Returns a generator that yields tokens in the same way as
+;; json-tokenizer: array-start, array-end, object-start, object-end,
+;; #\: and #\, for the structural characters, and scalar values.
+(define (json-token-generator :optional (port (current-input-port)))
+  (let1 special (%handler json-special-handler identity)
+    (^[] (%json-read-token port special))))
 
 ;;;============================================================
 ;;; Writer
 ;;;
 
-(define (print-value obj)
-  (cond [(or (eq? obj 'false) (eq? obj #f)) (display "false")]
-        [(or (eq? obj 'true) (eq? obj #t))  (display "true")]
-        [(eq? obj 'null)  (display "null")]
-        [(list? obj)      (print-object obj)]
-        [(string? obj)    (print-string obj)]
-        [(number? obj)    (print-number obj)]
-        [(is-a? obj <dictionary>) (print-object obj)]
-        [(is-a? obj <sequence>)   (print-array obj)]
-        [(is-a? obj <json-mixin>) (print-instance obj)]
-        [else (error <json-construct-error> :object obj
-                     "can't convert Scheme object to json:" obj)]))
-
-(define (print-object obj)
-  (write-char #\{)
-  (fold (^[attr comma-needed?]
-          (unless (pair? attr)
-            (error <json-construct-error> :object obj
-                   "construct-json needs an assoc list or dictionary, \
-                    but got:" obj))
-          (when comma-needed?
-            (write-char #\,))
-          (print-string (x->string (car attr)))
-          (write-char #\:)
-          (print-value (cdr attr))
-          #t)
-        #f obj)
-  (write-char #\}))
-
-(define (print-array obj)
-  (write-char #\[)
-  (for-each-with-index (^[i val]
-                         (unless (zero? i) (write-char #\,))
-                         (print-value val))
-                       obj)
-  (write-char #\]))
-
-(define (print-instance obj)            ;<json-mixin>
-  (let1 class (class-of obj)
-    (write-char #\{)
-    (fold (^[slot comma-needed?]
-            (if-let1 json-name (slot-definition-option slot :json-name #f)
-              (begin
-                (when comma-needed?
-                  (write-char #\,))
-                (print-string (if (eqv? json-name #t)
-                                (x->string (slot-definition-name slot))
-                                (x->string json-name)))
-                (write-char #\:)
-                (print-value (slot-ref obj (slot-definition-name slot)))
-                #t)
-              comma-needed?))
-          #f (class-slots class))
-    (write-char #\})))
-
-(define (print-number num)
-  (cond [(or (not (real? num)) (not (finite? num)))
-         (error <json-construct-error> :object num
-                "json cannot represent a number" num)]
-        [(and (rational? num) (not (integer? num)))
-         (write (exact->inexact num))]
-        [else (write num)]))
-
-(define (print-string str)
-  (define specials
-    '((#\" . #\") (#\\ . #\\) (#\x08 . #\b) (#\page . #\f)
-      (#\newline . #\n) (#\return . #\r) (#\tab . #\t)))
-  (define (hexescape code) (format #t "\\u~4,'0x" code))
-  (define (print-char c)
-    (cond [(assv c specials) => (^p (write-char #\\) (write-char (cdr p)))]
-          [(and (char-set-contains? char-set:ascii c)
-                (not (eq? (char-general-category c) 'Cc)))
-           (write-char c)]
-          [else
-           (let1 code (char->ucs c)
-             (if (>= code #x10000)
-               (for-each hexescape (ucs4->utf16 code))
-               (hexescape code)))]))
-  (write-char #\")
-  (string-for-each print-char str)
-  (write-char #\"))
-
 (define (construct-json x :optional (oport (current-output-port)))
-  (with-output-to-port oport
-    (^() (print-value x))))
+  (%json-write x oport))
 
 (define (construct-json-string x)
   (call-with-output-string (cut construct-json x <>)))
@@ -0,0 +1,372 @@
+/*
+ * csv.c - native CSV reader
+ *
+ *   Copyright (c) 2025  Shiro Kawai  <shiro@acm.org>
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *   3. Neither the name of the authors nor the names of its contributors
+ *      may be used to endorse or promote products derived from this
+ *      software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ *   TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <gauche.h>
+#include <gauche/extend.h>
+#include <gauche/priv/portP.h>
+#include <ctype.h>
+#include "csv.h"
+
+/* The reader works on bytes.  Since the separator and the quote
+   character are ASCII, we can find the field delimiters in the port
+   buffer with memchr without decoding characters (a byte below 0x80
+   never appears inside a multibyte character in utf-8).  Characters
+   are only decoded to check non-ASCII whitespaces around the fields.
+
+   The semantics are the same as the Scheme version (csv-reader in
+   csv.scm): leading whitespaces of each field and trailing whitespaces
+   of unquoted fields are dropped; anything between the closing quote
+   and the next delimiter is ignored. */
+
+typedef struct csv_reader_rec {
+    ScmPort *port;
+    int sep;
+    int quo;
+    ScmDString ds;              /* for fields across the buffer boundary */
+} csv_reader;
+
+enum {
+    CSV_SEP,                    /* field ended with a separator */
+    CSV_EOR                     /* field ended with a newline or EOF */
+};
+
+/* csv_start returns this if the field begins with an ordinary char. */
+#define CSV_OTHER  (-2)
+
+#define CSV_ASCII_WS_P(b)  ((b) == ' ' || ((b) >= '\t' && (b) <= '\r'))
+
+/* Same as char-whitespace? */
+static int csv_ws_p(ScmChar c)
+{
+    return (SCM_CHAR_ASCII_P(c) && isspace(c)) || SCM_CHAR_EXTRA_WHITESPACE(c);
+}
+
+/* Returns the first separator or newline in [s, e), or NULL. */
+static const char *csv_scan_delim(csv_reader *r, const char *s, const char *e)
+{
+    const char *nl = memchr(s, '\n', e - s);
+    const char *sp = memchr(s, r->sep, (nl ? nl : e) - s);
+    return sp ? sp : nl;
+}
+
+static ScmSize csv_count_newlines(const char *s, const char *e)
+{
+    ScmSize n = 0;
+    while ((s = memchr(s, '\n', e - s)) != NULL) { s++; n++; }
+    return n;
+}
+
+/* Creates a string from [s, e), dropping trailing whitespaces. */
+static ScmObj csv_trimmed_string(const char *s, const char *e)
+{
+    while (e > s) {
+        unsigned char b = (unsigned char)e[-1];
+        if (b < 0x80) {
+            if (!CSV_ASCII_WS_P(b)) break;
+            e--;
+        } else {
+            const char *c = e - 1;
+            while (c > s && (*c & 0xc0) == 0x80) c--;
+            ScmChar ch;
+            SCM_CHAR_GET(c, ch);
+            if (!SCM_CHAR_EXTRA_WHITESPACE(ch)) break;
+            e = c;
+        }
+    }
+    return Scm_MakeString(s, e - s, -1, SCM_STRING_COPYING);
+}
+
+static ScmObj csv_trimmed_dstring(csv_reader *r)
+{
+    ScmSmallInt size, len;
+    const char *s = Scm_DStringPeek(&r->ds, &size, &len);
+    return csv_trimmed_string(s, s + size);
+}
+
+/* Skips leading whitespaces of a field.  Returns the first byte of
+   the field without consuming it if it is a newline, a separator or a
+   quote character; EOF at the end of input, or CSV_OTHER otherwise. */
+static int csv_start(csv_reader *r)
+{
+    ScmPort *p = r->port;
+    for (;;) {
+        const char *s, *e;
+        if (Scm__PortPeekBuffered(p, &s, &e)) {
+            const char *q = s;
+            int b = 0;
+            for (; q < e; q++) {
+                b = (unsigned char)*q;
+                if (b == '\n' || b == r->sep || b == r->quo) break;
+                if (b >= 0x80 || !CSV_ASCII_WS_P(b)) break;
+            }
+            Scm__PortConsumeBuffered(p, q - s);
+            if (q < e) {
+                if (b == '\n' || b == r->sep || b == r->quo) return b;
+                if (b < 0x80) return CSV_OTHER;
+                if (e - q > SCM_CHAR_NFOLLOWS(b)) {
+                    ScmChar ch;
+                    SCM_CHAR_GET(q, ch);
+                    if (!SCM_CHAR_EXTRA_WHITESPACE(ch)) return CSV_OTHER;
+                    Scm__PortConsumeBuffered(p, SCM_CHAR_NFOLLOWS(b) + 1);
+                    continue;
+                }
+                /* a multibyte char across the buffer boundary */
+            }
+        }
+        ScmChar ch = Scm_PeekcUnsafe(p);
+        if (ch == EOF) return EOF;
+        if (ch == '\n' || ch == r->sep || ch == r->quo) return ch;
+        if (!csv_ws_p(ch)) return CSV_OTHER;
+        (void)Scm_GetcUnsafe(p);
+    }
+}
+
+/* Reads an unquoted field.  The first byte isn't consumed yet. */
+static ScmObj csv_unquoted(csv_reader *r, int *term)
+{
+    ScmPort *p = r->port;
+    Scm_DStringTruncate(&r->ds, 0);
+    for (;;) {
+        const char *s, *e;
+        if (Scm__PortPeekBuffered(p, &s, &e)) {
+            const char *d = csv_scan_delim(r, s, e);
+            if (d) {
+                ScmObj f;
+                *term = (*d == '\n') ? CSV_EOR : CSV_SEP;
+                if (Scm_DStringSize(&r->ds) == 0) {
+                    f = csv_trimmed_string(s, d); /* common case */
+                } else {
+                    Scm_DStringPutz(&r->ds, s, d - s);
+                    f = csv_trimmed_dstring(r);
+                }
+                Scm__PortConsumeBuffered(p, d - s + 1);
+                if (*term == CSV_EOR) Scm__PortAddLines(p, 1);
+                return f;
+            }
+            Scm_DStringPutz(&r->ds, s, e - s);
+            Scm__PortConsumeBuffered(p, e - s);
+        }
+        int b = Scm_GetbUnsafe(p);
+        if (b == EOF || b == '\n') {
+            *term = CSV_EOR;
+            return csv_trimmed_dstring(r);
+        }
+        if (b == r->sep) {
+            *term = CSV_SEP;
+            return csv_trimmed_dstring(r);
+        }
+        SCM_DSTRING_PUTB(&r->ds, b);
+    }
+}
+
+/* Skips the garbage after the closing quote. */
+static void csv_quoted_tail(csv_reader *r, int *term)
+{
+    ScmPort *p = r->port;
+    for (;;) {
+        const char *s, *e;
+        if (Scm__PortPeekBuffered(p, &s, &e)) {
+            const char *d = csv_scan_delim(r, s, e);
+            if (d) {
+                *term = (*d == '\n') ? CSV_EOR : CSV_SEP;
+                Scm__PortConsumeBuffered(p, d - s + 1);
+                if (*term == CSV_EOR) Scm__PortAddLines(p, 1);
+                return;
+            }
+            Scm__PortConsumeBuffered(p, e - s);
+        }
+        int b = Scm_GetbUnsafe(p);
+        if (b == EOF || b == '\n') { *term = CSV_EOR; return; }
+        if (b == r->sep)           { *term = CSV_SEP; return; }
+    }
+}
+
+/* Reads a quoted field.  The opening quote has been consumed. */
+static ScmObj csv_quoted(csv_reader *r, int *term)
+{
+    ScmPort *p = r->port;
+    ScmObj f = SCM_FALSE;
+    Scm_DStringTruncate(&r->ds, 0);
+    for (;;) {
+        const char *s, *e;
+        if (Scm__PortPeekBuffered(p, &s, &e)) {
+            const char *q = memchr(s, r->quo, e - s);
+            const char *lim = q ? q : e;
+            ScmSize nl = csv_count_newlines(s, lim);
+            if (q && q + 1 < e && q[1] != r->quo
+                && Scm_DStringSize(&r->ds) == 0) {
+                /* Fast path: no doubled quotes, and the whole field is
+                   in the buffer. */
+                f = Scm_MakeString(s, q - s, -1, SCM_STRING_COPYING);
+                Scm__PortConsumeBuffered(p, q - s + 1);
+                Scm__PortAddLines(p, nl);
+                break;
+            }
+            Scm_DStringPutz(&r->ds, s, lim - s);
+            Scm__PortConsumeBuffered(p, lim - s);
+            Scm__PortAddLines(p, nl);
+        }
+        int b = Scm_GetbUnsafe(p);
+        if (b == EOF) Scm_Error("unterminated quoted field");
+        if (b == r->quo) {
+            if (Scm_PeekbUnsafe(p) != r->quo) {
+                f = Scm_DStringGet(&r->ds, 0);
+                break;
+            }
+            (void)Scm_GetbUnsafe(p);
+        }
+        SCM_DSTRING_PUTB(&r->ds, b);
+    }
+    csv_quoted_tail(r, term);
+    return f;
+}
+
+static ScmObj csv_read_record(csv_reader *r)
+{
+    ScmObj h = SCM_NIL, t = SCM_NIL;
+    int term = CSV_EOR;
+    do {
+        ScmObj f;
+        int c = csv_start(r);
+        if (c == EOF) {
+            f = SCM_MAKE_STR("");
+            term = CSV_EOR;
+        } else if (c == '\n') {
+            (void)Scm_GetbUnsafe(r->port);
+            f = SCM_MAKE_STR("");
+            term = CSV_EOR;
+        } else if (c == r->sep) {
+            (void)Scm_GetbUnsafe(r->port);
+            f = SCM_MAKE_STR("");
+            term = CSV_SEP;
+        } else if (c == r->quo) {
+            (void)Scm_GetbUnsafe(r->port);
+            f = csv_quoted(r, &term);
+        } else {
+            f = csv_unquoted(r, &term);
+        }
+        SCM_APPEND1(h, t, f);
+    } while (term == CSV_SEP);
+    return h;
+}
+
+static void csv_reader_init(csv_reader *r, ScmPort *port,
+                            ScmChar sep, ScmChar quo)
+{
+    if (!SCM_CHAR_ASCII_P(sep) || !SCM_CHAR_ASCII_P(quo)) {
+        Scm_Error("separator and quote character must be ASCII, "
+                  "but got %C and %C", sep, quo);
+    }
+    r->port = port;
+    r->sep = (int)sep;
+    r->quo = (int)quo;
+    Scm_DStringInit(&r->ds);
+}
+
+static ScmObj csv_read_toplevel(csv_reader *r)
+{
+    if (Scm_PeekbUnsafe(r->port) == EOF) return SCM_EOF;
+    return csv_read_record(r);
+}
+
+ScmObj Scm_CsvRead(ScmPort *port, ScmChar sep, ScmChar quo)
+{
+    csv_reader r;
+    ScmObj result = SCM_EOF;
+    ScmVM *vm = Scm_VM();
+
+    csv_reader_init(&r, port, sep, quo);
+    PORT_LOCK(port, vm);
+    PORT_SAFE_CALL(port, result = csv_read_toplevel(&r), /*no cleanup*/);
+    PORT_UNLOCK(port);
+    return result;
+}
+
+static ScmObj csv_read_records(csv_reader *r, ScmSmallInt limit)
+{
+    ScmObj h = SCM_NIL, t = SCM_NIL;
+    ScmSize start = Scm_PortBytes(r->port);
+    while (limit < 0 || Scm_PortBytes(r->port) - start < limit) {
+        if (Scm_PeekbUnsafe(r->port) == EOF) break;
+        SCM_APPEND1(h, t, csv_read_record(r));
+    }
+    return h;
+}
+
+ScmObj Scm_CsvReadRecords(ScmPort *port, ScmChar sep, ScmChar quo,
+                          ScmSmallInt limit, ScmSize *consumed)
+{
+    csv_reader r;
+    ScmObj result = SCM_NIL;
+    ScmVM *vm = Scm_VM();
+    ScmSize start = Scm_PortBytes(port);
+
+    csv_reader_init(&r, port, sep, quo);
+    PORT_LOCK(port, vm);
+    PORT_SAFE_CALL(port, result = csv_read_records(&r, limit),
+                   /*no cleanup*/);
+    PORT_UNLOCK(port);
+    *consumed = Scm_PortBytes(port) - start;
+    return result;
+}
+
+static int csv_skip_line(ScmPort *p)
+{
+    for (;;) {
+        const char *s, *e;
+        if (Scm__PortPeekBuffered(p, &s, &e)) {
+            const char *nl = memchr(s, '\n', e - s);
+            if (nl) {
+                Scm__PortConsumeBuffered(p, nl - s + 1);
+                Scm__PortAddLines(p, 1);
+                return TRUE;
+            }
+            Scm__PortConsumeBuffered(p, e - s);
+        }
+        int b = Scm_GetbUnsafe(p);
+        if (b == EOF) return FALSE;
+        if (b == '\n') return TRUE;
+    }
+}
+
+int Scm_CsvSkipLine(ScmPort *port)
+{
+    int result = FALSE;
+    ScmVM *vm = Scm_VM();
+
+    PORT_LOCK(port, vm);
+    PORT_SAFE_CALL(port, result = csv_skip_line(port), /*no cleanup*/);
+    PORT_UNLOCK(port);
+    return result;
+}
@@ -37,7 +37,9 @@
   (use srfi.13)
   (use srfi.42)
   (use gauche.sequence)
+  (use gauche.threads)
   (export make-csv-reader
+          csv-file->rows
           make-csv-writer
           make-csv-header-parser
           make-csv-record-parser
@@ -49,10 +51,34 @@
 ;;;Low-level API - convert text into nested lists
 ;;;
 
+;; The reader for ASCII separator and quote character is written in C
+;; (csv.c).  The Scheme version, csv-reader, handles the other cases.
+(inline-stub
+ (declcode
+  (.include "csv.h"))
+
+ (define-cproc %csv-read (port::<input-port> sep::<char> quo::<char>)
+   Scm_CsvRead)
+ (define-cproc %csv-read-records (port::<input-port> sep::<char> quo::<char>
+                                  limit::<fixnum>)
+   ::(<top> <integer>)
+   (let* ([consumed::ScmSize 0]
+          [r (Scm_CsvReadRecords port sep quo limit (& consumed))])
+     (return r (Scm_MakeInteger consumed))))
+ (define-cproc %csv-skip-line (port::<input-port>) ::<boolean>
+   Scm_CsvSkipLine)
+ )
+
+(define (%native-ok? sep quo)
+  (and (< (char->integer sep) #x80) (< (char->integer quo) #x80)))
+
 ;; API
 (define (make-csv-reader separator :optional (quote-char #\"))
-  (^[:optional (port (current-input-port))]
-    (csv-reader separator quote-char port)))
+  (if (%native-ok? separator quote-char)
+    (^[:optional (port (current-input-port))]
+      (%csv-read port separator quote-char))
+    (^[:optional (port (current-input-port))]
+      (csv-reader separator quote-char port))))
 
 (define (csv-reader sep quo port)
   (define (eor? ch) (or (eqv? ch #\newline) (eof-object? ch)))
@@ -94,6 +120,67 @@
     (eof-object)
     (start '())))
 
+;; API
+;; Reads all the records in FILE.  A large file is split into chunks,
+;; which are parsed in parallel.  Each chunk but the first starts right
+;; after a newline, which isn't a record boundary if the newline is in
+;; a quoted field.  We find it out when we join the results: the result
+;; of a chunk is used only if the preceding chunk ended exactly where
+;; the chunk started; otherwise the chunk is read again from where
+;; the preceding chunk ended.
+(define (csv-file->rows file separator :key (quote-char #\")
+                        (num-threads (sys-available-processors))
+                        (chunk-size 1048576))
+  (define size (~ (sys-stat file)'size))
+  (define nchunks
+    (if (%native-ok? separator quote-char)
+      (max 1 (min (quotient size (max chunk-size 1)) num-threads))
+      1))
+  ;; Returns (rows . end-position)
+  (define (read-chunk start end)
+    (call-with-input-file file
+      (^p (port-seek p start)
+          (receive (rows nbytes)
+              (%csv-read-records p separator quote-char (- end start))
+            (cons rows (+ start nbytes))))))
+  ;; Chunk K spans [starts[K], starts[K+1])
+  (define (chunk-starts)
+    (call-with-input-file file
+      (^p (rlet1 v (make-vector (+ nchunks 1) size)
+            (vector-set! v 0 0)
+            (dotimes [k (- nchunks 1)]
+              (port-seek p (- (quotient (* (+ k 1) size) nchunks) 1))
+              (when (%csv-skip-line p)
+                (vector-set! v (+ k 1) (port-tell p))))))))
+
+  (cond
+   [(not (%native-ok? separator quote-char))
+    (call-with-input-file file
+      (cut port->list (make-csv-reader separator quote-char) <>))]
+   [(= nchunks 1)
+    (call-with-input-file file
+      (^p (values-ref (%csv-read-records p separator quote-char -1) 0)))]
+   [else
+    (let* ([starts (chunk-starts)]
+           [threads (map (^k (thread-start!
+                              (make-thread
+                               (^[] (guard (e [else #f])
+                                      (read-chunk (~ starts k)
+                                                  (~ starts (+ k 1))))))))
+                         (iota nchunks))])
+      (let loop ([k 0] [ts threads] [pos 0] [rowss '()])
+        (if (null? ts)
+          (concatenate! (reverse! rowss))
+          (let ([r (thread-join! (car ts))]
+                [start (~ starts k)]
+                [end (~ starts (+ k 1))])
+            (cond [(and r (= pos start))
+                   (loop (+ k 1) (cdr ts) (cdr r) (cons (car r) rowss))]
+                  [(< pos end)
+                   (let1 r (read-chunk pos end)
+                     (loop (+ k 1) (cdr ts) (cdr r) (cons (car r) rowss)))]
+                  [else (loop (+ k 1) (cdr ts) pos rowss)])))))]))
+
 ;; API
 (define (make-csv-writer separator :optional
                          (newline "\n") (quote-char #\")
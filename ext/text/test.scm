@@ -1,6 +1,7 @@
 (use gauche.test)
 
 (test-start "text.* extensions")
+(include "test-csv.scm")
 (include "test-gap-buffer.scm")
 (include "test-gettext.scm")
 (include "test-line-edit.scm")
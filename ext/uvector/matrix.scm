@@ -16,6 +16,53 @@
 
 (select-module gauche.array)
 
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+;; native kernels
+
+;; Rank-2 f32 and f64 arrays are handed to the C kernels in gauche.uvector
+;; (uvmatrix.c) as a view #(storage offset row-stride col-stride rows cols)
+;; of the backing storage.  The mapper of any array, including the ones
+;; made by share-array, is affine, so probing it at three indices gives
+;; the offset and the strides.
+
+(define %matrix-mul!         (with-module gauche.uvector %matrix-mul!))
+(define %matrix-copy!        (with-module gauche.uvector %matrix-copy!))
+(define %matrix-vector-mul!  (with-module gauche.uvector %matrix-vector-mul!))
+(define %matrix-determinant  (with-module gauche.uvector %matrix-determinant))
+(define %matrix-inverse!     (with-module gauche.uvector %matrix-inverse!))
+(define %matrix-lu!          (with-module gauche.uvector %matrix-lu!))
+(define %matrix-cholesky!    (with-module gauche.uvector %matrix-cholesky!))
+
+;; Returns the view of A, or #f if A isn't a non-empty rank-2 f32/f64 array.
+(define (array-matrix-view a)
+  (and (or (eq? (class-of a) <f32array>)
+           (eq? (class-of a) <f64array>))
+       (= (array-rank a) 2)
+       (let ([r0 (array-start a 0)]
+             [c0 (array-start a 1)]
+             [rows (array-length a 0)]
+             [cols (array-length a 1)]
+             [mapper (mapper-of a)])
+         (and (> rows 0) (> cols 0)
+              (let1 off (mapper (vector r0 c0))
+                (vector (backing-storage-of a) off
+                        (if (> rows 1) (- (mapper (vector (+ r0 1) c0)) off) 0)
+                        (if (> cols 1) (- (mapper (vector r0 (+ c0 1))) off) 0)
+                        rows cols))))))
+
+(define (transposed-view v)
+  (vector (vector-ref v 0) (vector-ref v 1)
+          (vector-ref v 3) (vector-ref v 2)
+          (vector-ref v 5) (vector-ref v 4)))
+
+(define (view-storage v) (vector-ref v 0))
+(define (view-rows v) (vector-ref v 4))
+(define (view-cols v) (vector-ref v 5))
+
+;; A new zero-based N x M array of the same class as A.
+(define (make-matrix-like a n m)
+  (make-array-internal (class-of a) (shape 0 n 0 m)))
+
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 ;; general array manipulation
 
@@ -64,13 +111,17 @@
     (array-set! sh dim2 0 tmp0)
     (array-set! sh dim2 1 tmp1)
     (rlet1 res (make-array-internal (class-of a) sh)
-      (array-for-each-index a
-        (^[vec1] (let* ([vec2 (vector-copy vec1)]
-                        [tmp (vector-ref vec2 dim1)])
-                   (vector-set! vec2 dim1 (vector-ref vec2 dim2))
-                   (vector-set! vec2 dim2 tmp)
-                   (array-set! res vec2 (array-ref a vec1))))
-        (make-vector rank)))))
+      (if-let1 v (and (or (and (eqv? dim1 0) (eqv? dim2 1))
+                          (and (eqv? dim1 1) (eqv? dim2 0)))
+                      (array-matrix-view a))
+        (%matrix-copy! (array-matrix-view res) (transposed-view v))
+        (array-for-each-index a
+          (^[vec1] (let* ([vec2 (vector-copy vec1)]
+                          [tmp (vector-ref vec2 dim1)])
+                     (vector-set! vec2 dim1 (vector-ref vec2 dim2))
+                     (vector-set! vec2 dim2 tmp)
+                     (array-set! res vec2 (array-ref a vec1))))
+          (make-vector rank))))))
 
 (define (array-rotate-90 a :optional (dim1 0) (dim2 1))
   (let* ([sh (array-copy (array-shape a))]
@@ -209,30 +260,38 @@
       (error "can only compute inverses of 2D arrays"))
     (unless (= n m)
       (error "can only compute inverses of square matrices"))
-    (let* ([class (class-of a)]
-           [id (identity-array n (if (or (eq? class <f32array>)
-                                         (eq? class <f64array>))
-                                   class <array>))]
-           [tmp (array-concatenate a id 1)])
-      (array-solve-left-identity! tmp)
-      (and (= 1 (array-ref tmp (- (s32vector-ref end 0) 1)
-                           (- (s32vector-ref end 1) 1)))
-           (subarray tmp (shape (s32vector-ref start 0) (s32vector-ref end 0)
-                                (s32vector-ref end 1) (+ (s32vector-ref end 1) n)))))))
+    (if-let1 v (array-matrix-view a)
+      (let1 res (make-matrix-like a n n)
+        (and (%matrix-inverse! (array-matrix-view res) v) res))
+      (let* ([class (class-of a)]
+             [id (identity-array n (if (or (eq? class <f32array>)
+                                           (eq? class <f64array>))
+                                     class <array>))]
+             [tmp (array-concatenate a id 1)])
+        (array-solve-left-identity! tmp)
+        (and (= 1 (array-ref tmp (- (s32vector-ref end 0) 1)
+                             (- (s32vector-ref end 1) 1)))
+             (subarray tmp (shape (s32vector-ref start 0) (s32vector-ref end 0)
+                                  (s32vector-ref end 1) (+ (s32vector-ref end 1) n))))))))
 
 
 (define (determinant! a)
-  (let* ([start (s32vector->list (start-vector-of a))]
-         [end (s32vector->list (end-vector-of a))]
-         [row-col-offset (- (car start) (cadr start))]
-         [factor (array-row-echelon! a)])
-    (unless (= 2 (length start)) ; add determinant for the 2x2x2 case?
-      (error "can't compute hyperdeterminants in the general case"))
-    (unless (apply = (map - end start))
-      (error "can't compute determinants of non-square matrices"))
-    (apply * factor (map (^i (array-ref a i (- i row-col-offset)))
-                         (map (cute + <> (car start))
-                              (iota (- (car end) (car start))))))))
+  (if-let1 v (array-matrix-view a)
+    (begin
+      (unless (= (view-rows v) (view-cols v))
+        (error "can't compute determinants of non-square matrices"))
+      (%matrix-determinant v #t))
+    (let* ([start (s32vector->list (start-vector-of a))]
+           [end (s32vector->list (end-vector-of a))]
+           [row-col-offset (- (car start) (cadr start))]
+           [factor (array-row-echelon! a)])
+      (unless (= 2 (length start)) ; add determinant for the 2x2x2 case?
+        (error "can't compute hyperdeterminants in the general case"))
+      (unless (apply = (map - end start))
+        (error "can't compute determinants of non-square matrices"))
+      (apply * factor (map (^i (array-ref a i (- i row-col-offset)))
+                           (map (cute + <> (car start))
+                                (iota (- (car end) (car start)))))))))
 
 (define (determinant a)
   (let1 class (class-of a)
@@ -246,11 +305,121 @@
                                 (make-vector rank))])
         (determinant! b)))))
 
+(define (check-square-matrix a who)
+  (unless (= (array-rank a) 2)
+    (errorf "~a: rank-2 array required, but got: ~s" who a))
+  (unless (= (array-length a 0) (array-length a 1))
+    (errorf "~a: square matrix required, but got shape ~s"
+            who (array->list (array-shape a)))))
+
+;; Rows of square matrix A as a vector of vectors.
+(define (matrix-rows a)
+  (let ([r0 (array-start a 0)]
+        [c0 (array-start a 1)]
+        [n (array-length a 0)])
+    (vector-tabulate (^i (vector-tabulate (^j (array-ref a (+ r0 i) (+ c0 j)))
+                                          n))
+                     n)))
+
+(define (rows->matrix rows)
+  (let* ([n (vector-length rows)]
+         [res (make-array-internal <array> (shape 0 n 0 n))])
+    (dotimes [i n]
+      (dotimes [j n]
+        (array-set! res i j (vector-ref (vector-ref rows i) j))))
+    res))
+
+;; LU decomposition with partial pivoting.  Returns L, U and a permutation
+;; s32vector P, such that row i of L U is row (P[i]) of A, counted from
+;; the first row of A.  L has the unit diagonal.  A singular matrix is
+;; decomposed as well, with zeros on the diagonal of U.
+(define (array-lu a)
+  (check-square-matrix a 'array-lu)
+  (let ([n (array-length a 0)]
+        [perm (list->s32vector (iota (array-length a 0)))])
+    (if-let1 v (array-matrix-view a)
+      (let ([l (make-matrix-like a n n)]
+            [u (make-matrix-like a n n)])
+        (%matrix-lu! (array-matrix-view l) (array-matrix-view u) v perm)
+        (values l u perm))
+      (let ([w (matrix-rows a)]
+            [l (make-vector n)])
+        (dotimes [k n]
+          (let1 p (fold (^[i p] (if (> (magnitude (~ w i k)) (magnitude (~ w p k)))
+                                  i p))
+                        k (iota (- n k 1) (+ k 1)))
+            (unless (= p k)
+              (let1 t (vector-ref w p)
+                (vector-set! w p (vector-ref w k))
+                (vector-set! w k t))
+              (s32vector-swap! perm p k))
+            (unless (zero? (~ w k k))
+              (do ([i (+ k 1) (+ i 1)])
+                  [(= i n)]
+                (let1 f (/ (~ w i k) (~ w k k))
+                  (set! (~ w i k) f)
+                  (do ([j (+ k 1) (+ j 1)])
+                      [(= j n)]
+                    (set! (~ w i j) (- (~ w i j) (* f (~ w k j))))))))))
+        (dotimes [i n]
+          (vector-set! l i (make-vector n 0))
+          (dotimes [j i]
+            (set! (~ l i j) (~ w i j))
+            (set! (~ w i j) 0))
+          (set! (~ l i i) 1))
+        (values (rows->matrix l) (rows->matrix w) perm)))))
+
+;; Cholesky decomposition A = L L^T of symmetric positive definite A.
+;; Only the lower triangle of A is looked at.  Returns #f if A isn't
+;; positive definite.
+(define (array-cholesky a)
+  (check-square-matrix a 'array-cholesky)
+  (let1 n (array-length a 0)
+    (if-let1 v (array-matrix-view a)
+      (let1 l (make-matrix-like a n n)
+        (and (%matrix-cholesky! (array-matrix-view l) v) l))
+      (let ([w (matrix-rows a)]
+            [l (vector-tabulate (^_ (make-vector n 0)) n)])
+        (define (dot i j)
+          (fold (^[k s] (+ s (* (~ l i k) (~ l j k)))) 0 (iota j)))
+        (let/cc return
+          (dotimes [j n]
+            (let1 d (- (~ w j j) (dot j j))
+              (unless (positive? d) (return #f))
+              (set! (~ l j j) (sqrt d))
+              (do ([i (+ j 1) (+ i 1)])
+                  [(= i n)]
+                (set! (~ l i j) (/ (- (~ w i j) (dot i j)) (~ l j j))))))
+          (rows->matrix l))))))
+
 
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 ;; matrix arithmetic
 
-(define (%array-mul r a b) ; NxM * MxP => NxP
+(define (%array-mul r a b :optional (run-rows #f)) ; NxM * MxP => NxP
+  (or (%array-mul-native r a b run-rows)
+      (%array-mul-generic r a b)))
+
+;; Returns #f if we can't use the native kernel.  RUN-ROWS, if given, is
+;; called with a procedure (^[start end] ...) that computes the rows
+;; [start, end) of the result, and the number of rows; it may call the
+;; procedure on subranges concurrently.
+(define (%array-mul-native r a b run-rows)
+  (and-let* ([va (array-matrix-view a)]
+             [vb (array-matrix-view b)]
+             [ (eq? (class-of a) (class-of b)) ]
+             [ (= (view-cols va) (view-rows vb)) ]
+             [ (or (not r) (eq? (class-of r) (class-of a))) ]
+             [res (or r (make-matrix-like a (view-rows va) (view-cols vb)))]
+             [vr (array-matrix-view res)]
+             [ (not (eq? (view-storage vr) (view-storage va))) ]
+             [ (not (eq? (view-storage vr) (view-storage vb))) ])
+    (if run-rows
+      (run-rows (^[s e] (%matrix-mul! vr va vb s e)) (view-rows va))
+      (%matrix-mul! vr va vb))
+    res))
+
+(define (%array-mul-generic r a b)
   (let ([a-start (start-vector-of a)]
         [a-end (end-vector-of a)]
         [b-start (start-vector-of b)]
@@ -312,6 +481,21 @@
 
 ;; Array x vector
 (define (%array-vector-mul r a v)
+  (or (%matrix-vector-mul-native r (array-matrix-view a) v)
+      (%array-vector-mul-generic r a v)))
+
+;; VIEW is a matrix view or #f.  Returns #f if we can't use the native
+;; kernel, that is, unless V is a uvector of the element type of VIEW.
+(define (%matrix-vector-mul-native r view v)
+  (and-let* ([ view ]
+             [ (eq? (class-of v) (class-of (view-storage view))) ]
+             [ (= (uvector-length v) (view-cols view)) ]
+             [ (or (not r) (eq? (class-of r) (class-of v))) ]
+             [ (not (eq? r v)) ])
+    (rlet1 r (or r (make-uvector (class-of v) (view-rows view)))
+      (%matrix-vector-mul! r view v))))
+
+(define (%array-vector-mul-generic r a v)
   (let ([a-start (start-vector-of a)]
         [a-end (end-vector-of a)])
     (assume (= 2 (s32vector-length a-start))
@@ -341,6 +525,12 @@
 
 ;; Vector x array
 (define (%vector-array-mul r v a)
+  (or (%matrix-vector-mul-native r (and-let1 view (array-matrix-view a)
+                                     (transposed-view view))
+                                 v)
+      (%vector-array-mul-generic r v a)))
+
+(define (%vector-array-mul-generic r v a)
   (let ([a-start (start-vector-of a)]
         [a-end (end-vector-of a)])
     (assume (= 2 (s32vector-length a-start))
@@ -2629,6 +2629,174 @@
       #,(<f64array> (0 2 0 2) 1 1/2 1/3 1/4))
      )))
 
+;; f32 and f64 matrices go to the native kernels.  Small ones are
+;; compared with the generic code on <array>s of the same elements; large
+;; ones, which exercise the blocking, are checked with matrix-vector
+;; products.
+(test-section "native matrix kernels")
+
+(let ()
+  (define seed 12345)
+  (define (rand)                        ;multiples of 1/64 in [-4, 4)
+    (set! seed (modulo (+ (* seed 1103515245) 12345) 2147483648))
+    (/ (- (quotient seed 65536) 16384) 64))
+  (define (rand-array class r0 rows c0 cols)
+    (rlet1 a ((if (eq? class <f32array>) make-f32array make-f64array)
+              (shape r0 (+ r0 rows) c0 (+ c0 cols)))
+      (array-for-each-index a (^[i j] (array-set! a i j (rand))))))
+  (define (rand-vector class n)
+    (rlet1 v (make-uvector class n)
+      (dotimes [i n] (uvector-set! v i (rand)))))
+  (define (generic a)
+    (tabulate-array (array-shape a) (^[ind] (array-ref a ind)) (make-vector 2)))
+  (define (->list x)
+    (cond [(list? x) x]
+          [(array? x) (array->list x)]
+          [(vector? x) (vector->list x)]
+          [else (uvector->list x)]))
+  ;; Elements agree within TOL relative to the expected ones, or absolute
+  ;; if they're smaller than 1.
+  (define (close? tol)
+    (^[x y]
+      (and (or (not (array? x))
+               (equal? (array->list (array-shape x)) (array->list (array-shape y))))
+           (= (length (->list x)) (length (->list y)))
+           (every (^[p q] (<= (abs (- p q)) (* tol (max 1 (abs p)))))
+                  (->list x) (->list y)))))
+  (define (tol-of class) (if (eq? class <f32array>) 1e-5 1e-12))
+  (define (vclass-of class) (if (eq? class <f32array>) <f32vector> <f64vector>))
+
+  (dolist [class (list <f64array> <f32array>)]
+    (let1 tol (tol-of class)
+      (dolist [dims '((1 1 1) (3 4 5) (7 2 9) (17 13 11))]
+        (let ([a (rand-array class 0 (car dims) 2 (cadr dims))]
+              [b (rand-array class 1 (cadr dims) 0 (caddr dims))])
+          (test* #"array-mul ~(class-name class) ~dims"
+                 (array-mul (generic a) (generic b))
+                 (array-mul a b) (close? tol))
+          (test* #"array-transpose ~(class-name class) ~dims"
+                 (array-transpose (generic a))
+                 (array-transpose a) (close? 0))))
+      (let ([a (rand-array class 0 9 0 7)]
+            [v (rand-vector (vclass-of class) 7)]
+            [w (rand-vector (vclass-of class) 9)])
+        (test* #"array-vector-mul ~(class-name class)"
+               (array-vector-mul (generic a) (uvector->vector v))
+               (array-vector-mul a v) (close? tol))
+        (test* #"vector-array-mul ~(class-name class)"
+               (vector-array-mul (uvector->vector w) (generic a))
+               (vector-array-mul w a) (close? tol))
+        (test* #"array-vector-mul ~(class-name class) with vector"
+               (array-vector-mul (generic a) (uvector->vector v))
+               (array-vector-mul a (uvector->vector v)) (close? tol)))
+      (let1 a (rand-array class 2 6 3 6)
+        (test* #"determinant ~(class-name class)"
+               (determinant (generic a)) (determinant a)
+               (^[x y] (<= (abs (- x y)) (* tol 100 (abs x)))))
+        (test* #"array-inverse ~(class-name class)"
+               (array-inverse (generic a)) (array-inverse a)
+               (close? (* tol 100))))))
+
+  ;; shared arrays: transposed and strided views of the backing storage
+  (let* ([a (rand-array <f64array> 0 8 0 10)]
+         [at (share-array a (shape 0 10 0 8) (^[i j] (values j i)))]
+         [as (share-array a (shape 1 5 0 4)
+                          (^[i j] (values (* 2 (- i 1)) (+ 1 (* 2 j)))))])
+    (test* "array-mul transposed"
+           (array-mul (generic at) (generic a))
+           (array-mul at a) (close? 1e-12))
+    (test* "array-mul strided"
+           (array-mul (generic as) (generic as))
+           (array-mul as as) (close? 1e-12))
+    (test* "array-transpose transposed" (generic a) (array-transpose at)
+           (close? 0))
+    (test* "determinant strided"
+           (determinant (generic as)) (determinant as)
+           (^[x y] (<= (abs (- x y)) (* 1e-10 (abs x))))))
+
+  (test* "array-mul f32 x f64" <f64array>
+         (class-of (array-mul (rand-array <f32array> 0 2 0 2)
+                              (rand-array <f64array> 0 2 0 2))))
+  (test* "array-mul dimension mismatch" (test-error)
+         (array-mul (rand-array <f64array> 0 2 0 3)
+                    (rand-array <f64array> 0 2 0 3)))
+  (test* "array-inverse singular" #f
+         (array-inverse (f64array (shape 0 2 0 2) 1 2 2 4)))
+  (test* "determinant singular" 0.0
+         (determinant (f64array (shape 0 2 0 2) 1 2 2 4)))
+
+  ;; Sizes beyond the blocking factors of the kernels
+  (let* ([n 300] [m 270] [p 280]
+         [a (rand-array <f64array> 0 n 0 m)]
+         [b (rand-array <f64array> 0 m 0 p)]
+         [x (rand-vector <f64vector> p)]
+         [y (rand-vector <f64vector> m)]
+         [z (rand-vector <f64vector> n)]
+         [c (array-mul a b)])
+    (test* "array-vector-mul large"
+           (map (^i (fold (^[j s] (+ s (* (array-ref a i j) (f64vector-ref y j))))
+                          0 (iota m)))
+                (iota n))
+           (array-vector-mul a y) (close? 1e-12))
+    (test* "array-mul large"
+           (array-vector-mul a (array-vector-mul b x))
+           (array-vector-mul c x) (close? 1e-10))
+    (test* "vector-array-mul large"
+           (array-vector-mul (array-transpose c) z)
+           (vector-array-mul z c) (close? 1e-10)))
+
+  (dolist [class (list <f64array> <f32array>)]
+    (let1 tol (* 1000 (tol-of class))
+      (dolist [n '(1 5 150)]
+        (let* ([a (rand-array class 0 n 0 n)]
+               [x (rand-vector (vclass-of class) n)]
+               [ax (array-vector-mul a x)])
+          (receive (l u perm) (array-lu a)
+            (test* #"array-lu ~(class-name class) ~n"
+                   (map (^i (uvector-ref ax (s32vector-ref perm i))) (iota n))
+                   (array-vector-mul l (array-vector-mul u x))
+                   (close? tol))
+            (test* #"array-lu ~(class-name class) ~n triangular" #t
+                   (every (^i (and (= (array-ref l i i) 1)
+                                   (every (^j (and (zero? (array-ref l j i))
+                                                   (zero? (array-ref u i j))))
+                                          (iota i))))
+                          (iota n))))
+          ;; shifted to keep the condition number small
+          (let* ([s (array-add-elements a (array-mul-elements
+                                           (identity-array n class) (+ n 4)))]
+                 [sinv (array-inverse s)])
+            (test* #"array-inverse ~(class-name class) ~n" x
+                   (array-vector-mul s (array-vector-mul sinv x))
+                   (close? tol)))
+          (let* ([s (array-add-elements (array-mul a (array-transpose a))
+                                        (array-mul-elements
+                                         (identity-array n class) n))]
+                 [l (array-cholesky s)])
+            (test* #"array-cholesky ~(class-name class) ~n"
+                   (array-vector-mul s x)
+                   (array-vector-mul l (vector-array-mul x l))
+                   (close? tol)))))))
+
+  (test* "array-lu generic"
+         '(#,(<array> (0 2 0 2) 1 0 1/3 1) #,(<array> (0 2 0 2) 3 4 0 2/3) #s32(1 0))
+         (receive (l u p) (array-lu (array (shape 1 3 1 3) 1 2 3 4))
+           (list l u p)))
+  (test* "array-lu f64"
+         '(#,(<f64array> (0 2 0 2) 1 0 0.5 1) #,(<f64array> (0 2 0 2) 4 4 0 1) #s32(1 0))
+         (receive (l u p) (array-lu (f64array (shape 1 3 1 3) 2 3 4 4))
+           (list l u p)))
+  (test* "array-cholesky generic" '#,(<array> (0 2 0 2) 2 0 1 3)
+         (array-cholesky (array (shape 0 2 0 2) 4 2 2 10)))
+  (test* "array-cholesky f64" '#,(<f64array> (0 2 0 2) 2 0 1 3)
+         (array-cholesky (f64array (shape 0 2 0 2) 4 2 2 10)))
+  (test* "array-cholesky not positive definite" '(#f #f)
+         (list (array-cholesky (array (shape 0 2 0 2) 1 2 2 1))
+               (array-cholesky (f64array (shape 0 2 0 2) 1 2 2 1))))
+  (test* "array-lu non-square" (test-error)
+         (array-lu (f64array (shape 0 2 0 3) 1 2 3 4 5 6)))
+  )
+
 ;;-------------------------------------------------------------------
 ;; NB: copy-port uses read-block! and write-block for block copy,
 ;;     so we test it here.
@@ -2757,6 +2925,76 @@
        (rlet1 v (make-bytevector 8 0)
          (bytevector-copy!-r6 '#u8(1 2 3 4 5) 1 v 2 3)))
 
+;;-------------------------------------------------------------------
+(test-section "atomic access and shared memory")
+
+(test* "atomic-ref/set!" '(5 -3)
+       (let1 v (make-s32vector 2 5)
+         (uvector-atomic-set! v 1 -3)
+         (list (uvector-atomic-ref v 0) (uvector-atomic-ref v 1))))
+(test* "atomic-add!" '(10 13 #u8(0 3))
+       (let1 v (u8vector 10 250)
+         (list (uvector-atomic-add! v 0 3)
+               (uvector-atomic-ref v 0)
+               (begin (uvector-atomic-add! v 0 -13)
+                      (uvector-atomic-add! v 1 9) ; wraps around
+                      v))))
+(test* "atomic-add! u64" (- (expt 2 64) 1)
+       (let1 v (make-u64vector 1 0)
+         (uvector-atomic-add! v 0 -1)
+         (uvector-atomic-ref v 0)))
+(test* "atomic-cas!" '(#f #t #s64(7))
+       (let1 v (s64vector 3)
+         (list (uvector-atomic-cas! v 0 4 7)
+               (uvector-atomic-cas! v 0 3 7)
+               v)))
+(test* "atomic-set! out of range value" (test-error)
+       (uvector-atomic-set! (make-s8vector 1) 0 128))
+(test* "atomic-ref out of range index" (test-error)
+       (uvector-atomic-ref (make-s8vector 1) 1))
+(test* "atomic-add! immutable" (test-error)
+       (uvector-atomic-add! '#u32(0) 0 1))
+(test* "atomic-ref f64" (test-error)
+       (uvector-atomic-ref (make-f64vector 1) 0))
+
+(test* "make-shared-uvector" '#s32(0 0 0 0)
+       (make-shared-uvector <s32vector> 4))
+
+(cond-expand
+ [(and (not gauche.os.windows) (not gauche.os.cygwin))
+  (test* "shared across fork" 20000
+         (let* ([v (make-shared-uvector <u32vector> 1)]
+                [pids (map (^_ (let1 pid (sys-fork)
+                                 (when (= pid 0)
+                                   (dotimes [5000] (uvector-atomic-add! v 0 1))
+                                   (sys-exit 0))
+                                 pid))
+                           (iota 3))])
+           (dotimes [5000] (uvector-atomic-add! v 0 1))
+           (for-each sys-waitpid pids)
+           (uvector-atomic-ref v 0)))]
+ [else])
+
+(cond-expand
+ [gauche.sys.shm
+  (let1 name #"/gauche-test-~(sys-getpid)"
+    (test* "named shared uvector" '(#f64(0.0 2.5 0.0) #f64(0.0 2.5 0.0))
+           (let* ([v (make-shared-uvector <f64vector> 3 :name name)]
+                  [w (open-shared-uvector <f64vector> name)])
+             (f64vector-set! v 1 2.5)
+             (list v w)))
+    (test* "named shared uvector (read-only)" #t
+           (uvector-immutable?
+            (open-shared-uvector <u8vector> name :read-only #t :length 8)))
+    (test* "named shared uvector (already exists)" (test-error)
+           (make-shared-uvector <u8vector> 10 :name name))
+    (test* "named shared uvector (too long)" (test-error)
+           (open-shared-uvector <u8vector> name :length 100))
+    (sys-shm-unlink name)
+    (test* "named shared uvector (unlinked)" (test-error)
+           (open-shared-uvector <u8vector> name)))]
+ [else])
+
 ;;-------------------------------------------------------------------
 (test-section "generator and uvector")
 
@@ -2810,6 +3048,185 @@
 (use gauche.uvector.c128)
 (test-module 'gauche.uvector.c128)
 
+;;-------------------------------------------------------------------
+(test-section "parallel operations")
+
+(use gauche.uvector.parallel)
+(test-module 'gauche.uvector.parallel)
+
+(let* ([n 50000]
+       [fv (f64vector-tabulate n (^i (/. (- (modulo (* i 7919) 1000) 500) 8)))]
+       [gv (f64vector-tabulate n (^i (/. (modulo (* i 104729) 997) 4)))]
+       [sv (s16vector-tabulate n (^i (- (modulo (* i 7919) 60001) 30000)))]
+       [tv (s16vector-tabulate n (^i (- (modulo (* i 31) 50001) 25000)))])
+  (define (t name expected thunk)
+    ;; run with a lowered threshold so that the work is actually split
+    (test* #"~name (sequential)" expected (thunk))
+    (test* #"~name (parallel)" expected
+           (parameterize ([parallel-uvector-threshold 1000]) (thunk))))
+
+  (t "add" (f64vector-add fv gv) (^[] (parallel-uvector-add fv gv)))
+  (t "sub scalar" (f64vector-sub fv 1.5) (^[] (parallel-uvector-sub fv 1.5)))
+  (t "mul" (f64vector-mul fv gv) (^[] (parallel-uvector-mul fv gv)))
+  (t "div" (f64vector-div fv 3.0) (^[] (parallel-uvector-div fv 3.0)))
+  (t "add clamp" (s16vector-add sv tv 'both)
+     (^[] (parallel-uvector-add sv tv 'both)))
+  (t "add!" (f64vector-add fv gv)
+     (^[] (let1 v (f64vector-copy fv) (parallel-uvector-add! v gv) v)))
+  (t "clamp" (s16vector-clamp sv -100 #f)
+     (^[] (parallel-uvector-clamp sv -100 #f)))
+  (t "add with a vector" (f64vector-add fv (f64vector->vector gv))
+     (^[] (parallel-uvector-add fv (f64vector->vector gv))))
+  (t "dot" (s16vector-dot sv tv) (^[] (parallel-uvector-dot sv tv)))
+  ;; all values are multiples of 1/8, so the sum is exact in any order
+  (t "dot f64" (f64vector-dot fv gv) (^[] (parallel-uvector-dot fv gv)))
+  (t "sum" (fold + 0 (s16vector->list sv)) (^[] (parallel-uvector-sum sv)))
+  (t "sum f64" (fold + 0 (f64vector->list fv)) (^[] (parallel-uvector-sum fv)))
+  (t "min" (fold min 32767 (s16vector->list sv)) (^[] (parallel-uvector-min sv)))
+  (t "max" (fold max -inf.0 (f64vector->list fv)) (^[] (parallel-uvector-max fv)))
+  (t "map! proc" (s16vector-map (^x (quotient x 3)) sv)
+     (^[] (parallel-uvector-map! (^x (quotient x 3)) (s16vector-copy sv))))
+  (t "map! abs" (f64vector-map abs fv)
+     (^[] (parallel-uvector-map! 'abs (f64vector-copy fv))))
+  (t "map! square" (f64vector-mul fv fv)
+     (^[] (parallel-uvector-map! 'square (f64vector-copy fv))))
+  (t "add length mismatch" (test-error)
+     (^[] (parallel-uvector-add fv (f64vector 1 2 3))))
+  (t "error in a task" (test-error)
+     (^[] (parallel-uvector-map! (^x (if (= x (s16vector-ref sv 40000)) (error "boom") x))
+                                 (s16vector-copy sv))))
+  )
+
+(test* "sum of large integers" (* 20000 (- (expt 2 63) 1))
+       (parameterize ([parallel-uvector-threshold 1000])
+         (parallel-uvector-sum (make-s64vector 20000 (- (expt 2 63) 1)))))
+(test* "sum empty" 0 (parallel-uvector-sum (u8vector)))
+(test* "sum empty f32" 0.0 (parallel-uvector-sum (f32vector)))
+(test* "min empty" (test-error) (parallel-uvector-min (u8vector)))
+(test* "max NaN" #t (nan? (parallel-uvector-max (f64vector 1 +nan.0 3))))
+(test* "sum c64" 3.0+3.0i (parallel-uvector-sum (c64vector 1+i 2+2i)))
+(test* "map! sqrt" '#f64(1.0 2.0 3.0)
+       (parallel-uvector-map! 'sqrt (f64vector 1 4 9)))
+(test* "map! on integers" (test-error)
+       (parallel-uvector-map! 'sqrt (u8vector 1 4 9)))
+(test* "map! immutable" (test-error)
+       (parallel-uvector-map! 'abs #f64(-1.0 2.0)))
+(test* "div on integers" (test-error)
+       (parallel-uvector-div (u8vector 1 2) 2))
+
+;; Elements are multiples of 1/64 in [-2, 2), so the products are exact.
+(let ()
+  (define make-array-internal (with-module gauche.array make-array-internal))
+  (define (mk class rows cols k)
+    (rlet1 a (make-array-internal class (shape 0 rows 0 cols))
+      (array-for-each-index a
+        (^[i j] (array-set! a i j (/ (- (modulo (* (+ (* i cols) j) k) 257) 128)
+                                     64))))))
+  (dolist [t `((,<f64array> 120 100 90) (,<f32array> 120 100 90)
+               (,<array> 12 10 9))]
+    (let ([a (mk (car t) (cadr t) (caddr t) 7919)]
+          [b (mk (car t) (caddr t) (cadddr t) 104729)])
+      (test* #"parallel-array-mul ~(class-name (car t))" (array-mul a b)
+             (parameterize ([parallel-uvector-threshold 1000])
+               (parallel-array-mul a b))))))
+
+;; The vectorized kernels must give the same results as the scalar loops,
+;; including overflow errors and partial clamping.  Vectors are longer
+;; than a few kernel chunks and have a tail.
+(test-section "vectorized kernels")
+
+(let ([%uvector-kernels (with-module gauche.uvector %uvector-kernels)]
+      [%uvector-reduce (with-module gauche.uvector %uvector-reduce)]
+      [n 203])
+  (define variant (%uvector-kernels))
+  (define (scalar thunk)
+    (unwind-protect
+        (begin (%uvector-kernels #f)
+               (guard (e [(is-a? e <error>) 'error]) (thunk)))
+      (%uvector-kernels variant)))
+  (define (t name thunk)
+    (test* #"~name (~variant)" (scalar thunk)
+           (guard (e [(is-a? e <error>) 'error]) (thunk))))
+  (define (proc tag op)
+    (module-binding-ref 'gauche.uvector (symbol-append tag 'vector- op)))
+  (define (tab tag f)
+    ((module-binding-ref 'gauche.uvector (symbol-append 'list-> tag 'vector))
+     (map f (iota n))))
+  (define (ival i m) (- (modulo (* i 7919) m) (quotient m 2)))
+
+  (test* "kernel variant" #t (symbol? variant))
+  (test* "kernels off" #f (begin (%uvector-kernels #f) (%uvector-kernels)))
+  (%uvector-kernels variant)
+  (test* "unknown variant" (test-error) (%uvector-kernels 'no-such-variant))
+
+  (dolist [tag '(s8 u8 s16 u16 s32 u32 s64 u64)]
+    (let* ([signed? (memq tag '(s8 s16 s32 s64))]
+           [bits (string->number (string-copy (symbol->string tag) 1))]
+           [hi (- (if signed? (expt 2 (- bits 1)) (expt 2 bits)) 1)]
+           [lo (if signed? (- -1 hi) 0)]
+           ;; small values never overflow; the extreme one at 150 does
+           [x (tab tag (^i (if signed? (ival i 100) (modulo (* i 31) 100))))]
+           [y (tab tag (^i (if signed? (ival (+ i 3) 60) (modulo i 50))))]
+           [z (rlet1 v (uvector-copy x) (uvector-set! v 150 (if signed? lo hi)))]
+           [k (if signed? -3 3)]
+           [add (proc tag 'add)] [sub (proc tag 'sub)] [mul (proc tag 'mul)])
+      (t #"~tag add" (^[] (add x y)))
+      (t #"~tag sub" (^[] (if signed? (sub x y) (sub x y 'low))))
+      (t #"~tag mul" (^[] (mul x y)))
+      (t #"~tag mul both" (^[] (mul x y 'both)))
+      (t #"~tag add const" (^[] (add x k)))
+      (t #"~tag mul const" (^[] (mul x k)))
+      (t #"~tag add overflow" (^[] (add z z)))
+      (t #"~tag add overflow both" (^[] (add z z 'both)))
+      (t #"~tag add overflow low" (^[] (add z z 'low)))
+      (t #"~tag add overflow high" (^[] (add z z 'high)))
+      (t #"~tag sub overflow both" (^[] (sub y z 'both)))
+      (t #"~tag mul overflow both" (^[] (mul z k 'both)))
+      (t #"~tag add! in place" (^[] (rlet1 v (uvector-copy x)
+                                      ((proc tag 'add!) v v 'both))))
+      (t #"~tag dot" (^[] ((proc tag 'dot) x y)))
+      (t #"~tag clamp" (^[] ((proc tag 'clamp) z (if signed? -20 5) 40)))
+      (t #"~tag clamp low" (^[] ((proc tag 'clamp) z (if signed? -20 5) #f)))
+      (t #"~tag clamp!" (^[] ((proc tag 'clamp!) (uvector-copy z) #f 40)))
+      (dolist [op '(sum min max)]
+        (t #"~tag ~op" (^[] (%uvector-reduce z op)))
+        (t #"~tag ~op range" (^[] (%uvector-reduce z op 7 190))))))
+
+  ;; Flonum elements are multiples of 1/8, so that sums and dot products
+  ;; are exact regardless of the summation order.
+  (dolist [tag '(f32 f64)]
+    (let* ([x (tab tag (^i (/. (ival i 1000) 8)))]
+           [y (tab tag (^i (/. (+ (ival (+ i 5) 998) 0.5) 4)))]
+           [z (rlet1 v (uvector-copy x) (uvector-set! v 170 +nan.0))])
+      (t #"~tag add" (^[] ((proc tag 'add) x y)))
+      (t #"~tag sub const" (^[] ((proc tag 'sub) x 1.5)))
+      (t #"~tag mul" (^[] ((proc tag 'mul) x y)))
+      (t #"~tag div" (^[] ((proc tag 'div) x y)))
+      (t #"~tag div const" (^[] ((proc tag 'div) x 3.0)))
+      ;; 0.1 and 1/3 aren't exact in float
+      (t #"~tag add const 0.1" (^[] ((proc tag 'add) x 0.1)))
+      (t #"~tag mul const 0.1" (^[] ((proc tag 'mul) x 0.1)))
+      (t #"~tag div const 0.1" (^[] ((proc tag 'div) x 0.1)))
+      (t #"~tag mul const 1/3" (^[] ((proc tag 'mul) x (/. 3))))
+      (t #"~tag dot" (^[] ((proc tag 'dot) x y)))
+      (t #"~tag clamp" (^[] ((proc tag 'clamp) x -10.0 20.0)))
+      (t #"~tag clamp NaN" (^[] (uvector->list ((proc tag 'clamp) z #f 20.0)
+                                               0 170)))
+      (t #"~tag sum" (^[] (%uvector-reduce x 'sum)))
+      (t #"~tag min" (^[] (%uvector-reduce x 'min)))
+      (t #"~tag max range" (^[] (%uvector-reduce x 'max 3 201)))
+      ;; Zeros of both signs are equal; the scalar loop returns the first
+      ;; one.  We check the sign through the reciprocal.
+      (let ([zs (tab tag (^i (cond [(= i 0) 1.0] [(odd? i) 0.0] [else -0.0])))]
+            [nzs (tab tag (^i (cond [(= i 0) -1.0] [(odd? i) -0.0] [else 0.0])))]
+            [signed (^[r] (list r (/. r)))])
+        (t #"~tag min +-0" (^[] (signed (%uvector-reduce zs 'min))))
+        (t #"~tag max +-0" (^[] (signed (%uvector-reduce nzs 'max))))
+        (t #"~tag min +-0 range" (^[] (signed (%uvector-reduce zs 'min 2 190))))
+        (t #"~tag max +-0 range" (^[] (signed (%uvector-reduce nzs 'max 1 190)))))
+      (test* #"~tag max NaN" #t (nan? (%uvector-reduce z 'max)))
+      (test* #"~tag min NaN" #t (nan? (%uvector-reduce z 'min 100 200))))))
+
 ;;-------------------------------------------------------------------
 ;; SRFI-207 depends on gauche.uvector, gauche.unicode and gauche.generator,
 ;; so we test it after those dependencies are tested.
@@ -69,6 +69,10 @@
 
           write-block write-uvector write-bytevector
 
+          make-shared-uvector open-shared-uvector
+          uvector-atomic-ref uvector-atomic-set!
+          uvector-atomic-add! uvector-atomic-cas!
+
           ;; R7RS compatibility (scheme base) and (scheme bytevector)
           bytevector bytevector? make-bytevector bytevector-fill!
           bytevector-length bytevector-u8-ref bytevector-u8-set!
@@ -123,6 +127,110 @@
      (return h)))
  )
 
+;; Reductions and elementwise flonum math on a range.  These are
+;; the kernels of gauche.uvector.parallel, which calls them on slices.
+(inline-stub
+ (define-cproc %uvector-reduce (v::<uvector> op::<symbol>
+                                :optional (start::<fixnum> 0) (end::<fixnum> -1))
+   (let* ([o::int 0])
+     (cond [(SCM_EQ (SCM_OBJ op) 'sum) (= o UVECTOR_REDUCE_SUM)]
+           [(SCM_EQ (SCM_OBJ op) 'min) (= o UVECTOR_REDUCE_MIN)]
+           [(SCM_EQ (SCM_OBJ op) 'max) (= o UVECTOR_REDUCE_MAX)]
+           [else (Scm_Error "sum, min or max required, but got: %S" op)])
+     (return (Scm_UVectorReduce v o start end))))
+
+ (define-cproc %uvector-math! (v::<uvector> op::<symbol>
+                               :optional (start::<fixnum> 0) (end::<fixnum> -1))
+   ::<void>
+   (let* ([o::int 0])
+     (cond [(SCM_EQ (SCM_OBJ op) 'abs)      (= o UVECTOR_MATH_ABS)]
+           [(SCM_EQ (SCM_OBJ op) 'neg)      (= o UVECTOR_MATH_NEG)]
+           [(SCM_EQ (SCM_OBJ op) 'square)   (= o UVECTOR_MATH_SQUARE)]
+           [(SCM_EQ (SCM_OBJ op) 'sqrt)     (= o UVECTOR_MATH_SQRT)]
+           [(SCM_EQ (SCM_OBJ op) 'exp)      (= o UVECTOR_MATH_EXP)]
+           [(SCM_EQ (SCM_OBJ op) 'log)      (= o UVECTOR_MATH_LOG)]
+           [(SCM_EQ (SCM_OBJ op) 'sin)      (= o UVECTOR_MATH_SIN)]
+           [(SCM_EQ (SCM_OBJ op) 'cos)      (= o UVECTOR_MATH_COS)]
+           [(SCM_EQ (SCM_OBJ op) 'tan)      (= o UVECTOR_MATH_TAN)]
+           [(SCM_EQ (SCM_OBJ op) 'floor)    (= o UVECTOR_MATH_FLOOR)]
+           [(SCM_EQ (SCM_OBJ op) 'ceiling)  (= o UVECTOR_MATH_CEILING)]
+           [(SCM_EQ (SCM_OBJ op) 'round)    (= o UVECTOR_MATH_ROUND)]
+           [(SCM_EQ (SCM_OBJ op) 'truncate) (= o UVECTOR_MATH_TRUNCATE)]
+           [else (Scm_Error "unknown uvector math operation: %S" op)])
+     (Scm_UVectorMathX v o start end)))
+ )
+
+;; Selects the vectorized kernels used by element-wise arithmetic and
+;; reductions; #t for the best one the CPU supports, #f to use the
+;; scalar loops only, or a variant name such as sse2 or avx2.
+;; Returns the variant in use.  Mainly for testing and benchmarking.
+(inline-stub
+ (define-cproc %uvector-kernels (:optional variant)
+   (unless (SCM_UNBOUNDP variant)
+     (Scm_UVectorSelectKernels variant))
+   (return (Scm_UVectorKernelVariant)))
+
+ (initcode (Scm_UVectorSelectKernels SCM_TRUE))
+ )
+
+;; Native matrix operations used by gauche.array on f32 and f64 arrays.
+;; A matrix is given as a view #(storage offset row-stride col-stride
+;; rows cols); see uvmatrix.c.
+(inline-stub
+ (define-cproc %matrix-mul! (c a b :optional (start::<fixnum> 0)
+                                             (end::<fixnum> -1))
+   ::<void> (Scm_MatrixMul c a b start end))
+ (define-cproc %matrix-copy! (dst src) ::<void> (Scm_MatrixCopy dst src))
+ (define-cproc %matrix-vector-mul! (y::<uvector> a x::<uvector>) ::<void>
+   (Scm_MatrixVectorMul y a x))
+ (define-cproc %matrix-determinant (a :optional (destructive::<boolean> #f))
+   ::<double> (return (Scm_MatrixDeterminant a destructive)))
+ (define-cproc %matrix-inverse! (x a) ::<boolean>
+   (return (Scm_MatrixInverse x a)))
+ (define-cproc %matrix-lu! (l u a piv::<uvector>) ::<int>
+   (return (Scm_MatrixLU l u a piv)))
+ (define-cproc %matrix-cholesky! (l a) ::<boolean>
+   (return (Scm_MatrixCholesky l a)))
+ )
+
+;; Shared memory uvectors.  NAME is a POSIX shared memory object name
+;; such as "/myapp-table", or #f for anonymous memory shared with the
+;; child processes forked afterwards.
+(define (make-shared-uvector class len :key (name #f) (mode #o600))
+  (let1 esize (uvector-class-element-size class)
+    (when (< esize 0)
+      (error "uvector class required, but got:" class))
+    (make-view-uvector (sys-shm-mmap name (logior PROT_READ PROT_WRITE)
+                                     (max (* esize len) 1) #t mode)
+                       class len)))
+
+(define (open-shared-uvector class name :key (length #f) (read-only #f))
+  (let1 esize (uvector-class-element-size class)
+    (when (< esize 0)
+      (error "uvector class required, but got:" class))
+    (make-view-uvector (sys-shm-mmap name
+                                     (if read-only
+                                       PROT_READ
+                                       (logior PROT_READ PROT_WRITE))
+                                     (if length (* esize length) 0))
+                       class length)))
+
+;; Atomic access to integer elements, lock-free even across processes.
+(inline-stub
+ (define-cproc uvector-atomic-ref (v::<uvector> k::<fixnum>)
+   (return (Scm_UVectorAtomicOp v k UVECTOR_ATOMIC_REF SCM_UNDEFINED
+                                SCM_UNDEFINED)))
+ (define-cproc uvector-atomic-set! (v::<uvector> k::<fixnum> val) ::<void>
+   (Scm_UVectorAtomicOp v k UVECTOR_ATOMIC_SET val SCM_UNDEFINED))
+ ;; Returns the previous value.
+ (define-cproc uvector-atomic-add! (v::<uvector> k::<fixnum> delta)
+   (return (Scm_UVectorAtomicOp v k UVECTOR_ATOMIC_ADD delta SCM_UNDEFINED)))
+ (define-cproc uvector-atomic-cas! (v::<uvector> k::<fixnum> expected new)
+   ::<boolean>
+   (return (SCM_TRUEP (Scm_UVectorAtomicOp v k UVECTOR_ATOMIC_CAS
+                                           expected new))))
+ )
+
 ;; byte swapping
 (inline-stub
  (define-cise-stmt swap-bytes-common
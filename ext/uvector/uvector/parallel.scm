@@ -0,0 +1,283 @@
+;;;
+;;; gauche.uvector.parallel - parallel bulk operations on uvectors
+;;;
+;;;   Copyright (c) 2026  Shiro Kawai  <shiro@acm.org>
+;;;
+;;;   Redistribution and use in source and binary forms, with or without
+;;;   modification, are permitted provided that the following conditions
+;;;   are met:
+;;;
+;;;   1. Redistributions of source code must retain the above copyright
+;;;      notice, this list of conditions and the following disclaimer.
+;;;
+;;;   2. Redistributions in binary form must reproduce the above copyright
+;;;      notice, this list of conditions and the following disclaimer in the
+;;;      documentation and/or other materials provided with the distribution.
+;;;
+;;;   3. Neither the name of the authors nor the names of its contributors
+;;;      may be used to endorse or promote products derived from this
+;;;      software without specific prior written permission.
+;;;
+;;;   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+;;;   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+;;;   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+;;;   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+;;;   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+;;;   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+;;;   TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+;;;   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+;;;   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+;;;   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+;;;   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+;;;
+
+;; Parallel versions of elementwise arithmetic, reductions and maps
+;; on large uniform vectors.  A vector is split into contiguous ranges,
+;; each of which is handed to the existing sequential kernel as a
+;; uvector-alias slice, so the results are the same as the sequential
+;; version's (except the summation order of inexact reductions).
+;; Matrix multiplication of f32/f64 arrays is split by rows likewise.
+
+(define-module gauche.uvector.parallel
+  (use gauche.uvector)
+  (use gauche.threads)
+  (use gauche.array)
+  (export parallel-uvector-threshold parallel-uvector-workers
+          parallel-uvector-add parallel-uvector-add!
+          parallel-uvector-sub parallel-uvector-sub!
+          parallel-uvector-mul parallel-uvector-mul!
+          parallel-uvector-div parallel-uvector-div!
+          parallel-uvector-clamp parallel-uvector-clamp!
+          parallel-uvector-dot parallel-uvector-sum
+          parallel-uvector-min parallel-uvector-max
+          parallel-uvector-map!
+          parallel-array-mul))
+(select-module gauche.uvector.parallel)
+
+(define %uvector-reduce (with-module gauche.uvector %uvector-reduce))
+(define %uvector-math!  (with-module gauche.uvector %uvector-math!))
+(define %array-mul      (with-module gauche.array %array-mul))
+
+;; Vectors shorter than this are processed by the calling thread alone.
+(define parallel-uvector-threshold (make-parameter 100000))
+
+;; We don't make a slice smaller than this.
+(define-constant *min-chunk-size* 8192)
+
+;;;
+;;; Worker pool
+;;;
+
+;; The pool is started by the first parallel operation, with one thread
+;; less than the available processors, for the calling thread works too.
+;; Tasks are (job . thunk), kept in a list protected by *pool-lock*.
+;; A thread waiting for its job keeps taking tasks from the queue,
+;; so a parallel operation called within a task (e.g. from the procedure
+;; given to parallel-uvector-map!) doesn't deadlock.
+
+(define-record-type <job> make-job #f
+  (remaining job-remaining job-remaining-set!)
+  (error     job-error     job-error-set!)
+  (lock      job-lock)
+  (cv        job-cv))
+
+(define *pool-lock* (make-mutex))
+(define *pool-cv*   (make-condition-variable))
+(define *tasks*     '())
+(define *nworkers*  #f)                 ;#f until the pool is started
+
+;; Returns the number of worker threads, not counting the caller.
+(define (parallel-uvector-workers)
+  (or *nworkers*
+      (if (eq? (gauche-thread-type) 'none)
+        0
+        (max 0 (- (sys-available-processors) 1)))))
+
+(define (ensure-pool!)
+  (unless *nworkers*
+    (with-locking-mutex *pool-lock*
+      (^[]
+        (unless *nworkers*
+          (let1 n (parallel-uvector-workers)
+            (dotimes [i n]
+              (thread-start! (make-thread worker-loop #"uvector-worker-~i")))
+            (set! *nworkers* n)))))))
+
+(define (take-task!)
+  (with-locking-mutex *pool-lock*
+    (^[] (and (pair? *tasks*) (pop! *tasks*)))))
+
+(define (worker-loop)
+  (let loop ()
+    (mutex-lock! *pool-lock*)
+    (if (null? *tasks*)
+      (mutex-unlock! *pool-lock* *pool-cv*)
+      (let1 task (pop! *tasks*)
+        (mutex-unlock! *pool-lock*)
+        (run-task task)))
+    (loop)))
+
+(define (run-task task)
+  (let1 job (car task)
+    (guard (e [else (unless (job-error job) (job-error-set! job e))])
+      ((cdr task)))
+    (with-locking-mutex (job-lock job)
+      (^[]
+        (job-remaining-set! job (- (job-remaining job) 1))
+        (when (zero? (job-remaining job))
+          (condition-variable-broadcast! (job-cv job)))))))
+
+;; Wait until JOB is done, or woken up by a task completion.
+(define (wait-job job)
+  (mutex-lock! (job-lock job))
+  (if (zero? (job-remaining job))
+    (mutex-unlock! (job-lock job))
+    (mutex-unlock! (job-lock job) (job-cv job))))
+
+;; Run THUNKS in the pool and wait for all of them.  An error in any
+;; of them is reraised after all are done.
+(define (run-parallel thunks)
+  (ensure-pool!)
+  (let1 job (make-job (length thunks) #f (make-mutex) (make-condition-variable))
+    (with-locking-mutex *pool-lock*
+      (^[]
+        ;; Newer jobs go first, so that nested jobs finish promptly.
+        (set! *tasks* (fold-right (^[t ts] (acons job t ts)) *tasks* thunks))
+        (condition-variable-broadcast! *pool-cv*)))
+    (let loop ()
+      (unless (zero? (with-locking-mutex (job-lock job)
+                       (^[] (job-remaining job))))
+        (if-let1 task (take-task!)
+          (run-task task)
+          (wait-job job))
+        (loop)))
+    (when (job-error job) (raise (job-error job)))))
+
+;; Call (PROC start end) on subranges of [0, N), concurrently if N is
+;; large enough, and returns a list of the results in order.  WEIGHT is
+;; the cost of each index relative to an elementwise operation.
+(define (map-ranges proc n :optional (weight 1))
+  (let* ([nthreads (+ (parallel-uvector-workers) 1)]
+         [work (* n weight)]
+         [nchunks (if (or (= nthreads 1) (< work (parallel-uvector-threshold)))
+                    1
+                    (min (* nthreads 2) n (quotient work *min-chunk-size*)))])
+    (if (<= nchunks 1)
+      (list (proc 0 n))
+      (let* ([bounds (map (^i (quotient (* i n) nchunks)) (iota (+ nchunks 1)))]
+             [results (make-vector nchunks #f)])
+        (run-parallel (map (^[k s e] (^[] (vector-set! results k (proc s e))))
+                           (iota nchunks) bounds (cdr bounds)))
+        (vector->list results)))))
+
+;;;
+;;; Kernels
+;;;
+
+;; Class -> alist of sequential kernels.  Some are missing on some
+;; element types, e.g. div on integral vectors or clamp on complex ones.
+(define *kernels*
+  (rlet1 tab (make-hash-table 'eq?)
+    (let1 mod (find-module 'gauche.uvector)
+      (dolist [tag '(s8 u8 s16 u16 s32 u32 s64 u64 f16 f32 f64 c32 c64 c128)]
+        (hash-table-put! tab
+                         (global-variable-ref mod (symbol-append '< tag 'vector>))
+                         (filter-map
+                          (^[op]
+                            (and-let1 p (global-variable-ref
+                                         mod (symbol-append tag 'vector- op) #f)
+                              (cons op p)))
+                          '(add! sub! mul! div! clamp! dot map!)))))))
+
+(define (kernel v op)
+  (or (and-let* ([ops (hash-table-get *kernels* (class-of v) #f)])
+        (assq-ref ops op))
+      (errorf "~a isn't supported on ~s" op (class-of v))))
+
+(define (slice v s e) (uvector-alias (class-of v) v s e))
+
+;; An argument we can pass along with a slice of V: a uvector of the
+;; same length is sliced in the same way, and a scalar or a clamp mode
+;; is passed as is.  Vectors and lists make us fall back to sequential
+;; operation, as does a length mismatch, for the kernel to report it.
+(define (splittable? x n)
+  (cond [(uvector? x) (= (uvector-length x) n)]
+        [(or (vector? x) (pair? x)) #f]
+        [else #t]))
+
+(define (slice-arg x s e) (if (uvector? x) (slice x s e) x))
+
+(define (elementwise! op v args)
+  (let ([k (kernel v op)]
+        [n (uvector-length v)])
+    (if (every (cut splittable? <> n) args)
+      (map-ranges (^[s e] (apply k (slice v s e) (map (cut slice-arg <> s e) args)))
+                  n)
+      (apply k v args))
+    v))
+
+;;;
+;;; API
+;;;
+
+(define (parallel-uvector-add! v0 v1 :optional (clamp #f))
+  (elementwise! 'add! v0 (list v1 clamp)))
+(define (parallel-uvector-sub! v0 v1 :optional (clamp #f))
+  (elementwise! 'sub! v0 (list v1 clamp)))
+(define (parallel-uvector-mul! v0 v1 :optional (clamp #f))
+  (elementwise! 'mul! v0 (list v1 clamp)))
+(define (parallel-uvector-div! v0 v1 :optional (clamp #f))
+  (elementwise! 'div! v0 (list v1 clamp)))
+(define (parallel-uvector-clamp! v min max)
+  (elementwise! 'clamp! v (list min max)))
+
+(define (parallel-uvector-add v0 v1 :optional (clamp #f))
+  (parallel-uvector-add! (uvector-copy v0) v1 clamp))
+(define (parallel-uvector-sub v0 v1 :optional (clamp #f))
+  (parallel-uvector-sub! (uvector-copy v0) v1 clamp))
+(define (parallel-uvector-mul v0 v1 :optional (clamp #f))
+  (parallel-uvector-mul! (uvector-copy v0) v1 clamp))
+(define (parallel-uvector-div v0 v1 :optional (clamp #f))
+  (parallel-uvector-div! (uvector-copy v0) v1 clamp))
+(define (parallel-uvector-clamp v min max)
+  (parallel-uvector-clamp! (uvector-copy v) min max))
+
+(define (parallel-uvector-dot v0 v1)
+  (let ([k (kernel v0 'dot)]
+        [n (uvector-length v0)])
+    (if (and (uvector? v1) (= (uvector-length v1) n))
+      (apply + (map-ranges (^[s e] (k (slice v0 s e) (slice v1 s e))) n))
+      (k v0 v1))))
+
+(define (parallel-uvector-sum v)
+  (assume-type v <uvector>)
+  (apply + (map-ranges (^[s e] (%uvector-reduce v 'sum s e))
+                       (uvector-length v))))
+
+(define (parallel-uvector-min v)
+  (assume-type v <uvector>)
+  (apply min (map-ranges (^[s e] (%uvector-reduce v 'min s e))
+                         (uvector-length v))))
+
+(define (parallel-uvector-max v)
+  (assume-type v <uvector>)
+  (apply max (map-ranges (^[s e] (%uvector-reduce v 'max s e))
+                         (uvector-length v))))
+
+;; OP is either a symbol naming one of the built-in flonum functions,
+;; which runs entirely in C, or a procedure applied to each element.
+(define (parallel-uvector-map! op v)
+  (assume-type v <uvector>)
+  (if (symbol? op)
+    (map-ranges (^[s e] (%uvector-math! v op s e)) (uvector-length v))
+    (let1 k (kernel v 'map!)
+      (map-ranges (^[s e] (k op (slice v s e))) (uvector-length v))))
+  v)
+
+;; Rows of the result are computed concurrently when both A and B are
+;; f32 or f64 arrays of the same class; otherwise it's just array-mul.
+(define (parallel-array-mul a b)
+  (%array-mul #f a b
+              (^[proc nrows]
+                (map-ranges proc nrows
+                            (* (array-length a 1) (array-length b 1))))))
@@ -210,4 +210,42 @@ enum {
 };
 
 
+/*
+ * 'op' arguments for Scm_UVectorReduce and Scm_UVectorMathX.
+ */
+
+enum {
+    UVECTOR_REDUCE_SUM,
+    UVECTOR_REDUCE_MIN,
+    UVECTOR_REDUCE_MAX
+};
+
+enum {
+    UVECTOR_MATH_ABS,
+    UVECTOR_MATH_NEG,
+    UVECTOR_MATH_SQUARE,
+    UVECTOR_MATH_SQRT,
+    UVECTOR_MATH_EXP,
+    UVECTOR_MATH_LOG,
+    UVECTOR_MATH_SIN,
+    UVECTOR_MATH_COS,
+    UVECTOR_MATH_TAN,
+    UVECTOR_MATH_FLOOR,
+    UVECTOR_MATH_CEILING,
+    UVECTOR_MATH_ROUND,
+    UVECTOR_MATH_TRUNCATE
+};
+
+/*
+ * 'op' argument for Scm_UVectorAtomicOp.
+ */
+
+enum {
+    UVECTOR_ATOMIC_REF,
+    UVECTOR_ATOMIC_SET,
+    UVECTOR_ATOMIC_ADD,         /* fetch and add */
+    UVECTOR_ATOMIC_CAS          /* compare and swap */
+};
+
+
 #endif /* GAUCHE_UVECTOR_P_H */
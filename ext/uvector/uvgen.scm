@@ -314,20 +314,23 @@
 ;;
 
 (define (generate-numop)
-  (for-each (^[opname Opname Sopname]
+  (for-each (^[opname Opname Sopname OPNAME]
               (dolist [rule (make-rules)]
                 (for-each (cute substitute <> `((opname  ,opname)
                                                 (Opname  ,Opname)
                                                 (Sopname ,Sopname)
+                                                (OPNAME  ,OPNAME)
                                                 ,@rule))
                           *tmpl-numop*)))
             '("add" "sub" "mul")
             '("Add" "Sub" "Mul")
-            '("Add" "Sub" "Mul"))
+            '("Add" "Sub" "Mul")
+            '("ADD" "SUB" "MUL"))
   (dolist [rule (append (make-flonum-rules) (make-complex-rules))]
     (for-each (cute substitute <> `((opname  "div")
                                     (Opname  "Div")
                                     (Sopname  "Div")
+                                    (OPNAME  "DIV")
                                     ,@rule))
               *tmpl-numop*)))
 
@@ -385,18 +388,29 @@
         (case tag
           [(s64 u64) #"INT64LT(~|a|, ~|b|)"]
           [else      #"(~a < ~b)"]))
+      ;; With constant limits, clamp can use a vectorized kernel.
+      (define (fastpath dst okval)
+        (tree->string
+         `("if (mintype == ARGTYPE_CONST && maxtype == ARGTYPE_CONST\n"
+           "        && uvk_clamp(SCM_UVECTOR_",TAG", ",dst", SCM_OBJ(x), size,\n"
+           "                     mindc, &minval, maxdc, &maxval)) {\n"
+           "        return ",okval";\n"
+           "    }")))
       (dolist [ops `(("range-check" "RangeCheck"
                       ""
                       "return Scm_MakeInteger(i)"
-                      "SCM_FALSE")
+                      "SCM_FALSE"
+                      "")
                      ("clamp" "Clamp"
                       "ScmObj d = Scm_UVectorCopy(SCM_UVECTOR(x), 0, -1)"
                       ,#"SCM_~|TAG|VECTOR_ELEMENTS(d)[i] = ~(cast \"val\")"
-                      "d")
+                      "d"
+                      ,(fastpath "d" "d"))
                      ("clamp!" "ClampX"
                       ""
                       ,#"SCM_~|TAG|VECTOR_ELEMENTS(x)[i] = ~(cast \"val\")"
-                      "SCM_OBJ(x)")
+                      "SCM_OBJ(x)"
+                      ,(fastpath "SCM_OBJ(x)" "SCM_OBJ(x)"))
                      )]
         (for-each (cute substitute <> `((GETLIM  ,GETLIM)
                                         (LT  ,LT)
@@ -405,6 +419,7 @@
                                         (dstdecl  ,(ref ops 2))
                                         (action   ,(ref ops 3))
                                         (okval    ,(ref ops 4))
+                                        (fastpath ,(ref ops 5))
                                         ,@rule))
                   *tmpl-rangeop*)))))
 
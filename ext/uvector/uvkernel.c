@@ -0,0 +1,504 @@
+/*
+ * uvkernel.c - vectorized kernels of uvector arithmetic
+ *
+ *   Copyright (c) 2026  Shiro Kawai  <shiro@acm.org>
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *   3. Neither the name of the authors nor the names of its contributors
+ *      may be used to endorse or promote products derived from this
+ *      software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ *   TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* This file is included by uvector.c, once for the baseline instruction
+ * set, and once more for each extended instruction set we dispatch to at
+ * runtime.  The includer defines these macros:
+ *
+ *   UVK_SUFFIX  - appended to the name of every kernel and of the
+ *                 kernel table (e.g. generic, avx2).
+ *   UVK_ATTR    - function attributes, e.g. __attribute__((target("avx2"))).
+ *   UVK_VARIANT - the name of the variant as a C string.
+ *
+ * We don't write intrinsics.  Each kernel works on chunks of UVK_CHUNK
+ * elements with a fixed trip count, into a local buffer or into
+ * independent accumulator lanes, which are the forms the compiler
+ * vectorizes without alias checks or reassociation of flonum operations.
+ * The remainder of a range that is shorter than a chunk, and the chunks
+ * that would overflow, are left to the caller's scalar loop.
+ */
+
+#define UVK_NAME(name)      UVK_NAME1(name, UVK_SUFFIX)
+#define UVK_NAME1(name, s)  UVK_NAME2(name, s)
+#define UVK_NAME2(name, s)  name##_##s
+
+/*
+ * Element-wise add, sub, mul and div.
+ *
+ * A kernel stores the results of whole chunks to D, and returns the
+ * number of elements processed.  If CHECK is true, it stops before a
+ * chunk that contains a result out of the range of the element type, so
+ * that the caller raises an error or clamps one side.  If CHECK is
+ * false, results are saturated.
+ *
+ * STEP(x, y, r, ovf) computes r from x and y, and sets ovf to nonzero
+ * if the result is saturated.
+ */
+
+#define UVK_BINOP(name, etype, STEP)                                    \
+    static UVK_ATTR ScmSmallInt UVK_NAME(name##_vv)(void *dd,           \
+                                                    const void *xx,     \
+                                                    const void *yy,     \
+                                                    ScmSmallInt n,      \
+                                                    int check)          \
+    {                                                                   \
+        etype *d = (etype*)dd;                                          \
+        const etype *x = (const etype*)xx, *y = (const etype*)yy;       \
+        ScmSmallInt i;                                                  \
+        for (i = 0; i + UVK_CHUNK <= n; i += UVK_CHUNK) {               \
+            etype t[UVK_CHUNK];                                         \
+            int ovf = 0;                                                \
+            for (int j = 0; j < UVK_CHUNK; j++) {                       \
+                STEP(x[i+j], y[i+j], t[j], ovf);                        \
+            }                                                           \
+            if (ovf && check) break;                                    \
+            memcpy(d+i, t, sizeof(t));                                  \
+        }                                                               \
+        return i;                                                       \
+    }                                                                   \
+    static UVK_ATTR ScmSmallInt UVK_NAME(name##_vs)(void *dd,           \
+                                                    const void *xx,     \
+                                                    const void *yy,     \
+                                                    ScmSmallInt n,      \
+                                                    int check)          \
+    {                                                                   \
+        etype *d = (etype*)dd;                                          \
+        const etype *x = (const etype*)xx, y = *(const etype*)yy;       \
+        ScmSmallInt i;                                                  \
+        for (i = 0; i + UVK_CHUNK <= n; i += UVK_CHUNK) {               \
+            etype t[UVK_CHUNK];                                         \
+            int ovf = 0;                                                \
+            for (int j = 0; j < UVK_CHUNK; j++) {                       \
+                STEP(x[i+j], y, t[j], ovf);                             \
+            }                                                           \
+            if (ovf && check) break;                                    \
+            memcpy(d+i, t, sizeof(t));                                  \
+        }                                                               \
+        return i;                                                       \
+    }
+
+/* Operation in a wider type WTYPE, saturated to [LO, HI]. */
+#define UVK_SAT(wtype, op, lo, hi, x, y, r, ovf)                        \
+    do {                                                                \
+        wtype w_ = (wtype)(x) op (wtype)(y);                            \
+        ovf |= (w_ < (lo)) | (w_ > (hi));                               \
+        r = (w_ < (lo))? (lo) : (w_ > (hi))? (hi) : w_;                 \
+    } while (0)
+
+/* Same as UVK_SAT, but WTYPE is unsigned and only overflows upward. */
+#define UVK_SATU(wtype, op, hi, x, y, r, ovf)                           \
+    do {                                                                \
+        wtype w_ = (wtype)(x) op (wtype)(y);                            \
+        ovf |= (w_ > (hi));                                             \
+        r = (w_ > (hi))? (hi) : w_;                                     \
+    } while (0)
+
+#define UVK_S8_ADD(x, y, r, o)   UVK_SAT(int, +, -128, 127, x, y, r, o)
+#define UVK_S8_SUB(x, y, r, o)   UVK_SAT(int, -, -128, 127, x, y, r, o)
+#define UVK_S8_MUL(x, y, r, o)   UVK_SAT(int, *, -128, 127, x, y, r, o)
+#define UVK_U8_ADD(x, y, r, o)   UVK_SAT(int, +, 0, 255, x, y, r, o)
+#define UVK_U8_SUB(x, y, r, o)   UVK_SAT(int, -, 0, 255, x, y, r, o)
+#define UVK_U8_MUL(x, y, r, o)   UVK_SAT(int, *, 0, 255, x, y, r, o)
+#define UVK_S16_ADD(x, y, r, o)  UVK_SAT(int, +, -32768, 32767, x, y, r, o)
+#define UVK_S16_SUB(x, y, r, o)  UVK_SAT(int, -, -32768, 32767, x, y, r, o)
+#define UVK_S16_MUL(x, y, r, o)  UVK_SAT(int, *, -32768, 32767, x, y, r, o)
+#define UVK_U16_ADD(x, y, r, o)  UVK_SAT(int, +, 0, 65535, x, y, r, o)
+#define UVK_U16_SUB(x, y, r, o)  UVK_SAT(int, -, 0, 65535, x, y, r, o)
+#define UVK_U16_MUL(x, y, r, o)  UVK_SATU(uint32_t, *, 65535, x, y, r, o)
+#define UVK_S32_ADD(x, y, r, o)  UVK_SAT(int64_t, +, INT32_MIN, INT32_MAX, x, y, r, o)
+#define UVK_S32_SUB(x, y, r, o)  UVK_SAT(int64_t, -, INT32_MIN, INT32_MAX, x, y, r, o)
+#define UVK_S32_MUL(x, y, r, o)  UVK_SAT(int64_t, *, INT32_MIN, INT32_MAX, x, y, r, o)
+#define UVK_U32_ADD(x, y, r, o)  UVK_SATU(uint64_t, +, UINT32_MAX, x, y, r, o)
+#define UVK_U32_SUB(x, y, r, o)  UVK_SAT(int64_t, -, 0, UINT32_MAX, x, y, r, o)
+#define UVK_U32_MUL(x, y, r, o)  UVK_SATU(uint64_t, *, UINT32_MAX, x, y, r, o)
+
+/* 64bit elements have no wider type to vectorize with; we detect
+   overflow by sign bits.  (Multiplication is left to the scalar loop.) */
+#define UVK_S64_ADD(x, y, r, o)                                         \
+    do {                                                                \
+        int64_t r_ = (int64_t)((uint64_t)(x) + (uint64_t)(y));          \
+        int v_ = (((x) ^ r_) & ((y) ^ r_)) < 0;                         \
+        o |= v_;                                                        \
+        r = v_? (((x) < 0)? INT64_MIN : INT64_MAX) : r_;                \
+    } while (0)
+#define UVK_S64_SUB(x, y, r, o)                                         \
+    do {                                                                \
+        int64_t r_ = (int64_t)((uint64_t)(x) - (uint64_t)(y));          \
+        int v_ = (((x) ^ (y)) & ((x) ^ r_)) < 0;                        \
+        o |= v_;                                                        \
+        r = v_? (((x) < 0)? INT64_MIN : INT64_MAX) : r_;                \
+    } while (0)
+#define UVK_U64_ADD(x, y, r, o)                                         \
+    do {                                                                \
+        uint64_t r_ = (x) + (y);                                        \
+        int v_ = r_ < (x);                                              \
+        o |= v_;                                                        \
+        r = v_? UINT64_MAX : r_;                                        \
+    } while (0)
+#define UVK_U64_SUB(x, y, r, o)                                         \
+    do {                                                                \
+        int v_ = (x) < (y);                                             \
+        o |= v_;                                                        \
+        r = v_? 0 : (x) - (y);                                          \
+    } while (0)
+
+#define UVK_F_ADD(x, y, r, o)  (r = (x) + (y))
+#define UVK_F_SUB(x, y, r, o)  (r = (x) - (y))
+#define UVK_F_MUL(x, y, r, o)  (r = (x) * (y))
+#define UVK_F_DIV(x, y, r, o)  (r = (x) / (y))
+
+UVK_BINOP(uvk_s8_add,  int8_t,   UVK_S8_ADD)
+UVK_BINOP(uvk_s8_sub,  int8_t,   UVK_S8_SUB)
+UVK_BINOP(uvk_s8_mul,  int8_t,   UVK_S8_MUL)
+UVK_BINOP(uvk_u8_add,  uint8_t,  UVK_U8_ADD)
+UVK_BINOP(uvk_u8_sub,  uint8_t,  UVK_U8_SUB)
+UVK_BINOP(uvk_u8_mul,  uint8_t,  UVK_U8_MUL)
+UVK_BINOP(uvk_s16_add, int16_t,  UVK_S16_ADD)
+UVK_BINOP(uvk_s16_sub, int16_t,  UVK_S16_SUB)
+UVK_BINOP(uvk_s16_mul, int16_t,  UVK_S16_MUL)
+UVK_BINOP(uvk_u16_add, uint16_t, UVK_U16_ADD)
+UVK_BINOP(uvk_u16_sub, uint16_t, UVK_U16_SUB)
+UVK_BINOP(uvk_u16_mul, uint16_t, UVK_U16_MUL)
+UVK_BINOP(uvk_s32_add, int32_t,  UVK_S32_ADD)
+UVK_BINOP(uvk_s32_sub, int32_t,  UVK_S32_SUB)
+UVK_BINOP(uvk_s32_mul, int32_t,  UVK_S32_MUL)
+UVK_BINOP(uvk_u32_add, uint32_t, UVK_U32_ADD)
+UVK_BINOP(uvk_u32_sub, uint32_t, UVK_U32_SUB)
+UVK_BINOP(uvk_u32_mul, uint32_t, UVK_U32_MUL)
+UVK_BINOP(uvk_s64_add, int64_t,  UVK_S64_ADD)
+UVK_BINOP(uvk_s64_sub, int64_t,  UVK_S64_SUB)
+UVK_BINOP(uvk_u64_add, uint64_t, UVK_U64_ADD)
+UVK_BINOP(uvk_u64_sub, uint64_t, UVK_U64_SUB)
+UVK_BINOP(uvk_f32_add, float,    UVK_F_ADD)
+UVK_BINOP(uvk_f32_sub, float,    UVK_F_SUB)
+UVK_BINOP(uvk_f32_mul, float,    UVK_F_MUL)
+UVK_BINOP(uvk_f32_div, float,    UVK_F_DIV)
+UVK_BINOP(uvk_f64_add, double,   UVK_F_ADD)
+UVK_BINOP(uvk_f64_sub, double,   UVK_F_SUB)
+UVK_BINOP(uvk_f64_mul, double,   UVK_F_MUL)
+UVK_BINOP(uvk_f64_div, double,   UVK_F_DIV)
+
+/*
+ * Reductions: sum, min, max and dot product.  They cover the whole
+ * range.  Integer sums are exact as long as the caller keeps N below
+ * 2^30.  Flonum sums are accumulated in UVK_LANES independent lanes;
+ * the order of additions differs from the sequential loop.
+ */
+
+/* ACCTYPE must hold the sum of a chunk. */
+#define UVK_ISUM(name, etype, acctype)                                  \
+    static UVK_ATTR int64_t UVK_NAME(name)(const void *xx, ScmSmallInt n) \
+    {                                                                   \
+        const etype *x = (const etype*)xx;                              \
+        int64_t sum = 0;                                                \
+        ScmSmallInt i;                                                  \
+        for (i = 0; i + UVK_CHUNK <= n; i += UVK_CHUNK) {               \
+            acctype acc = 0;                                            \
+            for (int j = 0; j < UVK_CHUNK; j++) acc += x[i+j];          \
+            sum += acc;                                                 \
+        }                                                               \
+        for (; i < n; i++) sum += x[i];                                 \
+        return sum;                                                     \
+    }
+
+/* PTYPE must hold a product, and ACCTYPE the sum of products of
+   a chunk. */
+#define UVK_IDOT(name, etype, ptype, acctype)                           \
+    static UVK_ATTR int64_t UVK_NAME(name)(const void *xx,              \
+                                           const void *yy,              \
+                                           ScmSmallInt n)               \
+    {                                                                   \
+        const etype *x = (const etype*)xx, *y = (const etype*)yy;       \
+        int64_t sum = 0;                                                \
+        ScmSmallInt i;                                                  \
+        for (i = 0; i + UVK_CHUNK <= n; i += UVK_CHUNK) {               \
+            acctype acc = 0;                                            \
+            for (int j = 0; j < UVK_CHUNK; j++) {                       \
+                acc += (acctype)((ptype)x[i+j] * (ptype)y[i+j]);        \
+            }                                                           \
+            sum += acc;                                                 \
+        }                                                               \
+        for (; i < n; i++) sum += (int64_t)x[i] * (int64_t)y[i];        \
+        return sum;                                                     \
+    }
+
+#define UVK_FSUM(name, etype)                                           \
+    static UVK_ATTR double UVK_NAME(name)(const void *xx, ScmSmallInt n) \
+    {                                                                   \
+        const etype *x = (const etype*)xx;                              \
+        double acc[UVK_LANES] = {0.0};                                  \
+        ScmSmallInt i;                                                  \
+        for (i = 0; i + UVK_CHUNK <= n; i += UVK_CHUNK) {               \
+            for (int j = 0; j < UVK_CHUNK; j += UVK_LANES) {            \
+                for (int k = 0; k < UVK_LANES; k++) {                   \
+                    acc[k] += (double)x[i+j+k];                         \
+                }                                                       \
+            }                                                           \
+        }                                                               \
+        double sum = 0.0;                                               \
+        for (int k = 0; k < UVK_LANES; k++) sum += acc[k];              \
+        for (; i < n; i++) sum += (double)x[i];                         \
+        return sum;                                                     \
+    }
+
+#define UVK_FDOT(name, etype)                                           \
+    static UVK_ATTR double UVK_NAME(name)(const void *xx,               \
+                                         const void *yy,                \
+                                         ScmSmallInt n)                 \
+    {                                                                   \
+        const etype *x = (const etype*)xx, *y = (const etype*)yy;       \
+        double acc[UVK_LANES] = {0.0};                                  \
+        ScmSmallInt i;                                                  \
+        for (i = 0; i + UVK_CHUNK <= n; i += UVK_CHUNK) {               \
+            for (int j = 0; j < UVK_CHUNK; j += UVK_LANES) {            \
+                for (int k = 0; k < UVK_LANES; k++) {                   \
+                    acc[k] += (double)x[i+j+k] * (double)y[i+j+k];      \
+                }                                                       \
+            }                                                           \
+        }                                                               \
+        double sum = 0.0;                                               \
+        for (int k = 0; k < UVK_LANES; k++) sum += acc[k];              \
+        for (; i < n; i++) sum += (double)x[i] * (double)y[i];          \
+        return sum;                                                     \
+    }
+
+/* CMP is < for min and > for max.  N must be positive.  The result
+   is stored in *R as etype. */
+#define UVK_IMINMAX(name, etype, CMP)                                   \
+    static UVK_ATTR void UVK_NAME(name)(const void *xx, ScmSmallInt n,  \
+                                        void *r)                        \
+    {                                                                   \
+        const etype *x = (const etype*)xx;                              \
+        etype m = x[0];                                                 \
+        ScmSmallInt i;                                                  \
+        for (i = 0; i + UVK_CHUNK <= n; i += UVK_CHUNK) {               \
+            for (int j = 0; j < UVK_CHUNK; j++) {                       \
+                m = (x[i+j] CMP m)? x[i+j] : m;                         \
+            }                                                           \
+        }                                                               \
+        for (; i < n; i++) m = (x[i] CMP m)? x[i] : m;                  \
+        *(etype*)r = m;                                                 \
+    }
+
+/* Like UVK_IMINMAX, but NaN is contagious; the result is the first
+   NaN if there's any. */
+#define UVK_FMINMAX(name, etype, CMP)                                   \
+    static UVK_ATTR void UVK_NAME(name)(const void *xx, ScmSmallInt n,  \
+                                        void *r)                        \
+    {                                                                   \
+        const etype *x = (const etype*)xx;                              \
+        etype m[UVK_LANES];                                             \
+        ScmSmallInt i;                                                  \
+        for (int k = 0; k < UVK_LANES; k++) m[k] = x[0];                \
+        for (i = 0; i + UVK_CHUNK <= n; i += UVK_CHUNK) {               \
+            int nan = 0;                                                \
+            for (int j = 0; j < UVK_CHUNK; j += UVK_LANES) {            \
+                for (int k = 0; k < UVK_LANES; k++) {                   \
+                    etype v = x[i+j+k];                                 \
+                    nan |= (v != v);                                    \
+                    m[k] = (v CMP m[k])? v : m[k];                      \
+                }                                                       \
+            }                                                           \
+            if (nan) break;                                             \
+        }                                                               \
+        etype mm = m[0];                                                \
+        for (int k = 1; k < UVK_LANES; k++) mm = (m[k] CMP mm)? m[k] : mm; \
+        for (; i < n; i++) {                                            \
+            if (x[i] != x[i]) { mm = x[i]; break; }                     \
+            mm = (x[i] CMP mm)? x[i] : mm;                              \
+        }                                                               \
+        /* The scalar loop returns the first of the equal elements.     \
+           It only matters for zeros, whose signs may differ. */        \
+        if (mm == 0) {                                                  \
+            for (i = 0; x[i] != 0; i++) ;                               \
+            mm = x[i];                                                  \
+        }                                                               \
+        *(etype*)r = mm;                                                \
+    }
+
+UVK_ISUM(uvk_s8_sum,  int8_t,   int32_t)
+UVK_ISUM(uvk_u8_sum,  uint8_t,  int32_t)
+UVK_ISUM(uvk_s16_sum, int16_t,  int32_t)
+UVK_ISUM(uvk_u16_sum, uint16_t, int32_t)
+UVK_ISUM(uvk_s32_sum, int32_t,  int64_t)
+UVK_ISUM(uvk_u32_sum, uint32_t, int64_t)
+UVK_FSUM(uvk_f32_sum, float)
+UVK_FSUM(uvk_f64_sum, double)
+
+UVK_IDOT(uvk_s8_dot,  int8_t,   int32_t,  int32_t)
+UVK_IDOT(uvk_u8_dot,  uint8_t,  int32_t,  int32_t)
+UVK_IDOT(uvk_s16_dot, int16_t,  int32_t,  int64_t)
+UVK_IDOT(uvk_u16_dot, uint16_t, uint32_t, int64_t)
+UVK_FDOT(uvk_f32_dot, float)
+UVK_FDOT(uvk_f64_dot, double)
+
+UVK_IMINMAX(uvk_s8_min,  int8_t,   <)
+UVK_IMINMAX(uvk_s8_max,  int8_t,   >)
+UVK_IMINMAX(uvk_u8_min,  uint8_t,  <)
+UVK_IMINMAX(uvk_u8_max,  uint8_t,  >)
+UVK_IMINMAX(uvk_s16_min, int16_t,  <)
+UVK_IMINMAX(uvk_s16_max, int16_t,  >)
+UVK_IMINMAX(uvk_u16_min, uint16_t, <)
+UVK_IMINMAX(uvk_u16_max, uint16_t, >)
+UVK_IMINMAX(uvk_s32_min, int32_t,  <)
+UVK_IMINMAX(uvk_s32_max, int32_t,  >)
+UVK_IMINMAX(uvk_u32_min, uint32_t, <)
+UVK_IMINMAX(uvk_u32_max, uint32_t, >)
+UVK_IMINMAX(uvk_s64_min, int64_t,  <)
+UVK_IMINMAX(uvk_s64_max, int64_t,  >)
+UVK_IMINMAX(uvk_u64_min, uint64_t, <)
+UVK_IMINMAX(uvk_u64_max, uint64_t, >)
+UVK_FMINMAX(uvk_f32_min, float,    <)
+UVK_FMINMAX(uvk_f32_max, float,    >)
+UVK_FMINMAX(uvk_f64_min, double,   <)
+UVK_FMINMAX(uvk_f64_max, double,   >)
+
+/*
+ * Clamp.  *LO and *HI are etype; the caller passes the limits of the
+ * type (or infinities) for the "don't care" side.  As the scalar loop,
+ * a NaN element or limit is left as is.
+ */
+#define UVK_CLAMP(name, etype)                                          \
+    static UVK_ATTR void UVK_NAME(name)(void *dd, const void *xx,       \
+                                        ScmSmallInt n,                  \
+                                        const void *lo, const void *hi) \
+    {                                                                   \
+        etype *d = (etype*)dd;                                          \
+        const etype *x = (const etype*)xx;                              \
+        const etype l = *(const etype*)lo, h = *(const etype*)hi;       \
+        ScmSmallInt i;                                                  \
+        for (i = 0; i + UVK_CHUNK <= n; i += UVK_CHUNK) {               \
+            etype t[UVK_CHUNK];                                         \
+            for (int j = 0; j < UVK_CHUNK; j++) {                       \
+                etype v = x[i+j];                                       \
+                v = (v < l)? l : v;                                     \
+                t[j] = (h < v)? h : v;                                  \
+            }                                                           \
+            memcpy(d+i, t, sizeof(t));                                  \
+        }                                                               \
+        for (; i < n; i++) {                                            \
+            etype v = x[i];                                             \
+            v = (v < l)? l : v;                                         \
+            d[i] = (h < v)? h : v;                                      \
+        }                                                               \
+    }
+
+UVK_CLAMP(uvk_s8_clamp,  int8_t)
+UVK_CLAMP(uvk_u8_clamp,  uint8_t)
+UVK_CLAMP(uvk_s16_clamp, int16_t)
+UVK_CLAMP(uvk_u16_clamp, uint16_t)
+UVK_CLAMP(uvk_s32_clamp, int32_t)
+UVK_CLAMP(uvk_u32_clamp, uint32_t)
+UVK_CLAMP(uvk_s64_clamp, int64_t)
+UVK_CLAMP(uvk_u64_clamp, uint64_t)
+UVK_CLAMP(uvk_f32_clamp, float)
+UVK_CLAMP(uvk_f64_clamp, double)
+
+/*
+ * The kernel table of this variant.
+ */
+#define UVK_BINOPS3(t) \
+    {{UVK_NAME(uvk_##t##_add_vv), UVK_NAME(uvk_##t##_add_vs)},  \
+     {UVK_NAME(uvk_##t##_sub_vv), UVK_NAME(uvk_##t##_sub_vs)},  \
+     {UVK_NAME(uvk_##t##_mul_vv), UVK_NAME(uvk_##t##_mul_vs)}}
+#define UVK_BINOPS2(t) \
+    {{UVK_NAME(uvk_##t##_add_vv), UVK_NAME(uvk_##t##_add_vs)},  \
+     {UVK_NAME(uvk_##t##_sub_vv), UVK_NAME(uvk_##t##_sub_vs)}}
+#define UVK_BINOPS4(t) \
+    {{UVK_NAME(uvk_##t##_add_vv), UVK_NAME(uvk_##t##_add_vs)},  \
+     {UVK_NAME(uvk_##t##_sub_vv), UVK_NAME(uvk_##t##_sub_vs)},  \
+     {UVK_NAME(uvk_##t##_mul_vv), UVK_NAME(uvk_##t##_mul_vs)},  \
+     {UVK_NAME(uvk_##t##_div_vv), UVK_NAME(uvk_##t##_div_vs)}}
+#define UVK_MINMAX(t) {UVK_NAME(uvk_##t##_min), UVK_NAME(uvk_##t##_max)}
+
+static const UVKernels UVK_NAME(uvkernels) = {
+    UVK_VARIANT,
+    {   /* binop */
+        [SCM_UVECTOR_S8]  = UVK_BINOPS3(s8),
+        [SCM_UVECTOR_U8]  = UVK_BINOPS3(u8),
+        [SCM_UVECTOR_S16] = UVK_BINOPS3(s16),
+        [SCM_UVECTOR_U16] = UVK_BINOPS3(u16),
+        [SCM_UVECTOR_S32] = UVK_BINOPS3(s32),
+        [SCM_UVECTOR_U32] = UVK_BINOPS3(u32),
+        [SCM_UVECTOR_S64] = UVK_BINOPS2(s64),
+        [SCM_UVECTOR_U64] = UVK_BINOPS2(u64),
+        [SCM_UVECTOR_F32] = UVK_BINOPS4(f32),
+        [SCM_UVECTOR_F64] = UVK_BINOPS4(f64),
+    },
+    {   /* isum */
+        [SCM_UVECTOR_S8]  = UVK_NAME(uvk_s8_sum),
+        [SCM_UVECTOR_U8]  = UVK_NAME(uvk_u8_sum),
+        [SCM_UVECTOR_S16] = UVK_NAME(uvk_s16_sum),
+        [SCM_UVECTOR_U16] = UVK_NAME(uvk_u16_sum),
+        [SCM_UVECTOR_S32] = UVK_NAME(uvk_s32_sum),
+        [SCM_UVECTOR_U32] = UVK_NAME(uvk_u32_sum),
+    },
+    {   /* fsum */
+        [SCM_UVECTOR_F32] = UVK_NAME(uvk_f32_sum),
+        [SCM_UVECTOR_F64] = UVK_NAME(uvk_f64_sum),
+    },
+    {   /* idot */
+        [SCM_UVECTOR_S8]  = UVK_NAME(uvk_s8_dot),
+        [SCM_UVECTOR_U8]  = UVK_NAME(uvk_u8_dot),
+        [SCM_UVECTOR_S16] = UVK_NAME(uvk_s16_dot),
+        [SCM_UVECTOR_U16] = UVK_NAME(uvk_u16_dot),
+    },
+    {   /* fdot */
+        [SCM_UVECTOR_F32] = UVK_NAME(uvk_f32_dot),
+        [SCM_UVECTOR_F64] = UVK_NAME(uvk_f64_dot),
+    },
+    {   /* minmax */
+        [SCM_UVECTOR_S8]  = UVK_MINMAX(s8),
+        [SCM_UVECTOR_U8]  = UVK_MINMAX(u8),
+        [SCM_UVECTOR_S16] = UVK_MINMAX(s16),
+        [SCM_UVECTOR_U16] = UVK_MINMAX(u16),
+        [SCM_UVECTOR_S32] = UVK_MINMAX(s32),
+        [SCM_UVECTOR_U32] = UVK_MINMAX(u32),
+        [SCM_UVECTOR_S64] = UVK_MINMAX(s64),
+        [SCM_UVECTOR_U64] = UVK_MINMAX(u64),
+        [SCM_UVECTOR_F32] = UVK_MINMAX(f32),
+        [SCM_UVECTOR_F64] = UVK_MINMAX(f64),
+    },
+    {   /* clamp */
+        [SCM_UVECTOR_S8]  = UVK_NAME(uvk_s8_clamp),
+        [SCM_UVECTOR_U8]  = UVK_NAME(uvk_u8_clamp),
+        [SCM_UVECTOR_S16] = UVK_NAME(uvk_s16_clamp),
+        [SCM_UVECTOR_U16] = UVK_NAME(uvk_u16_clamp),
+        [SCM_UVECTOR_S32] = UVK_NAME(uvk_s32_clamp),
+        [SCM_UVECTOR_U32] = UVK_NAME(uvk_u32_clamp),
+        [SCM_UVECTOR_S64] = UVK_NAME(uvk_s64_clamp),
+        [SCM_UVECTOR_U64] = UVK_NAME(uvk_u64_clamp),
+        [SCM_UVECTOR_F32] = UVK_NAME(uvk_f32_clamp),
+        [SCM_UVECTOR_F64] = UVK_NAME(uvk_f64_clamp),
+    },
+};
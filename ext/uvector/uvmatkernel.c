@@ -0,0 +1,434 @@
+/*
+ * uvmatkernel.c - matrix kernels for f32 and f64 arrays
+ *
+ *   Copyright (c) 2026  Shiro Kawai  <shiro@acm.org>
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *   3. Neither the name of the authors nor the names of its contributors
+ *      may be used to endorse or promote products derived from this
+ *      software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ *   TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* This file is included by uvmatrix.c for each combination of the
+ * element type and the instruction set.  The includer defines these
+ * macros:
+ *
+ *   UVM_T       - the element type, double or float.
+ *   UVM_SUFFIX  - appended to the name of every function and of the
+ *                 kernel table (e.g. f64_generic).
+ *   UVM_ATTR    - function attributes, e.g. __attribute__((target("avx2"))).
+ *   UVM_MR, UVM_NR - the size of the register block of the multiplication
+ *                 micro kernel.  UVM_NR should be a multiple of the vector
+ *                 width.
+ *   UVM_DECOMPOSITION - defined to include the decompositions, which we
+ *                 only need in double precision.
+ *
+ * Everything is built on the blocked matrix multiplication, which packs
+ * blocks of the operands into contiguous panels so that the micro kernel
+ * reads them sequentially, and keeps an UVM_MR x UVM_NR block of the
+ * result in registers.  LU and Cholesky decompositions and the triangular
+ * solvers process UVM_NB columns at a time and do the rest of the work
+ * with the multiplication.
+ */
+
+/* Element (i, j) of matrix M */
+#define UVM_E(m, i, j)  (((UVM_T*)(m).p)[(i)*(m).rs + (j)*(m).cs])
+#define UVM_SUB(m, i, j) uvm_sub(m, i, j, sizeof(UVM_T))
+
+/* C[0:mr, 0:nr] += A * B, where A is a packed UVM_MR x KC panel and
+   B is a packed KC x UVM_NR panel. */
+static UVM_ATTR void UVM_NAME(uvm_micro)(ScmSmallInt kc,
+                                         const UVM_T *a, const UVM_T *b,
+                                         uvm_mat c, int mr, int nr)
+{
+    UVM_T acc[UVM_MR][UVM_NR];
+    for (int i = 0; i < UVM_MR; i++) {
+        for (int j = 0; j < UVM_NR; j++) acc[i][j] = 0;
+    }
+    for (ScmSmallInt k = 0; k < kc; k++) {
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC unroll 8
+#endif
+        for (int i = 0; i < UVM_MR; i++) {
+            UVM_T ai = a[k*UVM_MR + i];
+            for (int j = 0; j < UVM_NR; j++) acc[i][j] += ai * b[k*UVM_NR + j];
+        }
+    }
+    for (int i = 0; i < mr; i++) {
+        for (int j = 0; j < nr; j++) UVM_E(c, i, j) += acc[i][j];
+    }
+}
+
+/* C = A B if ZERO is true, or C += ALPHA A B otherwise, where A is M x K
+   and B is K x N.  C must not overlap A or B. */
+static UVM_ATTR void UVM_NAME(uvm_gemm)(ScmSmallInt m, ScmSmallInt n,
+                                        ScmSmallInt k, UVM_T alpha,
+                                        uvm_mat a, uvm_mat b,
+                                        int zero, uvm_mat c)
+{
+    if (zero) {
+        for (ScmSmallInt i = 0; i < m; i++) {
+            for (ScmSmallInt j = 0; j < n; j++) UVM_E(c, i, j) = 0;
+        }
+        alpha = 1;
+    }
+    if (m == 0 || n == 0 || k == 0) return;
+
+    ScmSmallInt kcmax = (k < UVM_KC)? k : UVM_KC;
+    ScmSmallInt mcmax = (m < UVM_MC)? m : UVM_MC;
+    ScmSmallInt ncmax = (n < UVM_NC)? n : UVM_NC;
+    mcmax = (mcmax + UVM_MR - 1) / UVM_MR * UVM_MR;
+    ncmax = (ncmax + UVM_NR - 1) / UVM_NR * UVM_NR;
+    UVM_T *ap = SCM_NEW_ATOMIC_ARRAY(UVM_T, mcmax*kcmax);
+    UVM_T *bp = SCM_NEW_ATOMIC_ARRAY(UVM_T, kcmax*ncmax);
+
+    for (ScmSmallInt jc = 0; jc < n; jc += UVM_NC) {
+        ScmSmallInt nc = (n - jc < UVM_NC)? n - jc : UVM_NC;
+        for (ScmSmallInt pc = 0; pc < k; pc += UVM_KC) {
+            ScmSmallInt kc = (k - pc < UVM_KC)? k - pc : UVM_KC;
+            /* Pack B[pc:pc+kc, jc:jc+nc] into panels of UVM_NR columns,
+               padding with zeros. */
+            for (ScmSmallInt j = 0; j < nc; j += UVM_NR) {
+                UVM_T *q = bp + j*kc;
+                int nr = (nc - j < UVM_NR)? (int)(nc - j) : UVM_NR;
+                for (ScmSmallInt p = 0; p < kc; p++) {
+                    for (int jj = 0; jj < nr; jj++) {
+                        q[p*UVM_NR + jj] = UVM_E(b, pc + p, jc + j + jj);
+                    }
+                    for (int jj = nr; jj < UVM_NR; jj++) q[p*UVM_NR + jj] = 0;
+                }
+            }
+            for (ScmSmallInt ic = 0; ic < m; ic += UVM_MC) {
+                ScmSmallInt mc = (m - ic < UVM_MC)? m - ic : UVM_MC;
+                /* Pack ALPHA * A[ic:ic+mc, pc:pc+kc] into panels of
+                   UVM_MR rows. */
+                for (ScmSmallInt i = 0; i < mc; i += UVM_MR) {
+                    UVM_T *q = ap + i*kc;
+                    int mr = (mc - i < UVM_MR)? (int)(mc - i) : UVM_MR;
+                    for (ScmSmallInt p = 0; p < kc; p++) {
+                        for (int ii = 0; ii < mr; ii++) {
+                            q[p*UVM_MR + ii] = alpha * UVM_E(a, ic + i + ii, pc + p);
+                        }
+                        for (int ii = mr; ii < UVM_MR; ii++) q[p*UVM_MR + ii] = 0;
+                    }
+                }
+                for (ScmSmallInt j = 0; j < nc; j += UVM_NR) {
+                    int nr = (nc - j < UVM_NR)? (int)(nc - j) : UVM_NR;
+                    for (ScmSmallInt i = 0; i < mc; i += UVM_MR) {
+                        int mr = (mc - i < UVM_MR)? (int)(mc - i) : UVM_MR;
+                        UVM_NAME(uvm_micro)(kc, ap + i*kc, bp + j*kc,
+                                            UVM_SUB(c, ic + i, jc + j),
+                                            mr, nr);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* Y += ALPHA X, for N elements with strides XS and YS. */
+static UVM_ATTR void UVM_NAME(uvm_axpy)(ScmSmallInt n, UVM_T alpha,
+                                        const UVM_T *x, ScmSmallInt xs,
+                                        UVM_T *y, ScmSmallInt ys)
+{
+    if (xs == 1 && ys == 1) {
+        for (ScmSmallInt i = 0; i < n; i++) y[i] += alpha * x[i];
+    } else {
+        for (ScmSmallInt i = 0; i < n; i++) y[i*ys] += alpha * x[i*xs];
+    }
+}
+
+/* Dot product of N elements with strides XS and YS. */
+static UVM_ATTR UVM_T UVM_NAME(uvm_dot)(ScmSmallInt n,
+                                        const UVM_T *x, ScmSmallInt xs,
+                                        const UVM_T *y, ScmSmallInt ys)
+{
+    UVM_T acc[UVM_LANES] = {0}, s = 0;
+    ScmSmallInt i = 0;
+    if (xs == 1 && ys == 1) {
+        for (; i + UVM_LANES <= n; i += UVM_LANES) {
+            for (int l = 0; l < UVM_LANES; l++) acc[l] += x[i+l] * y[i+l];
+        }
+        for (int l = 0; l < UVM_LANES; l++) s += acc[l];
+    }
+    for (; i < n; i++) s += x[i*xs] * y[i*ys];
+    return s;
+}
+
+/* D = S, both M x N.  Transposition is a copy from a view with swapped
+   strides; we go by tiles so that both sides stay in cache. */
+static UVM_ATTR void UVM_NAME(uvm_copy)(ScmSmallInt m, ScmSmallInt n,
+                                        uvm_mat d, uvm_mat s)
+{
+    for (ScmSmallInt i0 = 0; i0 < m; i0 += UVM_TILE) {
+        ScmSmallInt i1 = (m - i0 < UVM_TILE)? m : i0 + UVM_TILE;
+        for (ScmSmallInt j0 = 0; j0 < n; j0 += UVM_TILE) {
+            ScmSmallInt j1 = (n - j0 < UVM_TILE)? n : j0 + UVM_TILE;
+            for (ScmSmallInt i = i0; i < i1; i++) {
+                for (ScmSmallInt j = j0; j < j1; j++) {
+                    UVM_E(d, i, j) = UVM_E(s, i, j);
+                }
+            }
+        }
+    }
+}
+
+/* Y = A X, where A is M x N, and X and Y are contiguous. */
+static UVM_ATTR void UVM_NAME(uvm_gemv)(ScmSmallInt m, ScmSmallInt n,
+                                        uvm_mat a, const void *xx, void *yy)
+{
+    const UVM_T *x = (const UVM_T*)xx;
+    UVM_T *y = (UVM_T*)yy;
+    if (a.cs == 1) {
+        for (ScmSmallInt i = 0; i < m; i++) {
+            y[i] = UVM_NAME(uvm_dot)(n, &UVM_E(a, i, 0), 1, x, 1);
+        }
+    } else {
+        for (ScmSmallInt i = 0; i < m; i++) y[i] = 0;
+        for (ScmSmallInt j = 0; j < n; j++) {
+            UVM_NAME(uvm_axpy)(m, x[j], &UVM_E(a, 0, j), a.rs, y, 1);
+        }
+    }
+}
+
+#if defined(UVM_DECOMPOSITION)
+/* B = L^-1 B, where L is M x M unit lower triangular and B is M x N. */
+static UVM_ATTR void UVM_NAME(uvm_trsm_llu)(ScmSmallInt m, ScmSmallInt n,
+                                            uvm_mat l, uvm_mat b)
+{
+    for (ScmSmallInt i0 = 0; i0 < m; i0 += UVM_NB) {
+        ScmSmallInt i1 = (m - i0 < UVM_NB)? m : i0 + UVM_NB;
+        if (i0 > 0) {
+            UVM_NAME(uvm_gemm)(i1 - i0, n, i0, -1, UVM_SUB(l, i0, 0), b,
+                               FALSE, UVM_SUB(b, i0, 0));
+        }
+        for (ScmSmallInt i = i0; i < i1; i++) {
+            for (ScmSmallInt k = i0; k < i; k++) {
+                UVM_T f = UVM_E(l, i, k);
+                if (f != 0) {
+                    UVM_NAME(uvm_axpy)(n, -f, &UVM_E(b, k, 0), b.cs,
+                                       &UVM_E(b, i, 0), b.cs);
+                }
+            }
+        }
+    }
+}
+
+/* B = U^-1 B, where U is M x M upper triangular and B is M x N. */
+static UVM_ATTR void UVM_NAME(uvm_trsm_lun)(ScmSmallInt m, ScmSmallInt n,
+                                            uvm_mat u, uvm_mat b)
+{
+    for (ScmSmallInt i1 = m; i1 > 0; ) {
+        ScmSmallInt i0 = (i1 < UVM_NB)? 0 : i1 - UVM_NB;
+        if (i1 < m) {
+            UVM_NAME(uvm_gemm)(i1 - i0, n, m - i1, -1, UVM_SUB(u, i0, i1),
+                               UVM_SUB(b, i1, 0), FALSE, UVM_SUB(b, i0, 0));
+        }
+        for (ScmSmallInt i = i1 - 1; i >= i0; i--) {
+            for (ScmSmallInt k = i + 1; k < i1; k++) {
+                UVM_T f = UVM_E(u, i, k);
+                if (f != 0) {
+                    UVM_NAME(uvm_axpy)(n, -f, &UVM_E(b, k, 0), b.cs,
+                                       &UVM_E(b, i, 0), b.cs);
+                }
+            }
+            UVM_T d = UVM_E(u, i, i);
+            for (ScmSmallInt j = 0; j < n; j++) UVM_E(b, i, j) /= d;
+        }
+        i1 = i0;
+    }
+}
+
+/* LU decomposition of N x N matrix A with partial pivoting, in place.
+   Row k is swapped with row PIV[k] at the k-th step.  Returns the sign
+   of the permutation, or 0 if A is singular. */
+static UVM_ATTR int UVM_NAME(uvm_lu)(ScmSmallInt n, uvm_mat a, int32_t *piv)
+{
+    int sign = 1, singular = FALSE;
+
+    for (ScmSmallInt k0 = 0; k0 < n; k0 += UVM_NB) {
+        ScmSmallInt k1 = (n - k0 < UVM_NB)? n : k0 + UVM_NB;
+        /* Factorize the panel A[k0:n, k0:k1]. */
+        for (ScmSmallInt k = k0; k < k1; k++) {
+            ScmSmallInt p = k;
+            double pmax = fabs(UVM_E(a, k, k));
+            for (ScmSmallInt i = k + 1; i < n; i++) {
+                double v = fabs(UVM_E(a, i, k));
+                if (v > pmax) { pmax = v; p = i; }
+            }
+            piv[k] = (int32_t)k;
+            if (pmax == 0) { singular = TRUE; continue; }
+            if (p != k) {
+                for (ScmSmallInt j = 0; j < n; j++) {
+                    UVM_T t = UVM_E(a, k, j);
+                    UVM_E(a, k, j) = UVM_E(a, p, j);
+                    UVM_E(a, p, j) = t;
+                }
+                piv[k] = (int32_t)p;
+                sign = -sign;
+            }
+            UVM_T d = UVM_E(a, k, k);
+            for (ScmSmallInt i = k + 1; i < n; i++) {
+                UVM_T f = (UVM_E(a, i, k) /= d);
+                if (f != 0) {
+                    UVM_NAME(uvm_axpy)(k1 - k - 1, -f, &UVM_E(a, k, k+1), a.cs,
+                                       &UVM_E(a, i, k+1), a.cs);
+                }
+            }
+        }
+        if (k1 < n) {
+            /* U12 = L11^-1 A12, A22 -= L21 U12 */
+            UVM_NAME(uvm_trsm_llu)(k1 - k0, n - k1, UVM_SUB(a, k0, k0),
+                                   UVM_SUB(a, k0, k1));
+            UVM_NAME(uvm_gemm)(n - k1, n - k1, k1 - k0, -1,
+                               UVM_SUB(a, k1, k0), UVM_SUB(a, k0, k1),
+                               FALSE, UVM_SUB(a, k1, k1));
+        }
+    }
+    return singular? 0 : sign;
+}
+
+/* X = A^-1, given LU and PIV from uvm_lu of A.  X is N x N and distinct
+   from LU. */
+static UVM_ATTR void UVM_NAME(uvm_lu_inverse)(ScmSmallInt n, uvm_mat lu,
+                                              const int32_t *piv, uvm_mat x)
+{
+    for (ScmSmallInt i = 0; i < n; i++) {
+        for (ScmSmallInt j = 0; j < n; j++) UVM_E(x, i, j) = (i == j);
+    }
+    for (ScmSmallInt k = 0; k < n; k++) {
+        ScmSmallInt p = piv[k];
+        if (p == k) continue;
+        for (ScmSmallInt j = 0; j < n; j++) {
+            UVM_T t = UVM_E(x, k, j);
+            UVM_E(x, k, j) = UVM_E(x, p, j);
+            UVM_E(x, p, j) = t;
+        }
+    }
+    UVM_NAME(uvm_trsm_llu)(n, n, lu, x);
+    UVM_NAME(uvm_trsm_lun)(n, n, lu, x);
+}
+
+/* Cholesky decomposition of N x N symmetric positive definite matrix A,
+   in place.  Only the lower triangle of A is read; it receives L such
+   that A = L L^T, and the upper triangle is cleared.  Returns FALSE if
+   A isn't positive definite. */
+static UVM_ATTR int UVM_NAME(uvm_cholesky)(ScmSmallInt n, uvm_mat a)
+{
+    for (ScmSmallInt k0 = 0; k0 < n; k0 += UVM_NB) {
+        ScmSmallInt k1 = (n - k0 < UVM_NB)? n : k0 + UVM_NB;
+        /* The diagonal block; the columns before k0 are already
+           subtracted by the updates of the preceding steps. */
+        for (ScmSmallInt j = k0; j < k1; j++) {
+            UVM_T d = UVM_E(a, j, j)
+                - UVM_NAME(uvm_dot)(j - k0, &UVM_E(a, j, k0), a.cs,
+                                    &UVM_E(a, j, k0), a.cs);
+            if (!(d > 0)) return FALSE;
+            UVM_E(a, j, j) = d = (UVM_T)sqrt(d);
+            for (ScmSmallInt i = j + 1; i < k1; i++) {
+                UVM_E(a, i, j) = (UVM_E(a, i, j)
+                                  - UVM_NAME(uvm_dot)(j - k0,
+                                                      &UVM_E(a, i, k0), a.cs,
+                                                      &UVM_E(a, j, k0), a.cs))
+                    / d;
+            }
+        }
+        if (k1 == n) break;
+        /* L21 = A21 L11^-T */
+        for (ScmSmallInt i = k1; i < n; i++) {
+            for (ScmSmallInt j = k0; j < k1; j++) {
+                UVM_E(a, i, j) = (UVM_E(a, i, j)
+                                  - UVM_NAME(uvm_dot)(j - k0,
+                                                      &UVM_E(a, i, k0), a.cs,
+                                                      &UVM_E(a, j, k0), a.cs))
+                    / UVM_E(a, j, j);
+            }
+        }
+        /* A22 -= L21 L21^T, only the blocks on and below the diagonal. */
+        for (ScmSmallInt i0 = k1; i0 < n; i0 += UVM_NB) {
+            ScmSmallInt i1 = (n - i0 < UVM_NB)? n : i0 + UVM_NB;
+            UVM_NAME(uvm_gemm)(i1 - i0, i1 - k1, k1 - k0, -1,
+                               UVM_SUB(a, i0, k0),
+                               uvm_trans(UVM_SUB(a, k1, k0)),
+                               FALSE, UVM_SUB(a, i0, k1));
+        }
+    }
+    for (ScmSmallInt i = 0; i < n; i++) {
+        for (ScmSmallInt j = i + 1; j < n; j++) UVM_E(a, i, j) = 0;
+    }
+    return TRUE;
+}
+
+/* Moves the strictly lower triangle of N x N matrix LU, given by uvm_lu,
+   to L with the unit diagonal, leaving U in LU. */
+static UVM_ATTR void UVM_NAME(uvm_lu_split)(ScmSmallInt n, uvm_mat lu,
+                                            uvm_mat l)
+{
+    for (ScmSmallInt i = 0; i < n; i++) {
+        for (ScmSmallInt j = 0; j < n; j++) {
+            if (j < i) {
+                UVM_E(l, i, j) = UVM_E(lu, i, j);
+                UVM_E(lu, i, j) = 0;
+            } else {
+                UVM_E(l, i, j) = (i == j);
+            }
+        }
+    }
+}
+
+/* Product of the diagonal elements of N x N matrix A. */
+static UVM_ATTR double UVM_NAME(uvm_diag_product)(ScmSmallInt n, uvm_mat a)
+{
+    double r = 1.0;
+    for (ScmSmallInt i = 0; i < n; i++) r *= UVM_E(a, i, i);
+    return r;
+}
+#endif /* UVM_DECOMPOSITION */
+
+/* C = A B, where A is M x K and B is K x N. */
+static UVM_ATTR void UVM_NAME(uvm_mul)(ScmSmallInt m, ScmSmallInt n,
+                                       ScmSmallInt k,
+                                       uvm_mat a, uvm_mat b, uvm_mat c)
+{
+    UVM_NAME(uvm_gemm)(m, n, k, 1, a, b, TRUE, c);
+}
+
+static const uvm_kernels UVM_NAME(uvm_kernels) = {
+    UVM_NAME(uvm_mul),
+    UVM_NAME(uvm_copy),
+    UVM_NAME(uvm_gemv),
+#if defined(UVM_DECOMPOSITION)
+    UVM_NAME(uvm_lu),
+    UVM_NAME(uvm_lu_inverse),
+    UVM_NAME(uvm_cholesky),
+    UVM_NAME(uvm_lu_split),
+    UVM_NAME(uvm_diag_product)
+#else
+    NULL, NULL, NULL, NULL, NULL
+#endif
+};
+
+#undef UVM_E
+#undef UVM_SUB
@@ -0,0 +1,456 @@
+/*
+ * uvmatrix.c - native matrix operations for f32 and f64 arrays
+ *
+ *   Copyright (c) 2026  Shiro Kawai  <shiro@acm.org>
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *
+ *   3. Neither the name of the authors nor the names of its contributors
+ *      may be used to endorse or promote products derived from this
+ *      software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ *   TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ *   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ *   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ *   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ *   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <math.h>
+#define EXTUVECTOR_EXPORTS
+#include "gauche/uvector.h"
+
+/*
+ * Matrices are passed from gauche.array as a vector
+ *
+ *   #(storage offset row-stride col-stride rows cols)
+ *
+ * where storage is an f32vector or f64vector, and element (i, j) is at
+ * offset + i*row-stride + j*col-stride.  It covers any rank-2 array,
+ * including the ones made by share-array, and transposition is just
+ * swapping the strides.
+ */
+
+typedef struct {
+    void *p;                    /* element (0, 0) */
+    ScmSmallInt rs, cs;         /* row and column strides, in elements */
+} uvm_mat;
+
+static inline uvm_mat uvm_sub(uvm_mat m, ScmSmallInt i, ScmSmallInt j,
+                              size_t esize)
+{
+    uvm_mat r = m;
+    r.p = (char*)m.p + (i*m.rs + j*m.cs)*(ScmSmallInt)esize;
+    return r;
+}
+
+static inline uvm_mat uvm_trans(uvm_mat m)
+{
+    uvm_mat r = m;
+    r.rs = m.cs;
+    r.cs = m.rs;
+    return r;
+}
+
+/* The decompositions are NULL in the f32 tables. */
+typedef struct {
+    void   (*mul)(ScmSmallInt m, ScmSmallInt n, ScmSmallInt k,
+                  uvm_mat a, uvm_mat b, uvm_mat c);
+    void   (*copy)(ScmSmallInt m, ScmSmallInt n, uvm_mat d, uvm_mat s);
+    void   (*gemv)(ScmSmallInt m, ScmSmallInt n, uvm_mat a,
+                   const void *x, void *y);
+    int    (*lu)(ScmSmallInt n, uvm_mat a, int32_t *piv);
+    void   (*lu_inverse)(ScmSmallInt n, uvm_mat lu, const int32_t *piv,
+                         uvm_mat x);
+    int    (*cholesky)(ScmSmallInt n, uvm_mat a);
+    void   (*lu_split)(ScmSmallInt n, uvm_mat lu, uvm_mat l);
+    double (*diag_product)(ScmSmallInt n, uvm_mat a);
+} uvm_kernels;
+
+#define UVM_MC     96           /* rows of a packed block of A */
+#define UVM_KC     256          /* depth of packed blocks */
+#define UVM_NC     2048         /* columns of a packed block of B */
+#define UVM_NB     64           /* panel width of decompositions */
+#define UVM_TILE   32           /* tile size of copying */
+#define UVM_LANES  8            /* accumulators of dot products */
+
+#define UVM_NAME(name)      UVM_NAME1(name, UVM_SUFFIX)
+#define UVM_NAME1(name, s)  UVM_NAME2(name, s)
+#define UVM_NAME2(name, s)  name##_##s
+
+#define UVM_ATTR
+#define UVM_DECOMPOSITION
+#define UVM_T       double
+#define UVM_SUFFIX  f64_generic
+#define UVM_MR      2
+#define UVM_NR      4
+#include "uvmatkernel.c"
+#undef UVM_T
+#undef UVM_SUFFIX
+#undef UVM_MR
+#undef UVM_NR
+#undef UVM_DECOMPOSITION
+
+#define UVM_T       float
+#define UVM_SUFFIX  f32_generic
+#define UVM_MR      2
+#define UVM_NR      8
+#include "uvmatkernel.c"
+#undef UVM_T
+#undef UVM_SUFFIX
+#undef UVM_MR
+#undef UVM_NR
+#undef UVM_ATTR
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define UVM_HAVE_AVX2 1
+#define UVM_ATTR    __attribute__((target("avx2,fma")))
+#define UVM_DECOMPOSITION
+#define UVM_T       double
+#define UVM_SUFFIX  f64_avx2
+#define UVM_MR      6
+#define UVM_NR      8
+#include "uvmatkernel.c"
+#undef UVM_T
+#undef UVM_SUFFIX
+#undef UVM_MR
+#undef UVM_NR
+#undef UVM_DECOMPOSITION
+
+#define UVM_T       float
+#define UVM_SUFFIX  f32_avx2
+#define UVM_MR      6
+#define UVM_NR      16
+#include "uvmatkernel.c"
+#undef UVM_T
+#undef UVM_SUFFIX
+#undef UVM_MR
+#undef UVM_NR
+#undef UVM_ATTR
+#endif /* x86 */
+
+/* We use the AVX2 kernels when the uvector kernels are AVX2 ones, so
+   that %uvector-kernels switches both. */
+static const uvm_kernels *uvm_select(int type)
+{
+#if defined(UVM_HAVE_AVX2)
+    static int fma = -1;
+    if (fma < 0) {
+        __builtin_cpu_init();
+        fma = __builtin_cpu_supports("fma")? 1 : 0;
+    }
+    if (fma && SCM_EQ(Scm_UVectorKernelVariant(), SCM_INTERN("avx2"))) {
+        return (type == SCM_UVECTOR_F64)
+            ? &uvm_kernels_f64_avx2 : &uvm_kernels_f32_avx2;
+    }
+#endif
+    return (type == SCM_UVECTOR_F64)
+        ? &uvm_kernels_f64_generic : &uvm_kernels_f32_generic;
+}
+
+/*
+ * Decoding views
+ */
+
+typedef struct {
+    ScmUVector *v;
+    int type;
+    uvm_mat m;
+    ScmSmallInt rows, cols;
+} uvm_view;
+
+static void get_view(ScmObj obj, uvm_view *view)
+{
+    ScmSmallInt f[5];
+
+    if (!SCM_VECTORP(obj) || SCM_VECTOR_SIZE(obj) != 6) goto bad;
+    ScmObj v = SCM_VECTOR_ELEMENT(obj, 0);
+    if (!SCM_F64VECTORP(v) && !SCM_F32VECTORP(v)) goto bad;
+    for (int i = 0; i < 5; i++) {
+        ScmObj x = SCM_VECTOR_ELEMENT(obj, i+1);
+        if (!SCM_INTP(x)) goto bad;
+        f[i] = SCM_INT_VALUE(x);
+    }
+    if (f[3] < 0 || f[4] < 0) goto bad;
+    /* All the elements must be within the storage. */
+    if (f[3] > 0 && f[4] > 0) {
+        ScmSmallInt lo = f[0], hi = f[0];
+        ScmSmallInt dr = (f[3]-1)*f[1], dc = (f[4]-1)*f[2];
+        if (dr < 0) lo += dr; else hi += dr;
+        if (dc < 0) lo += dc; else hi += dc;
+        if (lo < 0 || hi >= SCM_UVECTOR_SIZE(v)) goto bad;
+    }
+    view->v = SCM_UVECTOR(v);
+    view->type = Scm_UVectorType(Scm_ClassOf(v));
+    view->m.p = (char*)SCM_UVECTOR_ELEMENTS(v)
+        + f[0]*Scm_UVectorElementSize(Scm_ClassOf(v));
+    view->m.rs = f[1];
+    view->m.cs = f[2];
+    view->rows = f[3];
+    view->cols = f[4];
+    return;
+  bad:
+    Scm_Error("invalid matrix view: %S", obj);
+}
+
+static void check_same_type(uvm_view *a, uvm_view *b)
+{
+    if (a->type != b->type) {
+        Scm_Error("matrices of the same element type required, "
+                  "but got %S and %S",
+                  Scm_ClassOf(SCM_OBJ(a->v)), Scm_ClassOf(SCM_OBJ(b->v)));
+    }
+}
+
+static void check_square(uvm_view *a)
+{
+    if (a->rows != a->cols) {
+        Scm_Error("square matrix required, but got %ldx%ld matrix",
+                  a->rows, a->cols);
+    }
+}
+
+static void check_shape(uvm_view *a, ScmSmallInt rows, ScmSmallInt cols)
+{
+    if (a->rows != rows || a->cols != cols) {
+        Scm_Error("%ldx%ld matrix required, but got %ldx%ld matrix",
+                  rows, cols, a->rows, a->cols);
+    }
+}
+
+/*
+ * Decompositions are always done in double precision; f32 matrices
+ * are converted to a dense f64 work area first, and the results are
+ * rounded back.  It's O(n^2) extra work for O(n^3) computation, and
+ * saves us from the accumulated rounding errors of single precision.
+ */
+
+static const uvm_kernels *uvm_f64(void)
+{
+    return uvm_select(SCM_UVECTOR_F64);
+}
+
+/* Returns a dense double copy of V. */
+static uvm_mat to_f64(uvm_view *v)
+{
+    ScmSmallInt m = v->rows, n = v->cols;
+    uvm_mat w;
+    w.p = SCM_NEW_ATOMIC_ARRAY(double, m*n + 1);
+    w.rs = n;
+    w.cs = 1;
+    if (v->type == SCM_UVECTOR_F64) {
+        uvm_f64()->copy(m, n, w, v->m);
+    } else {
+        const float *s = (const float*)v->m.p;
+        double *d = (double*)w.p;
+        for (ScmSmallInt i = 0; i < m; i++) {
+            for (ScmSmallInt j = 0; j < n; j++) {
+                d[i*n + j] = s[i*v->m.rs + j*v->m.cs];
+            }
+        }
+    }
+    return w;
+}
+
+/* Returns a double matrix to store the result destined to V; it is V
+   itself if V is f64.  Call from_f64 when the result is ready. */
+static uvm_mat f64_target(uvm_view *v)
+{
+    if (v->type == SCM_UVECTOR_F64) return v->m;
+    uvm_mat w;
+    w.p = SCM_NEW_ATOMIC_ARRAY(double, v->rows*v->cols + 1);
+    w.rs = v->cols;
+    w.cs = 1;
+    return w;
+}
+
+static void from_f64(uvm_view *v, uvm_mat w)
+{
+    if (v->type == SCM_UVECTOR_F64) {
+        if (w.p != v->m.p) uvm_f64()->copy(v->rows, v->cols, v->m, w);
+    } else {
+        const double *s = (const double*)w.p;
+        float *d = (float*)v->m.p;
+        for (ScmSmallInt i = 0; i < v->rows; i++) {
+            for (ScmSmallInt j = 0; j < v->cols; j++) {
+                d[i*v->m.rs + j*v->m.cs] = (float)s[i*w.rs + j*w.cs];
+            }
+        }
+    }
+}
+
+/*
+ * API
+ */
+
+/* Rows [START, END) of C = A B.  C must not share storage with A or B. */
+void Scm_MatrixMul(ScmObj c, ScmObj a, ScmObj b,
+                   ScmSmallInt start, ScmSmallInt end)
+{
+    uvm_view vc, va, vb;
+    get_view(c, &vc);
+    get_view(a, &va);
+    get_view(b, &vb);
+    check_same_type(&va, &vb);
+    check_same_type(&va, &vc);
+    SCM_UVECTOR_CHECK_MUTABLE(vc.v);
+    if (va.cols != vb.rows) {
+        Scm_Error("dimension mismatch: can't multiply %ldx%ld and %ldx%ld "
+                  "matrices", va.rows, va.cols, vb.rows, vb.cols);
+    }
+    check_shape(&vc, va.rows, vb.cols);
+    SCM_CHECK_START_END(start, end, va.rows);
+    if (vc.v == va.v || vc.v == vb.v) {
+        Scm_Error("the result matrix can't share storage with operands");
+    }
+    int esize = Scm_UVectorElementSize(Scm_ClassOf(SCM_OBJ(va.v)));
+    uvm_select(va.type)->mul(end - start, vb.cols, va.cols,
+                             uvm_sub(va.m, start, 0, esize), vb.m,
+                             uvm_sub(vc.m, start, 0, esize));
+}
+
+/* DST = SRC.  Give SRC with swapped strides to transpose. */
+void Scm_MatrixCopy(ScmObj dst, ScmObj src)
+{
+    uvm_view vd, vs;
+    get_view(dst, &vd);
+    get_view(src, &vs);
+    check_same_type(&vd, &vs);
+    SCM_UVECTOR_CHECK_MUTABLE(vd.v);
+    check_shape(&vd, vs.rows, vs.cols);
+    uvm_select(vd.type)->copy(vd.rows, vd.cols, vd.m, vs.m);
+}
+
+/* Y = A X, where X and Y are uvectors of the element type of A. */
+void Scm_MatrixVectorMul(ScmUVector *y, ScmObj a, ScmUVector *x)
+{
+    uvm_view va;
+    get_view(a, &va);
+    ScmClass *k = Scm_ClassOf(SCM_OBJ(va.v));
+    if (Scm_ClassOf(SCM_OBJ(x)) != k || Scm_ClassOf(SCM_OBJ(y)) != k) {
+        Scm_Error("%A required, but got %S and %S", k->name, x, y);
+    }
+    SCM_UVECTOR_CHECK_MUTABLE(y);
+    if (SCM_UVECTOR_SIZE(x) != va.cols || SCM_UVECTOR_SIZE(y) != va.rows) {
+        Scm_Error("dimension mismatch: can't multiply %ldx%ld matrix "
+                  "and vector of length %ld", va.rows, va.cols,
+                  SCM_UVECTOR_SIZE(x));
+    }
+    if (x == y) Scm_Error("the result vector can't be the operand: %S", y);
+    uvm_select(va.type)->gemv(va.rows, va.cols, va.m,
+                              SCM_UVECTOR_ELEMENTS(x),
+                              SCM_UVECTOR_ELEMENTS(y));
+}
+
+/* Determinant of square matrix A.  If DESTRUCTIVE is true, an f64
+   matrix A is overwritten by its LU decomposition, saving a copy. */
+double Scm_MatrixDeterminant(ScmObj a, int destructive)
+{
+    uvm_view va;
+    get_view(a, &va);
+    check_square(&va);
+    if (destructive) SCM_UVECTOR_CHECK_MUTABLE(va.v);
+    const uvm_kernels *k = uvm_f64();
+    ScmSmallInt n = va.rows;
+    uvm_mat w = (destructive && va.type == SCM_UVECTOR_F64)? va.m : to_f64(&va);
+    int32_t *piv = SCM_NEW_ATOMIC_ARRAY(int32_t, n+1);
+    int sign = k->lu(n, w, piv);
+    if (sign == 0) return 0.0;
+    return sign * k->diag_product(n, w);
+}
+
+/* X = A^-1.  Returns FALSE, leaving X unspecified, if A is singular. */
+int Scm_MatrixInverse(ScmObj x, ScmObj a)
+{
+    uvm_view vx, va;
+    get_view(x, &vx);
+    get_view(a, &va);
+    check_same_type(&vx, &va);
+    check_square(&va);
+    check_shape(&vx, va.rows, va.cols);
+    SCM_UVECTOR_CHECK_MUTABLE(vx.v);
+    const uvm_kernels *k = uvm_f64();
+    ScmSmallInt n = va.rows;
+    uvm_mat w = to_f64(&va);
+    int32_t *piv = SCM_NEW_ATOMIC_ARRAY(int32_t, n+1);
+    if (k->lu(n, w, piv) == 0) return FALSE;
+    uvm_mat t = f64_target(&vx);
+    k->lu_inverse(n, w, piv, t);
+    from_f64(&vx, t);
+    return TRUE;
+}
+
+/* LU decomposition with partial pivoting: P A = L U.  L and U must
+   be distinct from each other and have the shape of A.  PIV, an
+   s32vector of length n, receives the permutation as the row of A that
+   each row of P A comes from.  Returns the sign of the permutation,
+   or 0 if A is singular. */
+int Scm_MatrixLU(ScmObj l, ScmObj u, ScmObj a, ScmUVector *piv)
+{
+    uvm_view vl, vu, va;
+    get_view(l, &vl);
+    get_view(u, &vu);
+    get_view(a, &va);
+    check_same_type(&vl, &va);
+    check_same_type(&vu, &va);
+    check_square(&va);
+    check_shape(&vl, va.rows, va.cols);
+    check_shape(&vu, va.rows, va.cols);
+    SCM_UVECTOR_CHECK_MUTABLE(vl.v);
+    SCM_UVECTOR_CHECK_MUTABLE(vu.v);
+    if (vl.v == vu.v) Scm_Error("L and U can't share storage");
+    ScmSmallInt n = va.rows;
+    if (!SCM_S32VECTORP(piv) || SCM_S32VECTOR_SIZE(piv) != n) {
+        Scm_Error("s32vector of length %ld required, but got %S", n, piv);
+    }
+    SCM_UVECTOR_CHECK_MUTABLE(piv);
+
+    const uvm_kernels *k = uvm_f64();
+    uvm_mat w = to_f64(&va);
+    int32_t *swaps = SCM_NEW_ATOMIC_ARRAY(int32_t, n+1);
+    int sign = k->lu(n, w, swaps);
+    uvm_mat lt = f64_target(&vl);
+    k->lu_split(n, w, lt);
+    from_f64(&vl, lt);
+    from_f64(&vu, w);
+
+    int32_t *p = SCM_S32VECTOR_ELEMENTS(piv);
+    for (ScmSmallInt i = 0; i < n; i++) p[i] = (int32_t)i;
+    for (ScmSmallInt i = 0; i < n; i++) {
+        int32_t t = p[i]; p[i] = p[swaps[i]]; p[swaps[i]] = t;
+    }
+    return sign;
+}
+
+/* Cholesky decomposition A = L L^T of symmetric positive definite A.
+   Only the lower triangle of A is used.  Returns FALSE, leaving L
+   unspecified, if A isn't positive definite. */
+int Scm_MatrixCholesky(ScmObj l, ScmObj a)
+{
+    uvm_view vl, va;
+    get_view(l, &vl);
+    get_view(a, &va);
+    check_same_type(&vl, &va);
+    check_square(&va);
+    check_shape(&vl, va.rows, va.cols);
+    SCM_UVECTOR_CHECK_MUTABLE(vl.v);
+    uvm_mat w = to_f64(&va);
+    if (!uvm_f64()->cholesky(va.rows, w)) return FALSE;
+    from_f64(&vl, w);
+    return TRUE;
+}
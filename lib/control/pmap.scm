@@ -45,6 +45,7 @@
           sequential-mapper
           make-static-mapper
           make-pool-mapper
+          make-adaptive-mapper
           make-fully-concurrent-mapper))
 (select-module control.pmap)
 
@@ -62,6 +63,12 @@
 ;;      distribute elements evenly.  Low overhead, good when each task is
 ;;      lightweight and the execution time won't fractuate much.
 ;;
+;;   adaptive-mapper - Process elements in batches whose size is adjusted
+;;      by the observed time per element, and let idle threads steal
+;;      work from busy ones.  Threads are created only when the work turns
+;;      out to be long enough.  This is the default mapper on multi-core
+;;      systems.
+;;
 ;;   full-concurrent-mapper - Creates as many threads as the number of
 ;;      elements and run concurrently.  Relatively large overhead per element,
 ;;      but works better if (1) the number of elements are not very large,
@@ -274,6 +281,163 @@
           (run pool)
         (terminate-all! pool :force-timeout 0)))))
 
+;;
+;; adaptive mapper
+;;
+
+;; The calling thread starts processing elements alone, in batches whose
+;; size is adjusted so that each batch takes about *batch-time*
+;; microseconds.  Once the work has taken more than *spawn-time*
+;; microseconds, helper threads are created; so a cheap map over a small
+;; collection runs sequentially without thread overhead.
+;;
+;; Each worker owns a span of indexes.  The owner takes batches from the
+;; front of its span; an idle worker steals the latter half of the
+;; largest span.  Helpers start with empty spans, so the work is spread
+;; by stealing.  Results are stored by index, so the order is preserved.
+;;
+;; Vectors and uvectors are accessed by index directly; other collections
+;; are converted to a vector first.
+
+(define-class <adaptive-mapper> (<mapper>)
+  ((num-threads :init-keyword :num-threads)))
+
+(define (make-adaptive-mapper :optional (num-threads (sys-available-processors)))
+  (make <adaptive-mapper> :num-threads num-threads))
+
+(define-constant *batch-time* 200)      ;us
+(define-constant *spawn-time* 500)      ;us
+
+(define-record-type <span>
+  (make-span lock start end)
+  span?
+  (lock  span-lock)
+  (start span-start span-start-set!)
+  (end   span-end span-end-set!))
+
+;; Unlocked; only used as a hint.
+(define (span-size sp) (- (span-end sp) (span-start sp)))
+
+;; Takes up to K indexes from the front of SP.  Returns (start . end)
+;; or #f if SP is empty.
+(define (span-take! sp k)
+  (with-locking-mutex (span-lock sp)
+    (^[]
+      (let ([s (span-start sp)] [e (span-end sp)])
+        (and (< s e)
+             (let1 e2 (min e (+ s k))
+               (span-start-set! sp e2)
+               (cons s e2)))))))
+
+;; Moves the latter half of the largest span to (vector-ref spans me).
+;; Returns #f if there's nothing worth to steal.
+(define (span-steal! spans me)
+  (define (find-victim)
+    (let loop ([i 0] [best #f] [best-size 1])
+      (if (= i (vector-length spans))
+        best
+        (let1 z (span-size (vector-ref spans i))
+          (if (and (not (= i me)) (> z best-size))
+            (loop (+ i 1) i z)
+            (loop (+ i 1) best best-size))))))
+  (and-let* ([v (find-victim)])
+    (let* ([victim (vector-ref spans v)]
+           [r (with-locking-mutex (span-lock victim)
+                (^[]
+                  (let* ([s (span-start victim)]
+                         [e (span-end victim)]
+                         [n (- e s)])
+                    (and (>= n 2)
+                         (let1 m (- e (quotient n 2))
+                           (span-end-set! victim m)
+                           (cons m e))))))])
+      (if r
+        (let1 mine (vector-ref spans me)
+          (with-locking-mutex (span-lock mine)
+            (^[]
+              (span-start-set! mine (car r))
+              (span-end-set! mine (cdr r))))
+          #t)
+        (span-steal! spans me)))))      ;someone else took it; retry
+
+(define (%next-batch-size k n dt)
+  (if (<= dt 0)
+    (* k 2)
+    (clamp (round->exact (/ (* n *batch-time*) dt)) 1 (* k 2))))
+
+;; (PROCESS i) handles the i-th element.  TICK is called with the time
+;; each batch took.
+(define (%adaptive-worker spans me process stop? tick)
+  (let loop ([k 1])
+    (if-let1 r (and (not (stop?)) (span-take! (vector-ref spans me) k))
+      (let1 t0 (current-microseconds)
+        (do ([i (car r) (+ i 1)])
+            [(or (= i (cdr r)) (stop?))]
+          (process i))
+        (let1 dt (- (current-microseconds) t0)
+          (tick dt)
+          (loop (%next-batch-size k (- (cdr r) (car r)) dt))))
+      (when (and (not (stop?)) (span-steal! spans me))
+        (loop k)))))
+
+;; (PROCESS i stop!) handles the i-th element; it may call stop! to
+;; cancel the rest.  If PROCESS raises an exception, the rest is
+;; cancelled and the exception is re-raised after all workers finish.
+(define (%adaptive-run num-threads n process)
+  (define spans
+    (list->vector
+     (cons (make-span (make-mutex) 0 n)
+           (list-tabulate (- num-threads 1) (^_ (make-span (make-mutex) 0 0))))))
+  (define stopped #f)
+  (define exc #f)
+  (define lock (make-mutex))
+  (define helpers '())
+  (define elapsed 0)
+  (define (stop?) stopped)
+  (define (stop!) (set! stopped #t))
+  (define (work me tick)
+    (guard (e [else (with-locking-mutex lock
+                      (^[] (unless exc (set! exc e))))
+                    (stop!)])
+      (%adaptive-worker spans me (cut process <> stop!) stop? tick)))
+  (define (tick dt)
+    (when (and (null? helpers) (> num-threads 1))
+      (inc! elapsed dt)
+      (when (and (> elapsed *spawn-time*)
+                 (>= (span-size (vector-ref spans 0)) 2))
+        (set! helpers
+              (map (^i (thread-start! (make-thread (^[] (work i values)))))
+                   (iota (- num-threads 1) 1))))))
+  (work 0 tick)
+  (for-each thread-join! helpers)
+  (when exc (raise exc)))
+
+;; Returns the size and the accessor of COLL.
+(define (%indexer coll)
+  (cond [(vector? coll) (values (vector-length coll) (cut vector-ref coll <>))]
+        [(uvector? coll) (values (uvector-length coll) (cut uvector-ref coll <>))]
+        [else (%indexer (coerce-to <vector> coll))]))
+
+(define-method run-map ((mapper <adaptive-mapper>) proc coll)
+  (receive (n ref) (%indexer coll)
+    (let1 results (make-vector n)
+      (%adaptive-run (~ mapper'num-threads) n
+                     (^[i stop!] (vector-set! results i (proc (ref i)))))
+      (vector->list results))))
+
+(define-method run-select ((mapper <adaptive-mapper>) proc coll)
+  (receive (n ref) (%indexer coll)
+    (let ([found #f]
+          [lock (make-mutex)])
+      (%adaptive-run (~ mapper'num-threads) n
+                     (^[i stop!]
+                       (receive (s? r) (proc (ref i))
+                         (when s?
+                           (with-locking-mutex lock
+                             (^[] (unless found (set! found (list r)))))
+                           (stop!)))))
+      (and found (car found)))))
+
 ;;
 ;; fully concurrent mapper
 ;;
@@ -331,7 +495,7 @@
   (make-parameter
    (if (= 1 (sys-available-processors))
      (sequential-mapper)
-     (make-static-mapper))))
+     (make-adaptive-mapper))))
 
 ;;;
 ;;; High-level API
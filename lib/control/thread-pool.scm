@@ -39,6 +39,7 @@
   (use scheme.list)
   (use srfi.19)
   (use data.queue)
+  (use data.ring-buffer)
   (use util.match)
   (use gauche.threads)
   (use gauche.record)
@@ -55,6 +56,12 @@
 ;; - optionally, the client can ask to queue the finished job to result-queue.
 ;; - while exeuting the job, thread keeps job record in its 'specific' slot.
 ;; - graceful termination is requested by 'over in the job queue.
+;; - each worker has its own deque.  A job added by a running job goes
+;;   to the front of the worker's deque, and the worker takes jobs from
+;;   the front of it first.  An idle worker steals a job from the back
+;;   of other workers' deques before waiting on the job queue.  When a
+;;   worker pushes a job to its deque, it puts 'steal in the job queue
+;;   to wake up a waiting worker, if any.
 
 (define-class <thread-pool> ()
   ((result-queue :init-form (make-mtqueue)) ; Queue Job
@@ -62,6 +69,7 @@
    (pool         :init-keyword :pool :init-value '()) ; [Thread]
    (size         :init-keyword :size :init-value 2)
    (job-queue    :init-form (make-mtqueue)) ; Queue (Bool . Job)
+   (deques       :init-value '#())     ; Vector Deque, one for each worker
    (max-backlog  :allocation :propagated
                  :propagate '(job-queue max-length)
                  :init-keyword :max-backlog)
@@ -74,10 +82,12 @@
 
 (define-method initialize ((pool <thread-pool>) initargs)
   (next-method)
+  (set! (~ pool'deques) (vector-tabulate (~ pool'size)
+                                         (lambda (_) (make-deque))))
   (set! (~ pool'pool)
         (list-tabulate (~ pool'size)
-                       (lambda (_)
-                         (thread-start! (make-thread (cut worker pool)))))))
+                       (lambda (i)
+                         (thread-start! (make-thread (cut worker pool i)))))))
 
 (define (thread-pool-results pool)    (~ pool'result-queue))
 (define (thread-pool-shut-down? pool) (~ pool'shut-down))
@@ -88,26 +98,87 @@
 (define (%shut-down pool)
   (error <thread-pool-shut-down> :pool pool "Thread pool has shut down"))
 
-(define (worker pool)
+;; Per-worker deque.  The owner uses the front, and thieves the back.
+(define-record-type deque %make-deque #t
+  (mutex)
+  (buffer))
+
+(define (make-deque) (%make-deque (make-mutex) (make-ring-buffer)))
+
+(define (deque-push! dq entry)
+  (with-locking-mutex (deque-mutex dq)
+    (cut ring-buffer-add-front! (deque-buffer dq) entry)))
+
+(define (%deque-take! dq remover)
+  (with-locking-mutex (deque-mutex dq)
+    (^[] (and (not (ring-buffer-empty? (deque-buffer dq)))
+              (remover (deque-buffer dq))))))
+
+(define (deque-pop! dq)   (%deque-take! dq ring-buffer-remove-front!))
+(define (deque-steal! dq) (%deque-take! dq ring-buffer-remove-back!))
+
+(define (deque-take-all! dq)
+  (let loop ([entries '()])
+    (if-let1 e (deque-steal! dq)
+      (loop (cons e entries))
+      entries)))
+
+;; Steal a job from other workers, starting from the next one of
+;; the worker I.
+(define (steal pool i)
+  (let* ([deques (~ pool'deques)]
+         [n (vector-length deques)])
+    (let loop ([k 1])
+      (and (< k n)
+           (or (deque-steal! (vector-ref deques (modulo (+ i k) n)))
+               (loop (+ k 1)))))))
+
+;; (pool . index) if the current thread is a worker.
+(define *current-worker* (make-thread-local #f 'thread-pool-worker))
+
+(define (worker pool i)
   (define self (current-thread))
-  (match (dequeue/wait! (~ pool'job-queue))
-    [(need-result . job)
-     (thread-specific-set! self job)
-     (job-run! job)                     ; captures errors
-     (when need-result (enqueue! (~ pool'result-queue) job))
-     (thread-specific-set! self #f)
-     (worker pool)]
-    [_ #t]))                            ; no more jobs
+  (define own (vector-ref (~ pool'deques) i))
+  (tlset! *current-worker* (cons pool i))
+  (let loop ()
+    (match (or (deque-pop! own)
+               (dequeue! (~ pool'job-queue) #f)
+               (steal pool i)
+               (dequeue/wait! (~ pool'job-queue)))
+      [(need-result . job)
+       (thread-specific-set! self job)
+       (job-run! job)                   ; captures errors
+       (when need-result (enqueue! (~ pool'result-queue) job))
+       (thread-specific-set! self #f)
+       (loop)]
+      ['steal (loop)]
+      [_ #t])))                         ; no more jobs
+
+;; Returns the deque of the current thread if it is a worker of POOL.
+(define (own-deque pool)
+  (match (tlref *current-worker*)
+    [(p . i) (and (eq? p pool) (vector-ref (~ pool'deques) i))]
+    [_ #f]))
 
 ;; Returns job if queued, #f if job queue is full
+;; A job added from a job running in the pool goes to the worker's
+;; deque, bypassing the job queue and its max-backlog limit.
 (define (add-job! pool thunk :optional (need-result #f) (timeout #f))
   (when (~ pool'shut-down) (%shut-down pool))
   (let1 job (make-job thunk :cancellable #t)
     (job-acknowledge! job)
-    (and (enqueue/wait! (~ pool'job-queue) (cons need-result job) timeout #f)
-         (if (~ pool'shut-down)
-           (%shut-down pool)
-           job))))
+    (if-let1 dq (own-deque pool)
+      (begin
+        (deque-push! dq (cons need-result job))
+        ;; We can't tell reliably whether someone is waiting, for one may
+        ;; start waiting right after we check.  An extra 'steal is just
+        ;; skipped by the worker that gets it.
+        (queue-push/wait! (~ pool'job-queue) 'steal 0)
+        job)
+      (and (enqueue/wait! (~ pool'job-queue) (cons need-result job) timeout #f)
+           (if (~ pool'shut-down)
+             (%shut-down pool)
+             job)))))
 
 ;; Note: The signature has been changed from 0.9.1, in which wait-all
 ;; only takes check-interval optional argument.  It is impossible to detect
@@ -135,7 +206,9 @@
     ;; wait-all.
     (cond [(and (queue-empty? (~ pool'job-queue))
                 (= (mtqueue-num-waiting-readers (~ pool'job-queue))
-                   (~ pool'size)))]
+                   (~ pool'size))
+                (every (^[dq] (ring-buffer-empty? (deque-buffer dq)))
+                       (vector->list (~ pool'deques))))]
           [(and abstime (time>=? now abstime)) #f] ;timeout
           [else (sys-nanosleep check-interval)
                 (loop (and abstime (current-time)))])))
@@ -157,9 +230,12 @@
 
   ;; If requested, cancel jobs already queued but not being executing.
   (when cancel-queued-jobs
-    (dolist [job (dequeue-all! (~ pool'job-queue))]
-      (job-mark-killed! (cdr job) "thread pool has shut down")
-      (enqueue! (~ pool'result-queue) (cdr job))))
+    (dolist [job (append (dequeue-all! (~ pool'job-queue))
+                         (append-map deque-take-all!
+                                     (vector->list (~ pool'deques))))]
+      (when (pair? job)                 ; skip 'steal
+        (job-mark-killed! (cdr job) "thread pool has shut down")
+        (enqueue! (~ pool'result-queue) (cdr job)))))
 
   ;; Sends threads termination message
   (dotimes [count size]
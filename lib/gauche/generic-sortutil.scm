@@ -22,22 +22,22 @@
                    (and (not (less? current last))
                         (loop current)))))))))
 
-(define (%generic-sort seq less? :optional (key #f))
+(define %stable-sort-x! (with-module gauche.internal %stable-sort-x!))
+
+;; Returns a fresh vector of the elements of SEQ, stably sorted by the
+;; adaptive merge sort in compare.c.
+(define (sorted-vector seq less? key)
   (if key
-    ($ map-to (class-of seq) car
-       $ stable-sort (map (^e (cons e (key e))) seq)
-       (^[a b] (less? (cdr a) (cdr b))))
-    (coerce-to (class-of seq) (stable-sort (coerce-to <list> seq) less?))))
+    (let1 v (map-to <vector> (^e (cons e (key e))) seq)
+      (%stable-sort-x! v (^[a b] (less? (cdr a) (cdr b))))
+      (vector-map car v))
+    (%stable-sort-x! (coerce-to <vector> seq) less?)))
+
+(define (%generic-sort seq less? :optional (key #f))
+  (coerce-to (class-of seq) (sorted-vector seq less? key)))
 
 (define (%generic-sort! seq less? :optional (key #f))
-  (if key
-    (do-ec (:parallel
-            (: p (stable-sort! (map (^e (cons e (key e))) seq)
-                               (^[a b] (less? (cdr a) (cdr b)))))
-            (:integers i))
-           (set! (ref seq i) (car p)))
-    (do-ec (:parallel
-            (: elt (stable-sort! (coerce-to <list> seq) less?))
-            (:integers i))
-           (set! (ref seq i) elt)))
+  (do-ec (:parallel (:vector elt (sorted-vector seq less? key))
+                    (:integers i))
+         (set! (ref seq i) elt))
   seq)
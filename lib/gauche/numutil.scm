@@ -172,13 +172,7 @@
 ;; modulus exponent
 (define (expt-mod n e m)  ; (modulo (expt n e) m)
   (if (and (exact-integer? n) (exact-integer? e) (exact-integer? m) (>= e 0))
-    (if (< (* (integer-length n) e) (fixnum-width))
-      (modulo (expt n e) m) ; in fixnum range, it's fast enough
-      (let loop ([b (ash 1 (- (integer-length e) 1))]
-                 [r 1])
-        (cond [(zero? b) r]
-              [(zero? (logand b e)) (loop (ash b -1) (modulo (* r r) m))]
-              [else (loop (ash b -1) (modulo (* (modulo (* r r) m) n) m))])))
+    ((with-module gauche.internal %expt-mod) n e m)
     (modulo (expt (inexact n) e) m))) ; inexact fallback
 
 ;; modulus inverse.  returns q^-1 such that (* q q^-1) = 1 [mod m]
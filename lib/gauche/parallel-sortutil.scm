@@ -0,0 +1,98 @@
+;;;
+;;; parallel version of sort utilities
+;;;
+
+;; This module is autoloaded from sort! and stable-sort! (src/libcmp.scm)
+;; to sort large vectors and uniform vectors.  Users shouldn't use
+;; this module directly.
+
+(define-module gauche.parallel-sortutil
+  (use gauche.threads)
+  (export %parallel-sort!))
+(select-module gauche.parallel-sortutil)
+
+(define %merge-ranges! (with-module gauche.internal %merge-ranges!))
+(define %uvector-sort! (with-module gauche.internal %uvector-sort!))
+(define %uvector-copy  (with-module gauche.internal %uvector-copy))
+(define %radix-sort!   (with-module gauche.internal %radix-sort!))
+(define %sort!         (with-module gauche.internal %sort!))
+(define %stable-sort!  (with-module gauche.internal %stable-sort!))
+
+;; We don't split a sequence into chunks smaller than this.
+(define-constant *min-chunk-size* 16384)
+
+;; Sort SEQ, a vector or a uniform vector, in place in the default order.
+;; The caller must ensure that comparing the elements of SEQ doesn't call
+;; Scheme code (see %fast-sort! in src/libcmp.scm); the comparison is
+;; done concurrently.
+;;
+;; SEQ is divided into as many chunks as processors, which are sorted
+;; concurrently.  Then adjacent runs are merged pairwise, each round also
+;; in parallel, bouncing between SEQ and a scratch buffer.  Merging takes
+;; from the left run unless the right one is strictly less, so the result
+;; is stable if the chunk sort is.
+(define (%parallel-sort! seq stable?)
+  (let* ([n (if (vector? seq) (vector-length seq) (uvector-length seq))]
+         [nchunks (if (eq? (gauche-thread-type) 'none)
+                    1
+                    (min (sys-available-processors)
+                         (quotient n *min-chunk-size*)))])
+    (if (<= nchunks 1)
+      (sort-chunk! seq 0 n stable?)
+      (let1 bounds (map (^i (quotient (* i n) nchunks)) (iota (+ nchunks 1)))
+        (run-parallel (map (^[lo hi] (^[] (sort-chunk! seq lo hi stable?)))
+                           bounds (cdr bounds)))
+        (merge-runs! seq bounds))))
+  seq)
+
+(define (sort-chunk! seq lo hi stable?)
+  (cond [(uvector? seq) (%uvector-sort! seq lo hi)]
+        [else
+         ;; NB: We avoid sort! and stable-sort!, which would come back
+         ;; here for a large chunk.
+         (let1 chunk (vector-copy seq lo hi)
+           (cond [(not stable?) (%sort! chunk)]
+                 [(%radix-sort! chunk)]
+                 [else (%stable-sort! chunk)])
+           (vector-copy! seq lo chunk))]))
+
+;; BOUNDS is a list of indexes delimiting sorted runs in SEQ.
+(define (merge-runs! seq bounds)
+  (let loop ([src seq]
+             [dst (if (vector? seq)
+                    (make-vector (vector-length seq))
+                    (%uvector-copy seq))]
+             [bounds bounds])
+    (if (null? (cddr bounds))
+      (unless (eq? src seq)
+        (%merge-ranges! src seq 0 (cadr bounds) (cadr bounds)))
+      (let pairs ([bs bounds] [tasks '()] [next '()])
+        (cond [(null? (cdr bs))
+               (run-parallel tasks)
+               (loop dst src (reverse (cons (car bs) next)))]
+              [(null? (cddr bs))
+               ;; odd run out; just move it over
+               (let ([lo (car bs)] [hi (cadr bs)])
+                 (pairs (cdr bs)
+                        (cons (^[] (%merge-ranges! src dst lo hi hi)) tasks)
+                        (cons lo next)))]
+              [else
+               (let ([lo (car bs)] [mid (cadr bs)] [hi (caddr bs)])
+                 (pairs (cddr bs)
+                        (cons (^[] (%merge-ranges! src dst lo mid hi)) tasks)
+                        (cons lo next)))])))))
+
+;; Run THUNKS concurrently, using the current thread for one of them.
+;; An error in any of them is reraised after all are done.
+(define (run-parallel thunks)
+  (unless (null? thunks)
+    (let* ([threads (map (^t (thread-start! (make-thread t))) (cdr thunks))]
+           [errors (filter-map
+                    (^[run] (guard (e [else (list e)]) (run) #f))
+                    (cons (car thunks)
+                          (map (^t (^[] (thread-join! t))) threads)))])
+      (unless (null? errors)
+        (let1 e (caar errors)
+          (raise (if (uncaught-exception? e)
+                   (uncaught-exception-reason e)
+                   e)))))))
@@ -36,7 +36,9 @@
   (use util.match)
   (extend gauche.internal)
   (export profiler-show profiler-get-result
-          profiler-show-load-stats with-profiler)
+          profiler-show-load-stats with-profiler
+          alloc-profiler-get-result alloc-profiler-show
+          alloc-profiler-write-flamegraph with-alloc-profiler)
   )
 (select-module gauche.vm.profiler)
 
@@ -129,6 +131,101 @@
     (profiler-reset)
     (apply values vals)))
 
+;;
+;; Allocation profiler
+;;
+
+;; Returns a portable representation of the current allocation profiler
+;; result, or #f if no data has been gathered.  It is a list:
+;;
+;;   (<total-count> <total-bytes> <sample> ...)
+;;
+;; <total-count> and <total-bytes> are the number of allocations and
+;; bytes while the profiler was running.  Each <sample> is
+;;
+;;   (<stack> <source> <class> <count> <bytes>)
+;;
+;; <stack> is a list of names of the code, outermost first; the last one
+;; is the code that allocated.  <source> is (<file> <line>) of the
+;; allocation site, or #f if unknown.  <class> is the name of the class
+;; of the allocated objects, or either block or atomic-block if unknown.
+;; <count> and <bytes> are the number of samples and their total size.
+(define (alloc-profiler-get-result)
+  ;; NB: this part depends on the result object of alloc-profiler-raw-result,
+  ;; which may be changed later.  Keep this in sync with src/prof.c.
+  (match (alloc-profiler-raw-result)
+    [(tab total-count total-bytes)
+     `(,total-count ,total-bytes
+       ,@(append-map
+          (match-lambda
+            [(code . entries)
+             (map (match-lambda
+                    [#(off klass callers count bytes)
+                     (list (reverse (map alloc-entry-name (cons code callers)))
+                           (alloc-site-source code off)
+                           (if (is-a? klass <class>) (class-name klass) klass)
+                           count bytes)])
+                  entries)])
+          (hash-table->alist tab)))]
+    [_ #f]))
+
+;;
+;; Show the allocation profiler result.
+;;
+;;  Keyword args:
+;;    :results  - a result returned by alloc-profiler-get-result.
+;;                If not given, the current result is used.
+;;    :sort-by  - either bytes or count
+;;    :max-rows - # of rows to be shown in each table.  #f to show everything.
+;;
+(define (alloc-profiler-show :key (results #f) (sort-by 'bytes) (max-rows 30))
+  (if-let1 r (or results (alloc-profiler-get-result))
+    (show-alloc-stats r sort-by max-rows)
+    (print "No allocation profiling data has been gathered.")))
+
+;;
+;; Write the allocation profiler result in the 'folded stacks' format,
+;; which can be fed to flamegraph.pl and compatible tools.  Each line
+;; consists of the semicolon-separated stack, with the class of the
+;; allocated object as the leaf, and the weight.
+;;
+;;  Keyword args:
+;;    :port     - output port.  Defaults to the current output port.
+;;    :results  - a result returned by alloc-profiler-get-result.
+;;    :weight   - either bytes or count
+;;
+(define (alloc-profiler-write-flamegraph :key (port (current-output-port))
+                                              (results #f) (weight 'bytes))
+  (define ht (make-hash-table 'equal?))
+  (define (frame-name obj)
+    (string-map (^c (if (or (char=? c #\;) (char-whitespace? c)) #\_ c))
+                (x->string obj)))
+  (unless (memq weight '(bytes count))
+    (error "weight argument must be either bytes or count, but got:" weight))
+  (match (or results (alloc-profiler-get-result))
+    [(_ _ . samples)
+     (dolist [s samples]
+       (match-let1 (stack _ klass count bytes) s
+         (hash-table-update! ht
+                             (string-join (map frame-name
+                                               `(,@stack ,klass))
+                                          ";")
+                             (cut + <> (if (eq? weight 'bytes) bytes count))
+                             0)))
+     (dolist [p (sort (hash-table->alist ht) string<? car)]
+       (format port "~a ~d\n" (car p) (cdr p)))]
+    [_ #f]))
+
+;; Convenience API
+(define (with-alloc-profiler thunk :key (interval 128) (bytes #f))
+  (receive vals (dynamic-wind
+                  (cut alloc-profiler-start :interval interval :bytes bytes)
+                  thunk
+                  alloc-profiler-stop)
+    (alloc-profiler-show)
+    (alloc-profiler-reset)
+    (apply values vals)))
+
 ;;;==========================================================
 ;;; Internal routines
 ;;;
@@ -197,3 +294,61 @@
     `(METHOD ,(~ obj'generic'name)
              ,(map class-name (~ obj'specializers)))]
    [else (write-to-string obj)]))
+
+;; Entry name for the allocation profiler.  The code base is #f if
+;; the allocation is done outside of VM (e.g. during initialization).
+(define (alloc-entry-name code)
+  (if code (entry-name code) '%native))
+
+(define (alloc-site-source code off)
+  (and code off
+       (and-let* ([src (%compiled-code-source-info code off)]
+                  [si (debug-source-info src)])
+         (list (car si) (cadr si)))))
+
+;; Show the allocation profile by site and by class
+(define (show-alloc-stats result sort-by max-rows)
+  (define sorter
+    (case sort-by
+      [(bytes) (^[a b] (or (> (caddr a) (caddr b))
+                           (and (= (caddr a) (caddr b))
+                                (> (cadr a) (cadr b)))))]
+      [(count) (^[a b] (or (> (cadr a) (cadr b))
+                           (and (= (cadr a) (cadr b))
+                                (> (caddr a) (caddr b)))))]
+      [else
+       (error "alloc-profiler-show: sort-by argument must be either bytes or count, but got:" sort-by)]))
+  ;; Returns ((<key> <count> <bytes>) ...)
+  (define (tally samples key-of)
+    (let1 ht (make-hash-table 'equal?)
+      (dolist [s samples]
+        (match-let1 (_ _ _ count bytes) s
+          (hash-table-update! ht (key-of s)
+                              (^p (list (+ (car p) count) (+ (cadr p) bytes)))
+                              '(0 0))))
+      (sort (hash-table-map ht cons) sorter)))
+  (define (site-name s)
+    (match-let1 (stack source . _) s
+      (if source
+        (format "~s (~a:~a)" (last stack) (car source) (cadr source))
+        (format "~s" (last stack)))))
+  (define (pct n total)
+    (if (zero? total) 0 (exact (round (* 100 (/ n total))))))
+
+  (match-let1 (total-count total-bytes . samples) result
+    (let ([num-samples (fold (^[s n] (+ n (list-ref s 3))) 0 samples)]
+          [sum-bytes (fold (^[s n] (+ n (list-ref s 4))) 0 samples)])
+      (define (show-table title rows)
+        (format #t "~50a ~13@a ~16@a\n" title "samples" "bytes")
+        (print (make-string 50 #\-) "+" (make-string 13 #\-)
+               "+" (make-string 16 #\-))
+        (dolist [row (if (integer? max-rows) (take* rows max-rows) rows)]
+          (match-let1 (name count bytes) row
+            (format #t "~50a ~7d(~3d%) ~10d(~3d%)\n"
+                    name count (pct count num-samples)
+                    bytes (pct bytes sum-bytes)))))
+      (print "Allocation statistics (total "total-count" allocations, "
+             total-bytes" bytes, "num-samples" samples)")
+      (show-table "Site" (tally samples site-name))
+      (newline)
+      (show-table "Class" (tally samples (^s (x->string (caddr s))))))))
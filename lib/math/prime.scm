@@ -40,7 +40,6 @@
   (use gauche.sequence)
   (use gauche.threads)
   (use data.sparse)
-  (use util.match)
   (export primes *primes* reset-primes
           small-prime? *small-prime-bound*
           miller-rabin-prime? bpsw-prime?
@@ -56,34 +55,16 @@
 ;; written by @cddddr.  Optimized by SK.  As of 0.9.4_pre2, it can generate
 ;; first 10^7 primes in 14sec on 2.4GHz Core2 machine.
 
-(define (take-first-term a0 d lower-bound)
-  (if (<= lower-bound a0)
-      a0
-      (+ a0 (* d (quotient (- lower-bound a0 (- d) 1) d)))))
 (define (->odd x)  (if (odd? x) x (+ x 1)))
 (define (->even x) (if (even? x) x (+ x 1)))
-(define-inline (integer->index x) (ash x -1))
 
 (define-constant *segment-size* (->even #e5e4))
 (define-constant *first-segment-start*
   (->odd (ceiling->exact (expt *segment-size* 0.6))))
 (define-constant *sieve-vec-size* (/ *segment-size* 2))
-(define-constant *sieve-filler* '#u8(0))
 
-;; sieve is a bytevector, representing a range of odd numbers.
-;; given odd number N in the range [start, end] (where start and end
-;; are both odd), (vector-ref bytevec (/ (- N start) 2)) is 0 if N
-;; is composite, 1 if not.
-(define (segment-sieve! bytevec start primes)
-  (let ([root (floor->exact (sqrt (+ start *segment-size* -1)))]
-        [start-index (integer->index start)])
-    (let sieve! ([ps (cdr primes)])
-      (match-let1 (p . qs) ps
-        (when (<= p root)
-          (let1 i (- (take-first-term (integer->index (* p p)) p start-index)
-                     start-index)
-            (u8vector-multi-copy! bytevec i p *sieve-filler*))
-          (sieve! qs))))))
+(define %prime-sieve-segment!
+  (with-module gauche.internal %prime-sieve-segment!))
 
 (define (bytevec->generator bytevec start)
   (let1 i 0
@@ -94,9 +75,14 @@
                   (+ (* j 2) start)]
                  [else (loop (+ j 1))])))))
 
-(define (segment-prime-generator start primes)
-  (let1 bytevec (make-u8vector *sieve-vec-size* 1)
-    (segment-sieve! bytevec start primes)
+;; sieve is a bytevector, representing a range of odd numbers.
+;; given odd number N in the range [start, end] (where start and end
+;; are both odd), (vector-ref bytevec (/ (- N start) 2)) is 0 if N
+;; is composite, 1 if not.  sieve-primes is a u32vector of odd primes
+;; that covers the square root of end.
+(define (segment-prime-generator start sieve-primes)
+  (let1 bytevec (make-u8vector *sieve-vec-size*)
+    (%prime-sieve-segment! bytevec start sieve-primes)
     (bytevec->generator bytevec start)))
 
 ;; Head of prime sequence.  We don't make it a generator,
@@ -113,11 +99,24 @@
 (define (primes)
   (define start *first-segment-start*)
   (define gen (list->generator (force *small-primes*)))
+  ;; Odd primes up to sieve-bound, passed to the sieve.  We take them
+  ;; from prime-lseq, in which only the primes below start are realized.
+  ;; Since start/2 < p < start for some prime p, taking primes up to
+  ;; start/2 doesn't force unrealized elements.
+  (define sieve-primes '#u32())
+  (define sieve-bound 0)
   (define (gen-primes)
     (let loop ([v (gen)])
       (if (eof-object? v)
-        (begin
-          (set! gen (segment-prime-generator start prime-lseq))
+        (let1 root (floor->exact (sqrt (+ start *segment-size* -1)))
+          (when (< sieve-bound root)
+            (set! sieve-bound (min (* root 2) (quotient start 2)))
+            (set! sieve-primes
+                  (let loop ([ps (cdr prime-lseq)] [r '()])
+                    (if (<= (car ps) sieve-bound)
+                      (loop (cdr ps) (cons (car ps) r))
+                      (list->u32vector (reverse! r))))))
+          (set! gen (segment-prime-generator start sieve-primes))
           (inc! start *segment-size*)
           (loop (gen)))
         v)))
@@ -140,19 +139,14 @@
 ;; n is the number to be tested, a is the chosen base.
 ;; returns #f if n is composite.
 (define (miller-rabin-test a n)
-  (let* ([n-1 (- n 1)]
-         [s (twos-exponent-factor n-1)]
-         [d (ash n-1 (- s))]
-         [a^d (expt-mod a d n)])
-    (or (= a^d 1)
-        (let loop ([i 0] [a^d a^d])
-          (cond [(= i s) #f]
-                [(= a^d n-1) #t]
-                [else (loop (+ i 1) (expt-mod a^d 2 n))])))))
+  ((with-module gauche.internal %strong-prp?) n a))
 
 ;; For small integers, determinisitc Miller-Rabin is known.
 ;; Selfridge&Wagstaff  doi:10.2307/2006210
 ;; Jaeschke doi:10.2307/2153262
+;; The last entry, covering all n below 2^64, is due to Jim Sinclair (2011).
+;; Its bases can be multiples of n; such a base is reduced to 0 modulo n
+;; and the test passes vacuously, as it should.
 (define *deterministic-witnesses*
   ;; ((bound a ...) ...)
   ;; If the number to test is less than bound, we only need to test with a ...
@@ -161,7 +155,8 @@
     (4759123141 2 7 61)
     (2152302898747 2 3 5 7 11)
     (3474749660383 2 3 5 7 11 13)
-    (341550071728321 2 3 5 7 11 13 17)))
+    (341550071728321 2 3 5 7 11 13 17)
+    (18446744073709551616 2 325 9375 28178 450775 9780504 1795265022)))
 
 (define *small-prime-bound*
   (car (last *deterministic-witnesses*)))
@@ -241,47 +236,6 @@
       (* s d)
       (loop (+ d 2) (- s)))))
 
-;; Strong Lucas-Selfridge test
-(define (lucas-selfridge-test n P Q)
-
-  ;; calculate U_d, V_d and Q^d mod n.  (d is such that n = d * 2^s)
-  (define (calculate-UV n P Q D d)
-    (let1 dsize (integer-length d)
-      (let loop ([U 1] [V P] [U_2^m 1] [V_2^m P] [Q_m Q] [Q^d Q] [bit 1])
-        (if (= bit dsize)
-          (values U V Q^d)
-          (let ([U_2^m_1 (modulo (* U_2^m V_2^m) n)]
-                [V_2^m_1 (modulo (- (* V_2^m V_2^m) (* 2 Q_m)) n)]
-                [Q_m_1   (modulo (* Q_m Q_m) n)])
-            (if (not (logbit? bit d))
-              (loop U V U_2^m_1 V_2^m_1 Q_m_1 Q^d (+ bit 1))
-              (let ([U (half-modn (+ (* U_2^m_1 V) (* U V_2^m_1)))]
-                    [V (half-modn (+ (* V_2^m_1 V) (* D U U_2^m_1)))]
-                    [Q^d (modulo (* Q^d Q_m_1) n)])
-                (loop U V U_2^m_1 V_2^m_1 Q_m_1 Q^d (+ bit 1)))))))))
-
-  ;; divide by 2 modulo n; we know n is odd
-  (define (half-modn x)
-    (if (odd? x)
-      (modulo (ash (+ x n) -1) n)
-      (modulo (ash x -1) n)))
-
-  (let* ([n+1 (+ n 1)]
-         [s   (twos-exponent-factor n+1)]
-         [d   (ash n+1 (- s))]
-         [D   (bpsw-find-D n)]
-         [P   1]
-         [Q   (/ (- 1 D) 4)])
-    (receive (U V Q^d) (calculate-UV n P Q D d)
-      (or (zero? U)
-          (zero? V)
-          (let loop ([r 1] [V V] [Q^d Q^d])
-            (if (>= r s)
-              #f
-              (let1 V (modulo (- (* V V) (* 2 Q^d)) n)
-                (or (zero? V)
-                    (loop (+ r 1) V (modulo (* Q^d Q^d) n))))))))))
-
 ;; API
 (define (bpsw-prime? n)
   (cond [(< n 2) #f]
@@ -294,7 +248,8 @@
             [(< n 1000000) #t] ; we know it's prime
             [(not (miller-rabin-test 2 n)) #f]
             [(zero? (values-ref (exact-integer-sqrt n) 1)) #f] ;perfect square
-            [else (lucas-selfridge-test n 1 (/ (- 1 (bpsw-find-D n)) 4))]))]))
+            [else ((with-module gauche.internal %strong-lucas-prp?)
+                   n (bpsw-find-D n))]))]))
 
 ;;;
 ;;; Factorization
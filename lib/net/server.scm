@@ -0,0 +1,323 @@
+;;;
+;;; net.server - multi-process/multi-thread socket server
+;;;
+;;;   Copyright (c) 2026  Shiro Kawai  <shiro@acm.org>
+;;;
+;;;   Redistribution and use in source and binary forms, with or without
+;;;   modification, are permitted provided that the following conditions
+;;;   are met:
+;;;
+;;;   1. Redistributions of source code must retain the above copyright
+;;;      notice, this list of conditions and the following disclaimer.
+;;;
+;;;   2. Redistributions in binary form must reproduce the above copyright
+;;;      notice, this list of conditions and the following disclaimer in the
+;;;      documentation and/or other materials provided with the distribution.
+;;;
+;;;   3. Neither the name of the authors nor the names of its contributors
+;;;      may be used to endorse or promote products derived from this
+;;;      software without specific prior written permission.
+;;;
+;;;   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+;;;   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+;;;   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+;;;   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+;;;   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+;;;   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+;;;   TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+;;;   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+;;;   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+;;;   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+;;;   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+;;;
+
+;; A server runs a number of workers, each of which has its own
+;; listening sockets and its own fiber scheduler (see control.fiber),
+;; whose reactor thread is the per-worker event loop.  Each accepted
+;; connection is served by a fiber calling the handler.
+;;
+;; If the platform has SO_REUSEPORT, every worker binds its own socket
+;; to the same port and the kernel distributes connections among them.
+;; Otherwise, the sockets bound at startup are shared by all workers.
+;;
+;; In prefork mode, workers are child processes.  The master process
+;; restarts a worker that dies, replaces all workers on SIGHUP (new ones
+;; are started before the old ones are told to finish), and shuts down
+;; on SIGTERM or SIGINT.  A worker told to finish stops accepting, and
+;; waits for the connections being served for the grace period.
+;; In threads mode, workers are threads in the current process.
+
+(define-module net.server
+  (use gauche.net)
+  (use gauche.threads)
+  (use gauche.fcntl)
+  (use control.fiber)
+  (use scheme.list)
+  (export <server> make-server server? server-run! server-stop!
+          server-restart! server-ports run-server))
+(select-module net.server)
+
+;; These may not be available on all platforms.
+(define SO_REUSEPORT* (module-binding-ref 'gauche.net 'SO_REUSEPORT #f))
+(define SOMAXCONN*    (module-binding-ref 'gauche.net 'SOMAXCONN 128))
+
+(define-constant *poll-interval* 100000000) ; nanoseconds
+(define-constant *accept-backoff* 0.1)      ; seconds
+
+(define-record-type <server> %make-server server?
+  (handler      server-handler)
+  (host         server-host)
+  (port         server-port)
+  (mode         server-mode)            ; prefork or threads
+  (workers      server-workers)
+  (carriers     server-carriers)
+  (reuse-port?  server-reuse-port?)
+  (backlog      server-backlog)
+  (accept-batch server-accept-batch)
+  (grace-period server-grace-period)
+  (worker-init  server-worker-init)
+  (listeners    server-listeners server-listeners-set!) ; bound at startup
+  (addresses    server-addresses server-addresses-set!)
+  (request      server-request server-request-set!))    ; #f, restart or stop
+
+(define (make-server handler :key (host #f) (port 8080)
+                                  (mode (cond-expand
+                                         [gauche.os.windows 'threads]
+                                         [else 'prefork]))
+                                  (workers (sys-available-processors))
+                                  (carriers 1)
+                                  (reuse-port #t)
+                                  (backlog SOMAXCONN*)
+                                  (accept-batch 64)
+                                  (grace-period 30)
+                                  (worker-init #f))
+  (unless (memq mode '(prefork threads))
+    (error "mode must be either prefork or threads, but got:" mode))
+  (%make-server handler host port mode workers carriers
+                (and reuse-port SO_REUSEPORT* #t)
+                backlog accept-batch grace-period worker-init
+                #f #f #f))
+
+;; Returns the list of port numbers the server listens to.  Useful when
+;; the server is created with port 0, after it is started.
+(define (server-ports server)
+  (map sockaddr-port
+       (or (server-addresses server)
+           (error "server isn't started yet:" server))))
+
+(define (server-stop! server)    (server-request-set! server 'stop))
+(define (server-restart! server) (server-request-set! server 'restart))
+
+;; Runs the server until it is stopped.
+(define (server-run! server)
+  (let1 ls (open-listeners server #f)
+    (server-listeners-set! server ls)
+    (server-addresses-set! server (map socket-getsockname ls)))
+  (unwind-protect
+      (ecase (server-mode server)
+        [(prefork) (run-prefork server)]
+        [(threads) (run-threads server)])
+    (unless (server-reuse-port? server)
+      (for-each socket-close (server-listeners server)))))
+
+(define (run-server handler . args)
+  (server-run! (apply make-server handler args)))
+
+;;;
+;;; Listeners
+;;;
+
+;; If ADDRS is #f, binds to the host and port given to the server.
+;; Otherwise, binds to each of ADDRS.
+(define (open-listeners server addrs)
+  (define (init s _)
+    (when (server-reuse-port? server)
+      (socket-setsockopt s SOL_SOCKET SO_REUSEPORT* 1)))
+  (define opts `(:reuse-addr? #t :sock-init ,init
+                 :backlog ,(server-backlog server)))
+  (rlet1 ls (if addrs
+              (map (^a (apply make-server-socket a opts)) addrs)
+              (apply make-server-sockets (server-host server)
+                     (server-port server) opts))
+    (for-each set-nonblocking! ls)))
+
+;; Listeners for a new worker.  The first worker takes over the sockets
+;; bound at startup.
+(define (worker-listeners server first?)
+  (if (and (server-reuse-port? server) (not first?))
+    (open-listeners server (server-addresses server))
+    (server-listeners server)))
+
+(define (set-nonblocking! sock)
+  (let1 fd (socket-fd sock)
+    (sys-fcntl fd F_SETFL (logior (sys-fcntl fd F_GETFL) O_NONBLOCK))))
+
+;; Accepted sockets may inherit O_NONBLOCK on some systems, but handlers
+;; expect blocking ports.
+(define (set-blocking! sock)
+  (let1 fd (socket-fd sock)
+    (sys-fcntl fd F_SETFL (logand (sys-fcntl fd F_GETFL) (lognot O_NONBLOCK)))))
+
+;;;
+;;; Worker
+;;;
+
+;; Serves connections on LISTENERS until the atom STOPPING becomes true.
+;; Then waits for the connections being served, up to the grace period.
+(define (run-worker server listeners stopping)
+  (let ([sched (make-fiber-scheduler :num-carriers (server-carriers server))]
+        [active (atom 0)])
+    (let1 acceptors
+        (map (^l (spawn-fiber (^[] (accept-loop server l sched active stopping))
+                              :scheduler sched))
+             listeners)
+      (until (atom-ref stopping) (sys-nanosleep *poll-interval*))
+      (for-each fiber-join acceptors))
+    ;; With SO_REUSEPORT, connections queued on our sockets are reset
+    ;; when we close them, so we take them before closing.
+    (when (server-reuse-port? server)
+      (dolist [l listeners]
+        (let loop ()
+          (when (eq? (accept-one server l sched active) #t) (loop)))
+        (socket-close l)))
+    (let1 deadline (+ (sys-time) (server-grace-period server))
+      (until (or (zero? (atom-ref active)) (> (sys-time) deadline))
+        (sys-nanosleep *poll-interval*)))
+    (fiber-scheduler-shutdown! sched)))
+
+;; Accepts up to accept-batch connections each time the listener
+;; becomes readable.  We wake up periodically to check STOPPING.
+(define (accept-loop server listener sched active stopping)
+  (let ([fd (socket-fd listener)]
+        [batch (server-accept-batch server)])
+    (let loop ()
+      (unless (atom-ref stopping)
+        (when (fiber-wait-readable fd 0.5)
+          (let accept ([k 0])
+            (when (< k batch)
+              (case (accept-one server listener sched active)
+                [(#t) (accept (+ k 1))]
+                ;; The listener stays readable, so we'd spin if we went
+                ;; back to wait right away.
+                [(exhausted) (fiber-sleep *accept-backoff*)]
+                [else #f]))))
+        (loop)))))
+
+;; Accepts a connection if there's one, and starts serving it.
+;; Returns #t if accepted, #f if there's none, or exhausted if we can't
+;; accept for the lack of descriptors or memory; the connection remains
+;; in the queue then.  Other errors are raised.
+(define (accept-one server listener sched active)
+  (let1 conn (guard (e [(and (<system-error> e)
+                             (memq (sys-errno->symbol (condition-ref e 'errno))
+                                   '(EINTR EAGAIN EWOULDBLOCK ECONNABORTED
+                                     EPROTO)))
+                        #f]
+                       [(and (<system-error> e)
+                             (memq (sys-errno->symbol (condition-ref e 'errno))
+                                   '(EMFILE ENFILE ENOBUFS ENOMEM)))
+                        'exhausted])
+               (socket-accept listener))
+    (if (is-a? conn <socket>)
+      (begin
+        (set-blocking! conn)
+        (atomic-update! active (cut + <> 1))
+        (spawn-fiber (^[] (serve (server-handler server) conn active))
+                     :scheduler sched)
+        #t)
+      conn)))
+
+(define (serve handler conn active)
+  (unwind-protect
+      (guard (e [else (report-error e)])
+        (handler conn))
+    (socket-close conn)
+    (atomic-update! active (cut - <> 1))))
+
+;;;
+;;; Threads mode
+;;;
+
+(define (run-threads server)
+  (let* ([stopping (atom #f)]
+         [lsets (list-tabulate (server-workers server)
+                               (^i (worker-listeners server (= i 0))))]
+         [threads (map (^[ls]
+                         (thread-start!
+                          (make-thread (^[] (run-worker server ls stopping)))))
+                       lsets)])
+    (with-signal-handlers ([(list SIGTERM SIGINT) (server-stop! server)])
+      (^[]
+        (until (eq? (server-request server) 'stop)
+          (sys-nanosleep *poll-interval*))))
+    (atomic-update! stopping (^_ #t))
+    (for-each thread-join! threads)))
+
+;;;
+;;; Prefork mode
+;;;
+
+(define (run-prefork server)
+  (let ([children (make-hash-table eqv-comparator)] ; pid -> generation
+        [generation 0]
+        [stopping? #f])
+    (define (spawn! first?)
+      (let* ([ls (worker-listeners server first?)]
+             [pid (sys-fork)])
+        (when (zero? pid) (run-child server ls))
+        (hash-table-put! children pid generation)
+        ;; The child has its own sockets now.
+        (when (server-reuse-port? server) (for-each socket-close ls))))
+    (define (reap!)
+      (unless (zero? (hash-table-num-entries children))
+        (receive (pid _) (sys-waitpid -1 :nohang #t)
+          (when (and pid (> pid 0))
+            (let1 gen (hash-table-get children pid #f)
+              (hash-table-delete! children pid)
+              ;; A current worker died unexpectedly.  Avoid spinning
+              ;; if it keeps dying right away.
+              (when (and (eqv? gen generation) (not stopping?))
+                (sys-nanosleep *poll-interval*)
+                (spawn! #f)))
+            (reap!)))))
+    (define (terminate! pids)
+      (dolist [pid pids]
+        (guard (e [(<system-error> e) #f]) (sys-kill pid SIGTERM))))
+
+    (with-signal-handlers ([SIGHUP (server-restart! server)]
+                           [(list SIGTERM SIGINT) (server-stop! server)])
+      (^[]
+        (dotimes [i (server-workers server)] (spawn! (= i 0)))
+        (let loop ()
+          (reap!)
+          (case (server-request server)
+            [(restart)
+             (server-request-set! server #f)
+             (let1 old (hash-table-keys children)
+               (inc! generation)
+               (dotimes [_ (server-workers server)] (spawn! #f))
+               (terminate! old))
+             (loop)]
+            [(stop)
+             (set! stopping? #t)
+             (terminate! (hash-table-keys children))
+             (let1 deadline (+ (sys-time) (server-grace-period server) 1)
+               (until (zero? (hash-table-num-entries children))
+                 (when (> (sys-time) deadline)
+                   (dolist [pid (hash-table-keys children)]
+                     (guard (e [(<system-error> e) #f])
+                       (sys-kill pid SIGKILL))))
+                 (sys-nanosleep *poll-interval*)
+                 (reap!)))]
+            [else (sys-nanosleep *poll-interval*) (loop)]))))))
+
+;; Never returns.
+(define (run-child server listeners)
+  (let1 stopping (atom #f)
+    (set-signal-handler! SIGHUP #f)
+    (dolist [sig (list SIGTERM SIGINT)]
+      (set-signal-handler! sig (^_ (atomic-update! stopping (^_ #t)))))
+    (guard (e [else (report-error e) (sys-exit 1)])
+      (and-let1 init (server-worker-init server) (init))
+      (run-worker server listeners stopping))
+    (sys-exit 0)))
@@ -129,7 +129,9 @@
           debug-thread-pre debug-thread-post)
 
 (autoload gauche.vm.profiler
-          profiler-show profiler-show-load-stats with-profiler)
+          profiler-show profiler-show-load-stats with-profiler
+          alloc-profiler-show alloc-profiler-write-flamegraph
+          with-alloc-profiler)
 
 (autoload gauche.vm.debug-info decode-debug-info)
 
@@ -191,6 +193,8 @@
                                   %generic-sort
                                   %generic-sort!)
 
+(autoload gauche.parallel-sortutil %parallel-sort!)
+
 (autoload gauche.pputil   %pretty-print pprint)
 
 (autoload gauche.version-alist version-alist)
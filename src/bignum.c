@@ -767,8 +767,629 @@ static ScmBignum *bignum_lshift(ScmBignum *br, const ScmBignum *bx, int amount)
 
 /*-----------------------------------------------------------------------
  * Multiplication
+ *
+ *   Multiplication of bignums is dispatched by the operand size:
+ *
+ *     - schoolbook, O(n^2), for small numbers;
+ *     - Karatsuba, O(n^1.585);
+ *     - Toom-3, O(n^1.465);
+ *     - number theoretic transform (NTT), O(n log n), for huge numbers.
+ *
+ *   The routines below work on raw word arrays, least significant word
+ *   first, so that the recursive algorithms can operate on parts of the
+ *   operands without creating bignums.  Squaring is recognized by the
+ *   identity of the operand arrays, and takes cheaper paths at every
+ *   level.
+ *
+ *   The thresholds are in words, and are tuned on x86_64.  The benchmark
+ *   in test/bignum-performance.scm shows the crossover points.
+ */
+
+#define KARATSUBA_THRESHOLD   48
+#define TOOM3_THRESHOLD       800
+#define NTT_THRESHOLD         3000
+
+/* Largest NTT size (log2 of # of 16-bit pieces); see words_mul_ntt. */
+#define NTT_MAX_LOG           24
+
+static void words_mul_n(u_long *r, const u_long *a, const u_long *b, int n);
+
+/* r[0..n) = a[0..n) + b[0..n); returns carry.  r can be a or b. */
+static u_long words_add_n(u_long *r, const u_long *a, const u_long *b, int n)
+{
+    u_long c = 0;
+    for (int i=0; i<n; i++) {
+        u_long x = a[i], y = b[i];
+        UADD(r[i], c, x, y);
+    }
+    return c;
+}
+
+/* r[0..n) = a[0..n) - b[0..n); returns borrow.  r can be a or b. */
+static u_long words_sub_n(u_long *r, const u_long *a, const u_long *b, int n)
+{
+    u_long c = 0;
+    for (int i=0; i<n; i++) {
+        u_long x = a[i], y = b[i];
+        USUB(r[i], c, x, y);
+    }
+    return c;
+}
+
+/* r[0..an) = a[0..an) + b[0..bn), an >= bn; returns carry. */
+static u_long words_add(u_long *r, const u_long *a, int an,
+                        const u_long *b, int bn)
+{
+    u_long c = words_add_n(r, a, b, bn);
+    for (int i=bn; i<an; i++) {
+        u_long x = a[i];
+        UADD(r[i], c, x, 0);
+    }
+    return c;
+}
+
+/* r[0..n) += a[0..an), an <= n; returns carry out of r[n-1]. */
+static u_long words_add_to(u_long *r, int n, const u_long *a, int an)
+{
+    u_long c = words_add_n(r, r, a, an);
+    for (int i=an; c && i<n; i++) {
+        u_long x = r[i];
+        UADD(r[i], c, x, 0);
+    }
+    return c;
+}
+
+/* r[0..n) -= a[0..an), an <= n; returns borrow out of r[n-1]. */
+static u_long words_sub_from(u_long *r, int n, const u_long *a, int an)
+{
+    u_long c = words_sub_n(r, r, a, an);
+    for (int i=an; c && i<n; i++) {
+        u_long x = r[i];
+        USUB(r[i], c, x, 0);
+    }
+    return c;
+}
+
+static int words_cmp(const u_long *a, const u_long *b, int n)
+{
+    for (int i=n-1; i>=0; i--) {
+        if (a[i] != b[i]) return (a[i] > b[i])? 1 : -1;
+    }
+    return 0;
+}
+
+static void words_clear(u_long *r, int n)
+{
+    for (int i=0; i<n; i++) r[i] = 0;
+}
+
+/* r[0..an+bn) = a[0..an) * b[0..bn).  r must not overlap a or b. */
+static void words_mul_basecase(u_long *r, const u_long *a, int an,
+                               const u_long *b, int bn)
+{
+    words_clear(r, an);
+    for (int j=0; j<bn; j++) {
+        u_long y = b[j], carry = 0;
+        if (y != 0) {
+            for (int i=0; i<an; i++) {
+                u_long hi, lo, s, t = r[i+j], x = a[i], c = 0;
+                UMUL(hi, lo, x, y);
+                UADD(s, c, lo, carry);
+                hi += c;
+                c = 0;
+                UADD(lo, c, s, t);
+                r[i+j] = lo;
+                carry = hi + c;
+            }
+        }
+        r[j+an] = carry;
+    }
+}
+
+/* r[0..2n) = a[0..n)^2.  r must not overlap a.
+   Computes the cross products a[i]*a[j] (i<j) once, doubles them, and
+   adds the diagonal a[i]^2. */
+static void words_sqr_basecase(u_long *r, const u_long *a, int n)
+{
+    words_clear(r, 2*n);
+    for (int i=0; i<n-1; i++) {
+        u_long y = a[i], carry = 0;
+        if (y == 0) continue;
+        for (int j=i+1; j<n; j++) {
+            u_long hi, lo, s, t = r[i+j], x = a[j], c = 0;
+            UMUL(hi, lo, x, y);
+            UADD(s, c, lo, carry);
+            hi += c;
+            c = 0;
+            UADD(lo, c, s, t);
+            r[i+j] = lo;
+            carry = hi + c;
+        }
+        r[i+n] = carry;
+    }
+    for (int i=2*n-1; i>0; i--) {
+        r[i] = (r[i]<<1) | (r[i-1]>>(WORD_BITS-1));
+    }
+    r[0] <<= 1;
+
+    u_long c = 0;
+    for (int i=0; i<n; i++) {
+        u_long hi, lo, s, x = a[i], t0 = r[2*i], t1 = r[2*i+1];
+        UMUL(hi, lo, x, x);
+        UADD(s, c, t0, lo);
+        r[2*i] = s;
+        UADD(s, c, t1, hi);
+        r[2*i+1] = s;
+    }
+}
+
+/*
+ * Karatsuba
+ *
+ *   a = a1*B^k + a0, b = b1*B^k + b0, where a0 and b0 have k words.
+ *   a*b = z2*B^2k + (z1 - z2 - z0)*B^k + z0
+ *   where z0 = a0*b0, z2 = a1*b1, z1 = (a0+a1)*(b0+b1).
+ */
+
+/* The size of the work space words_mul_karatsuba needs for size n. */
+static int karatsuba_ws_size(int n)
+{
+    int h = n - n/2;
+    return 4*h + 4
+        + ((h+1 >= KARATSUBA_THRESHOLD)? karatsuba_ws_size(h+1) : 0);
+}
+
+static void words_mul_karatsuba(u_long *r, const u_long *a, const u_long *b,
+                                int n, u_long *ws);
+
+static void karatsuba_sub(u_long *r, const u_long *a, const u_long *b,
+                          int n, u_long *ws)
+{
+    if (n >= KARATSUBA_THRESHOLD) {
+        words_mul_karatsuba(r, a, b, n, ws);
+    } else if (a == b) {
+        words_sqr_basecase(r, a, n);
+    } else {
+        words_mul_basecase(r, a, n, b, n);
+    }
+}
+
+/* r[0..2n) = a[0..n) * b[0..n), n >= 2.  If a == b, squares.
+   ws must have karatsuba_ws_size(n) words. */
+static void words_mul_karatsuba(u_long *r, const u_long *a, const u_long *b,
+                                int n, u_long *ws)
+{
+    int k = n/2, h = n - k;
+    u_long *sa = ws, *sb = ws + h + 1, *t = ws + 2*h + 2;
+    u_long *ws2 = ws + 4*h + 4;
+
+    karatsuba_sub(r, a, b, k, ws2);
+    karatsuba_sub(r + 2*k, a + k, b + k, h, ws2);
+
+    sa[h] = words_add(sa, a + k, h, a, k);
+    if (a == b) {
+        karatsuba_sub(t, sa, sa, h+1, ws2);
+    } else {
+        sb[h] = words_add(sb, b + k, h, b, k);
+        karatsuba_sub(t, sa, sb, h+1, ws2);
+    }
+    words_sub_from(t, 2*h+2, r, 2*k);
+    words_sub_from(t, 2*h+2, r + 2*k, 2*h);
+
+    int tn = min(2*h+2, 2*n-k);
+    words_add_to(r + k, 2*n-k, t, tn);
+}
+
+/*
+ * Toom-3
+ *
+ *   Splits the operands into three parts and evaluates the polynomials
+ *   at 0, 1, -1, -2 and infinity.  The interpolation follows Bodrato's
+ *   sequence.  The signed intermediate values are kept in two's
+ *   complement in buffers of 2k+3 words, which is large enough to hold
+ *   any of them.
  */
 
+/* r[0..n) = |x - y| for n-word numbers.  Returns TRUE if x < y. */
+static int words_abs_diff(u_long *r, const u_long *x, const u_long *y, int n)
+{
+    if (words_cmp(x, y, n) >= 0) {
+        words_sub_n(r, x, y, n);
+        return FALSE;
+    } else {
+        words_sub_n(r, y, x, n);
+        return TRUE;
+    }
+}
+
+/* Two's complement negation of r[0..n). */
+static void words_negate(u_long *r, int n)
+{
+    u_long c = 1;
+    for (int i=0; i<n; i++) {
+        u_long x = ~r[i];
+        UADD(r[i], c, x, 0);
+    }
+}
+
+/* r[0..n) /= 3, assuming the division is exact.  Works for two's
+   complement negative numbers as well. */
+static void words_divexact_by3(u_long *r, int n)
+{
+    const u_long inv3 = (SCM_ULONG_MAX/3)*2 + 1; /* 3*inv3 == 1 mod B */
+    u_long borrow = 0, three = 3;
+    for (int i=0; i<n; i++) {
+        u_long x = r[i];
+        u_long s = x - borrow;
+        u_long q = s * inv3;
+        u_long hi, lo;
+        UMUL(hi, lo, q, three);
+        (void)lo;                   /* lo == s */
+        r[i] = q;
+        borrow = hi + (x < borrow);
+    }
+}
+
+/* Arithmetic shift right by 1 of two's complement r[0..n). */
+static void words_rshift1_signed(u_long *r, int n)
+{
+    for (int i=0; i<n-1; i++) {
+        r[i] = (r[i]>>1) | (r[i+1]<<(WORD_BITS-1));
+    }
+    r[n-1] = (r[n-1]>>1) | (r[n-1] & (1UL<<(WORD_BITS-1)));
+}
+
+/* Evaluates x = x2*B^2k + x1*B^k + x0 at 1, -1 and -2.
+   e1, em1, em2 get k+1 words each; returns the signs of the latter two
+   in *nm1, *nm2 (TRUE if negative).  tmp needs 2k+2 words. */
+static void toom3_eval(const u_long *x, int k, int k2,
+                       u_long *e1, u_long *em1, int *nm1,
+                       u_long *em2, int *nm2, u_long *tmp)
+{
+    const u_long *x0 = x, *x1 = x + k, *x2 = x + 2*k;
+    u_long *t = tmp, *u = tmp + k + 1;
+
+    /* t = x0 + x2, e1 = t + x1, em1 = t - x1 */
+    t[k] = words_add(t, x0, k, x2, k2);
+    for (int i=0; i<k; i++) u[i] = x1[i];
+    u[k] = 0;
+    e1[k] = t[k] + words_add_n(e1, t, u, k);
+    *nm1 = words_abs_diff(em1, t, u, k+1);
+
+    /* em2 = (x0 + 4*x2) - 2*x1 */
+    for (int i=0; i<k2; i++) {
+        t[i] = (x2[i]<<2) | ((i > 0)? (x2[i-1]>>(WORD_BITS-2)) : 0);
+    }
+    t[k2] = x2[k2-1]>>(WORD_BITS-2);
+    for (int i=k2+1; i<=k; i++) t[i] = 0;
+    words_add_to(t, k+1, x0, k);
+    u[k] = x1[k-1]>>(WORD_BITS-1);
+    for (int i=k-1; i>0; i--) u[i] = (x1[i]<<1) | (x1[i-1]>>(WORD_BITS-1));
+    u[0] = x1[0]<<1;
+    *nm2 = words_abs_diff(em2, t, u, k+1);
+}
+
+/* r[0..2n) = a[0..n) * b[0..n), n >= 5.  If a == b, squares. */
+static void words_mul_toom3(u_long *r, const u_long *a, const u_long *b,
+                            int n)
+{
+    int k = (n+2)/3, k2 = n - 2*k;   /* 0 < k2 <= k */
+    int m = 2*k + 3;
+    int sq = (a == b);
+    u_long *ws = SCM_NEW_ATOMIC_ARRAY(u_long, 8*(k+1) + 3*m);
+    u_long *ea1 = ws, *eam1 = ea1 + k+1, *eam2 = eam1 + k+1;
+    u_long *eb1 = eam2 + k+1, *ebm1 = eb1 + k+1, *ebm2 = ebm1 + k+1;
+    u_long *tmp = ebm2 + k+1;
+    u_long *w1 = tmp + 2*k+2, *wm1 = w1 + m, *wm2 = wm1 + m;
+    u_long *w0 = r, *winf = r + 4*k;
+    int nam1, nam2, nbm1, nbm2;
+
+    toom3_eval(a, k, k2, ea1, eam1, &nam1, eam2, &nam2, tmp);
+    if (sq) {
+        eb1 = ea1; ebm1 = eam1; ebm2 = eam2;
+        nbm1 = nam1; nbm2 = nam2;
+    } else {
+        toom3_eval(b, k, k2, eb1, ebm1, &nbm1, ebm2, &nbm2, tmp);
+    }
+
+    /* pointwise products */
+    words_mul_n(w0, a, b, k);
+    words_clear(r + 2*k, 2*k);
+    words_mul_n(winf, a + 2*k, b + 2*k, k2);
+    words_mul_n(w1, ea1, eb1, k+1);
+    w1[m-1] = 0;
+    words_mul_n(wm1, eam1, ebm1, k+1);
+    wm1[m-1] = 0;
+    if (nam1 != nbm1) words_negate(wm1, m);
+    words_mul_n(wm2, eam2, ebm2, k+1);
+    wm2[m-1] = 0;
+    if (nam2 != nbm2) words_negate(wm2, m);
+
+    /* interpolation; wm2 becomes r3, w1 becomes r1, wm1 becomes r2 */
+    words_sub_n(wm2, wm2, w1, m);           /* r3 = (W(-2) - W(1))/3 */
+    words_divexact_by3(wm2, m);
+    words_sub_n(w1, w1, wm1, m);            /* r1 = (W(1) - W(-1))/2 */
+    words_rshift1_signed(w1, m);
+    words_sub_from(wm1, m, w0, 2*k);        /* r2 = W(-1) - W(0) */
+    words_sub_n(wm2, wm1, wm2, m);          /* r3 = (r2 - r3)/2 + 2W(inf) */
+    words_rshift1_signed(wm2, m);
+    words_add_to(wm2, m, winf, 2*k2);
+    words_add_to(wm2, m, winf, 2*k2);
+    words_add_n(wm1, wm1, w1, m);           /* r2 = r2 + r1 - W(inf) */
+    words_sub_from(wm1, m, winf, 2*k2);
+    words_sub_n(w1, w1, wm2, m);            /* r1 = r1 - r3 */
+
+    /* recomposition */
+    words_add_to(r + k,   2*n - k,   w1,  min(m, 2*n - k));
+    words_add_to(r + 2*k, 2*n - 2*k, wm1, min(m, 2*n - 2*k));
+    words_add_to(r + 3*k, 2*n - 3*k, wm2, min(m, 2*n - 3*k));
+}
+
+/*
+ * Number theoretic transform
+ *
+ *   The operands are split into 16-bit pieces, and convolved by NTT
+ *   modulo two primes p1 = 7*2^26+1 and p2 = 5*2^25+1.  Each coefficient
+ *   of the convolution is less than N/2 * 2^32 <= 2^55 for the transform
+ *   size N <= 2^24, which is less than p1*p2, so it is recovered exactly
+ *   by CRT.
+ *
+ *   Modular multiplication uses Montgomery reduction with R = 2^32.
+ *   The data are kept in the normal representation, while the twiddle
+ *   factors are in the Montgomery representation, so that a Montgomery
+ *   multiplication of the two yields the normal product.
+ */
+
+typedef struct ntt_prime_rec {
+    uint32_t p;
+    uint32_t g;                 /* primitive root */
+} ntt_prime;
+
+static const ntt_prime ntt_primes[2] = {
+    { 469762049, 3 },           /* 7*2^26+1 */
+    { 167772161, 3 },           /* 5*2^25+1 */
+};
+
+/* a*b*2^-32 mod p, where pinv = -p^-1 mod 2^32 */
+static inline uint32_t ntt_mulmod(uint32_t a, uint32_t b,
+                                  uint32_t p, uint32_t pinv)
+{
+    uint64_t t = (uint64_t)a * b;
+    uint32_t q = (uint32_t)t * pinv;
+    uint32_t u = (uint32_t)((t + (uint64_t)q * p) >> 32);
+    return (u >= p)? u - p : u;
+}
+
+static uint32_t ntt_powmod(uint32_t x, uint64_t e, uint32_t p)
+{
+    uint64_t r = 1, y = x;
+    for (; e; e >>= 1) {
+        if (e & 1) r = r * y % p;
+        y = y * y % p;
+    }
+    return (uint32_t)r;
+}
+
+static inline uint32_t ntt_to_mont(uint32_t x, uint32_t p)
+{
+    return (uint32_t)(((uint64_t)x << 32) % p);
+}
+
+/* Decimation-in-frequency forward transform.  Output is in bit-reversed
+   order.  tw[j] is the j-th power of the N-th root of unity. */
+static void ntt_forward(uint32_t *x, long N, const uint32_t *tw,
+                        uint32_t p, uint32_t pinv)
+{
+    for (long len = N/2, step = 1; len >= 1; len >>= 1, step <<= 1) {
+        for (long i = 0; i < N; i += 2*len) {
+            for (long j = 0; j < len; j++) {
+                uint32_t u = x[i+j], v = x[i+j+len];
+                uint32_t s = u + v, d = u + p - v;
+                if (s >= p) s -= p;
+                if (d >= p) d -= p;
+                x[i+j] = s;
+                x[i+j+len] = ntt_mulmod(d, tw[j*step], p, pinv);
+            }
+        }
+    }
+}
+
+/* Decimation-in-time inverse transform, taking bit-reversed input.
+   itw[j] is the j-th power of the inverse root.  The result is not
+   scaled by 1/N. */
+static void ntt_inverse(uint32_t *x, long N, const uint32_t *itw,
+                        uint32_t p, uint32_t pinv)
+{
+    for (long len = 1, step = N/2; len < N; len <<= 1, step >>= 1) {
+        for (long i = 0; i < N; i += 2*len) {
+            for (long j = 0; j < len; j++) {
+                uint32_t u = x[i+j];
+                uint32_t v = ntt_mulmod(x[i+j+len], itw[j*step], p, pinv);
+                uint32_t s = u + v, d = u + p - v;
+                if (s >= p) s -= p;
+                if (d >= p) d -= p;
+                x[i+j] = s;
+                x[i+j+len] = d;
+            }
+        }
+    }
+}
+
+#define NTT_PIECES_PER_WORD  (WORD_BITS/16)
+
+static void ntt_load(uint32_t *x, long N, const u_long *a, int an)
+{
+    long k = 0;
+    for (int i=0; i<an; i++) {
+        u_long w = a[i];
+        for (int j=0; j<NTT_PIECES_PER_WORD; j++, w >>= 16) {
+            x[k++] = (uint32_t)(w & 0xffff);
+        }
+    }
+    for (; k<N; k++) x[k] = 0;
+}
+
+static int ntt_applicable(int an, int bn)
+{
+    return ((long)(an + bn) * NTT_PIECES_PER_WORD <= (1L<<NTT_MAX_LOG));
+}
+
+/* r[0..an+bn) = a[0..an) * b[0..bn).  If a == b, squares.
+   The caller must check ntt_applicable(an, bn). */
+static void words_mul_ntt(u_long *r, const u_long *a, int an,
+                          const u_long *b, int bn)
+{
+    long npieces = (long)(an + bn) * NTT_PIECES_PER_WORD;
+    long N = 1;
+    while (N < npieces) N <<= 1;
+
+    uint32_t *x = SCM_NEW_ATOMIC_ARRAY(uint32_t, N);
+    uint32_t *y = (a == b)? x : SCM_NEW_ATOMIC_ARRAY(uint32_t, N);
+    uint32_t *z = SCM_NEW_ATOMIC_ARRAY(uint32_t, N);
+    uint32_t *tw = SCM_NEW_ATOMIC_ARRAY(uint32_t, N);
+    uint32_t *itw = tw + N/2;
+
+    for (int q = 0; q < 2; q++) {
+        uint32_t p = ntt_primes[q].p;
+        uint32_t pinv = p;              /* Newton iteration for p^-1 */
+        for (int i=0; i<5; i++) pinv *= 2 - p*pinv;
+        pinv = -pinv;
+
+        uint32_t w = ntt_powmod(ntt_primes[q].g, (p-1)/N, p);
+        uint32_t wi = ntt_powmod(w, p-2, p);
+        uint64_t wk = 1, wik = 1;
+        for (long j=0; j<N/2; j++) {
+            tw[j] = ntt_to_mont((uint32_t)wk, p);
+            itw[j] = ntt_to_mont((uint32_t)wik, p);
+            wk = wk * w % p;
+            wik = wik * wi % p;
+        }
+
+        ntt_load(x, N, a, an);
+        ntt_forward(x, N, tw, p, pinv);
+        if (a != b) {
+            ntt_load(y, N, b, bn);
+            ntt_forward(y, N, tw, p, pinv);
+        }
+        /* the pointwise product leaves a factor 2^-32, which is
+           cancelled together with 1/N by the final scaling. */
+        for (long j=0; j<N; j++) x[j] = ntt_mulmod(x[j], y[j], p, pinv);
+        ntt_inverse(x, N, itw, p, pinv);
+        uint32_t scale = ntt_to_mont(ntt_to_mont(ntt_powmod((uint32_t)(N % p),
+                                                            p-2, p),
+                                                 p),
+                                     p);
+        for (long j=0; j<N; j++) x[j] = ntt_mulmod(x[j], scale, p, pinv);
+
+        if (q == 0) {
+            uint32_t *t = z; z = x; x = t;
+            if (a == b) y = x;
+        }
+    }
+
+    /* CRT: c = r1 + p1 * ((r2 - r1) * p1^-1 mod p2), and carry
+       propagation of 16-bit pieces. */
+    uint32_t p1 = ntt_primes[0].p, p2 = ntt_primes[1].p;
+    uint64_t p1inv = ntt_powmod(p1 % p2, p2-2, p2);
+    uint64_t acc = 0;
+    u_long word = 0;
+    int rn = 0, shift = 0;
+    for (long k=0; k<npieces; k++) {
+        uint64_t r1 = z[k], r2 = x[k];
+        uint64_t d = (r2 + p2 - r1 % p2) % p2;
+        acc += r1 + (uint64_t)p1 * (d * p1inv % p2);
+        word |= (u_long)(acc & 0xffff) << shift;
+        acc >>= 16;
+        shift += 16;
+        if (shift == WORD_BITS) {
+            r[rn++] = word;
+            word = 0;
+            shift = 0;
+        }
+    }
+}
+
+/* r[0..2n) = a[0..n) * b[0..n).  If a == b, squares.
+   r must not overlap a or b. */
+static void words_mul_n(u_long *r, const u_long *a, const u_long *b, int n)
+{
+    if (n < KARATSUBA_THRESHOLD) {
+        if (a == b) words_sqr_basecase(r, a, n);
+        else        words_mul_basecase(r, a, n, b, n);
+    } else if (n < TOOM3_THRESHOLD) {
+        u_long *ws = SCM_NEW_ATOMIC_ARRAY(u_long, karatsuba_ws_size(n));
+        words_mul_karatsuba(r, a, b, n, ws);
+    } else if (n < NTT_THRESHOLD || !ntt_applicable(n, n)) {
+        words_mul_toom3(r, a, b, n);
+    } else {
+        words_mul_ntt(r, a, n, b, n);
+    }
+}
+
+/* r[0..an+bn) = a[0..an) * b[0..bn), an >= bn >= 1.
+   r must not overlap a or b. */
+static void words_mul(u_long *r, const u_long *a, int an,
+                      const u_long *b, int bn)
+{
+    if (an == bn) {
+        words_mul_n(r, a, b, an);
+    } else if (bn < KARATSUBA_THRESHOLD) {
+        words_mul_basecase(r, a, an, b, bn);
+    } else if (bn >= NTT_THRESHOLD && ntt_applicable(an, bn)) {
+        words_mul_ntt(r, a, an, b, bn);
+    } else {
+        /* Unbalanced; multiply b by each bn-word chunk of a. */
+        u_long *t = SCM_NEW_ATOMIC_ARRAY(u_long, 2*bn);
+        words_clear(r, an + bn);
+        for (int i=0; i<an; i+=bn) {
+            int len = min(bn, an - i);
+            if (len == bn) words_mul_n(t, a + i, b, bn);
+            else           words_mul(t, b, bn, a + i, len);
+            words_add_to(r + i, an + bn - i, t, len + bn);
+        }
+    }
+}
+
+/* Multiplication with the specified algorithm at the top level, for
+   testing and benchmarking.  The shorter operand is zero-padded. */
+static void words_mul_with(u_long *r, const u_long *a, int an,
+                           const u_long *b, int bn, int algorithm)
+{
+    int n = an;
+    if (algorithm == SCM_BIGNUM_MUL_SCHOOLBOOK) {
+        if (a == b) words_sqr_basecase(r, a, n);
+        else        words_mul_basecase(r, a, an, b, bn);
+        return;
+    }
+    if (algorithm == SCM_BIGNUM_MUL_NTT) {
+        if (!ntt_applicable(an, bn)) Scm_Error("operands too large for NTT");
+        words_mul_ntt(r, a, an, b, bn);
+        return;
+    }
+    if (algorithm == SCM_BIGNUM_MUL_AUTO
+        || (algorithm == SCM_BIGNUM_MUL_KARATSUBA && n < 2)
+        || (algorithm == SCM_BIGNUM_MUL_TOOM3 && n < 5)) {
+        words_mul(r, a, an, b, bn);
+        return;
+    }
+    if (an != bn) {
+        u_long *bb = SCM_NEW_ATOMIC_ARRAY(u_long, n);
+        for (int i=0; i<bn; i++) bb[i] = b[i];
+        words_clear(bb + bn, n - bn);
+        b = bb;
+    }
+    u_long *rr = (an == bn)? r : SCM_NEW_ATOMIC_ARRAY(u_long, 2*n);
+    if (algorithm == SCM_BIGNUM_MUL_KARATSUBA) {
+        u_long *ws = SCM_NEW_ATOMIC_ARRAY(u_long, karatsuba_ws_size(n));
+        words_mul_karatsuba(rr, a, b, n, ws);
+    } else {
+        words_mul_toom3(rr, a, b, n);
+    }
+    if (rr != r) {
+        for (int i=0; i<an+bn; i++) r[i] = rr[i];
+    }
+}
+
 /* br += bx * (y << off*WORD_BITS).   br must have enough size. */
 static ScmBignum *bignum_mul_word(ScmBignum *br, const ScmBignum *bx,
                                   u_long y, int off)
@@ -797,16 +1418,29 @@ static ScmBignum *bignum_mul_word(ScmBignum *br, const ScmBignum *bx,
 }
 
 /* returns bx * by.  not normalized */
-static ScmBignum *bignum_mul(const ScmBignum *bx, const ScmBignum *by)
+static ScmBignum *bignum_mul_with(const ScmBignum *bx, const ScmBignum *by,
+                                  int algorithm)
 {
+    if (bx->size < by->size) {
+        const ScmBignum *t = bx; bx = by; by = t;
+    }
     ScmBignum *br = make_bignum(bx->size + by->size);
-    for (u_int i=0; i<by->size; i++) {
-        bignum_mul_word(br, bx, by->values[i], i);
+    const u_long *yv = by->values;
+    if (bx == by
+        || (bx->size == by->size
+            && memcmp(bx->values, by->values, bx->size*sizeof(u_long)) == 0)) {
+        yv = bx->values;        /* squaring */
     }
+    words_mul_with(br->values, bx->values, bx->size, yv, by->size, algorithm);
     br->sign = bx->sign * by->sign;
     return br;
 }
 
+static ScmBignum *bignum_mul(const ScmBignum *bx, const ScmBignum *by)
+{
+    return bignum_mul_with(bx, by, SCM_BIGNUM_MUL_AUTO);
+}
+
 /* return bx * y,  y != 0 and y != 1 */
 static ScmBignum *bignum_mul_si(const ScmBignum *bx, long y)
 {
@@ -837,6 +1471,14 @@ ScmObj Scm_BignumMul(const ScmBignum *bx, const ScmBignum *by)
     return Scm_NormalizeBignum(br);
 }
 
+/* For testing and benchmarking; see words_mul_with */
+ScmObj Scm__BignumMulWith(const ScmBignum *bx, const ScmBignum *by,
+                          int algorithm)
+{
+    ScmBignum *br = bignum_mul_with(bx, by, algorithm);
+    return Scm_NormalizeBignum(br);
+}
+
 ScmObj Scm_BignumMulSI(const ScmBignum *bx, long y)
 {
     if (y == 1) return SCM_OBJ(bx);
@@ -848,161 +1490,304 @@ ScmObj Scm_BignumMulSI(const ScmBignum *bx, long y)
  * Division
  */
 
-/* returns # of bits in the leftmost '1' in the word, counting from MSB. */
-static inline int div_normalization_factor(u_long w)
-{
-    u_long b = (1L<<(WORD_BITS-1)), c = 0;
-    for (; b > 0; b>>=1, c++) {
-        if (w & b) return c;
-    }
-    /* something got wrong here */
-    Scm_Panic("bignum.c: div_normalization_factor: can't be here");
-    return 0;                   /* dummy */
-}
-
-/* General case of division.  We use each half word as a digit.
-   Assumes digitsof(dividend) >= digitsof(divisor) > 1.
-   Assumes enough digits are allocated to quotient.
-   Remainder is returned (not normalized) */
-static ScmBignum *bignum_gdiv(const ScmBignum *dividend,
-                              const ScmBignum *divisor,
-                              ScmBignum *quotient)
-{
-    int d = div_normalization_factor(divisor->values[divisor->size-1]);
-    int n, m;
-    u_long vv, uj, uj2, cy;
-
-#define DIGIT(num, n) (((n)%2)? HI((num)->values[(n)/2]) : LO((num)->values[(n)/2]))
-#define DIGIT2(num, n) \
-    (((n)%2)?  \
-     ((LO((num)->values[(n)/2+1])<<HALF_BITS)|HI((num)->values[(n)/2])): \
-     (num)->values[(n)/2])
-#define SETDIGIT(num, n, v) \
-    (((n)%2)? \
-     (num->values[(n)/2] = (num->values[(n)/2] & LOMASK)|((v) << HALF_BITS)) :\
-     (num->values[(n)/2] = (num->values[(n)/2] & HIMASK)|((v) & LOMASK)))
-#define SETDIGIT2(num, n, v)                                             \
-    (((n)%2)?                                                            \
-     ((num->values[(n)/2] = LO(num->values[(n)/2])|((v)<<HALF_BITS)),    \
-      (num->values[(n)/2+1] = (num->values[(n)/2+1] & HIMASK)|HI(v))) : \
-     (num->values[(n)/2] = (v)))
+/* Division works on word arrays, like multiplication.  The basecase is
+   Knuth's algorithm D with full-word digits.  When both the divisor and
+   the quotient are long, we use Burnikel-Ziegler recursive division,
+   which splits a 2n/n division into two 3/2 divisions and reduces the
+   rest to multiplications; thus it is as fast as the multiplication
+   algorithm, times log n.
+   See C. Burnikel and J. Ziegler: Fast Recursive Division, MPI-I-98-1-022.
 
-    /* normalize */
-    ScmBignum *u, *v;
-    u = make_bignum(dividend->size + 1); /* will be returned as a remainder */
-    ALLOC_TEMP_BIGNUM(v, divisor->size);
-    if (d >= HALF_BITS) {
-        d -= HALF_BITS;
-        n = divisor->size*2 - 1;
-        m = dividend->size*2 - n;
-    } else {
-        n = divisor->size*2;
-        m = dividend->size*2 - n;
-    }
-    bignum_lshift(u, dividend, d);
-    bignum_lshift(v, divisor, d);
-    u_long vn_1 = DIGIT(v, n-1);
-    u_long vn_2 = DIGIT(v, n-2);
-#undef DIV_DEBUG
-#ifdef DIV_DEBUG
-    Scm_Printf(SCM_CUROUT, "shift=%d, n=%d, m=%d\n", d, n, m);
-    Scm_Printf(SCM_CUROUT, "u="); Scm_BignumDump(u, SCM_CUROUT);
-    Scm_Printf(SCM_CUROUT, "\nv="); Scm_BignumDump(v, SCM_CUROUT);
-    Scm_Printf(SCM_CUROUT, "\nvn_1=%08lx, vn_2=%08lx\n", vn_1, vn_2);
-#endif
+   The word-level routines assume the divisor is normalized, i.e. the MSB
+   of its top word is set. */
 
-    for (int j = m; j >= 0; j--) {
-        u_long uu = (DIGIT(u, j+n) << HALF_BITS) + DIGIT(u, j+n-1);
-        u_long qq = uu/vn_1;
-        u_long rr = uu%vn_1;
-#ifdef DIV_DEBUG
-        Scm_Printf(SCM_CUROUT, "loop on j=%d, uu=%08lx, qq=%08lx, rr=%08lx\n",
-                   j, uu, qq, rr);
-#endif
-        while (qq >= HALF_WORD) { qq--; rr += vn_1; }
-        while ((qq*vn_2 > (rr<<HALF_BITS)+DIGIT(u, j+n-2)) && (rr < HALF_WORD)) {
-            qq--; rr += vn_1;
+#define DIV_DC_THRESHOLD      60
+
+/* Returns floor((nh:nl) / d), and stores the remainder in *r.
+   d must be normalized, and nh < d. */
+static inline u_long udiv_2by1(u_long nh, u_long nl, u_long d, u_long *r)
+{
+    u_long d1 = HI(d), d0 = LO(d);
+
+    u_long q1 = nh / d1;
+    u_long r1 = nh - q1 * d1;
+    u_long m = q1 * d0;
+    r1 = (r1 << HALF_BITS) | HI(nl);
+    if (r1 < m) {
+        q1--; r1 += d;
+        if (r1 >= d && r1 < m) { q1--; r1 += d; } /* no carry in r1+d */
+    }
+    r1 -= m;
+
+    u_long q0 = r1 / d1;
+    u_long r0 = r1 - q0 * d1;
+    m = q0 * d0;
+    r0 = (r0 << HALF_BITS) | LO(nl);
+    if (r0 < m) {
+        q0--; r0 += d;
+        if (r0 >= d && r0 < m) { q0--; r0 += d; }
+    }
+    r0 -= m;
+
+    *r = r0;
+    return (q1 << HALF_BITS) | q0;
+}
+
+/* q[0..n) = u[0..n) / d; returns the remainder.  d != 0.  q can be u. */
+static u_long words_divrem_1(u_long *q, const u_long *u, int n, u_long d)
+{
+    int s = WORD_BITS - 1 - Scm__HighestBitNumber(d);
+    u_long dn = d << s, r = 0;
+
+    if (s == 0) {
+        for (int i=n-1; i>=0; i--) q[i] = udiv_2by1(r, u[i], dn, &r);
+        return r;
+    }
+    r = u[n-1] >> (WORD_BITS - s);
+    for (int i=n-1; i>=0; i--) {
+        u_long nl = u[i] << s;
+        if (i > 0) nl |= u[i-1] >> (WORD_BITS - s);
+        q[i] = udiv_2by1(r, nl, dn, &r);
+    }
+    return r >> s;
+}
+
+/* r[0..n) -= a[0..n) * b; returns the borrow word. */
+static u_long words_submul_1(u_long *r, const u_long *a, int n, u_long b)
+{
+    u_long borrow = 0;
+    for (int i=0; i<n; i++) {
+        u_long hi, lo, t, x = a[i];
+        UMUL(hi, lo, x, b);
+        u_long c = 0;
+        t = lo;
+        UADD(lo, c, t, borrow);
+        hi += c;
+        c = 0;
+        t = r[i];
+        USUB(r[i], c, t, lo);
+        borrow = hi + c;
+    }
+    return borrow;
+}
+
+/* r[0..n) = a[0..n) << s, 0 <= s < WORD_BITS; returns the shifted-out
+   bits.  r can be a. */
+static u_long words_lshift(u_long *r, const u_long *a, int n, int s)
+{
+    if (s == 0) {
+        for (int i=n-1; i>=0; i--) r[i] = a[i];
+        return 0;
+    }
+    u_long out = a[n-1] >> (WORD_BITS - s);
+    for (int i=n-1; i>0; i--) {
+        r[i] = (a[i] << s) | (a[i-1] >> (WORD_BITS - s));
+    }
+    r[0] = a[0] << s;
+    return out;
+}
+
+/* r[0..n) = a[0..n) >> s, 0 <= s < WORD_BITS.  r can be a. */
+static void words_rshift(u_long *r, const u_long *a, int n, int s)
+{
+    if (s == 0) {
+        for (int i=0; i<n; i++) r[i] = a[i];
+        return;
+    }
+    for (int i=0; i<n-1; i++) {
+        r[i] = (a[i] >> s) | (a[i+1] << (WORD_BITS - s));
+    }
+    r[n-1] = a[n-1] >> s;
+}
+
+/* Decrements q[0..n) by one; returns the borrow. */
+static u_long words_decr(u_long *q, int n)
+{
+    u_long one = 1;
+    return words_sub_from(q, n, &one, 1);
+}
+
+/* Algorithm D.  Divides u[0..un) by v[0..vn), un >= vn >= 2.
+   Stores the low un-vn words of the quotient in q and returns the top
+   quotient word, which is 0 or 1.  The remainder is left in u[0..vn). */
+static u_long words_div_basecase(u_long *q, u_long *u, int un,
+                                 const u_long *v, int vn)
+{
+    u_long v1 = v[vn-1], v0 = v[vn-2];
+    u_long qh = 0;
+
+    if (words_cmp(u+un-vn, v, vn) >= 0) {
+        words_sub_n(u+un-vn, u+un-vn, v, vn);
+        qh = 1;
+    }
+    for (int j=un-vn-1; j>=0; j--) {
+        /* The partial remainder u[j..j+vn] is less than v*B, hence
+           n2 <= v1. */
+        u_long n2 = u[j+vn], n1 = u[j+vn-1], n0 = u[j+vn-2];
+        u_long qq, rr;
+        int rr_overflow = FALSE;
+        if (n2 == v1) {
+            qq = SCM_ULONG_MAX;
+            rr = n1 + v1;
+            rr_overflow = (rr < n1);
+        } else {
+            qq = udiv_2by1(n2, n1, v1, &rr);
         }
-#ifdef DIV_DEBUG
-        Scm_Printf(SCM_CUROUT, "estimate uu=%08lx, qq=%08lx, rr=%08lx\n",
-                   uu, qq, rr);
-#endif
-        cy = 0;
-        for (int k = 0; k < n; k++) {
-            vv = qq * DIGIT(v, k);
-            uj = DIGIT2(u, j+k);
-            uj2 = uj - vv - cy;
-            cy =  (uj2 > uj)? HALF_WORD : 0;
-            SETDIGIT2(u, j+k, uj2);
+        /* Refine the estimate with v0; after this, qq is at most one
+           larger than the true quotient digit. */
+        while (!rr_overflow) {
+            u_long ph, pl;
+            UMUL(ph, pl, qq, v0);
+            if (ph < rr || (ph == rr && pl <= n0)) break;
+            qq--;
+            rr += v1;
+            rr_overflow = (rr < v1);
         }
-#ifdef DIV_DEBUG
-        Scm_Printf(SCM_CUROUT, "subtract cy = %d, ", cy);
-        Scm_Printf(SCM_CUROUT, "u="); Scm_BignumDump(u, SCM_CUROUT);
-        Scm_Printf(SCM_CUROUT, "\n");
-#endif
-        if (cy) {
+        u_long borrow = words_submul_1(u+j, v, vn, qq);
+        u_long top = u[j+vn];
+        u[j+vn] = top - borrow;
+        if (top < borrow) {
             qq--;
-            cy = 0;
-            for (int k = 0; k < n; k++) {
-                vv = DIGIT(v, k);
-                uj = DIGIT(u, j+k) + vv + cy;
-                cy = (uj >= HALF_WORD)? 1 : 0;
-                SETDIGIT(u, j+k, uj);
-            }
-            uj = DIGIT(u, j+n) + cy;
-            SETDIGIT(u, j+n, uj);
+            words_add_to(u+j, vn+1, v, vn); /* carry out cancels the borrow */
         }
-        SETDIGIT(quotient, j, qq);
+        q[j] = qq;
     }
-    bignum_rshift(u, u, d);
-#ifdef DIV_DEBUG
-    Scm_Printf(SCM_CUROUT, "quot q="); Scm_BignumDump(quotient, SCM_CUROUT);
-    Scm_Printf(SCM_CUROUT, "\nrem  u="); Scm_BignumDump(u, SCM_CUROUT);
-    Scm_Printf(SCM_CUROUT, "\n");
-#endif
-    return u;
+    return qh;
+}
+
+/* Burnikel-Ziegler 2n/n division.  Divides u[0..2n) by v[0..n).
+   Stores the low n words of the quotient in q and returns the top
+   quotient word.  The remainder is left in u[0..n).
+   tp is a scratch area of n words. */
+static u_long words_div_dc_n(u_long *q, u_long *u, const u_long *v, int n,
+                             u_long *tp)
+{
+    if (n < DIV_DC_THRESHOLD) return words_div_basecase(q, u, 2*n, v, n);
+
+    int lo = n/2, hi = n - lo;
+    u_long cy;
+
+    /* Upper half of the quotient: divide the top 2*hi words by the top
+       hi words of v, then correct the remainder with the rest of v. */
+    u_long qh = words_div_dc_n(q+lo, u+2*lo, v+lo, hi, tp);
+    words_mul(tp, q+lo, hi, v, lo);
+    cy = words_sub_n(u+lo, u+lo, tp, n);
+    if (qh) cy += words_sub_n(u+n, u+n, v, lo);
+    while (cy) {
+        qh -= words_decr(q+lo, hi);
+        cy -= words_add_n(u+lo, u+lo, v, n);
+    }
+
+    /* Lower half, likewise. */
+    u_long ql = words_div_dc_n(q, u+hi, v+hi, lo, tp);
+    words_mul(tp, v, hi, q, lo);
+    cy = words_sub_n(u, u, tp, n);
+    if (ql) cy += words_sub_n(u+lo, u+lo, v, hi);
+    while (cy) {
+        words_decr(q, lo);
+        cy -= words_add_n(u, u, v, n);
+    }
+    return qh;
 }
 
-/* Fast path if divisor fits in a half word.  Quotient remains in the
-   dividend's memory.   Remainder returned.  Quotient not normalized. */
-static u_long bignum_sdiv(ScmBignum *dividend, u_long divisor)
+/* Divides u[0..qn+vn) by v[0..vn) where qn <= vn, i.e. the quotient is
+   not longer than the divisor.  We divide by the top qn words of v and
+   correct the result.  Returns the top quotient word as above. */
+static u_long words_div_dc_partial(u_long *q, u_long *u, int qn,
+                                   const u_long *v, int vn, u_long *tp)
 {
-    int n = dividend->size - 1;
-    u_long *pu = dividend->values;
-    u_long q0 = 0, r0 = 0, q1, r1;
+    if (qn < DIV_DC_THRESHOLD) return words_div_basecase(q, u, qn+vn, v, vn);
+
+    int ln = vn - qn;
+    u_long qh = words_div_dc_n(q, u+ln, v+ln, qn, tp);
+    if (ln > 0) {
+        if (qn >= ln) words_mul(tp, q, qn, v, ln);
+        else          words_mul(tp, v, ln, q, qn);
+        u_long cy = words_sub_n(u, u, tp, vn);
+        if (qh) cy += words_sub_n(u+qn, u+qn, v, ln);
+        while (cy) {
+            qh -= words_decr(q, qn);
+            cy -= words_add_n(u, u, v, vn);
+        }
+    }
+    return qh;
+}
 
-    for (; n > 0; n--) {
-        q1 = pu[n] / divisor + q0;
-        r1 = ((pu[n] % divisor) << HALF_BITS) + HI(pu[n-1]);
-        q0 = ((r1 / divisor) << HALF_BITS);
-        r0 = r1 % divisor;
-        pu[n] = q1;
-        pu[n-1] = (r0 << HALF_BITS) + LO(pu[n-1]);
+/* Divides u[0..un) by v[0..vn), un >= vn >= 2.  Stores the low un-vn
+   words of the quotient in q and returns the top quotient word.  The
+   remainder is left in u[0..vn). */
+static u_long words_div(u_long *q, u_long *u, int un,
+                        const u_long *v, int vn)
+{
+    int qn = un - vn;
+    if (vn < DIV_DC_THRESHOLD || qn < DIV_DC_THRESHOLD) {
+        return words_div_basecase(q, u, un, v, vn);
+    }
+    u_long *tp = SCM_NEW_ATOMIC_ARRAY(u_long, vn);
+    if (qn <= vn) return words_div_dc_partial(q, u, qn, v, vn, tp);
+
+    /* Long quotient.  Treat vn words as a digit and run the schoolbook
+       algorithm on them; the top (possibly shorter) digit first. */
+    int i = qn - ((qn % vn)? (qn % vn) : vn);
+    u_long qh = words_div_dc_partial(q+i, u+i, qn-i, v, vn, tp);
+    for (i -= vn; i >= 0; i -= vn) {
+        /* The top vn words of u[i..i+2vn) is the previous remainder,
+           which is less than v; so the top quotient word is 0. */
+        words_div_dc_n(q+i, u+i, v, vn, tp);
+    }
+    return qh;
+}
+
+/* q[0..un-vn+1) = u[0..un) / v[0..vn), r[0..vn) = u[0..un) % v[0..vn).
+   un >= vn >= 1, and v[vn-1] != 0.  u and v are intact.
+   If algorithm is SCM_BIGNUM_DIV_SCHOOLBOOK, we don't use recursive
+   division (for testing). */
+static void words_divrem(u_long *q, u_long *r, const u_long *u, int un,
+                         const u_long *v, int vn, int algorithm)
+{
+    if (vn == 1) {
+        r[0] = words_divrem_1(q, u, un, v[0]);
+        return;
+    }
+    /* normalize */
+    int s = WORD_BITS - 1 - Scm__HighestBitNumber(v[vn-1]);
+    u_long *nu = SCM_NEW_ATOMIC_ARRAY(u_long, un+1);
+    u_long *nv = SCM_NEW_ATOMIC_ARRAY(u_long, vn);
+    nu[un] = words_lshift(nu, u, un, s);
+    words_lshift(nv, v, vn, s);
+
+    /* Since nu[un] < nv[vn-1], the top quotient word is always 0. */
+    if (algorithm == SCM_BIGNUM_DIV_SCHOOLBOOK) {
+        words_div_basecase(q, nu, un+1, nv, vn);
+    } else {
+        words_div(q, nu, un+1, nv, vn);
     }
-    q1 = pu[0] / divisor + q0;
-    r1 = pu[0] % divisor;
-    pu[0] = q1;
-    return r1;
+    words_rshift(r, nu, vn, s);
+}
+
+/* Divides absolute values; dividend->size >= divisor->size, and the top
+   word of the divisor must be nonzero.  Quotient must have
+   dividend->size - divisor->size + 1 words.
+   Remainder is returned (not normalized, sign is not set). */
+static ScmBignum *bignum_divrem(const ScmBignum *dividend,
+                                const ScmBignum *divisor,
+                                ScmBignum *quotient,
+                                int algorithm)
+{
+    ScmBignum *r = make_bignum(divisor->size);
+    words_divrem(quotient->values, r->values,
+                 dividend->values, dividend->size,
+                 divisor->values, divisor->size, algorithm);
+    return r;
 }
 
 /* assuming dividend is normalized. */
 ScmObj Scm_BignumDivSI(const ScmBignum *dividend, long divisor, long *remainder)
 {
     u_long dd = (divisor < 0)? -divisor : divisor;
-    u_long rr;
     int d_sign = (divisor < 0)? -1 : 1;
-    ScmBignum *q;
-
-    if (dd < HALF_WORD) {
-        q = SCM_BIGNUM(Scm_BignumCopy(dividend));
-        rr = bignum_sdiv(q, dd);
-    } else {
-        ScmBignum *bv = SCM_BIGNUM(Scm_MakeBignumFromSI(dd));
-        ScmBignum *br;
-        q = make_bignum(dividend->size + 1);
-        br = bignum_gdiv(dividend, bv, q);
-        rr = br->values[0];
-    }
+    ScmBignum *q = make_bignum(dividend->size);
+    u_long rr = words_divrem_1(q->values, dividend->values, dividend->size, dd);
     if (remainder) {
         *remainder = ((dividend->sign < 0)? -(signed long)rr : (signed long)rr);
     }
@@ -1051,8 +1836,10 @@ long Scm_BignumRemSI(const ScmBignum *dividend, long divisor)
 }
 
 /* assuming dividend and divisor is normalized.  returns quotient and
-   remainder */
-ScmObj Scm_BignumDivRem(const ScmBignum *dividend, const ScmBignum *divisor)
+   remainder.  The algorithm argument is for testing and benchmarking. */
+ScmObj Scm__BignumDivRemWith(const ScmBignum *dividend,
+                             const ScmBignum *divisor,
+                             int algorithm)
 {
     /* special case */
     if (Scm_BignumAbsCmp(dividend, divisor) < 0) {
@@ -1060,13 +1847,500 @@ ScmObj Scm_BignumDivRem(const ScmBignum *dividend, const ScmBignum *divisor)
     }
 
     ScmBignum *q = make_bignum(dividend->size - divisor->size + 1);
-    ScmBignum *r = bignum_gdiv(dividend, divisor, q);
+    ScmBignum *r = bignum_divrem(dividend, divisor, q, algorithm);
     q->sign = dividend->sign * divisor->sign;
     r->sign = dividend->sign;
 
     return Scm_Cons(Scm_NormalizeBignum(q), Scm_NormalizeBignum(r));
 }
 
+ScmObj Scm_BignumDivRem(const ScmBignum *dividend, const ScmBignum *divisor)
+{
+    return Scm__BignumDivRemWith(dividend, divisor, SCM_BIGNUM_DIV_AUTO);
+}
+
+/*-----------------------------------------------------------------------
+ * GCD
+ *
+ *   Lehmer's algorithm, in the double-digit form (Jebelean's condition)
+ *   with half-words as digits.  The leading word of u and the same bits
+ *   of v are reduced by simulating Euclid's algorithm with single-digit
+ *   cofactors; then the cofactors are applied to the whole numbers at
+ *   once.  Each outer step removes about HALF_BITS bits with a couple of
+ *   linear passes, instead of one long division per quotient digit.
+ */
+
+/* r[0..n) = a[0..n) * b; returns the carry word.  r can be a. */
+static u_long words_mul_1(u_long *r, const u_long *a, int n, u_long b)
+{
+    u_long carry = 0;
+    for (int i=0; i<n; i++) {
+        u_long hi, lo, t, x = a[i];
+        UMUL(hi, lo, x, b);
+        u_long c = 0;
+        t = lo;
+        UADD(r[i], c, t, carry);
+        carry = hi + c;
+    }
+    return carry;
+}
+
+/* r[0..n] = |a[0..n) * x - b[0..n) * y|, using t[0..n] as a work area. */
+static void words_lincomb(u_long *r, u_long *t,
+                          const u_long *a, u_long x,
+                          const u_long *b, u_long y, int n)
+{
+    r[n] = words_mul_1(r, a, n, x);
+    t[n] = words_mul_1(t, b, n, y);
+    if (words_cmp(r, t, n+1) >= 0) words_sub_n(r, r, t, n+1);
+    else                           words_sub_n(r, t, r, n+1);
+}
+
+static inline int words_size(const u_long *a, int n)
+{
+    while (n > 0 && a[n-1] == 0) n--;
+    return n;
+}
+
+/* Euclid's algorithm on words.  Both may be zero. */
+static u_long word_gcd(u_long x, u_long y)
+{
+    while (y > 0) {
+        u_long r = x % y;
+        x = y;
+        y = r;
+    }
+    return x;
+}
+
+/* Returns gcd(|bx|, |by|).  Both must be nonzero. */
+ScmObj Scm_BignumGcd(const ScmBignum *bx, const ScmBignum *by)
+{
+    int n = (int)((bx->size > by->size)? bx->size : by->size);
+    /* u and v are zero-extended to n words; one extra word is needed
+       for the linear combination. */
+    u_long *u = SCM_NEW_ATOMIC_ARRAY(u_long, n+1);
+    u_long *v = SCM_NEW_ATOMIC_ARRAY(u_long, n+1);
+    u_long *w = SCM_NEW_ATOMIC_ARRAY(u_long, n+1);
+    u_long *t = SCM_NEW_ATOMIC_ARRAY(u_long, n+1);
+    words_clear(u, n+1);
+    words_clear(v, n+1);
+    for (u_int i=0; i<bx->size; i++) u[i] = bx->values[i];
+    for (u_int i=0; i<by->size; i++) v[i] = by->values[i];
+
+    int un = words_size(u, n), vn = words_size(v, n);
+    if (un < vn || (un == vn && words_cmp(u, v, un) < 0)) {
+        u_long *z = u; u = v; v = z;
+        int zn = un; un = vn; vn = zn;
+    }
+
+    while (vn > 1) {
+        /* x, y: the top WORD_BITS-2 bits of u, and the same bits of v.
+           We leave two bits of headroom so that the signed arithmetic
+           below doesn't overflow. */
+        int k = (un-1)*WORD_BITS + Scm__HighestBitNumber(u[un-1]) + 1
+            - (WORD_BITS-2);
+        int kw = k/WORD_BITS, kb = k%WORD_BITS;
+        long x, y;
+        if (kb == 0) {
+            x = (long)u[kw];
+            y = (long)v[kw];
+        } else {
+            x = (long)((u[kw] >> kb) | (u[kw+1] << (WORD_BITS-kb)));
+            y = (long)((v[kw] >> kb) | (v[kw+1] << (WORD_BITS-kb)));
+        }
+
+        long A = 1, B = 0, C = 0, D = 1;
+        int steps;
+        for (steps = 0; ; steps++) {
+            if (y-C == 0) break;
+            long q = (x+(A-1))/(y-C);
+            long s = B+q*D;
+            long z = x-q*y;
+            if (s > z) break;
+            x = y; y = z;
+            z = A+q*C; A = D; B = C; C = s; D = z;
+        }
+
+        if (steps == 0) {
+            /* No progress; do a Euclidean step. */
+            u_long *q = SCM_NEW_ATOMIC_ARRAY(u_long, un-vn+1);
+            words_clear(w, n+1);
+            words_divrem(q, w, u, un, v, vn, SCM_BIGNUM_DIV_AUTO);
+            u_long *z = u; u = v; v = w; w = z;
+            un = vn;
+            vn = words_size(v, vn);
+            continue;
+        }
+
+        /* Apply the cofactors:
+             u, v = A*v-B*u, D*u-C*v   if steps is odd
+             u, v = A*u-B*v, D*v-C*u   if steps is even */
+        words_clear(w, n+1);
+        words_clear(t, n+1);
+        if (steps & 1) {
+            words_lincomb(w, t, v, (u_long)A, u, (u_long)B, un);
+            words_lincomb(t, v, u, (u_long)D, v, (u_long)C, un);
+        } else {
+            words_lincomb(w, t, u, (u_long)A, v, (u_long)B, un);
+            words_lincomb(t, u, v, (u_long)D, u, (u_long)C, un);
+        }
+        /* now w is the new u and t is the new v; u and v are free */
+        u_long *z0 = u, *z1 = v;
+        u = w; v = t; w = z0; t = z1;
+        un = words_size(u, un+1);
+        vn = words_size(v, un);
+        if (un < vn || (un == vn && words_cmp(u, v, un) < 0)) {
+            u_long *z = u; u = v; v = z;
+            int zn = un; un = vn; vn = zn;
+        }
+    }
+
+    if (vn == 1) {
+        u_long r = words_divrem_1(t, u, un, v[0]);
+        u_long g = word_gcd(v[0], r);
+        return Scm_MakeIntegerU(g);
+    }
+    return Scm_MakeBignumFromUIArray(1, u, un);
+}
+
+/*-----------------------------------------------------------------------
+ * Modular exponentiation and probable prime tests
+ *
+ *   Residues modulo an odd m of n words are kept in Montgomery form,
+ *   x*R mod m where R = 2^(WORD_BITS*n), so that a modular product
+ *   needs no division (P. L. Montgomery, "Modular multiplication without
+ *   trial division", Math. Comp. 44 (1985)).  We use the CIOS variant,
+ *   which interleaves the multiplication and the reduction word by word.
+ */
+
+typedef struct mont_rec {
+    const u_long *m;            /* modulus; odd, m[n-1] != 0 */
+    int n;
+    u_long minv;                /* -m^-1 mod 2^WORD_BITS */
+    u_long *one;                /* R mod m, i.e. 1 in Montgomery form */
+    u_long *r2;                 /* R^2 mod m */
+    u_long *t;                  /* work area of n+2 words */
+} mont;
+
+/* *lo = x*y + a + b; returns the high word.  This never overflows. */
+static inline u_long word_mac(u_long *lo, u_long x, u_long y,
+                              u_long a, u_long b)
+{
+    u_long hi, l, t, c = 0;
+    UMUL(hi, l, x, y);
+    t = l;
+    UADD(l, c, t, a);
+    hi += c;
+    c = 0;
+    t = l;
+    UADD(l, c, t, b);
+    *lo = l;
+    return hi + c;
+}
+
+/* Returns R^k mod m[0..n) in a fresh array of n words. */
+static u_long *mont_rpow(const u_long *m, int n, int k)
+{
+    int un = k*n + 1;
+    u_long *u = SCM_NEW_ATOMIC_ARRAY(u_long, un);
+    u_long *q = SCM_NEW_ATOMIC_ARRAY(u_long, un-n+1);
+    u_long *r = SCM_NEW_ATOMIC_ARRAY(u_long, n);
+    words_clear(u, un);
+    u[un-1] = 1;
+    words_divrem(q, r, u, un, m, n, SCM_BIGNUM_DIV_AUTO);
+    return r;
+}
+
+static void mont_init(mont *mc, const u_long *m, int n)
+{
+    /* Newton's iteration; each step doubles the number of correct low
+       bits, and m*m = 1 mod 8 for odd m gives us the first three. */
+    u_long inv = m[0];
+    for (int i=0; i<6; i++) inv *= 2 - m[0]*inv;
+    mc->m = m;
+    mc->n = n;
+    mc->minv = -inv;
+    mc->one = mont_rpow(m, n, 1);
+    mc->r2 = mont_rpow(m, n, 2);
+    mc->t = SCM_NEW_ATOMIC_ARRAY(u_long, n+2);
+}
+
+/* r = a*b/R mod m.  a, b < m.  r can be a or b. */
+static void mont_mul(u_long *r, const u_long *a, const u_long *b,
+                     const mont *mc)
+{
+    int n = mc->n;
+    const u_long *m = mc->m;
+    u_long *t = mc->t;
+    u_long c, s;
+
+    words_clear(t, n+2);
+    for (int i=0; i<n; i++) {
+        u_long carry = 0, bi = b[i];
+        for (int j=0; j<n; j++) carry = word_mac(&t[j], a[j], bi, t[j], carry);
+        c = 0;
+        s = t[n];
+        UADD(t[n], c, s, carry);
+        t[n+1] = c;
+
+        /* Add q*m, where q makes the low word zero, and shift a word. */
+        u_long q = t[0] * mc->minv;
+        carry = word_mac(&s, q, m[0], t[0], 0);
+        for (int j=1; j<n; j++) carry = word_mac(&t[j-1], q, m[j], t[j], carry);
+        c = 0;
+        s = t[n];
+        UADD(t[n-1], c, s, carry);
+        t[n] = t[n+1] + c;
+    }
+    /* Now t < 2m. */
+    if (t[n] || words_cmp(t, m, n) >= 0) words_sub_n(r, t, m, n);
+    else for (int i=0; i<n; i++) r[i] = t[i];
+}
+
+/* r = a + b mod m, r = a - b mod m.  a, b < m.  r can be a or b. */
+static void mont_add(u_long *r, const u_long *a, const u_long *b,
+                     const mont *mc)
+{
+    u_long carry = words_add_n(r, a, b, mc->n);
+    if (carry || words_cmp(r, mc->m, mc->n) >= 0) words_sub_n(r, r, mc->m, mc->n);
+}
+
+static void mont_sub(u_long *r, const u_long *a, const u_long *b,
+                     const mont *mc)
+{
+    if (words_sub_n(r, a, b, mc->n)) words_add_n(r, r, mc->m, mc->n);
+}
+
+/* r = a/2 mod m.  Since halving is linear, this works in Montgomery
+   form as well.  r can be a. */
+static void mont_half(u_long *r, const u_long *a, const mont *mc)
+{
+    int n = mc->n;
+    u_long top = 0;
+    if (a[0] & 1) top = words_add_n(r, a, mc->m, n);
+    else if (r != a) for (int i=0; i<n; i++) r[i] = a[i];
+    words_rshift(r, r, n, 1);
+    r[n-1] |= top << (WORD_BITS-1);
+}
+
+/* Loads x into a fresh array of n words in Montgomery form.  If x has
+   too many digits, or x >= m, it is reduced first. */
+static u_long *mont_from_words(const u_long *x, int xn, const mont *mc)
+{
+    int n = mc->n;
+    u_long *r = SCM_NEW_ATOMIC_ARRAY(u_long, n);
+    xn = words_size(x, xn);
+    if (xn > n || (xn == n && words_cmp(x, mc->m, n) >= 0)) {
+        u_long *q = SCM_NEW_ATOMIC_ARRAY(u_long, xn-n+1);
+        words_divrem(q, r, x, xn, mc->m, n, SCM_BIGNUM_DIV_AUTO);
+    } else {
+        words_clear(r, n);
+        for (int i=0; i<xn; i++) r[i] = x[i];
+    }
+    mont_mul(r, r, mc->r2, mc);
+    return r;
+}
+
+/* Returns x in Montgomery form as an integer. */
+static ScmObj mont_to_integer(const u_long *x, const mont *mc)
+{
+    int n = mc->n;
+    u_long *u = SCM_NEW_ATOMIC_ARRAY(u_long, n);
+    u_long *r = SCM_NEW_ATOMIC_ARRAY(u_long, n);
+    words_clear(u, n);
+    u[0] = 1;
+    mont_mul(r, x, u, mc);
+    return Scm_NormalizeBignum(SCM_BIGNUM(Scm_MakeBignumFromUIArray(1, r, n)));
+}
+
+static inline int words_bit(const u_long *e, int i)
+{
+    return (int)((e[i/WORD_BITS] >> (i%WORD_BITS)) & 1);
+}
+
+/* Removes the trailing zero bits of nonzero a[0..n); returns the
+   number of removed bits. */
+static int words_remove_twos(u_long *a, int n)
+{
+    int w = 0;
+    while (a[w] == 0) w++;
+    int b = Scm__LowestBitNumber(a[w]);
+    for (int i=w; i<n; i++) a[i-w] = a[i];
+    for (int i=n-w; i<n; i++) a[i] = 0;
+    words_rshift(a, a, n, b);
+    return w*WORD_BITS + b;
+}
+
+/* r = b^e in Montgomery form, by left-to-right sliding windows.
+   e[0..en) is the exponent, which must be positive and normalized. */
+static void mont_expt(u_long *r, const u_long *b, const u_long *e, int en,
+                      const mont *mc)
+{
+    int n = mc->n;
+    int ebits = (en-1)*WORD_BITS + Scm__HighestBitNumber(e[en-1]) + 1;
+    /* The window size minimizing the number of multiplications
+       (the table costs 2^(k-1) and each window one). */
+    int k = (ebits > 1000)? 6 : (ebits > 300)? 5 : (ebits > 80)? 4
+        : (ebits > 24)? 3 : (ebits > 6)? 2 : 1;
+
+    /* tab[i] holds b^(2i+1). */
+    int tn = 1 << (k-1);
+    u_long *tab = SCM_NEW_ATOMIC_ARRAY(u_long, tn*n);
+    for (int j=0; j<n; j++) tab[j] = b[j];
+    if (tn > 1) {
+        u_long *b2 = SCM_NEW_ATOMIC_ARRAY(u_long, n);
+        mont_mul(b2, b, b, mc);
+        for (int i=1; i<tn; i++) mont_mul(tab+i*n, tab+(i-1)*n, b2, mc);
+    }
+
+    int started = FALSE;
+    for (int i = ebits-1; i >= 0; ) {
+        if (!words_bit(e, i)) {
+            mont_mul(r, r, r, mc);   /* started must be true here */
+            i--;
+            continue;
+        }
+        /* Take the longest window e[j..i] not longer than k that
+           ends with 1. */
+        int j = (i-k+1 < 0)? 0 : i-k+1;
+        while (!words_bit(e, j)) j++;
+        u_long w = 0;
+        for (int l=i; l>=j; l--) w = (w<<1) | (u_long)words_bit(e, l);
+        if (started) {
+            for (int l=i; l>=j; l--) mont_mul(r, r, r, mc);
+            mont_mul(r, r, tab+(w>>1)*n, mc);
+        } else {
+            for (int l=0; l<n; l++) r[l] = tab[(w>>1)*n+l];
+            started = TRUE;
+        }
+        i = j-1;
+    }
+}
+
+/* Returns b^e mod m for nonnegative b and e and odd m > 1.
+   Signs are ignored. */
+ScmObj Scm_BignumExptMod(const ScmBignum *b, const ScmBignum *e,
+                         const ScmBignum *m)
+{
+    int n = words_size(m->values, (int)m->size);
+    int en = words_size(e->values, (int)e->size);
+    SCM_ASSERT(n > 0 && (m->values[0] & 1));
+    mont mc;
+    mont_init(&mc, m->values, n);
+    if (en == 0) return mont_to_integer(mc.one, &mc);
+
+    u_long *x = mont_from_words(b->values, (int)b->size, &mc);
+    u_long *r = SCM_NEW_ATOMIC_ARRAY(u_long, n);
+    mont_expt(r, x, e->values, en, &mc);
+    return mont_to_integer(r, &mc);
+}
+
+/* Strong probable prime test (a step of Miller-Rabin test) of n to
+   base a.  n must be odd and greater than 2.  Returns FALSE if n is
+   known to be composite.  If a is a multiple of n, the test is
+   inconclusive and we return TRUE. */
+int Scm_BignumStrongPRP(const ScmBignum *n, const ScmBignum *a)
+{
+    int nn = words_size(n->values, (int)n->size);
+    SCM_ASSERT(nn > 0 && (n->values[0] & 1));
+    mont mc;
+    mont_init(&mc, n->values, nn);
+
+    u_long *x = mont_from_words(a->values, (int)a->size, &mc);
+    if (words_size(x, nn) == 0) return TRUE;
+
+    /* n-1 = d * 2^s, d odd */
+    u_long *d = SCM_NEW_ATOMIC_ARRAY(u_long, nn);
+    for (int i=0; i<nn; i++) d[i] = n->values[i];
+    d[0] &= ~1UL;
+    int s = words_remove_twos(d, nn);
+
+    u_long *minus_one = SCM_NEW_ATOMIC_ARRAY(u_long, nn);
+    words_sub_n(minus_one, mc.m, mc.one, nn);
+
+    u_long *y = SCM_NEW_ATOMIC_ARRAY(u_long, nn);
+    mont_expt(y, x, d, words_size(d, nn), &mc);
+    if (words_cmp(y, mc.one, nn) == 0) return TRUE;
+    for (int i=0; i<s; i++) {
+        if (words_cmp(y, minus_one, nn) == 0) return TRUE;
+        mont_mul(y, y, y, &mc);
+    }
+    return FALSE;
+}
+
+/* Loads a small signed integer v modulo mc->m in Montgomery form. */
+static u_long *mont_from_si(long v, const mont *mc)
+{
+    u_long w = (v < 0)? -(u_long)v : (u_long)v;
+    u_long *r = mont_from_words(&w, 1, mc);
+    if (v < 0 && words_size(r, mc->n) > 0) words_sub_n(r, mc->m, r, mc->n);
+    return r;
+}
+
+/* Strong Lucas probable prime test of n with Selfridge's parameters,
+   P = 1 and Q = (1-D)/4.  n must be odd, greater than 2 and not a
+   perfect square, and D must satisfy jacobi(D, n) = -1.  Returns FALSE
+   if n is known to be composite.  See R. Baillie and S. S. Wagstaff Jr.,
+   "Lucas pseudoprimes", Math. Comp. 35 (1980). */
+int Scm_BignumStrongLucasPRP(const ScmBignum *n, long D)
+{
+    int nn = words_size(n->values, (int)n->size);
+    SCM_ASSERT(nn > 0 && (n->values[0] & 1));
+    mont mc;
+    mont_init(&mc, n->values, nn);
+
+    /* n+1 = d * 2^s, d odd.  n+1 may carry over to a new word. */
+    u_long *d = SCM_NEW_ATOMIC_ARRAY(u_long, nn+1);
+    for (int i=0; i<nn; i++) d[i] = n->values[i];
+    d[nn] = 0;
+    for (int i=0; i<=nn; i++) if (++d[i] != 0) break;
+    int s = words_remove_twos(d, nn+1);
+    int dn = words_size(d, nn+1);
+
+    u_long *Dm = mont_from_si(D, &mc);
+    u_long *Qm = mont_from_si((1-D)/4, &mc);
+    u_long *U  = SCM_NEW_ATOMIC_ARRAY(u_long, nn);
+    u_long *V  = SCM_NEW_ATOMIC_ARRAY(u_long, nn);
+    u_long *Qk = SCM_NEW_ATOMIC_ARRAY(u_long, nn);
+    u_long *t  = SCM_NEW_ATOMIC_ARRAY(u_long, nn);
+
+    /* Left-to-right binary method on k, starting at k = 1:
+         U_2k = U_k V_k,  V_2k = V_k^2 - 2Q^k,
+         U_k+1 = (U_k + V_k)/2,  V_k+1 = (D U_k + V_k)/2   (P = 1) */
+    for (int i=0; i<nn; i++) {
+        U[i] = mc.one[i];
+        V[i] = mc.one[i];
+        Qk[i] = Qm[i];
+    }
+    int dbits = (dn-1)*WORD_BITS + Scm__HighestBitNumber(d[dn-1]) + 1;
+    for (int i=dbits-2; i>=0; i--) {
+        mont_mul(U, U, V, &mc);
+        mont_mul(V, V, V, &mc);
+        mont_add(t, Qk, Qk, &mc);
+        mont_sub(V, V, t, &mc);
+        mont_mul(Qk, Qk, Qk, &mc);
+        if (words_bit(d, i)) {
+            mont_mul(t, Dm, U, &mc);
+            mont_add(U, U, V, &mc);
+            mont_half(U, U, &mc);
+            mont_add(V, V, t, &mc);
+            mont_half(V, V, &mc);
+            mont_mul(Qk, Qk, Qm, &mc);
+        }
+    }
+
+    if (words_size(U, nn) == 0) return TRUE;
+    for (int r=0; r<s; r++) {
+        if (words_size(V, nn) == 0) return TRUE;
+        mont_mul(V, V, V, &mc);
+        mont_add(t, Qk, Qk, &mc);
+        mont_sub(V, V, t, &mc);
+        mont_mul(Qk, Qk, Qk, &mc);
+    }
+    return FALSE;
+}
+
 /*-----------------------------------------------------------------------
  * Logical (bitwise) operations
  */
@@ -1238,27 +2512,210 @@ int Scm_BignumLogCount(const ScmBignum *b)
 
 
 /*-----------------------------------------------------------------------
- * Printing
+ * Radix conversion
  */
 
+/* Long numbers are converted by divide-and-conquer: To print, we divide
+   the number by a power of radix about the square root of it, and print
+   quotient and remainder recursively.  To read, we convert each half of
+   the digits and combine them by multiplication.  With the subquadratic
+   multiplication and division, both are O(M(n) log n).
+
+   The powers are radix^(k*2^i), where radix^k is the largest power of
+   radix that fits in a word.  They are computed by repeated squaring
+   and cached, for they are used over and over again. */
+
+#define RADIX_POWERS_MAX      40
+
+/* Below these sizes (in words for printing, in words of digits for
+   reading) we use the simple quadratic conversion. */
+#define TOSTR_DC_THRESHOLD    30
+#define FROMSTR_DC_THRESHOLD  40
+
+static struct {
+    ScmInternalMutex mutex;
+    ScmBignum *powers[SCM_RADIX_MAX-SCM_RADIX_MIN+1][RADIX_POWERS_MAX];
+} radix_powers = { SCM_INTERNAL_MUTEX_INITIALIZER };
+
+/* Returns k such that radix^k is the largest power of radix that fits
+   in a word, and sets radix^k to *base. */
+static int radix_word_digits(int radix, u_long *base)
+{
+    u_long b = radix;
+    int k = 1;
+    while (b <= SCM_ULONG_MAX / radix) { b *= radix; k++; }
+    *base = b;
+    return k;
+}
+
+/* Returns radix^(k*2^level), where k is as above.  The result has
+   no leading zero words. */
+static const ScmBignum *radix_power(int radix, int level)
+{
+    if (level >= RADIX_POWERS_MAX) Scm_Error("too large bignum");
+
+    ScmBignum *p;
+    SCM_INTERNAL_MUTEX_SAFE_LOCK_BEGIN(radix_powers.mutex);
+    ScmBignum **tab = radix_powers.powers[radix-SCM_RADIX_MIN];
+    if (tab[0] == NULL) {
+        u_long base;
+        radix_word_digits(radix, &base);
+        tab[0] = Scm_MakeBignumWithSize(1, base);
+    }
+    for (int i=1; i<=level; i++) {
+        if (tab[i] == NULL) {
+            ScmBignum *sq = bignum_mul(tab[i-1], tab[i-1]);
+            while (sq->values[sq->size-1] == 0) sq->size--;
+            tab[i] = sq;
+        }
+    }
+    p = tab[level];
+    SCM_INTERNAL_MUTEX_SAFE_LOCK_END();
+    return p;
+}
+
+/* Writes x[0..xn) as exactly len digits, padding zeros at the front,
+   into buf.  x must be less than radix^len.  x is destroyed. */
+static void words_to_digits(char *buf, int len, u_long *x, int xn,
+                            int radix, const char *tab)
+{
+    while (xn > 0 && x[xn-1] == 0) xn--;
+
+    if (xn < TOSTR_DC_THRESHOLD) {
+        u_long base;
+        int k = radix_word_digits(radix, &base);
+        char *p = buf + len;
+        while (xn > 0) {
+            u_long rem = words_divrem_1(x, x, xn, base);
+            if (x[xn-1] == 0) xn--;
+            for (int i=0; i<k && p > buf; i++) {
+                *--p = tab[rem % radix];
+                rem /= radix;
+            }
+        }
+        while (p > buf) *--p = '0';
+        return;
+    }
+
+    /* Split by radix^lowlen, whose size is at most half of x. */
+    int level = Scm__HighestBitNumber((u_long)xn/2);
+    u_long base;
+    int lowlen = radix_word_digits(radix, &base) << level;
+    const ScmBignum *p = radix_power(radix, level);
+    int pn = p->size;
+    u_long *q = SCM_NEW_ATOMIC_ARRAY(u_long, xn - pn + 1);
+    u_long *r = SCM_NEW_ATOMIC_ARRAY(u_long, pn);
+    words_divrem(q, r, x, xn, p->values, pn, SCM_BIGNUM_DIV_AUTO);
+    words_to_digits(buf, len - lowlen, q, xn - pn + 1, radix, tab);
+    words_to_digits(buf + len - lowlen, lowlen, r, pn, radix, tab);
+}
+
 ScmObj Scm_BignumToString(const ScmBignum *b, int radix, int use_upper)
 {
     static const char ltab[] = "0123456789abcdefghijklmnopqrstuvwxyz";
     static const char utab[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
     const char *tab = use_upper? utab : ltab;
-    ScmObj h = SCM_NIL, t = SCM_NIL;
     if (radix < SCM_RADIX_MIN || radix > SCM_RADIX_MAX)
         Scm_Error("radix out of range: %d", radix);
-    ScmBignum *q = SCM_BIGNUM(Scm_BignumCopy(b));
-    for (;q->size > 0;) {
-        long rem = bignum_sdiv(q, radix);
-        SCM_ASSERT(rem >= 0 && rem < radix);
-        SCM_APPEND1(h, t, SCM_MAKE_CHAR(tab[rem]));
-        for (; q->values[q->size-1] == 0 && q->size > 0; q->size--)
-            ;
+
+    int xn = b->size;
+    while (xn > 0 && b->values[xn-1] == 0) xn--;
+    if (xn == 0) return SCM_MAKE_STR("0");
+
+    /* Upper bound of the number of digits. */
+    double bits = (double)(xn-1)*WORD_BITS
+        + Scm__HighestBitNumber(b->values[xn-1]) + 1;
+    int len = (int)(bits / log2((double)radix)) + 2;
+
+    u_long *x = SCM_NEW_ATOMIC_ARRAY(u_long, xn);
+    for (int i=0; i<xn; i++) x[i] = b->values[i];
+    char *buf = SCM_NEW_ATOMIC2(char*, len + 2);
+    words_to_digits(buf + 1, len, x, xn, radix, tab);
+
+    char *p = buf + 1;
+    while (*p == '0') p++;      /* x is nonzero, so we won't overrun */
+    if (b->sign < 0) *--p = '-';
+    buf[len+1] = '\0';
+    int n = (int)(buf + len + 1 - p);
+    return Scm_MakeString(p, n, n, 0);
+}
+
+/* r[0..n) = r[0..n) * b + carry; returns the carry word. */
+static u_long words_muladd_1(u_long *r, int n, u_long b, u_long carry)
+{
+    for (int i=0; i<n; i++) {
+        u_long hi, lo, t, x = r[i];
+        UMUL(hi, lo, x, b);
+        u_long c = 0;
+        t = lo;
+        UADD(r[i], c, t, carry);
+        carry = hi + c;
+    }
+    return carry;
+}
+
+/* c[0..m) are the "big digits" in radix^k, least significant first.
+   Stores the value in r, which must have m words, and returns its size
+   without leading zeros. */
+static int chunks_to_words(u_long *r, const u_long *c, int m, int radix)
+{
+    if (m < FROMSTR_DC_THRESHOLD) {
+        u_long base;
+        radix_word_digits(radix, &base);
+        int rn = 0;
+        for (int i=m-1; i>=0; i--) {
+            u_long cy = words_muladd_1(r, rn, base, c[i]);
+            if (cy) r[rn++] = cy;
+        }
+        return rn;
+    }
+
+    /* Split into the low 2^level chunks and the rest. */
+    int level = Scm__HighestBitNumber((u_long)m-1);
+    int lm = 1 << level;
+    const ScmBignum *p = radix_power(radix, level);
+    int pn = p->size;
+    u_long *hi = SCM_NEW_ATOMIC_ARRAY(u_long, m - lm);
+    u_long *lo = SCM_NEW_ATOMIC_ARRAY(u_long, lm);
+    int hn = chunks_to_words(hi, c + lm, m - lm, radix);
+    int ln = chunks_to_words(lo, c, lm, radix);
+    int rn = hn + pn;
+    if (hn == 0) {
+        words_clear(r, rn);
+    } else if (hn >= pn) {
+        words_mul(r, hi, hn, p->values, pn);
+    } else {
+        words_mul(r, p->values, pn, hi, hn);
     }
-    if (q->sign < 0) SCM_APPEND1(h, t, SCM_MAKE_CHAR('-'));
-    return Scm_ListToString(Scm_ReverseX(h));
+    if (ln > 0) words_add_to(r, rn, lo, ln);
+    while (rn > 0 && r[rn-1] == 0) rn--;
+    return rn;
+}
+
+/* Returns an exact nonnegative integer whose representation in radix
+   is digits[0..ndigits), most significant first.  Each element is
+   a digit value (0 <= digit < radix), not a character.
+   The result is normalized. */
+ScmObj Scm_DigitsToBignum(const char *digits, int ndigits, int radix)
+{
+    if (radix < SCM_RADIX_MIN || radix > SCM_RADIX_MAX)
+        Scm_Error("radix out of range: %d", radix);
+    u_long base;
+    int k = radix_word_digits(radix, &base);
+    int m = (ndigits + k - 1) / k;
+    if (m == 0) return SCM_MAKE_INT(0);
+
+    u_long *c = SCM_NEW_ATOMIC_ARRAY(u_long, m);
+    for (int i=0; i<m; i++) {
+        int e = ndigits - i*k, s = (e - k > 0)? e - k : 0;
+        u_long v = 0;
+        for (int j=s; j<e; j++) v = v*radix + digits[j];
+        c[i] = v;
+    }
+    ScmBignum *r = make_bignum(m);
+    r->size = chunks_to_words(r->values, c, m, radix);
+    if (r->size == 0) return SCM_MAKE_INT(0);
+    return Scm_NormalizeBignum(r);
 }
 
 void Scm_BignumDump(const ScmBignum *b, ScmPort *out)
@@ -1312,3 +2769,12 @@ ScmBignum *Scm_BignumAccMultAddUI(ScmBignum *acc, u_long coef, u_long c)
         return rr;
     }
 }
+
+/*-----------------------------------------------------------------------
+ * Initialization
+ */
+
+void Scm__InitBignum(void)
+{
+    SCM_INTERNAL_MUTEX_INIT(radix_powers.mutex);
+}
@@ -32,6 +32,8 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #define LIBGAUCHE_BODY
 #include "gauche.h"
 #include "gauche/priv/configP.h"
@@ -332,10 +334,281 @@ static int cmp_int(ScmObj x, ScmObj y, ScmObj dummy SCM_UNUSED)
     return Scm_Compare(x, y);
 }
 
-void Scm_SortArray(ScmObj *elts, int nelts, ScmObj cmpfn SCM_UNUSED)
+/*
+ * Radix sort
+ *
+ *  When the default order is used and the elements are all fixnums, or
+ *  all flonums, we don't need to call Scm_Compare at all.  Each element
+ *  is mapped to an unsigned 64bit key that preserves the order, and the
+ *  keys are sorted by LSD radix sort, 8 bits per pass.  The radix sort
+ *  is stable, so it can also serve stable-sort.
+ *
+ *  The same machinery sorts numeric uniform vectors in place.
+ */
+
+#define RADIX_SORT_THRESHOLD  64 /* below this, comparison sort is faster */
+#define SIGN64  ((uint64_t)1 << 63)
+
+/* Order-preserving key of a double.  -0.0 and 0.0 are mapped to
+   the same key, for they are = to each other. */
+static inline uint64_t flonum_key(double d)
+{
+    union { double d; uint64_t u; } x;
+    x.d = (d == 0.0) ? 0.0 : d;
+    return (x.u & SIGN64) ? ~x.u : (x.u | SIGN64);
+}
+
+/* Sort KEYS[0..N) of which only lower NBYTES bytes are significant.
+   If VALS is not NULL, it is permuted along with KEYS.  A pass is
+   skipped if all keys have the same digit in it. */
+static void radix_sort(uint64_t *keys, ScmObj *vals, ScmSize n, int nbytes)
+{
+    ScmSize count[8][256];      /* nbytes <= 8 */
+    memset(count, 0, sizeof(count[0])*nbytes);
+    for (ScmSize i=0; i<n; i++) {
+        uint64_t k = keys[i];
+        for (int b=0; b<nbytes; b++, k >>= 8) count[b][k&0xff]++;
+    }
+
+    uint64_t *sk = keys, *dk = NULL;
+    ScmObj *sv = vals, *dv = NULL;
+    for (int b=0; b<nbytes; b++) {
+        int shift = b*8;
+        if (count[b][(sk[0]>>shift)&0xff] == n) continue;
+        if (dk == NULL) {
+            dk = SCM_NEW_ATOMIC_ARRAY(uint64_t, n);
+            if (vals) dv = SCM_NEW_ARRAY(ScmObj, n);
+        }
+        ScmSize pos = 0;
+        for (int d=0; d<256; d++) {
+            ScmSize c = count[b][d];
+            count[b][d] = pos;
+            pos += c;
+        }
+        for (ScmSize i=0; i<n; i++) {
+            ScmSize j = count[b][(sk[i]>>shift)&0xff]++;
+            dk[j] = sk[i];
+            if (vals) dv[j] = sv[i];
+        }
+        uint64_t *tk = sk; sk = dk; dk = tk;
+        ScmObj *tv = sv; sv = dv; dv = tv;
+    }
+    if (sk != keys) {
+        memcpy(keys, sk, n*sizeof(uint64_t));
+        if (vals) memcpy(vals, sv, n*sizeof(ScmObj));
+    }
+}
+
+/* Sorts ELTS[0..N) in the default order if all of them are fixnums,
+   or all of them are flonums other than NaN.  Returns TRUE if sorted,
+   FALSE if ELTS is left untouched, which is also the case when N is
+   too small to benefit.  The sort is stable. */
+int Scm__RadixSortArray(ScmObj *elts, ScmSize n)
+{
+    if (n <= 1) return TRUE;
+    if (n < RADIX_SORT_THRESHOLD) return FALSE;
+    uint64_t *keys;
+    if (SCM_INTP(elts[0])) {
+        for (ScmSize i=1; i<n; i++) {
+            if (!SCM_INTP(elts[i])) return FALSE;
+        }
+        keys = SCM_NEW_ATOMIC_ARRAY(uint64_t, n);
+        for (ScmSize i=0; i<n; i++) {
+            keys[i] = (uint64_t)(int64_t)SCM_INT_VALUE(elts[i]) ^ SIGN64;
+        }
+    } else if (SCM_FLONUMP(elts[0])) {
+        for (ScmSize i=0; i<n; i++) {
+            if (!SCM_FLONUMP(elts[i]) || isnan(SCM_FLONUM_VALUE(elts[i]))) {
+                return FALSE;
+            }
+        }
+        keys = SCM_NEW_ATOMIC_ARRAY(uint64_t, n);
+        for (ScmSize i=0; i<n; i++) {
+            keys[i] = flonum_key(SCM_FLONUM_VALUE(elts[i]));
+        }
+    } else {
+        return FALSE;
+    }
+    radix_sort(keys, elts, n, 8);
+    return TRUE;
+}
+
+/* Returns TRUE if the default order of ELTS[0..N) is decided without
+   calling Scheme code, i.e. all of them are real numbers, all are
+   strings, or all are characters.  Other objects may be compared by
+   a user-defined object-compare method.  Only such arrays are sorted
+   with multiple threads (see gauche.parallel-sortutil). */
+int Scm__BuiltinOrderArrayP(ScmObj *elts, ScmSize n)
+{
+    if (n == 0) return TRUE;
+    if (SCM_REALP(elts[0])) {
+        for (ScmSize i=1; i<n; i++) if (!SCM_REALP(elts[i])) return FALSE;
+    } else if (SCM_STRINGP(elts[0])) {
+        for (ScmSize i=1; i<n; i++) if (!SCM_STRINGP(elts[i])) return FALSE;
+    } else if (SCM_CHARP(elts[0])) {
+        for (ScmSize i=1; i<n; i++) if (!SCM_CHARP(elts[i])) return FALSE;
+    } else {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* Uniform vectors.  Integers are sorted in their numeric order.  Floating
+   point numbers are sorted by their bit patterns, which agrees with the
+   numeric order except that -0.0 comes before 0.0, and NaNs are placed
+   at either end, depending on their sign bit. */
+#define UV_INT_KEYS(ctype, utype, nb)                                   \
+    do {                                                                \
+        ctype *e = (ctype*)SCM_UVECTOR_ELEMENTS(v) + start;             \
+        const utype sb = (utype)1 << (nb*8-1);                          \
+        keys = SCM_NEW_ATOMIC_ARRAY(uint64_t, n);                       \
+        for (ScmSize i=0; i<n; i++) keys[i] = (utype)e[i] ^ (signedp?sb:0); \
+        radix_sort(keys, NULL, n, nb);                                  \
+        for (ScmSize i=0; i<n; i++) e[i] = (ctype)((utype)keys[i] ^ (signedp?sb:0)); \
+    } while (0)
+
+#define UV_FLT_KEYS(utype, nb)                                          \
+    do {                                                                \
+        utype *e = (utype*)SCM_UVECTOR_ELEMENTS(v) + start;             \
+        const utype sb = (utype)1 << (nb*8-1);                          \
+        keys = SCM_NEW_ATOMIC_ARRAY(uint64_t, n);                       \
+        for (ScmSize i=0; i<n; i++) {                                   \
+            keys[i] = (utype)((e[i] & sb) ? ~e[i] : (e[i] | sb));       \
+        }                                                               \
+        radix_sort(keys, NULL, n, nb);                                  \
+        for (ScmSize i=0; i<n; i++) {                                   \
+            utype k = (utype)keys[i];                                   \
+            e[i] = (k & sb) ? (utype)(k & ~sb) : (utype)~k;             \
+        }                                                               \
+    } while (0)
+
+void Scm__UVectorSort(ScmUVector *v, ScmSize start, ScmSize end)
+{
+    SCM_UVECTOR_CHECK_MUTABLE(v);
+    if (start < 0 || end > SCM_UVECTOR_SIZE(v) || start > end) {
+        Scm_Error("range out of bound: (%ld %ld)", start, end);
+    }
+    ScmSize n = end - start;
+    if (n <= 1) return;
+    uint64_t *keys;
+    int signedp = TRUE;
+    switch (Scm_UVectorType(SCM_CLASS_OF(v))) {
+    case SCM_UVECTOR_S8:  UV_INT_KEYS(int8_t, uint8_t, 1); break;
+    case SCM_UVECTOR_S16: UV_INT_KEYS(int16_t, uint16_t, 2); break;
+    case SCM_UVECTOR_S32: UV_INT_KEYS(int32_t, uint32_t, 4); break;
+    case SCM_UVECTOR_S64: UV_INT_KEYS(int64_t, uint64_t, 8); break;
+    case SCM_UVECTOR_F16: UV_FLT_KEYS(uint16_t, 2); break;
+    case SCM_UVECTOR_F32: UV_FLT_KEYS(uint32_t, 4); break;
+    case SCM_UVECTOR_F64: UV_FLT_KEYS(uint64_t, 8); break;
+    default:
+        signedp = FALSE;
+        switch (Scm_UVectorType(SCM_CLASS_OF(v))) {
+        case SCM_UVECTOR_U8:  UV_INT_KEYS(uint8_t, uint8_t, 1); break;
+        case SCM_UVECTOR_U16: UV_INT_KEYS(uint16_t, uint16_t, 2); break;
+        case SCM_UVECTOR_U32: UV_INT_KEYS(uint32_t, uint32_t, 4); break;
+        case SCM_UVECTOR_U64: UV_INT_KEYS(uint64_t, uint64_t, 8); break;
+        default:
+            Scm_Error("uniform vector of unordered elements can't be sorted: %S",
+                      SCM_OBJ(v));
+        }
+    }
+}
+
+/* Key of the I-th element of uvector V, for merging. */
+static inline uint64_t uvector_key(ScmUVector *v, int type, ScmSize i)
+{
+    void *e = SCM_UVECTOR_ELEMENTS(v);
+    switch (type) {
+    case SCM_UVECTOR_S8:  return (uint8_t)((int8_t*)e)[i] ^ 0x80;
+    case SCM_UVECTOR_U8:  return ((uint8_t*)e)[i];
+    case SCM_UVECTOR_S16: return (uint16_t)((int16_t*)e)[i] ^ 0x8000;
+    case SCM_UVECTOR_U16: return ((uint16_t*)e)[i];
+    case SCM_UVECTOR_S32: return (uint32_t)((int32_t*)e)[i] ^ 0x80000000UL;
+    case SCM_UVECTOR_U32: return ((uint32_t*)e)[i];
+    case SCM_UVECTOR_S64: return (uint64_t)((int64_t*)e)[i] ^ SIGN64;
+    case SCM_UVECTOR_U64: return ((uint64_t*)e)[i];
+    case SCM_UVECTOR_F16: {
+        uint16_t u = ((uint16_t*)e)[i];
+        return (uint16_t)((u & 0x8000) ? ~u : (u | 0x8000));
+    }
+    case SCM_UVECTOR_F32: {
+        uint32_t u = ((uint32_t*)e)[i];
+        return (uint32_t)((u & 0x80000000UL) ? ~u : (u | 0x80000000UL));
+    }
+    case SCM_UVECTOR_F64: {
+        uint64_t u = ((uint64_t*)e)[i];
+        return (u & SIGN64) ? ~u : (u | SIGN64);
+    }
+    default:
+        Scm_Error("uniform vector of unordered elements can't be merged: %S",
+                  SCM_OBJ(v));
+        return 0;               /* dummy */
+    }
+}
+
+/*
+ * Merging sorted ranges
+ *
+ *  SRC[LO..MID) and SRC[MID..HI) are sorted in the default order.
+ *  Merge them into DST[LO..HI).  An element from the left range precedes
+ *  an equal element from the right range.  These are the building blocks
+ *  of parallel sort (lib/gauche/parallel-sortutil.scm), which runs
+ *  them concurrently on disjoint ranges.
+ */
+void Scm__MergeArrays(ScmObj *src, ScmObj *dst,
+                      ScmSize lo, ScmSize mid, ScmSize hi)
+{
+    ScmSize i = lo, j = mid, k = lo;
+    while (i < mid && j < hi) {
+        if (Scm_Compare(src[j], src[i]) < 0) dst[k++] = src[j++];
+        else                                 dst[k++] = src[i++];
+    }
+    while (i < mid) dst[k++] = src[i++];
+    while (j < hi)  dst[k++] = src[j++];
+}
+
+void Scm__MergeUVectors(ScmUVector *src, ScmUVector *dst,
+                        ScmSize lo, ScmSize mid, ScmSize hi)
+{
+    int type = Scm_UVectorType(SCM_CLASS_OF(src));
+    if (type != Scm_UVectorType(SCM_CLASS_OF(dst))) {
+        Scm_Error("uniform vectors of the same type required, but got %S and %S",
+                  SCM_OBJ(src), SCM_OBJ(dst));
+    }
+    SCM_UVECTOR_CHECK_MUTABLE(dst);
+    if (lo < 0 || lo > mid || mid > hi
+        || hi > SCM_UVECTOR_SIZE(src) || hi > SCM_UVECTOR_SIZE(dst)) {
+        Scm_Error("range out of bound: (%ld %ld %ld)", lo, mid, hi);
+    }
+    size_t esize = Scm_UVectorElementSize(SCM_CLASS_OF(src));
+    char *s = (char*)SCM_UVECTOR_ELEMENTS(src);
+    char *d = (char*)SCM_UVECTOR_ELEMENTS(dst);
+    ScmSize i = lo, j = mid, k = lo;
+    if (i < mid && j < hi) {
+        uint64_t ki = uvector_key(src, type, i), kj = uvector_key(src, type, j);
+        for (;;) {
+            if (kj < ki) {
+                memcpy(d + k++*esize, s + j++*esize, esize);
+                if (j == hi) break;
+                kj = uvector_key(src, type, j);
+            } else {
+                memcpy(d + k++*esize, s + i++*esize, esize);
+                if (i == mid) break;
+                ki = uvector_key(src, type, i);
+            }
+        }
+    }
+    if (i < mid) memcpy(d + k*esize, s + i*esize, (mid-i)*esize);
+    else if (j < hi) memcpy(d + k*esize, s + j*esize, (hi-j)*esize);
+}
+
+void Scm_SortArray(ScmObj *elts, int nelts, ScmObj cmpfn)
 {
     int limit, i;
     if (nelts <= 1) return;
+    if (!SCM_PROCEDUREP(cmpfn) && Scm__RadixSortArray(elts, nelts)) {
+        return;
+    }
     /* approximate 2*log2(nelts) */
     for (i=nelts,limit=1; i > 0; limit++) {i>>=1;}
     if (SCM_PROCEDUREP(cmpfn)) {
@@ -345,6 +618,499 @@ void Scm_SortArray(ScmObj *elts, int nelts, ScmObj cmpfn SCM_UNUSED)
     }
 }
 
+/*
+ * Adaptive stable sort
+ *
+ *  A natural merge sort after Tim Peters' listsort (see listsort.txt in
+ *  CPython).  Ascending runs already in the input are found and used as
+ *  they are, strictly descending ones are reversed, and short ones are
+ *  extended to MINRUN by binary insertion.  Runs are merged keeping the
+ *  balance of the run stack, and the merge switches to galloping mode
+ *  when one side keeps winning.  Presorted input needs only n-1
+ *  comparisons.
+ *
+ *  CMP is called as cmp(x, y, data), and x is regarded to strictly
+ *  precede y iff it returns a negative value.  Only this "less than"
+ *  relation is used, and equal elements keep their order.
+ *  The comparator may be inconsistent; the result is then unspecified
+ *  but still a permutation of the input.  If the comparator raises an
+ *  error, however, the array is left in an intermediate state of
+ *  merging, so the caller should pass a scratch copy when the array
+ *  must be kept intact (see Scm__StableSortX).
+ */
+
+typedef int (*sort_cmp_t)(ScmObj, ScmObj, ScmObj);
+
+#define TIM_MIN_GALLOP 7
+#define TIM_MAX_PENDING 85      /* enough for 2^64 elements */
+#define TIM_TMPBUF_SIZE 256
+
+typedef struct tim_state_rec {
+    sort_cmp_t cmp;
+    ScmObj data;
+    int min_gallop;
+    ScmObj *tmp;
+    ScmSize tmpsize;
+    int npending;
+    ScmObj *base[TIM_MAX_PENDING];
+    ScmSize len[TIM_MAX_PENDING];
+    ScmObj tmpbuf[TIM_TMPBUF_SIZE];
+} tim_state;
+
+#define TIM_LT(ts, x, y)  ((ts)->cmp((x), (y), (ts)->data) < 0)
+
+static void tim_init(tim_state *ts, sort_cmp_t cmp, ScmObj data)
+{
+    ts->cmp = cmp;
+    ts->data = data;
+    ts->min_gallop = TIM_MIN_GALLOP;
+    ts->tmp = ts->tmpbuf;
+    ts->tmpsize = TIM_TMPBUF_SIZE;
+    ts->npending = 0;
+}
+
+/* The temporary area holds live objects, so it must be scanned by GC. */
+static ScmObj *tim_tmp(tim_state *ts, ScmSize need)
+{
+    if (need > ts->tmpsize) {
+        ts->tmp = SCM_NEW_ARRAY(ScmObj, need);
+        ts->tmpsize = need;
+    }
+    return ts->tmp;
+}
+
+/* Takes 6 most significant bits of N, plus 1 if any of the rest is set. */
+static ScmSize tim_minrun(ScmSize n)
+{
+    ScmSize r = 0;
+    while (n >= 64) {
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
+}
+
+/* Binary insertion sort of A[0..N), where A[0..START) is already sorted. */
+static void tim_binsort(tim_state *ts, ScmObj *a, ScmSize n, ScmSize start)
+{
+    for (; start < n; start++) {
+        ScmObj pivot = a[start];
+        ScmSize l = 0, r = start;
+        while (l < r) {
+            ScmSize m = l + ((r - l) >> 1);
+            if (TIM_LT(ts, pivot, a[m])) r = m;
+            else l = m + 1;
+        }
+        memmove(a+l+1, a+l, (start-l)*sizeof(ScmObj));
+        a[l] = pivot;
+    }
+}
+
+/* Returns the length of the run at the beginning of A[0..N).  If it is
+   strictly descending, it is reversed in place. */
+static ScmSize tim_count_run(tim_state *ts, ScmObj *a, ScmSize n)
+{
+    if (n <= 1) return n;
+    ScmSize k = 2;
+    if (TIM_LT(ts, a[1], a[0])) {
+        while (k < n && TIM_LT(ts, a[k], a[k-1])) k++;
+        for (ScmSize i = 0, j = k-1; i < j; i++, j--) {
+            ScmObj t = a[i]; a[i] = a[j]; a[j] = t;
+        }
+    } else {
+        while (k < n && !TIM_LT(ts, a[k], a[k-1])) k++;
+    }
+    return k;
+}
+
+/* Locate the position to insert KEY into sorted A[0..N), starting the
+   search from A[HINT].  tim_gallop_left returns the leftmost such position
+   (A[k-1] < KEY <= A[k]), and tim_gallop_right the rightmost one
+   (A[k-1] <= KEY < A[k]). */
+static ScmSize tim_gallop_left(tim_state *ts, ScmObj key,
+                               ScmObj *a, ScmSize n, ScmSize hint)
+{
+    ScmSize ofs = 1, lastofs = 0, maxofs;
+    if (TIM_LT(ts, a[hint], key)) {
+        /* a[hint+lastofs] < key <= a[hint+ofs] */
+        maxofs = n - hint;
+        while (ofs < maxofs && TIM_LT(ts, a[hint+ofs], key)) {
+            lastofs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+        if (ofs > maxofs) ofs = maxofs;
+        lastofs += hint;
+        ofs += hint;
+    } else {
+        /* a[hint-ofs] < key <= a[hint-lastofs] */
+        maxofs = hint + 1;
+        while (ofs < maxofs && !TIM_LT(ts, a[hint-ofs], key)) {
+            lastofs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+        if (ofs > maxofs) ofs = maxofs;
+        ScmSize k = lastofs;
+        lastofs = hint - ofs;
+        ofs = hint - k;
+    }
+    /* a[lastofs] < key <= a[ofs]; binary search in between */
+    lastofs++;
+    while (lastofs < ofs) {
+        ScmSize m = lastofs + ((ofs - lastofs) >> 1);
+        if (TIM_LT(ts, a[m], key)) lastofs = m + 1;
+        else ofs = m;
+    }
+    return ofs;
+}
+
+static ScmSize tim_gallop_right(tim_state *ts, ScmObj key,
+                                ScmObj *a, ScmSize n, ScmSize hint)
+{
+    ScmSize ofs = 1, lastofs = 0, maxofs;
+    if (TIM_LT(ts, key, a[hint])) {
+        /* a[hint-ofs] <= key < a[hint-lastofs] */
+        maxofs = hint + 1;
+        while (ofs < maxofs && TIM_LT(ts, key, a[hint-ofs])) {
+            lastofs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+        if (ofs > maxofs) ofs = maxofs;
+        ScmSize k = lastofs;
+        lastofs = hint - ofs;
+        ofs = hint - k;
+    } else {
+        /* a[hint+lastofs] <= key < a[hint+ofs] */
+        maxofs = n - hint;
+        while (ofs < maxofs && !TIM_LT(ts, key, a[hint+ofs])) {
+            lastofs = ofs;
+            ofs = (ofs << 1) + 1;
+        }
+        if (ofs > maxofs) ofs = maxofs;
+        lastofs += hint;
+        ofs += hint;
+    }
+    /* a[lastofs] <= key < a[ofs]; binary search in between */
+    lastofs++;
+    while (lastofs < ofs) {
+        ScmSize m = lastofs + ((ofs - lastofs) >> 1);
+        if (TIM_LT(ts, key, a[m])) ofs = m;
+        else lastofs = m + 1;
+    }
+    return ofs;
+}
+
+/* Merge adjacent runs PA[0..NA) and PB[0..NB), where NA <= NB,
+   PB[0] < PA[0] and PB[NB-1] < PA[NA-1].  Works from the left,
+   saving the A run in the temporary area.  Invariant: dest + na == pb. */
+static void tim_merge_lo(tim_state *ts, ScmObj *pa, ScmSize na,
+                         ScmObj *pb, ScmSize nb)
+{
+    ScmObj *dest = pa;
+    pa = tim_tmp(ts, na);
+    memcpy(pa, dest, na*sizeof(ScmObj));
+
+    *dest++ = *pb++; nb--;
+    if (nb == 0) goto done;
+    if (na == 1) goto copy_b;
+
+    int min_gallop = ts->min_gallop;
+    for (;;) {
+        ScmSize acount = 0, bcount = 0;
+        /* one element at a time, until one side wins consistently */
+        for (;;) {
+            if (TIM_LT(ts, *pb, *pa)) {
+                *dest++ = *pb++; nb--;
+                if (nb == 0) goto done;
+                bcount++; acount = 0;
+                if (bcount >= min_gallop) break;
+            } else {
+                *dest++ = *pa++; na--;
+                if (na == 1) goto copy_b;
+                acount++; bcount = 0;
+                if (acount >= min_gallop) break;
+            }
+        }
+        /* galloping */
+        min_gallop++;
+        do {
+            min_gallop -= (min_gallop > 1);
+            ts->min_gallop = min_gallop;
+            ScmSize k = tim_gallop_right(ts, *pb, pa, na, 0);
+            acount = k;
+            if (k) {
+                memcpy(dest, pa, k*sizeof(ScmObj));
+                dest += k; pa += k; na -= k;
+                if (na == 1) goto copy_b;
+                if (na == 0) goto done; /* only with inconsistent cmp */
+            }
+            *dest++ = *pb++; nb--;
+            if (nb == 0) goto done;
+
+            k = tim_gallop_left(ts, *pa, pb, nb, 0);
+            bcount = k;
+            if (k) {
+                memmove(dest, pb, k*sizeof(ScmObj));
+                dest += k; pb += k; nb -= k;
+                if (nb == 0) goto done;
+            }
+            *dest++ = *pa++; na--;
+            if (na == 1) goto copy_b;
+        } while (acount >= TIM_MIN_GALLOP || bcount >= TIM_MIN_GALLOP);
+        min_gallop++;           /* penalty for leaving galloping mode */
+        ts->min_gallop = min_gallop;
+    }
+ done:
+    if (na) memcpy(dest, pa, na*sizeof(ScmObj));
+    return;
+ copy_b:
+    /* the last element of A goes after the rest of B */
+    memmove(dest, pb, nb*sizeof(ScmObj));
+    dest[nb] = *pa;
+}
+
+/* Same as tim_merge_lo, but NA >= NB and works from the right,
+   saving the B run.  Invariant: dest - nb == pa. */
+static void tim_merge_hi(tim_state *ts, ScmObj *pa, ScmSize na,
+                         ScmObj *pb, ScmSize nb)
+{
+    ScmObj *basea = pa;
+    ScmObj *baseb = tim_tmp(ts, nb);
+    memcpy(baseb, pb, nb*sizeof(ScmObj));
+    ScmObj *dest = pb + nb - 1;
+    pb = baseb + nb - 1;
+    pa += na - 1;
+
+    *dest-- = *pa--; na--;
+    if (na == 0) goto done;
+    if (nb == 1) goto copy_a;
+
+    int min_gallop = ts->min_gallop;
+    for (;;) {
+        ScmSize acount = 0, bcount = 0;
+        for (;;) {
+            if (TIM_LT(ts, *pb, *pa)) {
+                *dest-- = *pa--; na--;
+                if (na == 0) goto done;
+                acount++; bcount = 0;
+                if (acount >= min_gallop) break;
+            } else {
+                *dest-- = *pb--; nb--;
+                if (nb == 1) goto copy_a;
+                bcount++; acount = 0;
+                if (bcount >= min_gallop) break;
+            }
+        }
+        min_gallop++;
+        do {
+            min_gallop -= (min_gallop > 1);
+            ts->min_gallop = min_gallop;
+            ScmSize k = na - tim_gallop_right(ts, *pb, basea, na, na-1);
+            acount = k;
+            if (k) {
+                dest -= k; pa -= k;
+                memmove(dest+1, pa+1, k*sizeof(ScmObj));
+                na -= k;
+                if (na == 0) goto done;
+            }
+            *dest-- = *pb--; nb--;
+            if (nb == 1) goto copy_a;
+
+            k = nb - tim_gallop_left(ts, *pa, baseb, nb, nb-1);
+            bcount = k;
+            if (k) {
+                dest -= k; pb -= k;
+                memcpy(dest+1, pb+1, k*sizeof(ScmObj));
+                nb -= k;
+                if (nb == 1) goto copy_a;
+                if (nb == 0) goto done; /* only with inconsistent cmp */
+            }
+            *dest-- = *pa--; na--;
+            if (na == 0) goto done;
+        } while (acount >= TIM_MIN_GALLOP || bcount >= TIM_MIN_GALLOP);
+        min_gallop++;
+        ts->min_gallop = min_gallop;
+    }
+ done:
+    if (nb) memcpy(dest-(nb-1), baseb, nb*sizeof(ScmObj));
+    return;
+ copy_a:
+    /* the first element of B goes before the rest of A */
+    dest -= na; pa -= na;
+    memmove(dest+1, pa+1, na*sizeof(ScmObj));
+    *dest = *pb;
+}
+
+/* Merge the I-th and I+1-th pending runs. */
+static void tim_merge_at(tim_state *ts, int i)
+{
+    ScmObj *pa = ts->base[i], *pb = ts->base[i+1];
+    ScmSize na = ts->len[i], nb = ts->len[i+1];
+
+    ts->len[i] = na + nb;
+    if (i == ts->npending - 3) {
+        ts->base[i+1] = ts->base[i+2];
+        ts->len[i+1] = ts->len[i+2];
+    }
+    ts->npending--;
+
+    /* Elements of A not greater than B[0] are already in place,
+       and so are elements of B not less than A[NA-1]. */
+    ScmSize k = tim_gallop_right(ts, *pb, pa, na, 0);
+    pa += k; na -= k;
+    if (na == 0) return;
+    nb = tim_gallop_left(ts, pa[na-1], pb, nb, nb-1);
+    if (nb == 0) return;
+
+    if (na <= nb) tim_merge_lo(ts, pa, na, pb, nb);
+    else          tim_merge_hi(ts, pa, na, pb, nb);
+}
+
+/* Keep the run lengths on the stack decreasing faster than Fibonacci
+   numbers, so that merges stay balanced. */
+static void tim_merge_collapse(tim_state *ts)
+{
+    ScmSize *len = ts->len;
+    while (ts->npending > 1) {
+        int n = ts->npending - 2;
+        if ((n > 0 && len[n-1] <= len[n] + len[n+1])
+            || (n > 1 && len[n-2] <= len[n-1] + len[n])) {
+            if (len[n-1] < len[n+1]) n--;
+            tim_merge_at(ts, n);
+        } else if (len[n] <= len[n+1]) {
+            tim_merge_at(ts, n);
+        } else {
+            break;
+        }
+    }
+}
+
+static void tim_merge_force_collapse(tim_state *ts)
+{
+    while (ts->npending > 1) {
+        int n = ts->npending - 2;
+        if (n > 0 && ts->len[n-1] < ts->len[n+1]) n--;
+        tim_merge_at(ts, n);
+    }
+}
+
+static void tim_sort(ScmObj *elts, ScmSize nelts, sort_cmp_t cmp, ScmObj data)
+{
+    if (nelts < 2) return;
+    tim_state ts;
+    tim_init(&ts, cmp, data);
+    ScmSize minrun = tim_minrun(nelts);
+    ScmObj *lo = elts;
+    ScmSize rest = nelts;
+    do {
+        ScmSize n = tim_count_run(&ts, lo, rest);
+        if (n < minrun) {
+            ScmSize force = (rest <= minrun) ? rest : minrun;
+            tim_binsort(&ts, lo, force, n);
+            n = force;
+        }
+        ts.base[ts.npending] = lo;
+        ts.len[ts.npending] = n;
+        ts.npending++;
+        tim_merge_collapse(&ts);
+        lo += n;
+        rest -= n;
+    } while (rest > 0);
+    tim_merge_force_collapse(&ts);
+}
+
+/* Merge sorted arrays A[0..NA) and B[0..NB) stably into DST, which
+   must have room for NA+NB elements. */
+static void tim_merge(ScmObj *dst, ScmObj *a, ScmSize na, ScmObj *b, ScmSize nb,
+                      sort_cmp_t cmp, ScmObj data)
+{
+    tim_state ts;
+    tim_init(&ts, cmp, data);
+    memcpy(dst, a, na*sizeof(ScmObj));
+    memcpy(dst+na, b, nb*sizeof(ScmObj));
+    if (na == 0 || nb == 0) return;
+    ts.base[0] = dst;    ts.len[0] = na;
+    ts.base[1] = dst+na; ts.len[1] = nb;
+    ts.npending = 2;
+    tim_merge_at(&ts, 0);
+}
+
+static int cmp_less(ScmObj x, ScmObj y, ScmObj fn)
+{
+    return SCM_FALSEP(Scm_ApplyRec2(fn, x, y)) ? 1 : -1;
+}
+
+/* Stable version of Scm_SortArray.  CMPFN has the same meaning. */
+void Scm_StableSortArray(ScmObj *elts, ScmSize nelts, ScmObj cmpfn)
+{
+    if (SCM_PROCEDUREP(cmpfn)) {
+        tim_sort(elts, nelts, cmp_scm, cmpfn);
+    } else if (!Scm__RadixSortArray(elts, nelts)) {
+        tim_sort(elts, nelts, cmp_int, NULL);
+    }
+}
+
+/* For Scheme-level stable-sort!.  Sorts a vector or a list SEQ in place;
+   for a list, the cells are kept and their cars are rearranged.
+   LESS is a predicate, or #f for the default order.
+   We sort a copy of the elements and write them back at the end, since
+   merging is done in place and an error raised by LESS in the middle
+   would leave the array with some elements duplicated and others lost. */
+ScmObj Scm__StableSortX(ScmObj seq, ScmObj less)
+{
+    ScmObj *elts;
+    ScmSize len;
+    if (SCM_VECTORP(seq)) {
+        len = SCM_VECTOR_SIZE(seq);
+        elts = SCM_NEW_ARRAY(ScmObj, len);
+        memcpy(elts, SCM_VECTOR_ELEMENTS(seq), len*sizeof(ScmObj));
+    } else if (Scm_Length(seq) >= 0) {
+        len = 0;
+        elts = Scm_ListToArray(seq, &len, NULL, TRUE);
+    } else {
+        SCM_TYPE_ERROR(seq, "proper list or vector");
+        return SCM_UNDEFINED;   /* dummy */
+    }
+    if (SCM_FALSEP(less)) Scm_StableSortArray(elts, len, SCM_FALSE);
+    else tim_sort(elts, len, cmp_less, less);
+    if (SCM_VECTORP(seq)) {
+        memcpy(SCM_VECTOR_ELEMENTS(seq), elts, len*sizeof(ScmObj));
+    } else if (SCM_PAIRP(seq)) {
+        ScmObj cp = seq;
+        for (ScmSize i=0; i<len; i++, cp = SCM_CDR(cp)) {
+            Scm_SetCar(cp, elts[i]);
+        }
+    }
+    return seq;
+}
+
+/* Stable merge of sorted lists A and B, with galloping.  LESS is a
+   predicate or #f.  If DESTRUCTIVE, the cells of A and B are reused. */
+ScmObj Scm__MergeLists(ScmObj a, ScmObj b, ScmObj less, int destructive)
+{
+    ScmSize na = Scm_Length(a), nb = Scm_Length(b);
+    if (na < 0) SCM_TYPE_ERROR(a, "proper list");
+    if (nb < 0) SCM_TYPE_ERROR(b, "proper list");
+    if (na == 0) return b;
+    if (nb == 0) return a;
+
+    ScmObj *va = SCM_NEW_ARRAY(ScmObj, na+nb), *vb = va + na;
+    ScmObj *dst = SCM_NEW_ARRAY(ScmObj, na+nb);
+    ScmObj cp;
+    ScmSize i = 0;
+    SCM_FOR_EACH(cp, a) va[i++] = SCM_CAR(cp);
+    SCM_FOR_EACH(cp, b) va[i++] = SCM_CAR(cp);
+    if (SCM_FALSEP(less)) tim_merge(dst, va, na, vb, nb, cmp_int, NULL);
+    else                  tim_merge(dst, va, na, vb, nb, cmp_less, less);
+
+    if (!destructive) return Scm_ArrayToList(dst, na+nb);
+    i = 0;
+    ScmObj last = SCM_NIL;
+    SCM_FOR_EACH(cp, a) { Scm_SetCar(cp, dst[i++]); last = cp; }
+    Scm_SetCdr(last, b);
+    SCM_FOR_EACH(cp, b) Scm_SetCar(cp, dst[i++]);
+    return a;
+}
+
 /*
  * higher-level fns
  */
@@ -356,7 +1122,7 @@ static ScmObj sort_list_int(ScmObj objs, ScmObj fn, int destructive)
     ScmObj starray[STATIC_SIZE];
     ScmSize len = STATIC_SIZE;
     ScmObj *array = Scm_ListToArray(objs, &len, starray, TRUE);
-    Scm_SortArray(array, len, fn);
+    Scm_StableSortArray(array, len, fn);
     if (destructive) {
         ScmObj cp = objs;
         for (ScmSize i=0; i<len; i++, cp = SCM_CDR(cp)) {
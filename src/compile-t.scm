@@ -104,3 +104,337 @@
                type instance: ~s"
               ($*-src iform) type))
     ($const type)))
+
+;;============================================================
+;; Fixnum specialization in loops
+;;
+
+;; Run after pass4.  We look at embedded loops---the 'embed' $CALL nodes
+;; made by pass2/local-call-embedder, which is what named let, do and
+;; dotimes usually become---and find loop variables that are always
+;; nonnegative fixnums.  With that knowledge, some generic instructions
+;; in the loop body can be replaced with the ones that skip type checks:
+;;
+;;   (vector-ref v i), (vector-set! v i x)
+;;      => VEC-REF-NC, VEC-SET-NC, if the expression is dominated by
+;;         the loop test i < (vector-length v).  That is, the bounds check
+;;         is done only once, by the loop test.
+;;   (+ i n), (+ n i), (- i n)  where n is a small constant
+;;      => FXADDI, which omits the tag check (overflow is still checked).
+;;
+;; A loop variable I is a nonnegative fixnum if it is never set!, its
+;; initial value is a nonnegative fixnum, and each jump (recursive call)
+;; passes either I itself, another nonnegative fixnum, or (+ I 1) under
+;; a test I < N or I != N where N is a fixnum.  For the latter, we also
+;; require that I starts no greater than N and N is loop-invariant, so
+;; that I <= N holds at the loop head and I != N implies I < N.
+;;
+;; The facts we record are about immutable lvars, so once established
+;; they're valid anywhere in their scope.  The ones that depend on the
+;; control flow (the outcome of $IF tests) are kept in a list ENV, each
+;; element being (lvar kind term), where kind is either lt (lvar < term)
+;; or ne (lvar != term).
+;;
+;; A term represents a nonnegative fixnum value:
+;;   (vec . lvar)  -  (vector-length lvar).  Since we've computed it,
+;;                    the value of lvar is a vector.
+;;   (fix . n)     -  a constant n.
+;;   (var . lvar)  -  the value of lvar.
+
+(define-simple-struct fxloop #f make-fxloop
+  (ivs       ; hashtable lvar -> #t, for lvars known to be nonneg fixnums
+   terms     ; hashtable lvar -> term, for lvars whose value is the term
+   bounds    ; hashtable lvar -> term, the loop variable never exceeds term
+   target    ; the embed $CALL node of the loop being analyzed, or #f
+   collect   ; called with each jump $CALL to target and env
+   seen      ; hashtable of visited $LABEL nodes
+   locals))  ; hashtable of lvars bound inside the analyzed loop
+
+(define (type/specialize-loops iform)
+  (unless (vm-compiler-flag-no-fixnum-specialization?)
+    (fxloop/walk iform '() (make-fxloop (make-hash-table 'eq?)
+                                        (make-hash-table 'eq?)
+                                        (make-hash-table 'eq?)
+                                        #f #f (make-hash-table 'eq?) #f)))
+  iform)
+
+;; If (fxloop-target cx) is #f, we rewrite $ASM nodes as we go, and
+;; analyze embedded loops we encounter.  Otherwise we're scanning the body
+;; of the loop being analyzed; we don't modify anything.
+(define/case (fxloop/walk iform env cx)
+  (iform-tag iform)
+  [($DEFINE) (fxloop/walk ($define-expr iform) '() cx)]
+  [($LSET)   (fxloop/walk ($lset-expr iform) env cx)]
+  [($GSET)   (fxloop/walk ($gset-expr iform) env cx)]
+  [($IF)     (let1 test ($if-test iform)
+               (fxloop/walk test env cx)
+               (receive (then-facts else-facts) (fxloop/test-facts test cx)
+                 (fxloop/walk ($if-then iform) (append then-facts env) cx)
+                 (fxloop/walk ($if-else iform) (append else-facts env) cx)))]
+  [($LET)    (dolist [init ($let-inits iform)] (fxloop/walk init env cx))
+             (fxloop/bind-locals! ($let-lvars iform) cx)
+             (when (and (eq? ($let-type iform) 'let)
+                        (not (fxloop-target cx)))
+               (for-each (cut fxloop/bind! <> <> cx)
+                         ($let-lvars iform) ($let-inits iform)))
+             (fxloop/walk ($let-body iform) env cx)]
+  [($RECEIVE) (fxloop/walk ($receive-expr iform) env cx)
+              (fxloop/bind-locals! ($receive-lvars iform) cx)
+              (fxloop/walk ($receive-body iform) env cx)]
+  [($LAMBDA) (fxloop/bind-locals! ($lambda-lvars iform) cx)
+             (fxloop/walk ($lambda-body iform) '() cx)]
+  [($CLAMBDA) (dolist [c ($clambda-closures iform)] (fxloop/walk c env cx))]
+  [($LABEL)  (unless (hash-table-get (fxloop-seen cx) iform #f)
+               (hash-table-put! (fxloop-seen cx) iform #t)
+               ;; A label may be reached from multiple places.
+               (fxloop/walk ($label-body iform) '() cx))]
+  [($SEQ)    (dolist [x ($seq-body iform)] (fxloop/walk x env cx))]
+  [($CALL)   (dolist [arg ($call-args iform)] (fxloop/walk arg env cx))
+             (case ($call-flag iform)
+               [(jump) (when (eq? ($call-proc iform) (fxloop-target cx))
+                         ((fxloop-collect cx) iform env))]
+               [(embed) (fxloop/embed iform env cx)]
+               [else (fxloop/walk ($call-proc iform) env cx)])]
+  [($ASM)    (dolist [arg ($asm-args iform)] (fxloop/walk arg env cx))
+             (unless (fxloop-target cx) (fxloop/asm! iform env cx))]
+  [($CONS $APPEND $MEMV $EQ? $EQV?)
+             (fxloop/walk ($*-arg0 iform) env cx)
+             (fxloop/walk ($*-arg1 iform) env cx)]
+  [($VECTOR $LIST $LIST*)
+             (dolist [arg ($*-args iform)] (fxloop/walk arg env cx))]
+  [($LIST->VECTOR) (fxloop/walk ($*-arg0 iform) env cx)]
+  [($DYNENV) (fxloop/walk ($dynenv-key iform) env cx)
+             (fxloop/walk ($dynenv-value iform) env cx)
+             (fxloop/walk ($dynenv-body iform) env cx)]
+  [else #f])
+
+(define (fxloop/bind-locals! lvars cx)
+  (and-let1 tab (fxloop-locals cx)
+    (dolist [lv lvars] (hash-table-put! tab lv #t))))
+
+;; LVAR is bound to INIT by let.
+(define (fxloop/bind! lvar init cx)
+  (when (lvar-immutable? lvar)
+    (and-let1 t (fxloop/term init cx)
+      (hash-table-put! (fxloop-terms cx) lvar t)
+      (hash-table-put! (fxloop-ivs cx) lvar #t))))
+
+;; The body of an embedded lambda is only entered from the embed call and
+;; the jumps within itself, so ENV at the call site stays valid in it.
+(define (fxloop/embed call env cx)
+  (let1 lm ($call-proc call)
+    (fxloop/bind-locals! ($lambda-lvars lm) cx)
+    (unless (fxloop-target cx)
+      (fxloop/analyze! call env cx))
+    (let1 body ($lambda-body lm)
+      (fxloop/walk (if (has-tag? body $LABEL) ($label-body body) body)
+                   env cx))))
+
+;; Returns a term if IFORM yields a nonnegative fixnum, #f otherwise.
+(define (fxloop/term iform cx)
+  (cond [($const? iform)
+         (let1 v ($const-value iform)
+           (and (fixnum? v) (>= v 0) `(fix . ,v)))]
+        [($lref? iform)
+         (let1 lv ($lref-lvar iform)
+           (cond [(hash-table-get (fxloop-terms cx) lv #f)]
+                 [(hash-table-get (fxloop-ivs cx) lv #f) `(var . ,lv)]
+                 [else #f]))]
+        [(and (has-tag? iform $ASM)
+              (eqv? (car ($asm-insn iform)) VEC-LEN)
+              ($lref? (car ($asm-args iform)))
+              (lvar-immutable? ($lref-lvar (car ($asm-args iform)))))
+         `(vec . ,($lref-lvar (car ($asm-args iform))))]
+        [else #f]))
+
+(define (fxloop/term=? a b)
+  (and (eq? (car a) (car b)) (eqv? (cdr a) (cdr b))))
+
+;; Returns two lists of facts; the ones hold when TEST yields true, and
+;; the ones hold when it yields false.
+(define (fxloop/test-facts test cx)
+  (define (fact x kind y)
+    (or (and-let* ([ ($lref? x) ]
+                   [lv ($lref-lvar x)]
+                   [ (lvar-immutable? lv) ]
+                   [t (fxloop/term y cx)])
+          `((,lv ,kind ,t)))
+        '()))
+  (if (has-tag? test $ASM)
+    (let ([code (car ($asm-insn test))]
+          [args ($asm-args test)])
+      (match args
+        [(x) (if (eqv? code NOT)
+               (receive (t e) (fxloop/test-facts x cx) (values e t))
+               (values '() '()))]
+        [(x y) (cond [(eqv? code NUMLT2) (values (fact x 'lt y) '())]
+                     [(eqv? code NUMGT2) (values (fact y 'lt x) '())]
+                     [(eqv? code NUMGE2) (values '() (fact x 'lt y))]
+                     [(eqv? code NUMLE2) (values '() (fact y 'lt x))]
+                     [(eqv? code NUMEQ2)
+                      (values '() (append (fact x 'ne y) (fact y 'ne x)))]
+                     [else (values '() '())])]
+        [_ (values '() '())]))
+    (values '() '())))
+
+;; Loop variable candidate
+(define-simple-struct fxcand #f make-fxcand
+  (lvar
+   term          ; term of the initial value
+   (inv #t)      ; #f if it can't be loop-invariant
+   (ind #t)      ; #f if it can't be a nonnegative fixnum variable
+   (steps '())   ; for each (+ lvar 1) passed to jump, facts on lvar there
+   (reset #f)    ; #t if other nonnegative fixnum is passed to jump
+   (bound #f)))  ; if known, lvar <= bound always holds at the loop head
+
+;; CALL is an embed $CALL.  Find out the loop variables that are
+;; nonnegative fixnums and record them in CX.
+;; We start from the optimistic assumption that all candidates are
+;; invariant and/or nonnegative fixnums, then scan the loop body to drop
+;; the ones that contradict, until no more candidates are dropped.
+(define (fxloop/analyze! call env cx)
+  (let* ([lm ($call-proc call)]
+         [lvars ($lambda-lvars lm)]
+         [cands (filter-map (^[lv init]
+                              (and (lvar-immutable? lv)
+                                   (and-let1 t (fxloop/term init cx)
+                                     (cons lv (make-fxcand lv t)))))
+                            lvars ($call-args call))])
+    (define (install! c)
+      (let1 lv (fxcand-lvar c)
+        (hash-table-delete! (fxloop-terms cx) lv)
+        (hash-table-delete! (fxloop-ivs cx) lv)
+        (when (fxcand-inv c)
+          (hash-table-put! (fxloop-terms cx) lv (fxcand-term c)))
+        (when (or (fxcand-inv c) (fxcand-ind c))
+          (hash-table-put! (fxloop-ivs cx) lv #t))))
+    (define (check-jump! jump env locals)
+      (for-each (^[lv arg]
+                  (unless (and ($lref? arg) (eq? ($lref-lvar arg) lv))
+                    (hash-table-put! locals lv #t) ; variant
+                    (and-let1 c (assq-ref cands lv)
+                      (fxcand-inv-set! c #f)
+                      (when (fxcand-ind c)
+                        (cond [(fxloop/step? arg lv)
+                               (let1 fs (filter (^f (eq? (car f) lv)) env)
+                                 (if (null? fs)
+                                   (fxcand-ind-set! c #f)
+                                   (fxcand-steps-set! c
+                                     (cons fs (fxcand-steps c)))))]
+                              [(fxloop/term arg cx) (fxcand-reset-set! c #t)]
+                              [else (fxcand-ind-set! c #f)])))))
+                lvars ($call-args jump)))
+    (when (and (pair? cands)
+               (eqv? ($lambda-optarg lm) 0)
+               (= (length lvars) (length ($call-args call))))
+      (let loop ()
+        (dolist [c (map cdr cands)]
+          (install! c)
+          (fxcand-steps-set! c '())
+          (fxcand-reset-set! c #f))
+        (let* ([locals (make-hash-table 'eq?)]
+               [flags (map (^c (list (fxcand-inv (cdr c)) (fxcand-ind (cdr c))))
+                           cands)]
+               [body ($lambda-body lm)])
+          (fxloop/walk (if (has-tag? body $LABEL) ($label-body body) body)
+                       env
+                       (make-fxloop (fxloop-ivs cx) (fxloop-terms cx)
+                                    (fxloop-bounds cx) call
+                                    (cut check-jump! <> <> locals)
+                                    (make-hash-table 'eq?) locals))
+          (dolist [c (map cdr cands)]
+            (when (fxcand-ind c) (fxloop/judge! c locals)))
+          (if (equal? flags
+                      (map (^c (list (fxcand-inv (cdr c)) (fxcand-ind (cdr c))))
+                           cands))
+            (dolist [c (map cdr cands)]
+              (install! c)
+              (if (and (fxcand-ind c) (fxcand-bound c))
+                (hash-table-put! (fxloop-bounds cx) (fxcand-lvar c)
+                                 (fxcand-bound c))
+                (hash-table-delete! (fxloop-bounds cx) (fxcand-lvar c))))
+            (loop)))))))
+
+;; (+ lvar 1) or (+ 1 lvar)
+(define (fxloop/step? iform lvar)
+  (and (has-tag? iform $ASM)
+       (eqv? (car ($asm-insn iform)) NUMADD2)
+       (match ($asm-args iform)
+         [(x y) (or (and ($lref? x) (eq? ($lref-lvar x) lvar)
+                         ($const? y) (eqv? ($const-value y) 1))
+                    (and ($lref? y) (eq? ($lref-lvar y) lvar)
+                         ($const? x) (eqv? ($const-value x) 1)))]
+         [_ #f])))
+
+;; Decide whether the candidate C is a nonnegative fixnum variable, after
+;; all jumps are scanned.  Each step (+ lvar 1) must be under lvar < N for
+;; some fixnum N, or, if all steps are under the tests against the same
+;; loop-invariant N and lvar starts from a value not greater than N,
+;; lvar != N suffices.
+(define (fxloop/judge! c locals)
+  (define (invariant? t)
+    (or (eq? (car t) 'fix) (not (hash-table-get locals (cdr t) #f))))
+  (define (starts-below? t)
+    (let1 t0 (fxcand-term c)
+      (or (fxloop/term=? t0 t)
+          (and (eq? (car t0) 'fix)
+               (or (eqv? (cdr t0) 0)
+                   (and (eq? (car t) 'fix) (<= (cdr t0) (cdr t))))))))
+  (let* ([steps (fxcand-steps c)]
+         [bound (and (pair? steps)
+                     (not (fxcand-reset c))
+                     (find (^t (and (invariant? t)
+                                    (starts-below? t)
+                                    (every (^[fs] (any (^f (fxloop/term=? (caddr f) t))
+                                                       fs))
+                                           steps)))
+                           (map caddr (car steps))))])
+    (fxcand-bound-set! c bound)
+    (unless (or bound
+                (every (^[fs] (any (^f (eq? (cadr f) 'lt)) fs)) steps))
+      (fxcand-ind-set! c #f))))
+
+;; Rewrite $ASM node if possible.
+(define (fxloop/asm! iform env cx)
+  (define (fxvar? x)
+    (and ($lref? x) (hash-table-get (fxloop-ivs cx) ($lref-lvar x) #f)))
+  (define (imm x neg?)
+    (and ($const? x)
+         (let1 v ($const-value x)
+           (and (fixnum? v)
+                (integer-fits-insn-arg? (if neg? (- v) v))
+                (if neg? (- v) v)))))
+  (define (fxaddi! x n)
+    ($asm-insn-set! iform `(,FXADDI ,n))
+    ($asm-args-set! iform (list x)))
+  (let ([code (car ($asm-insn iform))]
+        [args ($asm-args iform)])
+    (cond
+     [(eqv? code VEC-REF)
+      (when (fxloop/index-ok? (car args) (cadr args) env cx)
+        ($asm-insn-set! iform `(,VEC-REF-NC)))]
+     [(eqv? code VEC-SET)
+      (when (fxloop/index-ok? (car args) (cadr args) env cx)
+        ($asm-insn-set! iform `(,VEC-SET-NC)))]
+     [(eqv? code NUMADD2)
+      (let ([x (car args)] [y (cadr args)])
+        (cond [(and (fxvar? x) (imm y #f)) => (cut fxaddi! x <>)]
+              [(and (fxvar? y) (imm x #f)) => (cut fxaddi! y <>)]))]
+     [(eqv? code NUMSUB2)
+      (let ([x (car args)] [y (cadr args)])
+        (cond [(and (fxvar? x) (imm y #t)) => (cut fxaddi! x <>)]))])))
+
+;; Returns #t if (vector-ref VEC IND) is known to be in range.
+(define (fxloop/index-ok? vec ind env cx)
+  (and ($lref? vec)
+       ($lref? ind)
+       (lvar-immutable? ($lref-lvar vec))
+       (hash-table-get (fxloop-ivs cx) ($lref-lvar ind) #f)
+       (let ([t `(vec . ,($lref-lvar vec))]
+             [i ($lref-lvar ind)]
+             [bound (hash-table-get (fxloop-bounds cx) ($lref-lvar ind) #f)])
+         (any (^f (and (eq? (car f) i)
+                       (fxloop/term=? (caddr f) t)
+                       (or (eq? (cadr f) 'lt)
+                           (and bound (fxloop/term=? bound t)))))
+              env))))
@@ -1633,7 +1633,8 @@
   (rec iform))
 
 ;; Some inline stuff
-(define-inline (pass2-4 iform module) (pass4 (pass3 (pass2 iform) #f) module))
+(define-inline (pass2-4 iform module)
+  (type/specialize-loops (pass4 (pass3 (pass2 iform) #f) module)))
 
 ;; Compile target.  Used in pass5 to represent
 
@@ -2254,6 +2255,9 @@
    (return (SCM_VM_COMPILER_FLAG_IS_SET (Scm_VM) SCM_COMPILE_NO_POST_INLINE_OPT)))
  (define-cproc vm-compiler-flag-no-lifting? () ::<boolean>
    (return (SCM_VM_COMPILER_FLAG_IS_SET (Scm_VM) SCM_COMPILE_NO_LIFTING)))
+ (define-cproc vm-compiler-flag-no-fixnum-specialization? () ::<boolean>
+   (return (SCM_VM_COMPILER_FLAG_IS_SET (Scm_VM)
+                                        SCM_COMPILE_NO_FIXNUM_SPECIALIZATION)))
 
  (define-enum SCM_COMPILE_NOINLINE_GLOBALS)
  (define-enum SCM_COMPILE_NOINLINE_LOCALS)
@@ -2271,6 +2275,7 @@
  (define-enum SCM_COMPILE_LEGACY_DEFINE)
  (define-enum SCM_COMPILE_MUTABLE_LITERALS)
  (define-enum SCM_COMPILE_SRFI_FEATURE_ID)
+ (define-enum SCM_COMPILE_NO_FIXNUM_SPECIALIZATION)
 
  ;; Set/get VM's current module info. (temporary)
  (define-cproc vm-current-module () (return (SCM_OBJ (-> (Scm_VM) module))))
@@ -97,6 +97,7 @@ extern void Scm__InitNetAddr(void);
 extern void Scm__InitNetDb(void);
 extern void Scm__InitMutex(void);
 extern void Scm__InitThreads(void);
+extern void Scm__InitProf(void);
 
 extern void Scm_Init_libalpha(void);
 extern void Scm_Init_libbool(void);
@@ -224,6 +225,7 @@ void Scm_Init(const char *signature)
     CALL_INIT(Scm__InitNetDb);
     CALL_INIT(Scm__InitMutex);
     CALL_INIT(Scm__InitThreads);
+    CALL_INIT(Scm__InitProf);
 
     CALL_INIT(Scm_Init_libalpha);
     CALL_INIT(Scm_Init_libbool);
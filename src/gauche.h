@@ -464,10 +464,16 @@ typedef struct ScmHeaderRec {
 
 #define SCM_HEADER       ScmHeader hdr /* for declaration */
 
+/* While the allocation profiler is running, it needs to know the class
+   of the object just allocated.  See prof.c */
+SCM_EXTERN int   Scm__AllocProfilerActive;
+SCM_EXTERN void  Scm__ProfSetClass(void *obj, ScmClass *klass);
+
 /* Here comes the ugly part.  To understand the general idea, just ignore
    GAUCHE_BROKEN_LINKER_WORKAROUND part; except that, it's pretty simple.
    Every heap allocated object contains (pointer to its class + 7) in its
    tag field.  */
+
 #if !defined(GAUCHE_BROKEN_LINKER_WORKAROUND)
 
 # define SCM_CLASS_DECL(klass) extern ScmClass klass
@@ -479,7 +485,14 @@ typedef struct ScmHeaderRec {
    To get a class of a given object, always use Scm_ClassOf().
  */
 # define SCM_CLASS_OF(obj)      SCM_CLASS((SCM_OBJ(obj)->tag - 7))
-# define SCM_SET_CLASS(obj, k)  (SCM_OBJ(obj)->tag = (ScmByte*)(k) + 7)
+static inline void Scm__SetClass(void *obj, ScmByte *tag)
+{
+    if (Scm__AllocProfilerActive) {
+        Scm__ProfSetClass(obj, (ScmClass*)(tag - 7));
+    }
+    ((ScmHeader*)obj)->tag = tag;
+}
+# define SCM_SET_CLASS(obj, k)  Scm__SetClass((void*)(obj), (ScmByte*)(k) + 7)
 
 /* Check if classof(OBJ) equals to an extended class KLASS.
    We can check SCM_HPTRP instead of SCM_HOBJP here, since a pair never
@@ -497,7 +510,15 @@ typedef struct ScmHeaderRec {
 # define SCM_CLASS_STATIC_TAG(klass) SCM_CLASS2TAG(SCM_CLASS_STATIC_PTR(klass))
 
 # define SCM_CLASS_OF(obj)      (*(ScmClass**)((SCM_OBJ(obj)->tag - 7)))
-# define SCM_SET_CLASS(obj, k)  (SCM_OBJ(obj)->tag = (ScmByte*)((k)->classPtr) + 7)
+static inline void Scm__SetClass(void *obj, ScmByte *tag)
+{
+    if (Scm__AllocProfilerActive) {
+        Scm__ProfSetClass(obj, *(ScmClass**)(tag - 7));
+    }
+    ((ScmHeader*)obj)->tag = tag;
+}
+# define SCM_SET_CLASS(obj, k)                                   \
+    Scm__SetClass((void*)(obj), (ScmByte*)((k)->classPtr) + 7)
 
 # define SCM_XTYPEP(obj, klass) \
     (SCM_HOBJP(obj)&&(SCM_CLASS_OF(obj) == klass))
@@ -519,9 +540,17 @@ typedef struct ScmInstanceRec {
 #define SCM_INSTANCE(obj)        ((ScmInstance*)(obj))
 #define SCM_INSTANCE_SLOTS(obj)  (SCM_INSTANCE(obj)->slots)
 
-/* Fundamental allocators */
-#define SCM_MALLOC(size)          GC_MALLOC(size)
-#define SCM_MALLOC_ATOMIC(size)   GC_MALLOC_ATOMIC(size)
+/* Fundamental allocators.
+   While the allocation profiler is running, allocations are routed
+   to Scm__ProfMalloc so that they can be sampled.  See prof.c. */
+SCM_EXTERN void *Scm__ProfMalloc(size_t size, int atomic);
+
+#define SCM_MALLOC(size)                                        \
+    (Scm__AllocProfilerActive                                   \
+     ? Scm__ProfMalloc(size, FALSE) : GC_MALLOC(size))
+#define SCM_MALLOC_ATOMIC(size)                                 \
+    (Scm__AllocProfilerActive                                   \
+     ? Scm__ProfMalloc(size, TRUE) : GC_MALLOC_ATOMIC(size))
 #define SCM_STRDUP(s)             GC_STRDUP(s)
 #define SCM_STRDUP_PARTIAL(s, n)  Scm_StrdupPartial(s, n)
 
@@ -1666,6 +1695,10 @@ SCM_EXTERN void   Scm_ProfilerStart(void);
 SCM_EXTERN int    Scm_ProfilerStop(void);
 SCM_EXTERN void   Scm_ProfilerReset(void);
 
+SCM_EXTERN void   Scm_AllocProfilerStart(long interval, int byBytes);
+SCM_EXTERN int    Scm_AllocProfilerStop(void);
+SCM_EXTERN void   Scm_AllocProfilerReset(void);
+
 /*---------------------------------------------------
  * UTILITY STUFF
  */
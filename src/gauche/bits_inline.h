@@ -74,6 +74,9 @@ static inline u_long Scm__CountBitsBelow(u_long word, int n)
    there's at least one '1'. */
 static inline int Scm__LowestBitNumber(u_long word)
 {
+#if defined(__GNUC__)
+    return __builtin_ctzl(word);
+#else
     int n = 0;
     word ^= (word&(word-1));    /* leave the rightmost '1' only */
 
@@ -92,12 +95,16 @@ static inline int Scm__LowestBitNumber(u_long word)
     if (word&0xaaaaaaaaaaaaaaaa) n += 1;
 #endif
     return n;
+#endif /*!__GNUC__*/
 }
 
 /* Returns the bit number of the highest '1' bit in the word, assuming
    there's at least one '1'. */
 static inline int Scm__HighestBitNumber(u_long word)
 {
+#if defined(__GNUC__)
+    return SIZEOF_LONG*8 - 1 - __builtin_clzl(word);
+#else
     int n = 0;
     u_long z;
 
@@ -115,6 +122,7 @@ static inline int Scm__HighestBitNumber(u_long word)
     if ((z = word&0xcccccccccccccccc) != 0) { n += 2;  word = z; }
     return (word&0xaaaaaaaaaaaaaaaa)? n+1 : n;
 #endif
+#endif /*!__GNUC__*/
 }
 
 
@@ -318,6 +318,7 @@ SCM_EXTERN ScmObj Scm_DivCompat(ScmObj arg1, ScmObj arg2);
 SCM_EXTERN ScmObj Scm_Quotient(ScmObj arg1, ScmObj arg2, ScmObj *rem);
 SCM_EXTERN ScmObj Scm_Modulo(ScmObj arg1, ScmObj arg2, int remainder);
 SCM_EXTERN ScmObj Scm_Gcd(ScmObj x, ScmObj y);
+SCM_EXTERN ScmObj Scm_ExptMod(ScmObj b, ScmObj e, ScmObj m);
 
 SCM_EXTERN ScmObj Scm_Expt(ScmObj x, ScmObj y);
 SCM_EXTERN ScmObj Scm_ExactIntegerExpt(ScmObj x, ScmObj y);
@@ -425,6 +426,8 @@ SCM_EXTERN void   Scm_NumberFormatFromWriteContext(ScmNumberFormat*,
                                                    const ScmWriteState*);
 SCM_EXTERN size_t Scm_PrintNumber(ScmPort *port, ScmObj n, ScmNumberFormat *f);
 SCM_EXTERN size_t Scm_PrintDouble(ScmPort *port, double d, ScmNumberFormat *f);
+SCM_EXTERN void   Scm_DStringPutDouble(ScmDString *ds, double d,
+                                       ScmNumberFormat *f);
 
 /* Higher-level convenience routines */
 SCM_EXTERN ScmObj Scm_NumberToString(ScmObj num, int radix, u_long flags);
@@ -279,7 +279,8 @@ enum ScmPortFlags {
     SCM_PORT_WALKING = (1L<<1), /* indicates we're currently in 'walk' pass
                                    of two-pass writing. */
     SCM_PORT_PRIVATE = (1L<<2), /* this port is for 'private' use within
-                                   a thread, so never need to be locked. */
+                                   a thread, so never need to be locked.
+                                   See Scm_SetPortConfined(). */
     SCM_PORT_CASE_FOLD = (1L<<3),/* read from or write to this port should
                                     be case folding. */
     SCM_PORT_TRANSIENT = (1L<<4) /* a buffered output port that's used
@@ -348,6 +349,8 @@ SCM_EXTERN int    Scm_GetPortBufferSigpipeSensitive(ScmPort *port);
 SCM_EXTERN void   Scm_SetPortBufferSigpipeSensitive(ScmPort *port, int sensitive);
 SCM_EXTERN int    Scm_GetPortCaseFolding(ScmPort *port);
 SCM_EXTERN void   Scm_SetPortCaseFolding(ScmPort *port, int flag);
+SCM_EXTERN ScmVM *Scm_PortConfinedThread(ScmPort *port);
+SCM_EXTERN void   Scm_SetPortConfined(ScmPort *port, int flag);
 SCM_EXTERN ScmObj Scm_GetPortReaderLexicalMode(ScmPort *port);
 SCM_EXTERN void   Scm_SetPortReaderLexicalMode(ScmPort *port, ScmObj obj);
 
@@ -433,6 +436,8 @@ SCM_EXTERN ScmObj Scm_UngottenBytesUnsafe(ScmPort *port);
 
 SCM_EXTERN ScmObj Scm_ReadLine(ScmPort *port);
 SCM_EXTERN ScmObj Scm_ReadLineUnsafe(ScmPort *port);
+SCM_EXTERN ScmObj Scm_ReadString(ScmPort *port, ScmSize n);
+SCM_EXTERN ScmObj Scm_ReadStringUnsafe(ScmPort *port, ScmSize n);
 
 /*================================================================
  * File ports
@@ -69,9 +69,33 @@ SCM_EXTERN ScmObj Scm_BignumSub(const ScmBignum *bx, const ScmBignum *by);
 SCM_EXTERN ScmObj Scm_BignumSubSI(const ScmBignum *bx, long y);
 SCM_EXTERN ScmObj Scm_BignumMul(const ScmBignum *bx, const ScmBignum *by);
 SCM_EXTERN ScmObj Scm_BignumMulSI(const ScmBignum *bx, long y);
+
+/* Multiplication algorithms; for testing and benchmarking */
+enum {
+    SCM_BIGNUM_MUL_AUTO,
+    SCM_BIGNUM_MUL_SCHOOLBOOK,
+    SCM_BIGNUM_MUL_KARATSUBA,
+    SCM_BIGNUM_MUL_TOOM3,
+    SCM_BIGNUM_MUL_NTT
+};
+SCM_EXTERN ScmObj Scm__BignumMulWith(const ScmBignum *bx, const ScmBignum *by,
+                                     int algorithm);
 SCM_EXTERN ScmObj Scm_BignumDivSI(const ScmBignum *bx, long y, long *r);
 SCM_EXTERN ScmObj Scm_BignumDivRem(const ScmBignum *bx, const ScmBignum *by);
+/* Division algorithms; for testing and benchmarking */
+enum {
+    SCM_BIGNUM_DIV_AUTO,
+    SCM_BIGNUM_DIV_SCHOOLBOOK
+};
+SCM_EXTERN ScmObj Scm__BignumDivRemWith(const ScmBignum *bx,
+                                        const ScmBignum *by,
+                                        int algorithm);
 SCM_EXTERN long   Scm_BignumRemSI(const ScmBignum *bx, long y);
+SCM_EXTERN ScmObj Scm_BignumGcd(const ScmBignum *bx, const ScmBignum *by);
+SCM_EXTERN ScmObj Scm_BignumExptMod(const ScmBignum *b, const ScmBignum *e,
+                                   const ScmBignum *m);
+SCM_EXTERN int    Scm_BignumStrongPRP(const ScmBignum *n, const ScmBignum *a);
+SCM_EXTERN int    Scm_BignumStrongLucasPRP(const ScmBignum *n, long D);
 
 SCM_EXTERN ScmObj Scm_BignumLogAnd(const ScmBignum *bx, const ScmBignum *by);
 SCM_EXTERN ScmObj Scm_BignumLogIor(const ScmBignum *bx, const ScmBignum *by);
@@ -83,7 +107,12 @@ SCM_EXTERN ScmObj Scm_BignumAsh(const ScmBignum *bx, int cnt);
 SCM_EXTERN ScmBignum *Scm_MakeBignumWithSize(int size, u_long init);
 SCM_EXTERN ScmBignum *Scm_BignumAccMultAddUI(ScmBignum *acc,
                                              u_long coef, u_long c);
+SCM_EXTERN ScmObj Scm_DigitsToBignum(const char *digits, int ndigits,
+                                     int radix);
 
 SCM_EXTERN void   Scm_BignumDump(const ScmBignum *b, ScmPort *out);
 
+/* Called from Scm__InitNumber */
+SCM_EXTERN void Scm__InitBignum(void);
+
 #endif /* GAUCHE_PRIV_BIGNUMP_H */
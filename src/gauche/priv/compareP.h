@@ -46,4 +46,16 @@ struct ScmComparatorRec {
     u_long flags;
 };
 
+/* sort helpers used by libcmp.scm and gauche.parallel-sortutil */
+SCM_EXTERN int  Scm__RadixSortArray(ScmObj *elts, ScmSize n);
+SCM_EXTERN int  Scm__BuiltinOrderArrayP(ScmObj *elts, ScmSize n);
+SCM_EXTERN void Scm__UVectorSort(ScmUVector *v, ScmSize start, ScmSize end);
+SCM_EXTERN void Scm__MergeArrays(ScmObj *src, ScmObj *dst,
+                                 ScmSize lo, ScmSize mid, ScmSize hi);
+SCM_EXTERN void Scm__MergeUVectors(ScmUVector *src, ScmUVector *dst,
+                                   ScmSize lo, ScmSize mid, ScmSize hi);
+SCM_EXTERN ScmObj Scm__StableSortX(ScmObj seq, ScmObj less);
+SCM_EXTERN ScmObj Scm__MergeLists(ScmObj a, ScmObj b, ScmObj less,
+                                  int destructive);
+
 #endif /*GAUCHE_PRIV_COMPAREP_H*/
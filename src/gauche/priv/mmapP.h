@@ -52,6 +52,9 @@ SCM_CLASS_DECL(Scm_MemoryRegionClass);
 
 SCM_EXTERN ScmObj Scm_SysMmap(void *addrhint, int fd, size_t len, off_t off,
                               int prot, int flags);
+SCM_EXTERN ScmObj Scm_SysMmapShared(const char *name, size_t size,
+                                    int prot, int create, int mode);
+SCM_EXTERN void   Scm_SysShmUnlink(const char *name);
 SCM_EXTERN void   Scm_SysMmapWX(size_t len,
                                 ScmMemoryRegion **writable,
                                 ScmMemoryRegion **executable);
@@ -117,6 +117,11 @@ typedef struct ScmPortImplRec {
  */
 
 SCM_EXTERN void Scm__InstallCodingAwarePortHook(ScmPort *(*)(ScmPort*, const char*));
+SCM_EXTERN void Scm__PortConfinementViolation(ScmPort *port) SCM_NORETURN;
+SCM_EXTERN int  Scm__PortPeekBuffered(ScmPort *p,
+                                      const char **start, const char **end);
+SCM_EXTERN void Scm__PortConsumeBuffered(ScmPort *p, ScmSize nbytes);
+SCM_EXTERN void Scm__PortAddLines(ScmPort *p, ScmSize nlines);
 
 /* Windows-specific initialization */
 #if defined(GAUCHE_WINDOWS)
@@ -225,10 +230,23 @@ enum {
  *  atomic.  We would need to get system-level lock in PORT_UNLOCK as well.
  */
 
+/* A port with SCM_PORT_PRIVATE flag is confined to the thread that
+   holds the lock permanently (see Scm_SetPortConfined()).  The owner
+   thread never comes down to the locking branch, for the public APIs
+   take SHORTCUT.  If another thread reaches there, it is a misuse;
+   we raise an error instead of spinning forever. */
+#define PORT_CONFINEMENT_CHECK(p)                               \
+    do {                                                        \
+        if (SCM_PORT_FLAGS(p) & SCM_PORT_PRIVATE) {             \
+            Scm__PortConfinementViolation(SCM_PORT(p));         \
+        }                                                       \
+    } while (0)
+
 /* Lock a port P.  Can perform recursive lock. */
 #define PORT_LOCK(p, vm)                                        \
     do {                                                        \
         if (P_(p)->lockOwner != vm) {                           \
+          PORT_CONFINEMENT_CHECK(p);                            \
           for (;;) {                                            \
               ScmVM* owner__;                                   \
               (void)SCM_INTERNAL_FASTLOCK_LOCK(P_(p)->lock);    \
@@ -98,6 +98,26 @@ typedef struct ScmProfCountRec {
 /* # of on-memory samples for the call counter. */
 #define SCM_PROF_COUNTER_IN_BUFFER  12000
 
+/* A sample of allocation profiler.
+ * We keep the allocation site (code base and PC), a limited number
+ * of code bases in the continuation frames for the stack report,
+ * and the class of the allocated object if it is known.
+ */
+#define SCM_PROF_ALLOC_STACK_DEPTH  16
+
+typedef struct ScmProfAllocSampleRec {
+    ScmObj func;                /* ScmCompiledCode, or #f */
+    ScmWord *pc;
+    ScmClass *klass;            /* set via SCM_SET_CLASS; may be NULL */
+    size_t size;                /* requested size */
+    int atomic;                 /* TRUE if allocated by SCM_MALLOC_ATOMIC */
+    int depth;                  /* # of valid entries in callers */
+    ScmCompiledCode *callers[SCM_PROF_ALLOC_STACK_DEPTH]; /* innermost 1st */
+} ScmProfAllocSample;
+
+/* # of on-memory samples for the allocation profiler. */
+#define SCM_PROF_ALLOC_SAMPLES_IN_BUFFER  1000
+
 /* Profiling buffer.
  * It is allocated when profiler-start is called on this thread
  * for the first time.
@@ -112,6 +132,21 @@ struct ScmVMProfilerRec {
     ScmHashTable* statHash;     /* hashtable for collected data.
                                    value is a pair of integers,
                                    (<call-count> . <sample-hits>) */
+    int allocState;             /* allocation profiler state */
+    int allocFlushing;          /* TRUE while collecting alloc samples */
+    int allocByBytes;           /* TRUE if allocInterval is in bytes */
+    long allocInterval;         /* sampling interval */
+    long allocCountdown;        /* allocations/bytes to the next sample */
+    int currentAllocSample;     /* index to the current alloc sample */
+    void *allocPending;         /* the last sampled object, whose class */
+    int allocPendingIndex;      /*   is yet to be recorded */
+    int allocTotalSamples;      /* total # of alloc samples */
+    u_long allocTotalCount;     /* # of allocations while running */
+    u_long allocTotalBytes;     /* # of bytes allocated while running */
+    ScmHashTable *allocHash;    /* collected allocation samples.  see
+                                   alloc_collect() in prof.c */
+    ScmProfAllocSample *allocSamples;
+    ScmVM *allocVM;             /* the VM that started alloc profiler */
 #if defined(GAUCHE_WINDOWS)
     HANDLE hTargetThread;       /* target thread */
     HANDLE hObserverThread;     /* observer thread */
@@ -123,6 +158,8 @@ struct ScmVMProfilerRec {
 };
 
 SCM_EXTERN ScmObj Scm_ProfilerRawResult(void);
+SCM_EXTERN ScmObj Scm_AllocProfilerRawResult(void);
+SCM_EXTERN void   Scm__AllocProfilerCleanupVM(ScmVM *vm);
 
 /* Call Counter API */
 
@@ -104,6 +104,12 @@ typedef struct ScmMutexRec {
     ScmVM *owner;              /* the thread who owns this lock; may be NULL */
     ScmObj locker_proc;        /* subr thunk to lock this mutex */
     ScmObj unlocker_proc;      /* subr thunk to unlock this mutex */
+    /* contention statistics; only updated while stats are enabled
+       by Scm_MutexStatsEnable.  Protected by the internal mutex. */
+    u_long   acquire_count;    /* # of successful acquisitions */
+    u_long   contend_count;    /* # of lock attempts that had to wait */
+    uint64_t wait_total;       /* total wait time in nanoseconds */
+    uint64_t wait_max;         /* max wait time in nanoseconds */
 } ScmMutex;
 
 SCM_CLASS_DECL(Scm_MutexClass);
@@ -117,4 +123,41 @@ SCM_EXTERN ScmObj Scm_MutexUnlock(ScmMutex *mutex, ScmConditionVariable *cv, Scm
 SCM_EXTERN ScmObj Scm_MutexLocker(ScmMutex *mutex);
 SCM_EXTERN ScmObj Scm_MutexUnlocker(ScmMutex *mutex);
 
+SCM_EXTERN int    Scm_MutexStatsEnable(int flag);
+SCM_EXTERN int    Scm_MutexStatsEnabledP(void);
+SCM_EXTERN ScmObj Scm_MutexStats(ScmMutex *mutex);
+SCM_EXTERN void   Scm_MutexStatsReset(ScmMutex *mutex);
+
+/*
+ * Scheme reader-writer lock.
+ *   Any number of threads can hold read locks at the same time, while
+ *   a write lock is exclusive.  Writers are preferred; once a writer
+ *   is waiting, new readers are blocked until it is served.
+ *   Only the writer is recorded as an owner; a write lock held by
+ *   a terminated thread is treated as abandoned, as ScmMutex.
+ */
+typedef struct ScmRWLockRec {
+    SCM_INSTANCE_HEADER;
+    ScmInternalMutex mutex;
+    ScmInternalCond  readers_cv; /* readers wait on this */
+    ScmInternalCond  writers_cv; /* writers wait on this */
+    ScmObj name;
+    ScmObj specific;
+    int    readers;             /* # of threads holding read lock */
+    int    waiting_writers;     /* # of threads waiting for write lock */
+    int    write_locked;
+    ScmVM *writer;              /* the thread holding write lock; may be NULL */
+} ScmRWLock;
+
+SCM_CLASS_DECL(Scm_RWLockClass);
+#define SCM_CLASS_RWLOCK       (&Scm_RWLockClass)
+#define SCM_RWLOCK(obj)        ((ScmRWLock*)obj)
+#define SCM_RWLOCKP(obj)       SCM_XTYPEP(obj, SCM_CLASS_RWLOCK)
+
+SCM_EXTERN ScmObj Scm_MakeRWLock(ScmObj name);
+SCM_EXTERN ScmObj Scm_RWLockReadLock(ScmRWLock *rwlock, ScmObj timeout);
+SCM_EXTERN ScmObj Scm_RWLockWriteLock(ScmRWLock *rwlock, ScmObj timeout,
+                                      ScmVM *owner);
+SCM_EXTERN ScmObj Scm_RWLockUnlock(ScmRWLock *rwlock);
+
 #endif /*GAUCHE_THREAD_H*/
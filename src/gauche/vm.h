@@ -768,10 +768,12 @@ enum {
     SCM_COMPILE_MUTABLE_LITERALS = (1L<<12),/* Literal pairs are mutable */
     SCM_COMPILE_SRFI_FEATURE_ID = (1L<<13), /* Allow srfi-N feature id in
                                                cond-expand */
-    SCM_COMPILE_NOINLINE_INLINER = (1L<<14)/* (internal) Do not invoke custom
+    SCM_COMPILE_NOINLINE_INLINER = (1L<<14),/* (internal) Do not invoke custom
                                               inliner and ASM inliners.
                                               hybrid macro is still expanded.
                                               used for macroexpand-all */
+    SCM_COMPILE_NO_FIXNUM_SPECIALIZATION = (1L<<15) /* Do not specialize
+                                              fixnum operations in loops */
 };
 
 #define SCM_VM_COMPILER_FLAG_IS_SET(vm, flag) ((vm)->compilerFlags & (flag))
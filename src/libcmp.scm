@@ -529,6 +529,46 @@
         [else (SCM_TYPE_ERROR seq "proper list or vector")
               (return SCM_UNDEFINED)]))
 
+(define-cproc %radix-sort! (v::<vector>) ::<boolean>
+  (return (Scm__RadixSortArray (SCM_VECTOR_ELEMENTS v) (SCM_VECTOR_SIZE v))))
+
+(define-cproc %builtin-order-vector? (v::<vector>) ::<boolean>
+  (return (Scm__BuiltinOrderArrayP (SCM_VECTOR_ELEMENTS v)
+                                   (SCM_VECTOR_SIZE v))))
+
+(define-cproc %uvector-sort! (v::<uvector> start::<fixnum> end::<fixnum>)
+  ::<void>
+  (Scm__UVectorSort v start end))
+
+;; Merges sorted ranges SRC[LO,MID) and SRC[MID,HI) into DST[LO,HI).
+;; With MID = HI, this just copies the range.
+(define-cproc %merge-ranges! (src dst lo::<fixnum> mid::<fixnum> hi::<fixnum>)
+  ::<void>
+  (cond [(and (SCM_VECTORP src) (SCM_VECTORP dst))
+         (unless (and (<= 0 lo) (<= lo mid) (<= mid hi)
+                      (<= hi (SCM_VECTOR_SIZE src))
+                      (<= hi (SCM_VECTOR_SIZE dst)))
+           (Scm_Error "range out of bound: (%ld %ld %ld)" lo mid hi))
+         (Scm__MergeArrays (SCM_VECTOR_ELEMENTS src) (SCM_VECTOR_ELEMENTS dst)
+                           lo mid hi)]
+        [(and (SCM_UVECTORP src) (SCM_UVECTORP dst))
+         (Scm__MergeUVectors (SCM_UVECTOR src) (SCM_UVECTOR dst) lo mid hi)]
+        [else (Scm_Error "vectors or uniform vectors required, but got %S and %S"
+                         src dst)]))
+
+(define-cproc %uvector-copy (v::<uvector>)
+  (let* ([r (Scm_MakeUVector (SCM_CLASS_OF v) (SCM_UVECTOR_SIZE v) NULL)])
+    (memcpy (SCM_UVECTOR_ELEMENTS r) (SCM_UVECTOR_ELEMENTS v)
+            (Scm_UVectorSizeInBytes v))
+    (return r)))
+
+;; Adaptive stable sort of a list or a vector in place (Scm__StableSortX),
+;; and stable merge of lists.  LESS is a predicate, or #f for the default
+;; order.
+(define-cproc %stable-sort-x! (seq less) Scm__StableSortX)
+
+(define-cproc %merge-lists (a b less destructive::<boolean>) Scm__MergeLists)
+
 ;; internal macro
 (define-syntax define-less?
   (syntax-rules ()
@@ -540,10 +580,18 @@
              [else (errorf "~a requires a comparator or a procedure that \
                             takes two-arguments, but got: ~s" this cmp)]))]))
 
-;; sorted?, merge, merge!, stable-sort!, stable-sort are based on
+;; Passed to the C routines in place of less?; #f means the default
+;; order, for which Scm_Compare is called directly.
+(define-inline (%c-less cmp less?)
+  (and cmp (not (eq? cmp default-comparator)) less?))
+
+;; sorted?, and merge and merge! with a key, are based on
 ;; the public domain code by Richard A. O'Keefe, which in turn based
 ;; on Prolog code by D.H.D.Warren.  See lib/gauche/sort.orig.scm for
-;; the original code.
+;; the original code.  Without a key, merging and sorting of lists and
+;; vectors is done by an adaptive natural merge sort in compare.c,
+;; which takes advantage of existing runs in the input and gallops
+;; through long stretches of one side while merging.
 
 ;;; (sorted? sequence :optional less? key)
 
@@ -591,6 +639,7 @@
   (cond
    [(null? a) b]
    [(null? b) a]
+   [(memq key `(,identity ,values)) (%merge-lists a b (%c-less cmp less?) #f)]
    [else (let loop ([x (car a)] [kx (key (car a))] [a (cdr a)]
                     [y (car b)] [ky (key (car b))] [b (cdr b)])
            ;; The loop handles the merging of non-empty lists.  It has
@@ -626,6 +675,7 @@
   (cond
    [(null? a) b]
    [(null? b) a]
+   [(memq key `(,identity ,values)) (%merge-lists a b (%c-less cmp less?) #t)]
    [else (let ([kx (key (car a))]
                [ky (key (car b))])
            (if (less? ky kx)
@@ -641,80 +691,61 @@
                a)))]))
 
 ;;; (sort! sequence :optional less? key)
-;;; sorts the list or vector sequence destructively.  It uses a version
-;;; of merge-sort invented, to the best of my knowledge, by David H. D.
-;;; Warren, and first used in the DEC-10 Prolog system.  R. A. O'Keefe
-;;; adapted it to work destructively in Scheme.
+;;; sorts the list or vector sequence destructively.  A list is sorted
+;;; by rearranging cars, so the head cell stays the head.
 
 (define-in-module gauche (sort! seq . args)
-  (if (and (or (pair? seq) (vector? seq)) (null? args))
-    (%sort! seq)                  ; use internal version
-    (apply stable-sort! seq args)))
+  (cond [(apply %fast-sort! seq #f args) seq]
+        [(and (or (pair? seq) (vector? seq)) (null? args))
+         (%sort! seq)]                  ; use internal version
+        [else (apply stable-sort! seq args)]))
 
 (define-in-module gauche (stable-sort! seq :optional (cmp #f) (key identity))
-  (let1 sorted (%stable-sort! seq cmp key)
-    (if (and (pair? sorted) (not (eq? sorted seq)))
-      ;; %stable-sort! on a list may return a cell that's not the same
-      ;; cell as the head of input.  We have to ensure we preserve the
-      ;; identity.
-      (let loop ([p sorted])
-        (if (eq? (cdr p) seq)
-          (let ([sorted-car (car sorted)]
-                [sorted-cdr (cdr sorted)]
-                [seq-car (car seq)]
-                [seq-cdr (cdr seq)])
-            (set! (car sorted) seq-car)
-            (set! (cdr sorted) seq-cdr)
-            (set! (car seq) sorted-car)
-            (if (eq? p sorted)
-              (set! (cdr seq) sorted)
-              (begin
-                (set! (cdr seq) sorted-cdr)
-                (set! (cdr p) sorted)))
-            seq)
-          (loop (cdr p))))
-      sorted)))
-
-;; Internal stable sorter.  If key is identity we use merge sort
-;; straightforwardly.  Otherwise, we extract keys first, sort
+  (if (%fast-sort! seq #t cmp key)
+    seq
+    (%stable-sort! seq cmp key)))
+
+;; Fast paths for vectors and uniform vectors.  A vector consisting
+;; only of fixnums, or only of flonums, is radix-sorted if the default
+;; order is requested.  A numeric uniform vector is always radix-sorted
+;; in the default order.  Larger ones are sorted with multiple threads
+;; (see gauche.parallel-sortutil), but only when the order is decided
+;; in C, so no Scheme code is run concurrently behind the caller's back.
+;; Both keep the stability.
+;; Returns #t if SEQ has been sorted, #f if it should take the generic path.
+(define-constant *parallel-sort-threshold* 100000)
+
+(define (%fast-sort! seq stable? :optional (cmp #f) (key identity))
+  (define default-order?
+    (and (memq key `(,identity ,values))
+         (or (not cmp) (eq? cmp default-comparator))))
+  (cond [(vector? seq)
+         (cond [(not default-order?) #f]
+               [(%radix-sort! seq) #t]
+               [(and (>= (vector-length seq) *parallel-sort-threshold*)
+                     (%builtin-order-vector? seq))
+                (%parallel-sort! seq stable?)
+                #t]
+               [else #f])]
+        [(and (uvector? seq) default-order?)
+         (if (>= (uvector-length seq) *parallel-sort-threshold*)
+           (%parallel-sort! seq stable?)
+           (%uvector-sort! seq 0 (uvector-length seq)))
+         #t]
+        [else #f]))
+
+;; Internal stable sorter.  If key is identity we sort lists and
+;; vectors in C.  Otherwise, we extract keys first, sort
 ;; by the key, and strip the keys.
-;; Note that if SEQ is a list, the returned cell doesn't need to
-;; be the same cell as the head of SEQ.
+;; If SEQ is a list, the head cell of SEQ is returned.
 (define (%stable-sort! seq :optional (cmp #f) (key identity))
   (define-less? less? cmp 'sort!)
   (if (memq key `(,identity ,values))
-    ;; shortcut
-    (letrec ([step (^n (cond [(> n 2) (let* ([j (ash n -1)]
-                                             [a (step j)]
-                                             [k (- n j)]
-                                             [b (step k)])
-                                        (merge! a b less?))]
-                             [(= n 2) (let ([x (car seq)]
-                                            [y (cadr seq)]
-                                            [p seq])
-                                        (set! seq (cddr seq))
-                                        (when (less? y x)
-                                          (set-car! p y)
-                                          (set-car! (cdr p) x))
-                                        (set-cdr! (cdr p) '())
-                                        p)]
-                             [(= n 1) (let ([p seq])
-                                        (set! seq (cdr seq))
-                                        (set-cdr! p '())
-                                        p)]
-                             [else '()]))])
-      (cond [(null? seq) seq]
-            [(pair? seq) (step (length seq))]
-            [(vector? seq)
-             (let ([n (vector-length seq)]
-                   [vector seq])
-               (set! seq (vector->list seq))
-               (do ([p (step n) (cdr p)]
-                    [i 0 (+ i 1)])
-                   [(null? p) vector]
-                 (vector-set! vector i (car p))))]
-            [(is-a? seq <sequence>) (%generic-sort! seq less?)]
-            [else (error "sequence required, but got:" seq)]))
+    (cond [(null? seq) seq]
+          [(or (pair? seq) (vector? seq))
+           (%stable-sort-x! seq (%c-less cmp less?))]
+          [(is-a? seq <sequence>) (%generic-sort! seq less?)]
+          [else (error "sequence required, but got:" seq)])
     ;; Avoid making intermediate structure, for the point of stable-sort!
     ;; is to avoid allocation.
     (letrec ([kless? (^[a b] (less? (cdr a) (cdr b)))])
@@ -747,16 +778,18 @@
 ;;; copy of the sequence.
 
 (define-in-module gauche (sort seq . args)
-  (if (and (or (pair? seq) (vector? seq)) (null? args))
-    (%sort seq)  ;; use internal version
-    (apply stable-sort seq args)))
+  (cond [(vector? seq) (apply sort! (vector-copy seq) args)]
+        [(uvector? seq) (apply sort! (%uvector-copy seq) args)]
+        [(and (pair? seq) (null? args)) (%sort seq)] ;; use internal version
+        [else (apply stable-sort seq args)]))
 
 (define-in-module gauche (stable-sort seq :optional (cmp #f) (key identity))
   (define-less? less? cmp 'sort)
   (if (memq key `(,identity ,values))
     (cond [(null? seq) seq]
-          [(pair? seq) (%stable-sort! (list-copy seq) less?)]
-          [(vector? seq) (list->vector (sort! (vector->list seq) less?))]
+          [(vector? seq) (stable-sort! (vector-copy seq) cmp)]
+          [(uvector? seq) (stable-sort! (%uvector-copy seq) cmp)]
+          [(pair? seq) (%stable-sort! (list-copy seq) cmp)]
           [(is-a? seq <sequence>) (%generic-sort seq less?)]
           [else (error "sequence required, but got:" seq)])
     (cond [(null? seq) seq]
@@ -188,6 +188,14 @@
              [ (pair? sig) ])
     (alist-ref (cdr sig) 'type)))
 
+;; Returns the source form of the instruction that precedes OFFSET
+;; in CODE, or #f.  OFFSET is the one recorded by the profiler.
+(define-cproc %compiled-code-source-info (code::<compiled-code>
+                                          offset::<int>)
+  (when (or (< offset 0) (> offset (-> code codeSize)))
+    (Scm_Error "code offset out of range: %d" offset))
+  (return (Scm_VMGetSourceInfo code (+ (-> code code) offset))))
+
 (define-cproc %decode-packed-debug-info (code-vector::<u8vector>
                                          const-vector::<vector>)
   (return (Scm_DecodePackedDebugInfo (SCM_U8VECTOR_ELEMENTS code-vector)
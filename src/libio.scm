@@ -141,6 +141,12 @@
 
 (define-cproc port-unlink! (port::<port>) ::<void> Scm_UnlinkPorts)
 
+(define-cproc port-confine! (port::<port> :optional (flag::<boolean> #t))
+  ::<void> Scm_SetPortConfined)
+(define-cproc port-confined-thread (port::<port>)
+  (let* ([vm::ScmVM* (Scm_PortConfinedThread port)])
+    (return (?: vm (SCM_OBJ vm) SCM_FALSE))))
+
 (select-module gauche.internal)
 (define-cproc port-case-fold (port::<port>) ::<boolean>
   (setter (port::<port> flag::<boolean>) ::<void>
@@ -587,17 +593,9 @@
       (Scm_ReadError port "read-line: encountered illegal byte sequence: %S" r))
     (return r)))
 
-(define (read-string n :optional (port (current-input-port)))
-  (define o (open-output-string :private? #t))
-  (let loop ([i 0])
-    (if (>= i n)
-      (get-output-string o)
-      (let1 c (read-char port)
-        (if (eof-object? c)
-          (if (= i 0)
-            (eof-object)
-            (get-output-string o))
-          (begin (write-char c o) (loop (+ i 1))))))))
+(define-cproc read-string (n::<fixnum>
+                           :optional (port::<input-port> (current-input-port)))
+  Scm_ReadString)
 
 (define (write-string string :optional (port (current-output-port))
                                        (start 0)
@@ -143,6 +143,34 @@
   (when (SCM_BIGNUMP obj)
     (Scm_BignumDump (SCM_BIGNUM obj) SCM_CUROUT)))
 
+;; Multiply with the specified algorithm; for testing and benchmarking.
+;; ALGORITHM is one of schoolbook, karatsuba, toom3, ntt, or #f (auto).
+(define-cproc %bignum-mul (x y :optional (algorithm #f))
+  (let* ([algo::int SCM_BIGNUM_MUL_AUTO])
+    (cond [(SCM_FALSEP algorithm)]
+          [(SCM_EQ algorithm 'schoolbook) (set! algo SCM_BIGNUM_MUL_SCHOOLBOOK)]
+          [(SCM_EQ algorithm 'karatsuba) (set! algo SCM_BIGNUM_MUL_KARATSUBA)]
+          [(SCM_EQ algorithm 'toom3) (set! algo SCM_BIGNUM_MUL_TOOM3)]
+          [(SCM_EQ algorithm 'ntt) (set! algo SCM_BIGNUM_MUL_NTT)]
+          [else (Scm_Error "unknown multiplication algorithm: %S" algorithm)])
+    (if (and (SCM_BIGNUMP x) (SCM_BIGNUMP y))
+      (return (Scm__BignumMulWith (SCM_BIGNUM x) (SCM_BIGNUM y) algo))
+      (return (Scm_Mul x y)))))
+
+;; Truncated division with the specified algorithm; for testing and
+;; benchmarking.  ALGORITHM is either schoolbook or #f (auto).
+;; Returns quotient and remainder.
+(define-cproc %bignum-div-rem (x y :optional (algorithm #f)) ::(<top> <top>)
+  (let* ([algo::int SCM_BIGNUM_DIV_AUTO])
+    (cond [(SCM_FALSEP algorithm)]
+          [(SCM_EQ algorithm 'schoolbook) (set! algo SCM_BIGNUM_DIV_SCHOOLBOOK)]
+          [else (Scm_Error "unknown division algorithm: %S" algorithm)])
+    (if (and (SCM_BIGNUMP x) (SCM_BIGNUMP y))
+      (let* ([qr (Scm__BignumDivRemWith (SCM_BIGNUM x) (SCM_BIGNUM y) algo)])
+        (set! SCM_RESULT0 (SCM_CAR qr))
+        (set! SCM_RESULT1 (SCM_CDR qr)))
+      (set! SCM_RESULT0 (Scm_Quotient x y (& SCM_RESULT1))))))
+
 ;;
 ;; Comparison
 ;;
@@ -438,6 +466,64 @@
 (select-module gauche.internal)
 (define-cproc %gcd (n1 n2) :fast-flonum :constant Scm_Gcd)
 
+;; Used by expt-mod (gauche.numutil) and math.prime.
+(define-cproc %expt-mod (b e m) Scm_ExptMod)
+
+(inline-stub
+ (define-cfn integer->bignum (n) ::ScmBignum* :static
+   (if (SCM_INTP n)
+     (return (SCM_BIGNUM (Scm_MakeBignumFromSI (SCM_INT_VALUE n))))
+     (return (SCM_BIGNUM n)))))
+
+;; Strong probable prime tests.  N must be an odd integer greater than 2.
+;; If they return #f, N is composite.  For the Lucas test, D must be
+;; the Selfridge parameter, i.e. (jacobi D N) = -1, and N must not be
+;; a perfect square.
+(define-cproc %strong-prp? (n::<integer> a::<integer>) ::<boolean>
+  (return (Scm_BignumStrongPRP (integer->bignum n) (integer->bignum a))))
+(define-cproc %strong-lucas-prp? (n::<integer> d::<long>) ::<boolean>
+  (return (Scm_BignumStrongLucasPRP (integer->bignum n) d)))
+
+;; Segmented sieve for math.prime.  V represents the odd numbers START,
+;; START+2, ..., START+2*(len-1), where START is odd.  Each element is set
+;; to 1 if the number has no factor in PRIMES, 0 otherwise.  PRIMES is
+;; a u32vector of odd primes in ascending order; the ones greater than
+;; the square root of the last number are ignored.
+(define-cproc %prime-sieve-segment! (v::<u8vector> start::<integer>
+                                     primes::<u32vector>)
+  ::<void>
+  ;; We compute in uint64_t, for long may be 32bit.  The offsets from
+  ;; START are computed so that they won't overflow.
+  (let* ([oor::int FALSE]
+         [lo::uint64_t (Scm_GetIntegerU64Clamp start SCM_CLAMP_NONE (& oor))]
+         [len::ScmSmallInt (SCM_UVECTOR_SIZE v)]
+         [bits::uint8_t* (SCM_U8VECTOR_ELEMENTS v)]
+         [ps::uint32_t* (SCM_U32VECTOR_ELEMENTS primes)]
+         [np::ScmSmallInt (SCM_UVECTOR_SIZE primes)]
+         [k::ScmSmallInt 0])
+    (unless (and (not oor) (> lo 0) (logand lo 1))
+      (Scm_Error "positive odd number less than 2^64 required, but got %S"
+                 start))
+    (when (> (cast uint64_t len) (/ (- UINT64_MAX lo) 2))
+      (Scm_Error "sieve range out of bound: %S + 2*%ld" start (cast long len)))
+    (let* ([hi::uint64_t (+ lo (* 2 (cast uint64_t len)))])
+      (memset bits 1 len)
+      (while (< k np)
+        (let* ([p::uint64_t (aref ps k)]
+               [pp::uint64_t (* p p)]     ; p < 2^32, so this won't overflow
+               [i::uint64_t 0])
+          (when (>= pp hi) (break))
+          ;; index of the first odd multiple of p not less than max(p*p, lo)
+          (if (>= pp lo)
+            (set! i (/ (- pp lo) 2))
+            (let* ([r::uint64_t (% (- p (% lo p)) p)])
+              ;; lo is odd, so lo+r is odd iff r is even
+              (when (logand r 1) (+= r p))
+              (set! i (/ r 2))))
+          (for (() (< i (cast uint64_t len)) (+= i p))
+            (set! (aref bits i) 0)))
+        (post++ k)))))
+
 (select-module scheme)
 (define-cproc numerator (n)   :fast-flonum :constant Scm_Numerator)
 (define-cproc denominator (n) :fast-flonum :constant Scm_Denominator)
@@ -261,10 +261,19 @@
 (define-cproc profiler-stop  () ::<int>  Scm_ProfilerStop)
 (define-cproc profiler-reset () ::<void> Scm_ProfilerReset)
 
+;; Allocation profiler.  Samples every INTERVAL allocations, or every
+;; INTERVAL bytes if BYTES is true.
+(define-cproc alloc-profiler-start (:key (interval::<long> 128)
+                                         (bytes::<boolean> #f))
+  ::<void> (Scm_AllocProfilerStart interval bytes))
+(define-cproc alloc-profiler-stop  () ::<int>  Scm_AllocProfilerStop)
+(define-cproc alloc-profiler-reset () ::<void> Scm_AllocProfilerReset)
+
 (select-module gauche.internal)
 ;; Autoloaded profiler-get-result will use this.
 ;; See lib/gauche/vm/profiler.scm
 (define-cproc profiler-raw-result () Scm_ProfilerRawResult)
+(define-cproc alloc-profiler-raw-result () Scm_AllocProfilerRawResult)
 
 ;;;
 ;;; Introspection
@@ -618,6 +618,17 @@
           [else (SCM_TYPE_ERROR maybe-port "port or #f")])
     (return (Scm_SysMmap NULL fd size off prot flags))))
 
+;; NAME may be #f for anonymous memory shared with forked children.
+;; MODE defaults to #o600.
+(define-cproc sys-shm-mmap (name::<const-cstring>? prot::<int> size::<size_t>
+                                                   :optional
+                                                   (create?::<boolean> #f)
+                                                   (mode::<int> 384))
+  (return (Scm_SysMmapShared name size prot create? mode)))
+
+(define-cproc sys-shm-unlink (name::<const-cstring>) ::<void>
+  Scm_SysShmUnlink)
+
 (inline-stub
  (define-enum PROT_EXEC)
  (define-enum PROT_READ)
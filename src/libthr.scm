@@ -65,6 +65,13 @@
           mutex-specific-set! mutex-specific
           with-locking-mutex mutex-lock! mutex-unlock!
           mutex-locker mutex-unlocker
+          mutex-stats mutex-stats-reset!
+          mutex-stats-enable! mutex-stats-enabled?
+
+          <rwlock> rwlock? make-rwlock rwlock-name rwlock-state
+          rwlock-specific-set! rwlock-specific
+          rwlock-read-lock! rwlock-write-lock! rwlock-unlock!
+          with-rwlock-read with-rwlock-write
 
           <condition-variable> condition-variable?
           make-condition-variable condition-variable-name
@@ -231,6 +238,14 @@
 
  (define-cproc mutex-locker (mutex::<mutex>) Scm_MutexLocker)
  (define-cproc mutex-unlocker (mutex::<mutex>) Scm_MutexUnlocker)
+
+ (define-cproc mutex-stats (mutex::<mutex>) Scm_MutexStats)
+ (define-cproc mutex-stats-reset! (mutex::<mutex>) ::<void> Scm_MutexStatsReset)
+
+ ;; Returns the previous setting.
+ (define-cproc mutex-stats-enable! (flag::<boolean>) ::<boolean>
+   Scm_MutexStatsEnable)
+ (define-cproc mutex-stats-enabled? () ::<boolean> Scm_MutexStatsEnabledP)
  )
 
 ;; (run-once expr ...)
@@ -253,6 +268,68 @@
                        (set-box! ,results xs)))
                 (apply values (unbox ,results))))))))))
 
+;;===============================================================
+;; Reader-writer lock
+;;
+
+(define (rwlock? obj) (is-a? obj <rwlock>))
+
+(define (rwlock-name rwlock)
+  (assume-type rwlock <rwlock>)
+  (slot-ref rwlock 'name))
+
+(define (rwlock-state rwlock)
+  (assume-type rwlock <rwlock>)
+  (slot-ref rwlock 'state))
+
+(define (rwlock-specific-set! rwlock value)
+  (assume-type rwlock <rwlock>)
+  (slot-set! rwlock 'specific value))
+
+(define rwlock-specific
+  (getter-with-setter
+   (^[rwlock]
+     (assume-type rwlock <rwlock>)
+     (slot-ref rwlock 'specific))
+   rwlock-specific-set!))
+
+;; NB: <rwlock> isn't known to cgen type system (the host gosh that
+;; builds this file may not have it), so we check the type by ourselves.
+(inline-stub
+ (define-cise-stmt check-rwlock
+   [(_ obj) `(unless (SCM_RWLOCKP ,obj) (SCM_TYPE_ERROR ,obj "<rwlock>"))])
+
+ (define-cproc make-rwlock (:optional (name #f)) Scm_MakeRWLock)
+
+ (define-cproc rwlock-read-lock! (rwlock :optional (timeout #f))
+   (check-rwlock rwlock)
+   (return (Scm_RWLockReadLock (SCM_RWLOCK rwlock) timeout)))
+
+ (define-cproc rwlock-write-lock! (rwlock :optional (timeout #f) thread)
+   (check-rwlock rwlock)
+   (let* ([owner::ScmVM* NULL])
+     (cond [(SCM_VMP thread) (set! owner (SCM_VM thread))]
+           [(SCM_UNBOUNDP thread) (set! owner (Scm_VM))]
+           [(not (SCM_FALSEP thread)) (SCM_TYPE_ERROR thread "thread or #f")])
+     (return (Scm_RWLockWriteLock (SCM_RWLOCK rwlock) timeout owner))))
+
+ (define-cproc rwlock-unlock! (rwlock)
+   (check-rwlock rwlock)
+   (return (Scm_RWLockUnlock (SCM_RWLOCK rwlock))))
+ )
+
+(define (with-rwlock-read rwlock thunk)
+  (dynamic-wind
+      (^[] (rwlock-read-lock! rwlock))
+      thunk
+      (^[] (rwlock-unlock! rwlock))))
+
+(define (with-rwlock-write rwlock thunk)
+  (dynamic-wind
+      (^[] (rwlock-write-lock! rwlock))
+      thunk
+      (^[] (rwlock-unlock! rwlock))))
+
 ;;===============================================================
 ;; Condition variable
 ;;
@@ -62,6 +62,7 @@ int batch_mode = FALSE;         /* force batch mode */
 int interactive_mode = FALSE;   /* force interactive mode */
 int test_mode = FALSE;          /* add . and ../lib implicitly  */
 int profiling_mode = FALSE;     /* profile the script? */
+int alloc_profiling_mode = FALSE; /* profile allocations of the script? */
 int stats_mode = FALSE;         /* collect stats (EXPERIMENTAL) */
 int version_mode = FALSE;       /* show version and exit (-V option) */
 
@@ -115,7 +116,8 @@ void usage(int errorp)
             "           By default, the 'main' procedure in the user module is called\n"
             "           after loading the script (srfi-22).  This option allows to call\n"
             "           a main procedure in the different module.\n"
-            "  -p<type> Turns on the profiler.  <Type> can be 'time' or 'load'.\n"
+            "  -p<type> Turns on the profiler.  <Type> can be 'time', 'load' or\n"
+            "           'alloc'.\n"
             "  -F<feature> Makes <feature> available in cond-expand forms\n"
             "           If <feature> begins with '-', it removes the feature (without\n"
             "           preceding minus) instead.\n"
@@ -136,6 +138,8 @@ void usage(int errorp)
             "      case-fold       uses case-insensitive reader (as in R5RS)\n"
             "      include-verbose reports while including files\n"
             "      load-verbose    reports while loading files\n"
+            "      no-fixnum-specialization\n"
+            "                      doesn't specialize fixnum operations in loops.\n"
             "      no-inline       doesn't inline procedures & constants (combined\n"
             "                      no-inline-globals, no-inline-locals,\n"
             "                      no-inline-constants and no-inline-setters.)\n"
@@ -329,6 +333,9 @@ void further_options(const char *optarg)
     else if (strcmp(optarg, "no-lambda-lifting-pass") == 0) {
         SCM_VM_COMPILER_FLAG_SET(vm, SCM_COMPILE_NO_LIFTING);
     }
+    else if (strcmp(optarg, "no-fixnum-specialization") == 0) {
+        SCM_VM_COMPILER_FLAG_SET(vm, SCM_COMPILE_NO_FIXNUM_SPECIALIZATION);
+    }
     else if (strcmp(optarg, "no-dissolve-apply") == 0) {
         SCM_VM_COMPILER_FLAG_SET(vm, SCM_COMPILE_NODISSOLVE_APPLY);
     }
@@ -392,6 +399,7 @@ void further_options(const char *optarg)
         fprintf(stderr, "unknown -f option: %s\n", optarg);
         fprintf(stderr, "supported options are: -fcase-fold, -fload-verbose, "
                 "-finclude-verbose, -fno-dissolve-apply -fno-inline, "
+                "-fno-fixnum-specialization, "
                 "-fno-inline-globals, -fno-inline-locals, "
                 "-fno-inline-constants, -fno-inline-setters, -fno-source-info, "
                 "-fno-post-inline-pass, -fno-lambda-lifting-pass, "
@@ -413,9 +421,12 @@ void profiler_options(const char *optarg)
     else if (strcmp(optarg, "load") == 0) {
         SCM_VM_RUNTIME_FLAG_SET(vm, SCM_COLLECT_LOAD_STATS);
     }
+    else if (strcmp(optarg, "alloc") == 0) {
+        alloc_profiling_mode = TRUE;
+    }
     else {
         fprintf(stderr, "unknown -p option: %s\n", optarg);
-        fprintf(stderr, "supported profiling options are: -ptime or -pload\n");
+        fprintf(stderr, "supported profiling options are: -ptime, -pload or -palloc\n");
     }
 }
 
@@ -562,6 +573,12 @@ void cleanup_main(void *data SCM_UNUSED)
                         SCM_OBJ(Scm_GaucheModule()),
                         NULL); /* ignore errors */
     }
+    if (alloc_profiling_mode) {
+        Scm_AllocProfilerStop();
+        Scm_EvalCString("(alloc-profiler-show)",
+                        SCM_OBJ(Scm_GaucheModule()),
+                        NULL); /* ignore errors */
+    }
 
     /* EXPERIMENTAL */
     if (stats_mode) {
@@ -925,11 +942,12 @@ int main(int ac, char **av)
 
     /* Set up instruments. */
     ScmLoadPacket lpak;
-    if (profiling_mode) {
+    if (profiling_mode || alloc_profiling_mode) {
         if (Scm_Require(SCM_MAKE_STR("gauche/vm/profiler"), 0, &lpak) < 0) {
             error_exit(lpak.exception);
         }
-        Scm_ProfilerStart();
+        if (profiling_mode) Scm_ProfilerStart();
+        if (alloc_profiling_mode) Scm_AllocProfilerStart(128, FALSE);
     }
     Scm_AddCleanupHandler(cleanup_main, NULL);
 
@@ -45,6 +45,9 @@
 #ifdef HAVE_SYS_MMAN_H
 #include <sys/mman.h>
 #endif
+#ifdef HAVE_SHM_OPEN
+#include <fcntl.h>
+#endif
 
 static void mem_finalize(ScmObj obj, void *data SCM_UNUSED)
 {
@@ -199,6 +202,78 @@ ScmObj Scm_SysMmap(void *addrhint, int fd, size_t len, off_t off,
 #endif /*GAUCHE_WINDOWS*/
 }
 
+/* Map memory that is shared among processes.  If NAME is NULL, the
+   memory is anonymous and can only be shared with the processes forked
+   after this call.  Otherwise, NAME is a POSIX shared memory object name,
+   which other processes can map with the same name.
+   If CREATE is true, a new object of SIZE bytes is created with
+   permission MODE; it is an error if it already exists.  If CREATE is
+   false, an existing object is mapped, and SIZE may be 0 to map all of it.
+   Newly created memory is zero-filled. */
+ScmObj Scm_SysMmapShared(const char *name, size_t size, int prot,
+                         int create, int mode)
+{
+    if (name == NULL) {
+        if (!create) Scm_Error("name is required to open shared memory");
+        if (size == 0) Scm_Error("size must be positive");
+        return Scm_SysMmap(NULL, -1, size, 0, prot, MAP_SHARED|MAP_ANONYMOUS);
+    }
+#if defined(HAVE_SHM_OPEN)
+    int oflags = create? (O_RDWR|O_CREAT|O_EXCL)
+        : ((prot & PROT_WRITE)? O_RDWR : O_RDONLY);
+    int fd, r;
+    SCM_SYSCALL(fd, shm_open(name, oflags, mode));
+    if (fd < 0) Scm_SysError("shm_open failed for %s", name);
+
+    /* Clean up if anything fails after here.  If we've just created
+       the object, we don't leave it behind. */
+    ScmObj mem = SCM_FALSE;
+    SCM_UNWIND_PROTECT {
+        if (create) {
+            if (size == 0) Scm_Error("size must be positive");
+            SCM_SYSCALL(r, ftruncate(fd, (off_t)size));
+            if (r < 0) Scm_SysError("ftruncate failed for %s", name);
+        } else {
+            struct stat st;
+            SCM_SYSCALL(r, fstat(fd, &st));
+            if (r < 0) Scm_SysError("fstat failed for %s", name);
+            if (size == 0) size = (size_t)st.st_size;
+            else if (size > (size_t)st.st_size) {
+                Scm_Error("shared memory %s is smaller than requested (%lu < %lu)",
+                          name, (u_long)st.st_size, (u_long)size);
+            }
+            if (size == 0) Scm_Error("shared memory %s is empty", name);
+        }
+        mem = Scm_SysMmap(NULL, fd, size, 0, prot, MAP_SHARED);
+    } SCM_WHEN_ERROR {
+        close(fd);
+        if (create) shm_unlink(name);
+        SCM_NEXT_HANDLER;
+    } SCM_END_PROTECT;
+    /* The mapping stays valid after the descriptor is closed. */
+    close(fd);
+    return mem;
+#else  /*!HAVE_SHM_OPEN*/
+    Scm_Error("named shared memory isn't supported on this platform: %s",
+              name);
+    return SCM_UNDEFINED;       /* dummy */
+#endif /*!HAVE_SHM_OPEN*/
+}
+
+/* Remove the name of a POSIX shared memory object.  Existing mappings
+   remain valid. */
+void Scm_SysShmUnlink(const char *name)
+{
+#if defined(HAVE_SHM_OPEN)
+    int r;
+    SCM_SYSCALL(r, shm_unlink(name));
+    if (r < 0) Scm_SysError("shm_unlink failed for %s", name);
+#else  /*!HAVE_SHM_OPEN*/
+    Scm_Error("named shared memory isn't supported on this platform: %s",
+              name);
+#endif /*!HAVE_SHM_OPEN*/
+}
+
 /* Mmap for runtime code generation.  Returns two ScmMemoryRegions
    of the same size, one for write and one for execute.  If the system
    allows a page being both writable and executable, two regions may
@@ -69,6 +69,8 @@ static ScmObj mutex_allocate(ScmClass *klass, ScmObj initargs SCM_UNUSED)
     mutex->locked = FALSE;
     mutex->owner = NULL;
     mutex->locker_proc = mutex->unlocker_proc = SCM_FALSE;
+    mutex->acquire_count = mutex->contend_count = 0;
+    mutex->wait_total = mutex->wait_max = 0;
     return SCM_OBJ(mutex);
 }
 
@@ -161,6 +163,67 @@ ScmObj Scm_MakeMutex(ScmObj name)
     return m;
 }
 
+/*
+ * Contention statistics
+ *
+ *  When enabled, every Scm_MutexLock counts the acquisition, and if
+ *  it has to wait, measures the wait time with the monotonic clock.
+ *  The uncontended path only pays an increment.  The flag is global
+ *  and read without a lock; a thread may see the change a bit late,
+ *  which is harmless.
+ */
+static volatile int mutex_stats_enabled = FALSE;
+
+static uint64_t monotonic_nsec(void)
+{
+    u_long sec, nsec;
+    Scm_ClockGetTimeMonotonic(&sec, &nsec);
+    return (uint64_t)sec * 1000000000 + nsec;
+}
+
+int Scm_MutexStatsEnable(int flag)
+{
+    int prev = mutex_stats_enabled;
+    mutex_stats_enabled = flag;
+    return prev;
+}
+
+int Scm_MutexStatsEnabledP(void)
+{
+    return mutex_stats_enabled;
+}
+
+static ScmObj sym_acquired;
+static ScmObj sym_contended;
+static ScmObj sym_wait_time;
+static ScmObj sym_max_wait;
+
+/* Returns an alist.  Wait times are in seconds. */
+ScmObj Scm_MutexStats(ScmMutex *mutex)
+{
+    (void)SCM_INTERNAL_MUTEX_LOCK(mutex->mutex);
+    u_long acquired = mutex->acquire_count;
+    u_long contended = mutex->contend_count;
+    uint64_t total = mutex->wait_total;
+    uint64_t max = mutex->wait_max;
+    (void)SCM_INTERNAL_MUTEX_UNLOCK(mutex->mutex);
+
+    return SCM_LIST4(Scm_Cons(sym_acquired, Scm_MakeIntegerU(acquired)),
+                     Scm_Cons(sym_contended, Scm_MakeIntegerU(contended)),
+                     Scm_Cons(sym_wait_time,
+                              Scm_MakeFlonum((double)total/1.0e9)),
+                     Scm_Cons(sym_max_wait,
+                              Scm_MakeFlonum((double)max/1.0e9)));
+}
+
+void Scm_MutexStatsReset(ScmMutex *mutex)
+{
+    (void)SCM_INTERNAL_MUTEX_LOCK(mutex->mutex);
+    mutex->acquire_count = mutex->contend_count = 0;
+    mutex->wait_total = mutex->wait_max = 0;
+    (void)SCM_INTERNAL_MUTEX_UNLOCK(mutex->mutex);
+}
+
 /*
  * Lock and unlock mutex
  */
@@ -171,9 +234,16 @@ ScmObj Scm_MutexLock(ScmMutex *mutex, ScmObj timeout, ScmVM *owner)
     ScmObj r = SCM_TRUE;
     ScmVM * volatile abandoned = NULL;
     volatile int intr = FALSE;
+    int stats = mutex_stats_enabled;
+    int contended = FALSE;
+    uint64_t wait_start = 0;
 
     ScmTimeSpec *pts = Scm_GetTimeSpec(timeout, &ts);
     SCM_INTERNAL_MUTEX_SAFE_LOCK_BEGIN(mutex->mutex);
+    if (stats && mutex->locked) {
+        contended = TRUE;
+        wait_start = monotonic_nsec();
+    }
     while (mutex->locked) {
         if (mutex->owner && mutex->owner->state == SCM_VM_TERMINATED) {
             abandoned = mutex->owner;
@@ -192,6 +262,15 @@ ScmObj Scm_MutexLock(ScmMutex *mutex, ScmObj timeout, ScmVM *owner)
         mutex->locked = TRUE;
         mutex->owner = owner;
     }
+    if (stats) {
+        if (SCM_TRUEP(r)) mutex->acquire_count++;
+        if (contended) {
+            uint64_t w = monotonic_nsec() - wait_start;
+            mutex->contend_count++;
+            mutex->wait_total += w;
+            if (w > mutex->wait_max) mutex->wait_max = w;
+        }
+    }
     SCM_INTERNAL_MUTEX_SAFE_LOCK_END();
     if (intr) Scm_SigCheck(Scm_VM());
     if (abandoned) {
@@ -353,6 +432,280 @@ ScmObj Scm_ConditionVariableBroadcast(ScmConditionVariable *cond)
     return SCM_UNDEFINED;
 }
 
+/*=====================================================
+ * Reader-writer lock
+ */
+
+static ScmObj rwlock_allocate(ScmClass *klass, ScmObj initargs);
+static void   rwlock_print(ScmObj rwlock, ScmPort *port, ScmWriteContext *ctx);
+
+SCM_DEFINE_BASE_CLASS(Scm_RWLockClass, ScmRWLock,
+                      rwlock_print, NULL, NULL, rwlock_allocate,
+                      default_cpl);
+
+static void rwlock_finalize(ScmObj obj, void *data SCM_UNUSED)
+{
+    ScmRWLock *rw = SCM_RWLOCK(obj);
+    SCM_INTERNAL_MUTEX_DESTROY(rw->mutex);
+    SCM_INTERNAL_COND_DESTROY(rw->readers_cv);
+    SCM_INTERNAL_COND_DESTROY(rw->writers_cv);
+}
+
+static ScmObj rwlock_allocate(ScmClass *klass, ScmObj initargs SCM_UNUSED)
+{
+    ScmRWLock *rw = SCM_NEW_INSTANCE(ScmRWLock, klass);
+    SCM_INTERNAL_MUTEX_INIT(rw->mutex);
+    SCM_INTERNAL_COND_INIT(rw->readers_cv);
+    SCM_INTERNAL_COND_INIT(rw->writers_cv);
+    Scm_RegisterFinalizer(SCM_OBJ(rw), rwlock_finalize, NULL);
+    rw->name = SCM_FALSE;
+    rw->specific = SCM_UNDEFINED;
+    rw->readers = 0;
+    rw->waiting_writers = 0;
+    rw->write_locked = FALSE;
+    rw->writer = NULL;
+    return SCM_OBJ(rw);
+}
+
+static void rwlock_print(ScmObj obj, ScmPort *port,
+                         ScmWriteContext *ctx SCM_UNUSED)
+{
+    ScmRWLock *rw = SCM_RWLOCK(obj);
+
+    (void)SCM_INTERNAL_MUTEX_LOCK(rw->mutex);
+    int readers = rw->readers;
+    int write_locked = rw->write_locked;
+    ScmObj name = rw->name;
+    (void)SCM_INTERNAL_MUTEX_UNLOCK(rw->mutex);
+
+    if (SCM_FALSEP(name)) Scm_Printf(port, "#<rwlock %p ", rw);
+    else                  Scm_Printf(port, "#<rwlock %S ", name);
+    if (write_locked)     Scm_Printf(port, "write-locked>");
+    else if (readers > 0) Scm_Printf(port, "read-locked(%d)>", readers);
+    else                  Scm_Printf(port, "unlocked>");
+}
+
+/*
+ * Accessors
+ */
+static ScmObj sym_unlocked;
+static ScmObj sym_read_locked;
+
+/* Returns unlocked, read-locked, the writer thread, not-owned or
+   abandoned. */
+static ScmObj rwlock_state_get(ScmRWLock *rw)
+{
+    ScmObj r;
+    (void)SCM_INTERNAL_MUTEX_LOCK(rw->mutex);
+    if (rw->write_locked) {
+        if (rw->writer) {
+            if (rw->writer->state == SCM_VM_TERMINATED) r = sym_abandoned;
+            else r = SCM_OBJ(rw->writer);
+        } else {
+            r = sym_not_owned;
+        }
+    } else if (rw->readers > 0) {
+        r = sym_read_locked;
+    } else {
+        r = sym_unlocked;
+    }
+    (void)SCM_INTERNAL_MUTEX_UNLOCK(rw->mutex);
+    return r;
+}
+
+static ScmObj rwlock_readers_get(ScmRWLock *rw)
+{
+    return SCM_MAKE_INT(rw->readers);
+}
+
+static ScmObj rwlock_name_get(ScmRWLock *rw)
+{
+    return rw->name;
+}
+
+static void rwlock_name_set(ScmRWLock *rw, ScmObj name)
+{
+    rw->name = name;
+}
+
+static ScmObj rwlock_specific_get(ScmRWLock *rw)
+{
+    return rw->specific;
+}
+
+static void rwlock_specific_set(ScmRWLock *rw, ScmObj value)
+{
+    rw->specific = value;
+}
+
+static ScmClassStaticSlotSpec rwlock_slots[] = {
+    SCM_CLASS_SLOT_SPEC("name", rwlock_name_get, rwlock_name_set),
+    SCM_CLASS_SLOT_SPEC("state", rwlock_state_get, NULL),
+    SCM_CLASS_SLOT_SPEC("readers", rwlock_readers_get, NULL),
+    SCM_CLASS_SLOT_SPEC("specific", rwlock_specific_get, rwlock_specific_set),
+    SCM_CLASS_SLOT_SPEC_END()
+};
+
+/*
+ * Make rwlock
+ */
+ScmObj Scm_MakeRWLock(ScmObj name)
+{
+    ScmObj rw = rwlock_allocate(SCM_CLASS_RWLOCK, SCM_NIL);
+    SCM_RWLOCK(rw)->name = name;
+    return rw;
+}
+
+/*
+ * Lock and unlock
+ *
+ *  Writers are preferred: a reader doesn't enter while any writer is
+ *  waiting, so a steady stream of readers can't starve writers.  The
+ *  flip side is that a thread that already holds a read lock must not
+ *  try to take it again, for it would deadlock with a waiting writer.
+ *
+ *  When the wait is interrupted by a signal, we release the internal
+ *  lock, handle the signal, and retry unless the handler escapes.
+ */
+
+/* Called with rw->mutex held.  If the write lock is held by a terminated
+   thread, releases it and returns the thread. */
+static ScmVM *rwlock_check_abandoned(ScmRWLock *rw)
+{
+    if (rw->write_locked && rw->writer
+        && rw->writer->state == SCM_VM_TERMINATED) {
+        ScmVM *abandoned = rw->writer;
+        rw->write_locked = FALSE;
+        rw->writer = NULL;
+        return abandoned;
+    }
+    return NULL;
+}
+
+static ScmObj rwlock_raise_abandoned(ScmRWLock *rw, ScmVM *abandoned)
+{
+    ScmObj exc
+        = Scm_MakeThreadException(SCM_CLASS_ABANDONED_MUTEX_EXCEPTION,
+                                  abandoned);
+    SCM_THREAD_EXCEPTION(exc)->data = SCM_OBJ(rw);
+    return Scm_Raise(exc, 0);
+}
+
+ScmObj Scm_RWLockReadLock(ScmRWLock *rw, ScmObj timeout)
+{
+    ScmTimeSpec ts;
+    ScmObj r;
+    ScmVM * volatile abandoned;
+    volatile int intr;
+
+    ScmTimeSpec *pts = Scm_GetTimeSpec(timeout, &ts);
+    for (;;) {
+        r = SCM_TRUE;
+        abandoned = NULL;
+        intr = FALSE;
+        SCM_INTERNAL_MUTEX_SAFE_LOCK_BEGIN(rw->mutex);
+        for (;;) {
+            if (rw->write_locked) {
+                ScmVM *vm = rwlock_check_abandoned(rw);
+                if (vm) {
+                    abandoned = vm;
+                    SCM_INTERNAL_COND_BROADCAST(rw->readers_cv);
+                    SCM_INTERNAL_COND_SIGNAL(rw->writers_cv);
+                    continue;
+                }
+            } else if (rw->waiting_writers == 0) {
+                break;
+            }
+            if (pts) {
+                int tr = SCM_INTERNAL_COND_TIMEDWAIT(rw->readers_cv,
+                                                     rw->mutex, pts);
+                if (tr == SCM_INTERNAL_COND_TIMEDOUT) { r = SCM_FALSE; break; }
+                else if (tr == SCM_INTERNAL_COND_INTR) { intr = TRUE; break; }
+            } else {
+                SCM_INTERNAL_COND_WAIT(rw->readers_cv, rw->mutex);
+            }
+        }
+        if (SCM_TRUEP(r) && !intr) rw->readers++;
+        SCM_INTERNAL_MUTEX_SAFE_LOCK_END();
+        if (!intr) break;
+        Scm_SigCheck(Scm_VM());
+    }
+    if (abandoned) r = rwlock_raise_abandoned(rw, (ScmVM*)abandoned);
+    return r;
+}
+
+ScmObj Scm_RWLockWriteLock(ScmRWLock *rw, ScmObj timeout, ScmVM *owner)
+{
+    ScmTimeSpec ts;
+    ScmObj r;
+    ScmVM * volatile abandoned;
+    volatile int intr;
+
+    ScmTimeSpec *pts = Scm_GetTimeSpec(timeout, &ts);
+    for (;;) {
+        r = SCM_TRUE;
+        abandoned = NULL;
+        intr = FALSE;
+        SCM_INTERNAL_MUTEX_SAFE_LOCK_BEGIN(rw->mutex);
+        rw->waiting_writers++;
+        for (;;) {
+            if (rw->write_locked) {
+                ScmVM *vm = rwlock_check_abandoned(rw);
+                if (vm) { abandoned = vm; continue; }
+            } else if (rw->readers == 0) {
+                break;
+            }
+            if (pts) {
+                int tr = SCM_INTERNAL_COND_TIMEDWAIT(rw->writers_cv,
+                                                     rw->mutex, pts);
+                if (tr == SCM_INTERNAL_COND_TIMEDOUT) { r = SCM_FALSE; break; }
+                else if (tr == SCM_INTERNAL_COND_INTR) { intr = TRUE; break; }
+            } else {
+                SCM_INTERNAL_COND_WAIT(rw->writers_cv, rw->mutex);
+            }
+        }
+        rw->waiting_writers--;
+        if (SCM_TRUEP(r) && !intr) {
+            rw->write_locked = TRUE;
+            rw->writer = owner;
+        } else if (rw->waiting_writers == 0 && !rw->write_locked) {
+            /* We've been holding back readers; let them go. */
+            SCM_INTERNAL_COND_BROADCAST(rw->readers_cv);
+        }
+        SCM_INTERNAL_MUTEX_SAFE_LOCK_END();
+        if (!intr) break;
+        Scm_SigCheck(Scm_VM());
+    }
+    if (abandoned) r = rwlock_raise_abandoned(rw, (ScmVM*)abandoned);
+    return r;
+}
+
+/* Releases either a write lock or one read lock, whichever is held. */
+ScmObj Scm_RWLockUnlock(ScmRWLock *rw)
+{
+    int was_unlocked = FALSE;
+
+    (void)SCM_INTERNAL_MUTEX_LOCK(rw->mutex);
+    if (rw->write_locked) {
+        rw->write_locked = FALSE;
+        rw->writer = NULL;
+        if (rw->waiting_writers > 0) {
+            SCM_INTERNAL_COND_SIGNAL(rw->writers_cv);
+        } else {
+            SCM_INTERNAL_COND_BROADCAST(rw->readers_cv);
+        }
+    } else if (rw->readers > 0) {
+        if (--rw->readers == 0 && rw->waiting_writers > 0) {
+            SCM_INTERNAL_COND_SIGNAL(rw->writers_cv);
+        }
+    } else {
+        was_unlocked = TRUE;
+    }
+    (void)SCM_INTERNAL_MUTEX_UNLOCK(rw->mutex);
+    if (was_unlocked) Scm_Error("rwlock is not locked: %S", SCM_OBJ(rw));
+    return SCM_TRUE;
+}
+
 /*
  * Initialization
  */
@@ -363,6 +716,13 @@ void Scm__InitMutex()
     sym_not_owned     = SCM_INTERN("not-owned");
     sym_abandoned     = SCM_INTERN("abandoned");
     sym_not_abandoned = SCM_INTERN("not-abandoned");
+    sym_unlocked      = SCM_INTERN("unlocked");
+    sym_read_locked   = SCM_INTERN("read-locked");
+    sym_acquired      = SCM_INTERN("acquired");
+    sym_contended     = SCM_INTERN("contended");
+    sym_wait_time     = SCM_INTERN("wait-time");
+    sym_max_wait      = SCM_INTERN("max-wait");
     Scm_InitStaticClass(&Scm_MutexClass, "<mutex>", mod, mutex_slots, 0);
     Scm_InitStaticClass(&Scm_ConditionVariableClass, "<condition-variable>", mod, cv_slots, 0);
+    Scm_InitStaticClass(&Scm_RWLockClass, "<rwlock>", mod, rwlock_slots, 0);
 }
@@ -756,47 +756,76 @@ ScmObj Scm_ReduceRational(ScmObj rational)
     }
 }
 
-/* x, y must be exact numbers */
+/* Returns numer/denom, where we know they are relatively prime and
+   denom > 0; so we can skip normalization. */
+static ScmObj make_reduced_rational(ScmObj numer, ScmObj denom)
+{
+    if (SCM_EXACT_ONE_P(denom)) return numer;
+    if (SCM_EXACT_ZERO_P(numer)) return SCM_MAKE_INT(0);
+    return Scm_MakeRatnum(numer, denom);
+}
+
+/* x, y must be exact numbers.
+   We avoid taking gcd of the full-size result; see Knuth TAOCP 4.5.1.
+   With g = gcd(dx, dy), the result is t/(dx*(dy/g)) where
+   t = nx*(dy/g) + ny*(dx/g), and only gcd(t, g) can be the common
+   factor. */
 ScmObj Scm_RatnumAddSub(ScmObj x, ScmObj y, int subtract)
 {
     ScmObj nx = SCM_RATNUMP(x)? SCM_RATNUM_NUMER(x) : x;
     ScmObj dx = SCM_RATNUMP(x)? SCM_RATNUM_DENOM(x) : SCM_MAKE_INT(1);
     ScmObj ny = SCM_RATNUMP(y)? SCM_RATNUM_NUMER(y) : y;
     ScmObj dy = SCM_RATNUMP(y)? SCM_RATNUM_DENOM(y) : SCM_MAKE_INT(1);
-    ScmObj gcd, dr, nr;
+    ScmObj nr, dr;
 
-    /* shortcut */
+    /* shortcuts */
+    if (SCM_EXACT_ONE_P(dx)) {
+        /* (nx*dy + ny)/dy is already reduced */
+        nx = Scm_Mul(nx, dy);
+        nr = (subtract? Scm_Sub(nx, ny) : Scm_Add(nx, ny));
+        return make_reduced_rational(nr, dy);
+    }
+    if (SCM_EXACT_ONE_P(dy)) {
+        ny = Scm_Mul(ny, dx);
+        nr = (subtract? Scm_Sub(nx, ny) : Scm_Add(nx, ny));
+        return make_reduced_rational(nr, dx);
+    }
     if (Scm_NumEq(dx, dy)) {
-        dr = dx;
-        goto finish;
+        /* only the common denominator can share factors with the sum */
+        nr = (subtract? Scm_Sub(nx, ny) : Scm_Add(nx, ny));
+        ScmObj g = Scm_Gcd(nr, dx);
+        if (SCM_EXACT_ONE_P(g)) return make_reduced_rational(nr, dx);
+        return make_reduced_rational(Scm_Quotient(nr, g, NULL),
+                                     Scm_Quotient(dx, g, NULL));
     }
 
-    if (SCM_EXACT_ONE_P(dx)||SCM_EXACT_ONE_P(dx)) gcd = SCM_MAKE_INT(1);
-    else gcd = Scm_Gcd(dx, dy);
-    if (Scm_NumEq(dx, gcd)) {
-        /* only factor x */
-        nx = Scm_Mul(Scm_Quotient(dy, dx, NULL), nx);
-        dr = dy;
-        goto finish;
-    }
-    if (Scm_NumEq(dy, gcd)) {
-        /* only factor y */
-        ny = Scm_Mul(Scm_Quotient(dx, dy, NULL), ny);
-        dr = dx;
-        goto finish;
+    ScmObj g = Scm_Gcd(dx, dy);
+    if (SCM_EXACT_ONE_P(g)) {
+        nx = Scm_Mul(nx, dy);
+        ny = Scm_Mul(ny, dx);
+        nr = (subtract? Scm_Sub(nx, ny) : Scm_Add(nx, ny));
+        return make_reduced_rational(nr, Scm_Mul(dx, dy));
     }
 
     /* general case */
-    ScmObj fx = Scm_Quotient(dx, gcd, NULL);
-    ScmObj fy = Scm_Quotient(dy, gcd, NULL);
+    ScmObj fx = Scm_Quotient(dx, g, NULL);
+    ScmObj fy = Scm_Quotient(dy, g, NULL);
     nx = Scm_Mul(nx, fy);
     ny = Scm_Mul(ny, fx);
-    dr = Scm_Mul(dx, fy);
-  finish:
     nr = (subtract? Scm_Sub(nx, ny) : Scm_Add(nx, ny));
-    return Scm_MakeRational(nr, dr);
+    ScmObj g2 = Scm_Gcd(nr, g);
+    if (SCM_EXACT_ONE_P(g2)) {
+        dr = Scm_Mul(dx, fy);
+    } else {
+        nr = Scm_Quotient(nr, g2, NULL);
+        dr = Scm_Mul(fx, Scm_Quotient(dy, g2, NULL));
+    }
+    return make_reduced_rational(nr, dr);
 }
 
+/* Cross-cancel before multiplying: with g1 = gcd(nx, dy) and
+   g2 = gcd(ny, dx), (nx/g1)*(ny/g2) / ((dx/g2)*(dy/g1)) is already
+   reduced, and the gcds are taken on the smaller operands. */
 ScmObj Scm_RatnumMulDiv(ScmObj x, ScmObj y, int divide)
 {
     ScmObj nx = SCM_RATNUMP(x)? SCM_RATNUM_NUMER(x) : x;
@@ -806,9 +835,26 @@ ScmObj Scm_RatnumMulDiv(ScmObj x, ScmObj y, int divide)
 
     if (divide) {
         ScmObj t = ny; ny = dy; dy = t;
+        if (SCM_EXACT_ZERO_P(dy)) {
+            Scm_Error("attempt to calculate a division by zero");
+        }
+        if (Scm_Sign(dy) < 0) {
+            ny = Scm_Negate(ny);
+            dy = Scm_Negate(dy);
+        }
     }
-    return Scm_MakeRational(Scm_Mul(nx, ny),
-                            Scm_Mul(dx, dy));
+
+    ScmObj g1 = Scm_Gcd(nx, dy);
+    if (!SCM_EXACT_ONE_P(g1)) {
+        nx = Scm_Quotient(nx, g1, NULL);
+        dy = Scm_Quotient(dy, g1, NULL);
+    }
+    ScmObj g2 = Scm_Gcd(ny, dx);
+    if (!SCM_EXACT_ONE_P(g2)) {
+        ny = Scm_Quotient(ny, g2, NULL);
+        dx = Scm_Quotient(dx, g2, NULL);
+    }
+    return make_reduced_rational(Scm_Mul(nx, ny), Scm_Mul(dx, dy));
 }
 
 #define Scm_RatnumAdd(x, y)  Scm_RatnumAddSub(x, y, FALSE)
@@ -2230,6 +2276,7 @@ scm_div(ScmObj arg0, ScmObj arg1, int inexact, int compat, int vmp)
             goto ratnum_return;
         }
         if (SCM_RATNUMP(arg1)) {
+            if (!compat && !inexact) return Scm_RatnumDiv(arg0, arg1);
             arg0 = Scm_Mul(arg0, SCM_RATNUM_DENOM(arg1));
             arg1 = SCM_RATNUM_NUMER(arg1);
             goto ratnum_return;
@@ -2256,6 +2303,7 @@ scm_div(ScmObj arg0, ScmObj arg1, int inexact, int compat, int vmp)
             goto ratnum_return;
         }
         if (SCM_RATNUMP(arg1)) {
+            if (!compat && !inexact) return Scm_RatnumDiv(arg0, arg1);
             arg0 = Scm_Mul(arg0, SCM_RATNUM_DENOM(arg1));
             arg1 = SCM_RATNUM_NUMER(arg1);
             goto ratnum_return;
@@ -2276,11 +2324,13 @@ scm_div(ScmObj arg0, ScmObj arg1, int inexact, int compat, int vmp)
                 else goto div_by_zero;
             }
             if (SCM_EXACT_ONE_P(arg1)) SIMPLE_RETURN(arg0);
+            if (!compat && !inexact) return Scm_RatnumDiv(arg0, arg1);
             arg1 = Scm_Mul(SCM_RATNUM_DENOM(arg0), arg1);
             arg0 = SCM_RATNUM_NUMER(arg0);
             goto ratnum_return;
         }
         if (SCM_BIGNUMP(arg1)) {
+            if (!compat && !inexact) return Scm_RatnumDiv(arg0, arg1);
             arg1 = Scm_Mul(SCM_RATNUM_DENOM(arg0), arg1);
             arg0 = SCM_RATNUM_NUMER(arg0);
             goto ratnum_return;
@@ -2670,15 +2720,20 @@ ScmObj Scm_Modulo(ScmObj x, ScmObj y, int remp)
  * Gcd
  */
 
-/* assumes x > y >= 0 */
+/* Binary gcd (Stein's algorithm); avoids division, which is much
+   slower than shifts and subtractions on most machines. */
 static u_long gcd_fixfix(u_long x, u_long y)
 {
-    while (y > 0) {
-        u_long r = x % y;
-        x = y;
-        y = r;
-    }
-    return x;
+    if (x == 0) return y;
+    if (y == 0) return x;
+    int shift = Scm__LowestBitNumber(x|y);
+    x >>= Scm__LowestBitNumber(x);
+    do {
+        y >>= Scm__LowestBitNumber(y);
+        if (x > y) { u_long t = y; y = x; x = t; }
+        y -= x;
+    } while (y != 0);
+    return x << shift;
 }
 
 static double gcd_floflo(double x, double y)
@@ -2699,8 +2754,7 @@ static double gcd_floflo(double x, double y)
    since it only affects the remainder's sign which we adjust afterwards. */
 static u_long gcd_bigfix(ScmBignum *x, u_long y)
 {
-    long rem;
-    (void)Scm_BignumDivSI(x, (signed long)y, &rem);
+    long rem = Scm_BignumRemSI(x, (signed long)y);
     if (rem < 0) rem = -rem;
     return gcd_fixfix(y, (u_long)rem);
 }
@@ -2728,8 +2782,7 @@ ScmObj Scm_Gcd(ScmObj x, ScmObj y)
     if (!ox && !oy) {
         u_long ux = (ix < 0)? -ix : ix;
         u_long uy = (iy < 0)? -iy : iy;
-        u_long ur = (ux >= uy)? gcd_fixfix(ux, uy) : gcd_fixfix(uy, ux);
-        return Scm_MakeIntegerU(ur);
+        return Scm_MakeIntegerU(gcd_fixfix(ux, uy));
     }
 
     if (!oy && iy != LONG_MIN) {
@@ -2750,19 +2803,61 @@ ScmObj Scm_Gcd(ScmObj x, ScmObj y)
         return Scm_MakeIntegerU(ur);
     }
 
-    /* Now we need to treat both args as bignums.  We could use
-       Algorithm L in Knuth's TAOCP 4.5.2, but we assume this path
-       is rarely executed, so we don't bother for now. */
-    x = Scm_Abs(x);
-    y = Scm_Abs(y);
-    if (Scm_NumCmp(x, y) < 0) {ScmObj t = x; x = y; y = t;}
+    /* Now both args are bignums (LONG_MIN is out of fixnum range). */
+    SCM_ASSERT(SCM_BIGNUMP(x) && SCM_BIGNUMP(y));
+    return Scm_BignumGcd(SCM_BIGNUM(x), SCM_BIGNUM(y));
+}
 
-    while (!SCM_EXACT_ZERO_P(y)) {
-        ScmObj r = Scm_Modulo(x, y, TRUE);
-        x = y;
-        y = r;
+static ScmBignum *integer_to_bignum(ScmObj x)
+{
+    if (SCM_INTP(x)) return SCM_BIGNUM(Scm_MakeBignumFromSI(SCM_INT_VALUE(x)));
+    return SCM_BIGNUM(x);
+}
+
+/* (modulo (expt b e) m) for exact integers, without computing (expt b e).
+   e must be nonnegative.  An odd modulus is handled by Montgomery
+   multiplication in bignum.c; an even one by classical reduction. */
+ScmObj Scm_ExptMod(ScmObj b, ScmObj e, ScmObj m)
+{
+    if (!SCM_INTEGERP(b)) Scm_Error("exact integer required, but got %S", b);
+    if (!SCM_INTEGERP(e)) Scm_Error("exact integer required, but got %S", e);
+    if (!SCM_INTEGERP(m)) Scm_Error("exact integer required, but got %S", m);
+    if (Scm_Sign(e) < 0) {
+        Scm_Error("nonnegative exponent required, but got %S", e);
     }
-    return x;
+    if (SCM_EXACT_ZERO_P(m)) {
+        Scm_Error("attempt to take a modulo or remainder by zero");
+    }
+
+    ScmObj am = Scm_Abs(m), r;
+    if (SCM_EQ(am, SCM_MAKE_INT(1))) return SCM_MAKE_INT(0);
+    b = Scm_Modulo(b, am, FALSE);
+
+    if (SCM_INTP(am) && SCM_INTP(e)
+        && (u_long)SCM_INT_VALUE(am) <= HALF_WORD) {
+        /* The products fit in a word. */
+        u_long ub = (u_long)SCM_INT_VALUE(b), um = (u_long)SCM_INT_VALUE(am);
+        u_long ue = (u_long)SCM_INT_VALUE(e), ur = 1;
+        for (; ue; ue >>= 1) {
+            if (ue & 1) ur = ur * ub % um;
+            ub = ub * ub % um;
+        }
+        r = Scm_MakeIntegerU(ur);
+    } else if (Scm_OddP(am)) {
+        r = Scm_BignumExptMod(integer_to_bignum(b), integer_to_bignum(e),
+                              integer_to_bignum(am));
+    } else {
+        ScmBignum *be = integer_to_bignum(e);
+        r = SCM_MAKE_INT(1);
+        for (long i = (long)Scm_IntegerLength(e) - 1; i >= 0; i--) {
+            r = Scm_Modulo(Scm_Mul(r, r), am, FALSE);
+            if ((be->values[i/SCM_WORD_BITS] >> (i%SCM_WORD_BITS)) & 1) {
+                r = Scm_Modulo(Scm_Mul(r, b), am, FALSE);
+            }
+        }
+    }
+    if (Scm_Sign(m) < 0 && !SCM_EXACT_ZERO_P(r)) r = Scm_Add(r, m);
+    return r;
 }
 
 /*===============================================================
@@ -3753,6 +3848,8 @@ static double raise_pow10(double x, int n)
  * This version implements Burger&Dybvig algorithm (Robert G. Burger
  * and and R. Kent Dybvig, "Priting Floating-Point Numbers Quickly and
  * Accurately", PLDI '96, pp.108--116, 1996).
+ * The shortest representation, which is the most common case, is
+ * generated by Ryu without bignums; see ryu_shortest below.
  */
 
 /* compare x+d and y.  x, d, y are exact positive integers.
@@ -3772,6 +3869,236 @@ static inline int numcmp3(ScmObj x, ScmObj d, ScmObj y)
     }
 }
 
+/* 64x64->128 bit multiplication.  Returns the high word and stores
+   the low word in *lo. */
+static inline uint64_t umul64(uint64_t a, uint64_t b, uint64_t *lo)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 p = (unsigned __int128)a * b;
+    *lo = (uint64_t)p;
+    return (uint64_t)(p >> 64);
+#else  /*!defined(__SIZEOF_INT128__)*/
+    uint64_t aL = (uint32_t)a, aH = a >> 32;
+    uint64_t bL = (uint32_t)b, bH = b >> 32;
+    uint64_t pLL = aL*bL, pLH = aL*bH, pHL = aH*bL, pHH = aH*bH;
+    uint64_t mid1 = pHL + (pLL >> 32);
+    uint64_t mid2 = pLH + (uint32_t)mid1;
+    *lo = (mid2 << 32) | (uint32_t)pLL;
+    return pHH + (mid1 >> 32) + (mid2 >> 32);
+#endif /*!defined(__SIZEOF_INT128__)*/
+}
+
+/*
+ * Shortest representation by Ryu (Ulf Adams, "Ryu: Fast Float-to-String
+ * Conversion", PLDI 2018).  It finds the same digits as the free-format
+ * Burger&Dybvig algorithm using only 64x128-bit fixed-point
+ * multiplications, so we use it when no precision is specified.
+ * Two details are adjusted to match print_double below bit for bit:
+ * the boundary of 2^-1022 is treated as asymmetric, and when the exact
+ * value is right in the middle of two shortest candidates, we take
+ * the lower one iff the mantissa is even.
+ */
+
+#define RYU_POW5_INV_BITCOUNT 125
+#define RYU_POW5_BITCOUNT     125
+#define RYU_POW5_INV_TABLESIZ 342
+#define RYU_POW5_TABLESIZ     326
+
+/* 5^i, normalized to 125 bits, and 2^k/5^i rounded up, where k is
+   chosen to keep 125 bits.  Each entry is {low, high} 64-bit words.
+   Calculated by ryu_init(), called from Scm__InitNumber. */
+static uint64_t ryu_pow5_split[RYU_POW5_TABLESIZ][2];
+static uint64_t ryu_pow5_inv_split[RYU_POW5_INV_TABLESIZ][2];
+
+/* ceil(log2(5^e)) for e > 0, 1 for e == 0.  Valid for 0 <= e <= 3528. */
+static inline int ryu_pow5bits(int e)
+{
+    return (int)(((uint32_t)e * 1217359) >> 19) + 1;
+}
+
+/* floor(log10(2^e)), 0 <= e <= 1650 */
+static inline int ryu_log10_pow2(int e)
+{
+    return (int)(((uint32_t)e * 78913) >> 18);
+}
+
+/* floor(log10(5^e)), 0 <= e <= 2620 */
+static inline int ryu_log10_pow5(int e)
+{
+    return (int)(((uint32_t)e * 732923) >> 20);
+}
+
+static inline int ryu_multiple_of_pow5(uint64_t v, int p)
+{
+    int count = 0;
+    for (; v % 5 == 0; v /= 5) count++;
+    return count >= p;
+}
+
+static inline int ryu_multiple_of_pow2(uint64_t v, int p)
+{
+    return (v & (((uint64_t)1 << p) - 1)) == 0;
+}
+
+/* (m * mul) >> j, where mul is a 128-bit number, m < 2^55
+   and 64 < j < 128. */
+static inline uint64_t ryu_mul_shift(uint64_t m, const uint64_t *mul, int j)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 b0 = (unsigned __int128)m * mul[0];
+    unsigned __int128 b2 = (unsigned __int128)m * mul[1];
+    return (uint64_t)(((b0 >> 64) + b2) >> (j - 64));
+#else  /*!defined(__SIZEOF_INT128__)*/
+    uint64_t high0, low0, high1, low1;
+    high0 = umul64(m, mul[0], &low0);
+    high1 = umul64(m, mul[1], &low1);
+    (void)low0;
+    uint64_t sum = high0 + low1;
+    if (sum < high0) high1++;
+    int dist = j - 64;          /* 0 < dist < 64 */
+    return (high1 << (64 - dist)) | (sum >> dist);
+#endif /*!defined(__SIZEOF_INT128__)*/
+}
+
+static void ryu_split(ScmObj v, uint64_t *w)
+{
+    w[0] = Scm_GetIntegerU64Clamp(Scm_LogAnd(v, SCM_2_64_MINUS_1),
+                                  SCM_CLAMP_NONE, NULL);
+    w[1] = Scm_GetIntegerU64Clamp(Scm_Ash(v, -64), SCM_CLAMP_NONE, NULL);
+}
+
+static void ryu_init(void)
+{
+    ScmObj p5 = SCM_MAKE_INT(1);
+    for (int i=0; i<RYU_POW5_INV_TABLESIZ; i++) {
+        int bits = ryu_pow5bits(i); /* bit length of 5^i */
+        if (i < RYU_POW5_TABLESIZ) {
+            ryu_split(Scm_Ash(p5, RYU_POW5_BITCOUNT - bits),
+                      ryu_pow5_split[i]);
+        }
+        ScmObj k = Scm_Ash(SCM_MAKE_INT(1), bits - 1 + RYU_POW5_INV_BITCOUNT);
+        ryu_split(Scm_Add(Scm_Quotient(k, p5, NULL), SCM_MAKE_INT(1)),
+                  ryu_pow5_inv_split[i]);
+        p5 = Scm_Mul(p5, SCM_MAKE_INT(5));
+    }
+}
+
+/* Stores the shortest decimal digits of positive finite VAL into BUF,
+   which must have at least 17 bytes, and returns the number of digits.
+   *EST receives the decimal exponent such that VAL = 0.BUF * 10^*EST. */
+static int ryu_shortest(double val, char *buf, int *est)
+{
+    union { double d; uint64_t i; } u;
+    u.d = val;
+    uint64_t ieee_mant = u.i & (((uint64_t)1 << 52) - 1);
+    int ieee_exp = (int)((u.i >> 52) & 0x7ff);
+
+    int e2;
+    uint64_t m2;
+    if (ieee_exp == 0) {
+        e2 = 1 - 1023 - 52 - 2;
+        m2 = ieee_mant;
+    } else {
+        e2 = ieee_exp - 1023 - 52 - 2;
+        m2 = ((uint64_t)1 << 52) | ieee_mant;
+    }
+    int accept_bounds = (m2 & 1) == 0;
+
+    /* The interval of valid representations is (mm, mp) scaled by 4,
+       or [mm, mp] if accept_bounds.  The lower boundary is closer if
+       the mantissa is a power of two. */
+    uint64_t mv = 4 * m2;
+    int mm_shift = (ieee_mant != 0);
+
+    /* Convert to decimal: vr, vp and vm are mv, mp and mm multiplied
+       by 10^-e10. */
+    uint64_t vr, vp, vm;
+    int e10;
+    int vm_trailing_zeros = FALSE, vr_trailing_zeros = FALSE;
+    if (e2 >= 0) {
+        int q = ryu_log10_pow2(e2) - (e2 > 3);
+        int k = RYU_POW5_INV_BITCOUNT + ryu_pow5bits(q) - 1;
+        int i = -e2 + q + k;
+        e10 = q;
+        vr = ryu_mul_shift(4*m2, ryu_pow5_inv_split[q], i);
+        vp = ryu_mul_shift(4*m2 + 2, ryu_pow5_inv_split[q], i);
+        vm = ryu_mul_shift(4*m2 - 1 - mm_shift, ryu_pow5_inv_split[q], i);
+        if (q <= 21) {
+            /* Only one of mp, mv and mm can be a multiple of 5, if any. */
+            if (mv % 5 == 0) {
+                vr_trailing_zeros = ryu_multiple_of_pow5(mv, q);
+            } else if (accept_bounds) {
+                vm_trailing_zeros = ryu_multiple_of_pow5(mv - 1 - mm_shift, q);
+            } else {
+                vp -= ryu_multiple_of_pow5(mv + 2, q);
+            }
+        }
+    } else {
+        int q = ryu_log10_pow5(-e2) - (-e2 > 1);
+        int i = -e2 - q;
+        int k = ryu_pow5bits(i) - RYU_POW5_BITCOUNT;
+        int j = q - k;
+        e10 = q + e2;
+        vr = ryu_mul_shift(4*m2, ryu_pow5_split[i], j);
+        vp = ryu_mul_shift(4*m2 + 2, ryu_pow5_split[i], j);
+        vm = ryu_mul_shift(4*m2 - 1 - mm_shift, ryu_pow5_split[i], j);
+        if (q <= 1) {
+            /* mv has at least q trailing 0 bits, hence vr is exact. */
+            vr_trailing_zeros = TRUE;
+            if (accept_bounds) {
+                vm_trailing_zeros = (mm_shift == 1);
+            } else {
+                vp--;
+            }
+        } else if (q < 63) {
+            vr_trailing_zeros = ryu_multiple_of_pow2(mv, q);
+        }
+    }
+
+    /* Remove digits as long as the interval contains a shorter number. */
+    int removed = 0;
+    int last_removed = 0;
+    uint64_t output;
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        /* We need to track whether the removed digits are all zeros. */
+        while (vp/10 > vm/10) {
+            vm_trailing_zeros &= (vm % 10 == 0);
+            vr_trailing_zeros &= (last_removed == 0);
+            last_removed = (int)(vr % 10);
+            vr /= 10; vp /= 10; vm /= 10;
+            removed++;
+        }
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= (last_removed == 0);
+                last_removed = (int)(vr % 10);
+                vr /= 10; vp /= 10; vm /= 10;
+                removed++;
+            }
+        }
+        if (vr_trailing_zeros && last_removed == 5 && accept_bounds) {
+            last_removed = 4;   /* exactly halfway; round down */
+        }
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros))
+                       || last_removed >= 5);
+    } else {
+        int round_up = FALSE;
+        while (vp/10 > vm/10) {
+            round_up = (vr % 10 >= 5);
+            vr /= 10; vp /= 10; vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || round_up);
+    }
+
+    int n = 0;
+    char tmp[20];
+    for (; output > 0; output /= 10) tmp[n++] = (char)('0' + output % 10);
+    for (int i=0; i<n; i++) buf[i] = tmp[n-1-i];
+    *est = e10 + removed + n;
+    return n;
+}
+
 /* Increment the given decimal number represented as a string.
 
           /------------------ start
@@ -3852,6 +4179,71 @@ static void spill_fixup(ScmDString *ds, int numstart)
     Scm_DStringPutz(ds, nbuf, -1);
 }
 
+/* Prints the exponent part of print_double.  EST is the exponent. */
+static void print_exponent(ScmDString *ds, int est, int exp_width)
+{
+    SCM_ASSERT(est < 1000 && est > -1000);
+    if (est != 0) {
+        SCM_DSTRING_PUTC(ds, 'e');
+        if (est < 0) {
+            Scm_DStringPutc(ds, '-');
+            est = -est;
+        }
+        char zbuf[5]; /* we know est is at most 4 digits */
+        int echars = sprintf(zbuf, "%d", (int)est);
+        if (echars < exp_width) {
+            int fill = exp_width - echars;
+            while (fill--) {
+                Scm_DStringPutc(ds, '0');
+            }
+        }
+        Scm_DStringPutz(ds, zbuf, -1);
+    }
+}
+
+/* The part of print_double when we need the shortest representation,
+   that is, PRECISION is -1 or NOTATIONAL is true.  VAL is positive, and
+   the sign is already printed.  The output is the same as the
+   Burger&Dybvig loop in print_double. */
+static void print_double_shortest(ScmDString *ds, double val, int numstart,
+                                  int precision, int notational,
+                                  int exp_lo, int exp_hi, int exp_width)
+{
+    char digits[20];
+    int est;
+
+    int ndigs = ryu_shortest(val, digits, &est);
+
+    int point;
+    if (est < exp_hi && est > exp_lo) { point = est; est = 1; }
+    else { point = 1; }
+
+    if (point <= 0) {
+        Scm_DStringPutz(ds, "0.", 2);
+        for (int i=point; i<0; i++) SCM_DSTRING_PUTC(ds, '0');
+    }
+    for (int i=1; i<=ndigs; i++) {
+        SCM_DSTRING_PUTC(ds, digits[i-1]);
+        if (i == point && i < ndigs) SCM_DSTRING_PUTC(ds, '.');
+    }
+
+    int fracdigs = (ndigs > point)? ndigs - point : -1;
+    if (notational && precision >= 0 && fracdigs > precision) {
+        notational_rounding(ds, numstart, precision);
+    }
+
+    int digs = ndigs;
+    if (digs <= point) {
+        for (;digs < point; digs++) SCM_DSTRING_PUTC(ds, '0');
+        SCM_DSTRING_PUTC(ds, '.');
+        if (precision < 0) SCM_DSTRING_PUTC(ds, '0');
+    }
+    for (;(digs-point) < precision; digs++) {
+        SCM_DSTRING_PUTC(ds, '0');
+    }
+    print_exponent(ds, est-1, exp_width);
+}
+
 /* The main routine to get string representation of double.
    Convert VAL to a string and store to BUF, which must have at least FLT_BUF
    bytes long.
@@ -3897,6 +4289,13 @@ static void print_double(ScmDString *ds, double val, int plus_sign,
     else if (plus_sign) SCM_DSTRING_PUTC(ds, '+');
 
     int numstart = Scm_DStringSize(ds); /* remember this for notational rounding */
+    if (val < 0) val = -val;
+
+    if (precision < 0 || notational) {
+        print_double_shortest(ds, val, numstart, precision, notational,
+                              exp_lo, exp_hi, exp_width);
+        return;
+    }
 
     /* variable names follows Burger&Dybvig paper. mp, mm for m+, m-.
        note that m+ == m- for most cases, and m+ == 2*m- for the rest.
@@ -3910,7 +4309,6 @@ static void print_double(ScmDString *ds, double val, int plus_sign,
                             point it becomes 0, then we start counting. */
 
     IEXPT10_INIT();
-    if (val < 0) val = -val;
 
     /* initialize r, s, m+ and m- */
     ScmObj f = Scm_DecodeFlonum(val, &exp, &sign);
@@ -4096,25 +4494,8 @@ static void print_double(ScmDString *ds, double val, int plus_sign,
     }
 
  show_exponent:
-    SCM_ASSERT(est < 1000 && est > -1000);
     /* prints exponent.  we shifted decimal point, so -1. */
-    est--;
-    if (est != 0) {
-        SCM_DSTRING_PUTC(ds, 'e');
-        if (est < 0) {
-            Scm_DStringPutc(ds, '-');
-            est = -est;
-        }
-        char zbuf[5]; /* we know est is at most 4 digits */
-        int echars = sprintf(zbuf, "%d", (int)est);
-        if (echars < exp_width) {
-            int fill = exp_width - echars;
-            while (fill--) {
-                Scm_DStringPutc(ds, '0');
-            }
-        }
-        Scm_DStringPutz(ds, zbuf, -1);
-    }
+    print_exponent(ds, est-1, exp_width);
 }
 
 #define FLT_BUF 65  /* need to hold binary representation of the least fixnum */
@@ -4297,21 +4678,29 @@ size_t Scm_PrintNumber(ScmPort *port, ScmObj n, ScmNumberFormat *fmt)
     return print_number(port, n, fmt->flags, fmt);
 }
 
-/* API.  FMT can be NULL.  Utility to expose Burger&Dybvig algorithm. */
-size_t Scm_PrintDouble(ScmPort *port, double d, ScmNumberFormat *fmt)
+/* API.  FMT can be NULL.  Same as Scm_PrintDouble, but appends the
+   representation to DS.  Useful for routines that build output in
+   a DString. */
+void Scm_DStringPutDouble(ScmDString *ds, double d, ScmNumberFormat *fmt)
 {
     ScmNumberFormat defaults;
     if (fmt == NULL) {
         Scm_NumberFormatInit(&defaults);
         fmt = &defaults;
     }
-    ScmDString ds;
-    Scm_DStringInit(&ds);
-    print_double(&ds, d,
+    print_double(ds, d,
                  fmt->flags & SCM_NUMBER_FORMAT_SHOW_PLUS,
                  fmt->precision,
                  fmt->flags & SCM_NUMBER_FORMAT_ROUND_NOTATIONAL,
                  fmt->exp_lo, fmt->exp_hi, fmt->exp_width);
+}
+
+/* API.  FMT can be NULL.  Utility to expose Burger&Dybvig algorithm. */
+size_t Scm_PrintDouble(ScmPort *port, double d, ScmNumberFormat *fmt)
+{
+    ScmDString ds;
+    Scm_DStringInit(&ds);
+    Scm_DStringPutDouble(&ds, d, fmt);
     size_t nchars = Scm_DStringSize(&ds);
     Scm_Putz(Scm_DStringGetz(&ds), (int)nchars, port);
     return nchars;
@@ -4386,6 +4775,11 @@ static u_long bigdig[SCM_RADIX_MAX-SCM_RADIX_MIN+1] = { 0 };
 
 static ScmObj numerr(const char *msg, struct numread_packet *ctx);
 
+/* Once the accumulated bignum gets this many words, read_uint stops
+   accumulating (which is quadratic) and collects the rest of digits to
+   convert them at once by Scm_DigitsToBignum. */
+#define READ_UINT_BULK_WORDS 16
+
 /* Returns either small integer, bignum, or #f.
    initval may be a Scheme integer that will be 'concatenated' before
    the integer to be read; it is used to read floating-point number.
@@ -4403,6 +4797,8 @@ static ScmObj read_uint(const char **strp, int *lenp,
     u_long limit = longlimit[radix-SCM_RADIX_MIN], bdig = bigdig[radix-SCM_RADIX_MIN];
     u_long value_int = 0;
     ScmBignum *value_big = NULL;
+    char *bulk = NULL;          /* digit values to be converted at once */
+    int nbulk = 0;
     static const char tab[] = "0123456789abcdefghijklmnopqrstuvwxyz";
 
     if (!SCM_FALSEP(initval)) {
@@ -4457,6 +4853,10 @@ static ScmObj read_uint(const char **strp, int *lenp,
         }
         if (digval < 0) break;
         underscore_read = FALSE;
+        if (bulk) {
+            bulk[nbulk++] = (char)digval;
+            continue;
+        }
         value_int = value_int * radix + digval;
         digits++;
         if (value_big == NULL) {
@@ -4467,6 +4867,9 @@ static ScmObj read_uint(const char **strp, int *lenp,
         } else if (digits > diglimit) {
             value_big = Scm_BignumAccMultAddUI(value_big, bdig, value_int);
             value_int = digits = 0;
+            if (SCM_BIGNUM_SIZE(value_big) >= READ_UINT_BULK_WORDS) {
+                bulk = SCM_NEW_ATOMIC2(char*, len);
+            }
         }
     }
     if (str == *strp && SCM_FALSEP(initval)) return SCM_FALSE;
@@ -4487,6 +4890,13 @@ static ScmObj read_uint(const char **strp, int *lenp,
                                            ipow(radix, digits),
                                            value_int);
     }
+    if (nbulk > 0) {
+        ScmObj hi = Scm_NormalizeBignum(SCM_BIGNUM(value_big));
+        ScmObj scale = Scm_ExactIntegerExpt(SCM_MAKE_INT(radix),
+                                            SCM_MAKE_INT(nbulk));
+        return Scm_Add(Scm_Mul(hi, scale),
+                       Scm_DigitsToBignum(bulk, nbulk, radix));
+    }
     return Scm_NormalizeBignum(SCM_BIGNUM(value_big));
 }
 
@@ -4603,6 +5013,116 @@ static double algorithmR(ScmObj f, int e, double z)
     /*NOTREACHED*/
 }
 
+/*
+ * Eisel-Lemire algorithm (Daniel Lemire, "Number Parsing at a Gigabyte
+ * per Second", Software: Practice and Experience 51(8), 2021).
+ * It computes the correctly rounded double of w * 10^q from a 128-bit
+ * truncated approximation of 5^q, without touching bignums.  In the rare
+ * cases where the truncation error may affect rounding, it gives up and
+ * read_real falls back to algorithmR.
+ */
+
+#define EL_MIN_EXP10  (-342)
+#define EL_MAX_EXP10  308
+
+/* 5^q normalized to 128 bits, truncated, for q >= 0; and 2^k/5^-q
+   rounded up then truncated to 128 bits, for q < 0.  Each entry is
+   {high, low} 64-bit words.  Calculated by eisel_lemire_init(), called
+   from Scm__InitNumber. */
+static uint64_t el_pow5[EL_MAX_EXP10 - EL_MIN_EXP10 + 1][2];
+
+static void el_split(ScmObj v, uint64_t *w)
+{
+    v = Scm_Ash(v, 128 - (long)Scm_IntegerLength(v));
+    w[1] = Scm_GetIntegerU64Clamp(Scm_LogAnd(v, SCM_2_64_MINUS_1),
+                                  SCM_CLAMP_NONE, NULL);
+    w[0] = Scm_GetIntegerU64Clamp(Scm_Ash(v, -64), SCM_CLAMP_NONE, NULL);
+}
+
+static void eisel_lemire_init(void)
+{
+    ScmObj p5 = SCM_MAKE_INT(1);
+    for (int q = 0; q <= EL_MAX_EXP10; q++) {
+        el_split(p5, el_pow5[q - EL_MIN_EXP10]);
+        p5 = Scm_Mul(p5, SCM_MAKE_INT(5));
+    }
+    p5 = SCM_MAKE_INT(5);
+    for (int q = -1; q >= EL_MIN_EXP10; q--) {
+        /* For small |q|, 2^(z+127)/5^-q already has 128 bits. */
+        long z = Scm_IntegerLength(p5);
+        long b = (q >= -27)? z + 127 : 2*z + 128;
+        ScmObj k = Scm_Ash(SCM_MAKE_INT(1), b);
+        el_split(Scm_Add(Scm_Quotient(k, p5, NULL), SCM_MAKE_INT(1)),
+                 el_pow5[q - EL_MIN_EXP10]);
+        p5 = Scm_Mul(p5, SCM_MAKE_INT(5));
+    }
+}
+
+/* If the double closest to W * 10^Q can be determined, stores it in *R
+   and returns TRUE.  W must be nonzero. */
+static int eisel_lemire(uint64_t w, int q, double *r)
+{
+    if (q < EL_MIN_EXP10 || q > EL_MAX_EXP10) return FALSE;
+
+    int lz = 0;
+    while (!(w & ((uint64_t)1 << 63))) { w <<= 1; lz++; }
+
+    /* Product of w and 5^q.  We need 55 significant bits of the high
+       word; look at the second word of 5^q only when the lower bits of
+       the high word are all ones, i.e. a carry might propagate. */
+    const uint64_t *p5 = el_pow5[q - EL_MIN_EXP10];
+    uint64_t lo, hi = umul64(w, p5[0], &lo);
+    const uint64_t mask = ((uint64_t)1 << 9) - 1;
+    if ((hi & mask) == mask) {
+        uint64_t lo2, hi2 = umul64(w, p5[1], &lo2);
+        (void)lo2;
+        lo += hi2;
+        if (lo < hi2) hi++;
+        /* The product may still be off by the truncation error of 5^q.
+           Outside of the range where 5^q is exact in 128 bits, we
+           can't tell which way to round. */
+        if (lo == ~(uint64_t)0 && (q < -27 || q > 55)) return FALSE;
+    }
+
+    int upperbit = (int)(hi >> 63);
+    int shift = upperbit + 64 - 52 - 3;
+    uint64_t mant = hi >> shift;
+    /* floor(log2(10^q)) + 63 + upperbit - lz, plus exponent bias */
+    int power2 = (int)(((152170 + 65536) * q) >> 16) + 63
+        + upperbit - lz + 1023;
+
+    if (power2 <= 0) {
+        /* Subnormal.  The truncation error can't affect the result here,
+           for we have more than enough precision. */
+        if (-power2 + 1 >= 64) { *r = 0.0; return TRUE; }
+        mant >>= -power2 + 1;
+        mant += (mant & 1);
+        mant >>= 1;
+        power2 = (mant < ((uint64_t)1 << 52))? 0 : 1;
+    } else {
+        /* We round up, except when we're right in the middle of two
+           doubles and the lower one is even.  Exact halfway can only
+           happen when 5^q is small enough. */
+        if (lo <= 1 && q >= -4 && q <= 23 && (mant & 3) == 1
+            && (mant << shift) == hi) {
+            mant &= ~(uint64_t)1;
+        }
+        mant += (mant & 1);
+        mant >>= 1;
+        if (mant >= ((uint64_t)2 << 52)) {
+            mant = (uint64_t)1 << 52;
+            power2++;
+        }
+        mant &= ~((uint64_t)1 << 52);
+        if (power2 >= 0x7ff) { *r = SCM_DBL_POSITIVE_INFINITY; return TRUE; }
+    }
+
+    union { double d; uint64_t i; } u;
+    u.i = mant | ((uint64_t)power2 << 52);
+    *r = u.d;
+    return TRUE;
+}
+
 /* When read_real encounters '#', this is called.
    START points to the beginning of digit sequence (after prefixes and sign),
    STRP is a reference to the pointer where a character after '#' resides,
@@ -4892,7 +5412,23 @@ static ScmObj read_real(const char **strp, int *lenp,
        AlgorithmR.  We have to be careful, however, not to overflow
        the following GetDouble call. */
     int raise_factor = exponent - fracdigs;
-    double realnum = Scm_GetDouble(fraction);
+    double realnum;
+
+    /* If fraction fits in 64 bits, try Eisel-Lemire first, unless
+       Clinger's fast path (exact double multiplication) applies. */
+    if ((SCM_INTP(fraction) && SCM_INT_VALUE(fraction) > 0)
+        || (SCM_BIGNUMP(fraction) && SCM_BIGNUM_SIZE(fraction) <= 64/SCM_WORD_BITS)) {
+        uint64_t w = Scm_GetIntegerU64Clamp(fraction, SCM_CLAMP_NONE, NULL);
+        if ((w > ((uint64_t)1 << 52)
+             || raise_factor > MAX_EXACT_10_EXP
+             || raise_factor < -MAX_EXACT_10_EXP)
+            && eisel_lemire(w, raise_factor, &realnum)) {
+            if (minusp) realnum = -realnum;
+            return Scm_MakeFlonum(realnum);
+        }
+    }
+
+    realnum = Scm_GetDouble(fraction);
 
     if (SCM_IS_INF(realnum)) {
         /* We have too many digits to fit in double.  We can still get finite
@@ -5139,6 +5675,8 @@ void Scm__InitNumber(void)
 {
     ScmModule *mod = Scm_GaucheModule();
 
+    Scm__InitBignum();
+
     for (int radix = SCM_RADIX_MIN; radix <= SCM_RADIX_MAX; radix++) {
         longlimit[radix-SCM_RADIX_MIN] =
             (u_long)floor((double)LONG_MAX/radix - radix);
@@ -5190,6 +5728,9 @@ void Scm__InitNumber(void)
     dexpt2_minus_52 = ldexp(1.0, -52);
     dexpt2_minus_53 = ldexp(1.0, -53);
 
+    ryu_init();                 /* needs SCM_2_64_MINUS_1 */
+    eisel_lemire_init();        /* ditto */
+
     Scm_InitBuiltinGeneric(&generic_add, "object-+", mod);
     Scm_InitBuiltinGeneric(&generic_sub, "object--", mod);
     Scm_InitBuiltinGeneric(&generic_mul, "object-*", mod);
@@ -548,6 +548,48 @@ void Scm_SetPortCaseFolding(ScmPort *port, int folding)
     }
 }
 
+/* Thread confinement.
+   A confined port is permanently locked by its owner thread, so that
+   port operations from the owner always take the SHORTCUT path in
+   portapi.c and never touch the fastlock.  Operations from other
+   threads raise an error in PORT_LOCK (see portP.h).
+   To hand a port to another thread, the owner must release it first. */
+ScmVM *Scm_PortConfinedThread(ScmPort *port)
+{
+    if (SCM_PORT_FLAGS(port) & SCM_PORT_PRIVATE) {
+        return P_(port)->lockOwner;
+    }
+    return NULL;
+}
+
+void Scm_SetPortConfined(ScmPort *port, int flag)
+{
+    ScmVM *vm = Scm_VM();
+    if (flag) {
+        if (SCM_PORT_FLAGS(port) & SCM_PORT_PRIVATE) {
+            if (!PORT_LOCKED(port, vm)) Scm__PortConfinementViolation(port);
+            return;
+        }
+        /* Wait for other threads to release the port; then we keep
+           the lock until the confinement is released. */
+        PORT_LOCK(port, vm);
+        SCM_PORT_FLAGS(port) |= SCM_PORT_PRIVATE;
+    } else {
+        if (!(SCM_PORT_FLAGS(port) & SCM_PORT_PRIVATE)) return;
+        if (!PORT_LOCKED(port, vm)) Scm__PortConfinementViolation(port);
+        SCM_PORT_FLAGS(port) &= ~SCM_PORT_PRIVATE;
+        PORT_UNLOCK(port);
+    }
+}
+
+void Scm__PortConfinementViolation(ScmPort *port)
+{
+    ScmVM *owner = P_(port)->lockOwner;
+    Scm_PortError(port, SCM_PORT_ERROR_OTHER,
+                  "port %S is confined to thread %S",
+                  port, (owner ? SCM_OBJ(owner) : SCM_FALSE));
+}
+
 /* Port's reader lexical mode is set at port creation, taken from
    readerLexicalMode parameter.  It may be altered by reader directive
    such as #!r7rs.
@@ -926,15 +926,67 @@ ScmSize Scm_GetzUnsafe(char *buf, ScmSize buflen, ScmPort *p)
 
 /* Auxiliary procedures */
 
-/* NB: it may be further optimized by scanning the contents of buffer
-   when the port is a buffered port or an input string, which allows
-   us to avoid mb->wc->mb conversion.   See port.c, v 1.69 for some
-   attempt to do so.  The problem there is that if I have to take
-   into account the cases of the ungotten char and the scratch buffer,
-   code becomes ugly.  There might be some better approach. */
-
 #ifndef READLINE_AUX
 #define READLINE_AUX
+
+/* If the port is a buffered port or an input string, and there's no
+   pushed-back stuff (ungotten char or scratch bytes), we can look at
+   the buffered bytes directly, avoiding per-byte Getb overhead.
+   Returns TRUE and sets *start and *end to the available bytes if so.
+   The caller must hold the lock of the input port P, and advance the
+   input position by Scm__PortConsumeBuffered().  Consumed bytes aren't
+   counted for the line number; if they contain newlines, the caller
+   has to adjust it by Scm__PortAddLines().
+   These are also used by extensions that parse directly from the buffer
+   (e.g. rfc.json). */
+int Scm__PortPeekBuffered(ScmPort *p, const char **start, const char **end)
+{
+    if (SCM_PORT_CLOSED_P(p)) return FALSE; /* let Getb raise an error */
+    if (p->scrcnt > 0 || PORT_UNGOTTEN(p) != SCM_CHAR_INVALID) return FALSE;
+    switch (SCM_PORT_TYPE(p)) {
+    case SCM_PORT_FILE:
+        *start = PORT_BUF(p)->current;
+        *end   = PORT_BUF(p)->end;
+        return (*start < *end);
+    case SCM_PORT_ISTR:
+        *start = PORT_ISTR(p)->current;
+        *end   = PORT_ISTR(p)->end;
+        return (*start < *end);
+    default:
+        return FALSE;
+    }
+}
+
+void Scm__PortConsumeBuffered(ScmPort *p, ScmSize nbytes)
+{
+    if (SCM_PORT_TYPE(p) == SCM_PORT_FILE) {
+        PORT_BUF(p)->current += nbytes;
+    } else {
+        PORT_ISTR(p)->current += nbytes;
+    }
+    PORT_BYTES(p) += nbytes;
+}
+
+/* For the callers of Scm__PortConsumeBuffered that consumed NLINES
+   newlines. */
+void Scm__PortAddLines(ScmPort *p, ScmSize nlines)
+{
+    if (nlines > 0) {
+        PORT_LINE(p) += nlines;
+        reset_linked_column(p);
+    }
+}
+
+/* Returns a pointer to the first EOL byte ('\n' or '\r') within [s, e),
+   or NULL if there's none.  We leave the scanning to memchr, which is
+   usually vectorized by libc. */
+static const char *scan_eol(const char *s, const char *e)
+{
+    const char *nl = memchr(s, '\n', e - s);
+    const char *cr = memchr(s, '\r', (nl ? nl : e) - s);
+    return cr ? cr : nl;
+}
+
 /* Assumes the port is locked, and the caller takes care of unlocking
    even if an error is signalled within this body */
 /* NB: this routine reads bytes, not chars.  It allows to readline
@@ -943,24 +995,88 @@ ScmSize Scm_GetzUnsafe(char *buf, ScmSize buflen, ScmPort *p)
 ScmObj readline_body(ScmPort *p)
 {
     ScmDString ds;
+    int nread = FALSE;
+    int b1;
 
     Scm_DStringInit(&ds);
-    int b1 = Scm_GetbUnsafe(p);
-    if (b1 == EOF) return SCM_EOF;
     for (;;) {
-        if (b1 == EOF) return Scm_DStringGet(&ds, 0);
-        if (b1 == '\n') break;
+        /* Copy the bytes up to EOL in the buffer at once.  The EOL byte
+           itself, as well as the bytes beyond the buffer, is handled
+           by Getb. */
+        const char *start, *end;
+        if (Scm__PortPeekBuffered(p, &start, &end)) {
+            const char *eol = scan_eol(start, end);
+            ScmSize len = (eol ? eol : end) - start;
+            if (len > 0) {
+                Scm_DStringPutz(&ds, start, len);
+                Scm__PortConsumeBuffered(p, len);
+                nread = TRUE;
+            }
+        }
+        b1 = Scm_GetbUnsafe(p);
+        if (b1 == EOF) {
+            if (!nread) return SCM_EOF;
+            return Scm_DStringGet(&ds, 0);
+        }
+        nread = TRUE;
+        if (b1 == '\n') break;  /* Getb has counted the line */
         if (b1 == '\r') {
             int b2 = Scm_GetbUnsafe(p);
-            if (b2 == EOF || b2 == '\n') break;
-            Scm_UngetbUnsafe(b2, p);
+            if (b2 == '\n') break;
+            if (b2 != EOF) Scm_UngetbUnsafe(b2, p);
+            PORT_LINE(p)++;
+            reset_linked_column(p);
             break;
         }
         SCM_DSTRING_PUTB(&ds, b1);
-        b1 = Scm_GetbUnsafe(p);
     }
-    PORT_LINE(p)++;
-    reset_linked_column(p);
+    return Scm_DStringGet(&ds, 0);
+}
+
+/* Read up to N characters.  Like readline_body, we take complete
+   characters directly from the buffer; a character that straddles
+   the buffer boundary or an invalid byte sequence is left to Getc. */
+static ScmObj readstring_body(ScmPort *p, ScmSize n)
+{
+    ScmDString ds;
+    ScmSize i = 0;
+
+    Scm_DStringInit(&ds);
+    while (i < n) {
+        const char *start, *end;
+        if (Scm__PortPeekBuffered(p, &start, &end)) {
+            const char *s = start;
+            while (i < n && s < end) {
+                unsigned char b = (unsigned char)*s;
+                if (b < 0x80) {
+                    if (b == '\n') {
+                        PORT_LINE(p)++;
+                        reset_linked_column(p);
+                    }
+                    s++; i++;
+                    continue;
+                }
+                int nf = SCM_CHAR_NFOLLOWS(b);
+                if (nf <= 0 || s + nf >= end) break;
+                ScmChar ch;
+                SCM_CHAR_GET(s, ch);
+                if (ch == SCM_CHAR_INVALID) break;
+                s += nf + 1; i++;
+            }
+            if (s > start) {
+                Scm_DStringPutz(&ds, start, s - start);
+                Scm__PortConsumeBuffered(p, s - start);
+            }
+            if (i >= n) break;
+        }
+        int c = Scm_GetcUnsafe(p);
+        if (c == EOF) {
+            if (i == 0) return SCM_EOF;
+            break;
+        }
+        Scm_DStringPutc(&ds, c);
+        i++;
+    }
     return Scm_DStringGet(&ds, 0);
 }
 #endif /* READLINE_AUX */
@@ -982,6 +1098,28 @@ ScmObj Scm_ReadLineUnsafe(ScmPort *p)
     return r;
 }
 
+/*=================================================================
+ * ReadString
+ *   Reads up to N characters or EOF.
+ */
+
+#ifdef SAFE_PORT_OP
+ScmObj Scm_ReadString(ScmPort *p, ScmSize n)
+#else
+ScmObj Scm_ReadStringUnsafe(ScmPort *p, ScmSize n)
+#endif
+{
+    ScmObj r = SCM_UNDEFINED;
+    VMDECL;
+    SHORTCUT(p, return Scm_ReadStringUnsafe(p, n));
+
+    LOCK(p);
+    flush_linked_port(p);
+    SAFE_CALL(p, r = readstring_body(p, n));
+    UNLOCK(p);
+    return r;
+}
+
 /*=================================================================
  * ByteReady
  */
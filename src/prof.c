@@ -39,6 +39,10 @@
 #include "gauche/vminsn.h"
 #include "gauche/prof.h"
 
+/* The number of threads running the allocation profiler.  Referenced
+   from SCM_MALLOC and SCM_MALLOC_ATOMIC (see gauche.h). */
+int Scm__AllocProfilerActive = 0;
+
 #ifdef GAUCHE_PROFILE
 
 /* WARNING: duplicated code - see signal.c; we should integrate them later */
@@ -289,40 +293,248 @@ void Scm_ProfilerCountBufferFlush(ScmVM *vm)
 #endif /* !GAUCHE_WINDOWS */
 }
 
+/*=============================================================
+ * Allocation profiler
+ */
+
+/* The allocation profiler runs independently from the time profiler.
+ * While it is running on a thread, SCM_MALLOC and SCM_MALLOC_ATOMIC
+ * call Scm__ProfMalloc, which takes a sample every allocInterval
+ * allocations (or every allocInterval bytes, if allocByBytes is TRUE).
+ *
+ * A sample is attributed to the current code base and PC of the VM,
+ * that is, the instruction that allocated, or that called the subr
+ * that allocated.  We also record the code bases found in the
+ * continuation frames, up to SCM_PROF_ALLOC_STACK_DEPTH, for the stack
+ * (flamegraph) report.
+ *
+ * The allocator doesn't know what it is allocating.  However, most
+ * constructors set the class tag by SCM_SET_CLASS immediately after
+ * allocation, so we remember the last sampled block and let
+ * Scm__ProfSetClass fill the class of the sample.  Pairs don't have
+ * a class tag; we count a non-atomic block of the size of ScmPair as
+ * a pair.  Other blocks are reported as 'block or 'atomic-block.
+ *
+ * The samples are collected into allocHash when the buffer gets full.
+ * The allocation done during collection isn't sampled.
+ */
+
+static ScmInternalMutex alloc_prof_mutex = SCM_INTERNAL_MUTEX_INITIALIZER;
+static ScmObj sym_block = SCM_UNBOUND;        /* 'block */
+static ScmObj sym_atomic_block = SCM_UNBOUND; /* 'atomic-block */
+
+static void alloc_collect(ScmVMProfiler *prof);
+
+static void alloc_prof_activate(ScmVMProfiler *prof)
+{
+    SCM_INTERNAL_MUTEX_LOCK(alloc_prof_mutex);
+    prof->allocState = SCM_PROFILER_RUNNING;
+    Scm__AllocProfilerActive++;
+    SCM_INTERNAL_MUTEX_UNLOCK(alloc_prof_mutex);
+}
+
+/* Returns TRUE if the profiler was running.  The running thread and
+   the one terminating it may call this concurrently; see
+   Scm__AllocProfilerCleanupVM. */
+static int alloc_prof_deactivate(ScmVMProfiler *prof)
+{
+    int r = FALSE;
+    SCM_INTERNAL_MUTEX_LOCK(alloc_prof_mutex);
+    if (prof->allocState == SCM_PROFILER_RUNNING) {
+        prof->allocState = SCM_PROFILER_PAUSING;
+        Scm__AllocProfilerActive--;
+        r = TRUE;
+    }
+    SCM_INTERNAL_MUTEX_UNLOCK(alloc_prof_mutex);
+    return r;
+}
+
+void *Scm__ProfMalloc(size_t size, int atomic)
+{
+    void *p = atomic? GC_MALLOC_ATOMIC(size) : GC_MALLOC(size);
+    ScmVM *vm = Scm_VM();
+    if (vm == NULL || vm->prof == NULL) return p;
+
+    /* A thread created while the profiler is running shares vm->prof
+       with its creator (see Scm_NewVM); only the VM that started the
+       allocation profiler records samples. */
+    ScmVMProfiler *prof = vm->prof;
+    if (prof->allocState != SCM_PROFILER_RUNNING) return p;
+    if (prof->allocVM != vm) return p;
+    if (prof->allocFlushing) return p;
+
+    prof->allocTotalCount++;
+    prof->allocTotalBytes += size;
+    prof->allocCountdown -= (prof->allocByBytes? (long)size : 1);
+    if (prof->allocCountdown > 0) return p;
+    prof->allocCountdown = prof->allocInterval;
+
+    if (prof->currentAllocSample >= SCM_PROF_ALLOC_SAMPLES_IN_BUFFER) {
+        alloc_collect(prof);
+    }
+
+    int i = prof->currentAllocSample++;
+    ScmProfAllocSample *s = &prof->allocSamples[i];
+    if (vm->base) {
+        s->func = SCM_OBJ(vm->base);
+        s->pc = vm->pc;
+    } else {
+        s->func = SCM_FALSE;
+        s->pc = NULL;
+    }
+    s->klass = NULL;
+    s->size = size;
+    s->atomic = atomic;
+
+    /* If we're in a subr called from the current code, the topmost
+       frame is the one pushed for that call; skip it. */
+    ScmContFrame *c = vm->cont;
+    if (c && c->base == vm->base && c->pc == vm->pc) c = c->prev;
+    int depth = 0;
+    for (; c && depth < SCM_PROF_ALLOC_STACK_DEPTH; c = c->prev) {
+        if (c->base) s->callers[depth++] = c->base;
+    }
+    s->depth = depth;
+
+    prof->allocPending = p;
+    prof->allocPendingIndex = i;
+    prof->allocTotalSamples++;
+    return p;
+}
+
+void Scm__ProfSetClass(void *obj, ScmClass *klass)
+{
+    ScmVM *vm = Scm_VM();
+    if (vm == NULL || vm->prof == NULL) return;
+    if (vm->prof->allocVM != vm) return;
+    if (vm->prof->allocPending != obj) return;
+    vm->prof->allocSamples[vm->prof->allocPendingIndex].klass = klass;
+    vm->prof->allocPending = NULL;
+}
+
+static ScmObj alloc_sample_class(ScmProfAllocSample *s)
+{
+    if (s->klass) return SCM_OBJ(s->klass);
+    if (s->atomic) return sym_atomic_block;
+    if (s->size == sizeof(ScmPair)) return SCM_OBJ(SCM_CLASS_PAIR);
+    return sym_block;
+}
+
+static int alloc_callers_match(ScmObj callers, ScmProfAllocSample *s)
+{
+    for (int i=0; i<s->depth; i++, callers = SCM_CDR(callers)) {
+        if (!SCM_PAIRP(callers)) return FALSE;
+        if (!SCM_EQ(SCM_CAR(callers), SCM_OBJ(s->callers[i]))) return FALSE;
+    }
+    return SCM_NULLP(callers);
+}
+
+/* Register alloc samples into allocHash.  It is keyed by the code base
+   (or #f), and the value is a list of vectors:
+
+     #(<pc-offset> <class> <callers> <count> <bytes>)
+
+   <pc-offset> is the offset of PC in the code vector, or #f.  <class>
+   is a class, or a symbol block or atomic-block.  <callers> is a list
+   of code bases in the continuation frames, innermost first.
+   Keep this in sync with lib/gauche/vm/profiler.scm. */
+static void alloc_collect(ScmVMProfiler *prof)
+{
+    if (prof->allocSamples == NULL) return;
+
+    prof->allocFlushing = TRUE;
+    for (int i=0; i<prof->currentAllocSample; i++) {
+        ScmProfAllocSample *s = &prof->allocSamples[i];
+        ScmObj off = SCM_FALSE;
+        if (s->pc && SCM_COMPILED_CODE_P(s->func)) {
+            off = SCM_MAKE_INT(s->pc - SCM_COMPILED_CODE(s->func)->code);
+        }
+        ScmObj klass = alloc_sample_class(s);
+        ScmObj entries = Scm_HashTableRef(prof->allocHash, s->func, SCM_NIL);
+        ScmObj e = SCM_FALSE, cp;
+        SCM_FOR_EACH(cp, entries) {
+            ScmObj v = SCM_CAR(cp);
+            if (SCM_EQ(SCM_VECTOR_ELEMENT(v, 0), off)
+                && SCM_EQ(SCM_VECTOR_ELEMENT(v, 1), klass)
+                && alloc_callers_match(SCM_VECTOR_ELEMENT(v, 2), s)) {
+                e = v;
+                break;
+            }
+        }
+        if (SCM_FALSEP(e)) {
+            ScmObj callers = SCM_NIL;
+            for (int j=s->depth-1; j>=0; j--) {
+                callers = Scm_Cons(SCM_OBJ(s->callers[j]), callers);
+            }
+            e = Scm_MakeVector(5, SCM_MAKE_INT(0));
+            SCM_VECTOR_ELEMENT(e, 0) = off;
+            SCM_VECTOR_ELEMENT(e, 1) = klass;
+            SCM_VECTOR_ELEMENT(e, 2) = callers;
+            Scm_HashTableSet(prof->allocHash, s->func,
+                             Scm_Cons(e, entries), 0);
+        }
+        SCM_VECTOR_ELEMENT(e, 3) =
+            Scm_Add(SCM_VECTOR_ELEMENT(e, 3), SCM_MAKE_INT(1));
+        SCM_VECTOR_ELEMENT(e, 4) =
+            Scm_Add(SCM_VECTOR_ELEMENT(e, 4), Scm_MakeIntegerU(s->size));
+    }
+    prof->currentAllocSample = 0;
+    prof->allocPending = NULL;
+    prof->allocFlushing = FALSE;
+}
+
 /*=============================================================
  * External API
  */
+
+static ScmVMProfiler *make_profiler(void)
+{
+    ScmVMProfiler *prof = SCM_NEW(ScmVMProfiler);
+    prof->state = SCM_PROFILER_INACTIVE;
+    prof->samplerFd = -1;
+    prof->currentSample = 0;
+    prof->totalSamples = 0;
+    prof->errorOccurred = 0;
+    prof->currentCount = 0;
+    prof->statHash =
+        SCM_HASH_TABLE(Scm_MakeHashTableSimple(SCM_HASH_EQ, 0));
+    prof->allocState = SCM_PROFILER_INACTIVE;
+    prof->allocFlushing = FALSE;
+    prof->allocByBytes = FALSE;
+    prof->allocInterval = 0;
+    prof->allocCountdown = 0;
+    prof->currentAllocSample = 0;
+    prof->allocPending = NULL;
+    prof->allocPendingIndex = 0;
+    prof->allocTotalSamples = 0;
+    prof->allocTotalCount = 0;
+    prof->allocTotalBytes = 0;
+    prof->allocHash = NULL;
+    prof->allocSamples = NULL;
+    prof->allocVM = NULL;
+#if defined(GAUCHE_WINDOWS)
+    prof->hTargetThread = NULL;
+    prof->hObserverThread = NULL;
+    prof->hTimerEvent = NULL;
+    prof->samplerFileName = NULL;
+#endif /* GAUCHE_WINDOWS */
+    return prof;
+}
+
 void Scm_ProfilerStart(void)
 {
     ScmVM *vm = Scm_VM();
-    ScmObj templat = Scm_StringAppendC(SCM_STRING(Scm_TmpDir()),
-                                       "/gauche-profXXXXXX", -1, -1);
-    char *templat_buf = Scm_GetString(SCM_STRING(templat)); /*mutable copy*/
 
-    if (!vm->prof) {
-        vm->prof = SCM_NEW(ScmVMProfiler);
-        vm->prof->state = SCM_PROFILER_INACTIVE;
+    if (!vm->prof) vm->prof = make_profiler();
+    if (vm->prof->samplerFd < 0) {
+        ScmObj templat = Scm_StringAppendC(SCM_STRING(Scm_TmpDir()),
+                                           "/gauche-profXXXXXX", -1, -1);
+        char *templat_buf = Scm_GetString(SCM_STRING(templat)); /*mutable copy*/
         vm->prof->samplerFd = Scm_Mkstemp(templat_buf);
-        vm->prof->currentSample = 0;
-        vm->prof->totalSamples = 0;
-        vm->prof->errorOccurred = 0;
-        vm->prof->currentCount = 0;
-        vm->prof->statHash =
-            SCM_HASH_TABLE(Scm_MakeHashTableSimple(SCM_HASH_EQ, 0));
 #if defined(GAUCHE_WINDOWS)
-        vm->prof->hTargetThread = NULL;
-        vm->prof->hObserverThread = NULL;
-        vm->prof->hTimerEvent = NULL;
         vm->prof->samplerFileName = templat_buf;
 #else  /* !GAUCHE_WINDOWS */
         unlink(templat_buf);       /* keep anonymous tmpfile */
-#endif /* !GAUCHE_WINDOWS */
-    } else if (vm->prof->samplerFd < 0) {
-        vm->prof->samplerFd = Scm_Mkstemp(templat_buf);
-#if defined(GAUCHE_WINDOWS)
-        vm->prof->samplerFileName = templat_buf;
-#else  /* !GAUCHE_WINDOWS */
-        unlink(templat_buf);
 #endif /* !GAUCHE_WINDOWS */
     }
 
@@ -442,7 +654,133 @@ ScmObj Scm_ProfilerRawResult(void)
     return SCM_OBJ(vm->prof->statHash);
 }
 
+void Scm_AllocProfilerStart(long interval, int byBytes)
+{
+    ScmVM *vm = Scm_VM();
+
+    if (interval <= 0) {
+        Scm_Error("allocation profiler: sampling interval must be "
+                  "a positive integer, but got %ld", interval);
+    }
+    if (!vm->prof) vm->prof = make_profiler();
+
+    ScmVMProfiler *prof = vm->prof;
+    ScmVM *owner;
+    SCM_INTERNAL_MUTEX_LOCK(alloc_prof_mutex);
+    if (prof->allocVM == NULL) prof->allocVM = vm;
+    owner = prof->allocVM;
+    SCM_INTERNAL_MUTEX_UNLOCK(alloc_prof_mutex);
+    if (owner != vm) {
+        /* VM shares the profiler with the thread that created it, which
+           owns the allocation profiler.  Unless the shared profiler is
+           running the sampler, we can just have our own. */
+        if (vm->profilerRunning) {
+            Scm_Error("allocation profiler is used by another thread: %S",
+                      SCM_OBJ(owner));
+        }
+        vm->prof = prof = make_profiler();
+        prof->allocVM = vm;
+    }
+    if (prof->allocState == SCM_PROFILER_RUNNING) return;
+    if (prof->allocSamples == NULL) {
+        prof->allocSamples =
+            SCM_NEW_ARRAY(ScmProfAllocSample,
+                          SCM_PROF_ALLOC_SAMPLES_IN_BUFFER);
+    }
+    if (prof->allocHash == NULL) {
+        prof->allocHash =
+            SCM_HASH_TABLE(Scm_MakeHashTableSimple(SCM_HASH_EQ, 0));
+    }
+    prof->allocInterval = interval;
+    prof->allocByBytes = byBytes;
+    prof->allocCountdown = interval;
+    alloc_prof_activate(prof);
+}
+
+/* Returns the allocation profiler of VM, or NULL if VM hasn't started
+   one.  A thread created while profiling shares vm->prof with its
+   creator (see Scm_NewVM), but the allocation profiler belongs to the
+   VM that started it; other threads shouldn't touch the sample buffer
+   it is writing. */
+static ScmVMProfiler *alloc_profiler(ScmVM *vm)
+{
+    if (vm->prof == NULL || vm->prof->allocVM != vm) return NULL;
+    return vm->prof;
+}
+
+int Scm_AllocProfilerStop(void)
+{
+    ScmVMProfiler *prof = alloc_profiler(Scm_VM());
+    if (prof == NULL) return 0;
+    if (!alloc_prof_deactivate(prof)) return 0;
+    alloc_collect(prof);
+    return prof->allocTotalSamples;
+}
+
+void Scm_AllocProfilerReset(void)
+{
+    ScmVMProfiler *prof = alloc_profiler(Scm_VM());
+
+    if (prof == NULL) return;
+    if (prof->allocState == SCM_PROFILER_INACTIVE) return;
+    if (prof->allocState == SCM_PROFILER_RUNNING) Scm_AllocProfilerStop();
+
+    prof->currentAllocSample = 0;
+    prof->allocPending = NULL;
+    prof->allocTotalSamples = 0;
+    prof->allocTotalCount = 0;
+    prof->allocTotalBytes = 0;
+    prof->allocHash =
+        SCM_HASH_TABLE(Scm_MakeHashTableSimple(SCM_HASH_EQ, 0));
+    prof->allocState = SCM_PROFILER_INACTIVE;
+}
+
+/* Returns (<allocHash> <total-count> <total-bytes>).
+   See alloc_collect() for the content of allocHash. */
+ScmObj Scm_AllocProfilerRawResult(void)
+{
+    ScmVMProfiler *prof = alloc_profiler(Scm_VM());
+
+    if (prof == NULL) return SCM_FALSE;
+    if (prof->allocState == SCM_PROFILER_INACTIVE) return SCM_FALSE;
+    if (prof->allocState == SCM_PROFILER_RUNNING) Scm_AllocProfilerStop();
+
+    return SCM_LIST3(SCM_OBJ(prof->allocHash),
+                     Scm_MakeIntegerU(prof->allocTotalCount),
+                     Scm_MakeIntegerU(prof->allocTotalBytes));
+}
+
+/* Called when the thread running VM terminates.  If the thread
+   leaves the allocation profiler running, we stop it so that
+   Scm__AllocProfilerActive is kept balanced.  The profiler is released
+   so that other threads sharing it can start it again. */
+void Scm__AllocProfilerCleanupVM(ScmVM *vm)
+{
+    ScmVMProfiler *prof = alloc_profiler(vm);
+    if (prof == NULL) return;
+    (void)alloc_prof_deactivate(prof);
+    SCM_INTERNAL_MUTEX_LOCK(alloc_prof_mutex);
+    prof->allocVM = NULL;
+    SCM_INTERNAL_MUTEX_UNLOCK(alloc_prof_mutex);
+}
+
+void Scm__InitProf(void)
+{
+    SCM_INTERNAL_MUTEX_INIT(alloc_prof_mutex);
+    sym_block = SCM_INTERN("block");
+    sym_atomic_block = SCM_INTERN("atomic-block");
+}
+
 #else  /* !GAUCHE_PROFILE */
+void *Scm__ProfMalloc(size_t size, int atomic)
+{
+    return atomic? GC_MALLOC_ATOMIC(size) : GC_MALLOC(size);
+}
+
+void Scm__ProfSetClass(void *obj SCM_UNUSED, ScmClass *klass SCM_UNUSED)
+{
+}
+
 void Scm_ProfilerStart(void)
 {
     Scm_Error("profiler is not supported.");
@@ -464,4 +802,34 @@ ScmObj Scm_ProfilerRawResult(void)
     Scm_Error("profiler is not supported.");
     return SCM_FALSE;
 }
+
+void Scm_AllocProfilerStart(long interval SCM_UNUSED, int byBytes SCM_UNUSED)
+{
+    Scm_Error("profiler is not supported.");
+}
+
+int Scm_AllocProfilerStop(void)
+{
+    Scm_Error("profiler is not supported.");
+    return 0;
+}
+
+void Scm_AllocProfilerReset(void)
+{
+    Scm_Error("profiler is not supported.");
+}
+
+ScmObj Scm_AllocProfilerRawResult(void)
+{
+    Scm_Error("profiler is not supported.");
+    return SCM_FALSE;
+}
+
+void Scm__AllocProfilerCleanupVM(ScmVM *vm SCM_UNUSED)
+{
+}
+
+void Scm__InitProf(void)
+{
+}
 #endif /* !GAUCHE_PROFILE */
@@ -37,6 +37,7 @@
 #include "gauche/vm.h"
 #include "gauche/exception.h"
 #include "gauche/priv/vmP.h"
+#include "gauche/prof.h"
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -73,6 +74,7 @@ static void thread_cleanup_inner(ScmVM *vm)
     /* Change this VM state to TERMINATED, and signals the change
        to the waiting threads. */
     vm->state = SCM_VM_TERMINATED;
+    Scm__AllocProfilerCleanupVM(vm);
     if (vm->canceller) {
         /* This thread is cancelled. */
         ScmObj e = Scm_MakeThreadException(
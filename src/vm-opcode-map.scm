@@ -241,3 +241,26 @@
 (XLSET . 237)
 (EXTEND-DENV . 238)
 (TAIL-EXTEND-DENV . 239)
+(VEC-REF-NC . 240)
+(VEC-SET-NC . 241)
+(FXADDI . 242)
+(LREF0-FXADDI . 243)
+(LREF1-FXADDI . 244)
+(LREF2-FXADDI . 245)
+(LREF3-FXADDI . 246)
+(LREF10-FXADDI . 247)
+(LREF11-FXADDI . 248)
+(LREF12-FXADDI . 249)
+(LREF20-FXADDI . 250)
+(LREF21-FXADDI . 251)
+(LREF30-FXADDI . 252)
+(LREF0-FXADDI-PUSH . 253)
+(LREF1-FXADDI-PUSH . 254)
+(LREF2-FXADDI-PUSH . 255)
+(LREF3-FXADDI-PUSH . 256)
+(LREF10-FXADDI-PUSH . 257)
+(LREF11-FXADDI-PUSH . 258)
+(LREF12-FXADDI-PUSH . 259)
+(LREF20-FXADDI-PUSH . 260)
+(LREF21-FXADDI-PUSH . 261)
+(LREF30-FXADDI-PUSH . 262)
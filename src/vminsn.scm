@@ -1192,6 +1192,24 @@
       (set! (SCM_VECTOR_ELEMENT vec k) v)
       ($result SCM_UNDEFINED))))
 
+;; VEC-REF and VEC-SET without type and range checks.  The compiler
+;; emits them only when it has proven that the vector operand is a vector
+;; and the index is a fixnum within its range (see type/specialize-loops
+;; in compile-t.scm).  VEC-SET-NC still checks immutability.
+(define-insn VEC-REF-NC  0 none #f
+  ($w/argp vec
+    ($result (SCM_VECTOR_ELEMENT vec (SCM_INT_VALUE VAL0)))))
+
+(define-insn VEC-SET-NC  0 none #f
+  (let* ([vec] [ind] [v VAL0])
+    (POP-ARG ind)
+    (POP-ARG vec)
+    (when (SCM_VECTOR_IMMUTABLE_P vec)
+      ($vm-err "vector is immutable: %S" vec))
+    (SCM_FLONUM_ENSURE_MEM v)
+    (set! (SCM_VECTOR_ELEMENT vec (SCM_INT_VALUE ind)) v)
+    ($result SCM_UNDEFINED)))
+
 (define-insn UVEC-REF    1 none #f    ; uvector-ref
   (let* ([k VAL0]
          [utype::int (SCM_VM_INSN_ARG code)])
@@ -1322,6 +1340,16 @@
 (define-insn-lref+ LREF-NUMADDI 1 none (LREF NUMADDI))
 (define-insn-lref+ LREF-NUMADDI-PUSH 1 none (LREF NUMADDI PUSH))
 
+;; FXADDI(i)
+;;   Like NUMADDI, but the operand is known to be a fixnum by the compiler.
+;;   Only the overflow is checked.
+(define-insn FXADDI      1 none #f
+  ($w/argr arg
+    ($result:n (+ (SCM_INT_VALUE arg) (SCM_VM_INSN_ARG code)))))
+
+(define-insn-lref+ LREF-FXADDI 1 none (LREF FXADDI))
+(define-insn-lref+ LREF-FXADDI-PUSH 1 none (LREF FXADDI PUSH))
+
 (define-insn NUMSUBI     1 none #f      ; -, if one of op is small int
   (let* ([imm::long (SCM_VM_INSN_ARG code)])
     ($w/argr arg
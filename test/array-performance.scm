@@ -0,0 +1,55 @@
+;;
+;; Measure matrix operations on f64 and f32 arrays, with each variant
+;; of the native kernels, and in parallel.
+;;
+;;   gosh test/array-performance.scm [size]
+;;
+
+(use gauche.array)
+(use gauche.uvector)
+(use gauche.uvector.parallel)
+(use gauche.time)
+
+(define %uvector-kernels (with-module gauche.uvector %uvector-kernels))
+
+(define (random-array make n)
+  (rlet1 a (make (shape 0 n 0 n))
+    (array-for-each-index a
+      (^[i j] (array-set! a i j (/. (- (modulo (* (+ (* i n) j) 7919) 2001)
+                                       1000)
+                                    1000))))))
+
+(define (main args)
+  (define n (if (pair? (cdr args)) (x->integer (cadr args)) 1000))
+  (define variants
+    (delete-duplicates
+     (filter (^v (guard (e [else #f]) (%uvector-kernels v) #t))
+             `(generic avx2 ,(%uvector-kernels #t)))))
+  (define (run label flops thunk)
+    (dolist [v variants]
+      (%uvector-kernels v)
+      (let1 r (time-this 1 thunk)
+        (format #t "~22a ~8a ~8,3f sec (~,2f GFLOPS)\n" label v
+                (time-result-real r)
+                (/ flops (time-result-real r) 1e9)))))
+  (let ([a64 (random-array make-f64array n)]
+        [b64 (random-array make-f64array n)]
+        [a32 (random-array make-f32array n)]
+        [b32 (random-array make-f32array n)]
+        [x64 (make-f64vector n 1.0)]
+        [spd (array-add-elements
+              (let1 a (random-array make-f64array n)
+                (array-mul a (array-transpose a)))
+              (array-mul-elements (identity-array n <f64array>) n))])
+    (run "f64 mul" (* 2 n n n) (^[] (array-mul a64 b64)))
+    (run "f32 mul" (* 2 n n n) (^[] (array-mul a32 b32)))
+    (run "f64 mul parallel" (* 2 n n n) (^[] (parallel-array-mul a64 b64)))
+    (run "f32 mul parallel" (* 2 n n n) (^[] (parallel-array-mul a32 b32)))
+    (run "f64 transpose" (* n n) (^[] (array-transpose a64)))
+    (run "f64 array-vector-mul" (* 2 n n) (^[] (array-vector-mul a64 x64)))
+    (run "f64 determinant" (* 2/3 n n n) (^[] (determinant a64)))
+    (run "f64 lu" (* 2/3 n n n) (^[] (array-lu a64)))
+    (run "f64 inverse" (* 2 n n n) (^[] (array-inverse a64)))
+    (run "f64 cholesky" (* 1/3 n n n) (^[] (array-cholesky spd))))
+  (%uvector-kernels #t)
+  0)
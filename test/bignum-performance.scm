@@ -0,0 +1,66 @@
+;;
+;; Benchmark bignum multiplication, division and radix conversion.
+;; Use this to tune KARATSUBA_THRESHOLD, TOOM3_THRESHOLD, NTT_THRESHOLD
+;; and DIV_DC_THRESHOLD in src/bignum.c; the tables show the crossover
+;; points.
+;;
+;;   gosh test/bignum-performance.scm [max-words]
+;;
+
+(use gauche.time)
+(use srfi.27)
+
+(define %bignum-mul (with-module gauche.internal %bignum-mul))
+(define %bignum-div-rem (with-module gauche.internal %bignum-div-rem))
+
+(define *algorithms* '(schoolbook karatsuba toom3 ntt #f))
+
+;; Sizes are in words.
+(define *sizes* '(16 32 48 64 128 256 512 800 1024 2048 3000 4096
+                  8192 16384 65536 262144))
+
+(define (word-bits) (if (fixnum? (expt 2 40)) 64 32))
+
+;; Returns usec per call of thunk
+(define (bench thunk)
+  (let1 r (time-this '(cpu 1.0) thunk)
+    (* 1e6 (/ (time-result-user r) (~ r'count)))))
+
+(define (random-bignum words)
+  (+ (ash 1 (- (* words (word-bits)) 1))
+     (random-integer (ash 1 (- (* words (word-bits)) 1)))))
+
+(define (main args)
+  (define max-words (if (pair? (cdr args)) (x->integer (cadr args)) 65536))
+  (random-source-randomize! default-random-source)
+  (print "Multiplication (usec)")
+  (format #t "~8a~{~12@a~}\n" "words"
+          (map (^a (if a (symbol->string a) "auto")) *algorithms*))
+  (dolist [n (filter (cut <= <> max-words) *sizes*)]
+    (let ([x (random-bignum n)]
+          [y (random-bignum n)])
+      (format #t "~8d" n)
+      (dolist [algo *algorithms*]
+        (if (and (eq? algo 'schoolbook) (> n 16384))
+          (format #t "~12@a" "-")
+          (format #t "~12,1f" (bench (^[] (%bignum-mul x y algo)))))
+        (flush))
+      (newline)))
+  (newline)
+  (print "Division of 2n words by n words, and radix conversion (usec)")
+  (format #t "~8a~{~12@a~}\n" "n"
+          '("schoolbook" "auto" "->string" "string->"))
+  (dolist [n (filter (cut <= <> (quotient max-words 2)) *sizes*)]
+    (let* ([x (random-bignum (* n 2))]
+           [y (random-bignum n)]
+           [s (number->string x)])
+      (format #t "~8d" n)
+      (if (> n 16384)
+        (format #t "~12@a" "-")
+        (format #t "~12,1f" (bench (^[] (%bignum-div-rem x y 'schoolbook)))))
+      (format #t "~12,1f" (bench (^[] (%bignum-div-rem x y))))
+      (format #t "~12,1f" (bench (^[] (number->string x))))
+      (format #t "~12,1f" (bench (^[] (string->number s))))
+      (newline)
+      (flush)))
+  0)
@@ -102,6 +102,19 @@
                 (and (wait-all pool #f 1e7)
                      (map (cut job-result <>)
                           (queue->list (~ pool'result-queue))))))
+
+  ;; Jobs added by running jobs go to the worker's own deque, and
+  ;; are stolen by other workers.
+  (test* "nested jobs" '(#t 100)
+         (let1 count (atom 0)
+           (define (job n)
+             (^[]
+               (if (= n 1)
+                 (begin (sys-nanosleep 1e6) (atomic-update! count (cut + <> 1)))
+                 (begin (add-job! pool (job (quotient n 2)))
+                        (add-job! pool (job (- n (quotient n 2))))))))
+           (add-job! pool (job 100))
+           (list (wait-all pool #f 1e7) (atom-ref count))))
   )
 
 ;; Testing max backlog and timeout
@@ -291,6 +304,27 @@
              (append (pmap (cut * <> 2) (iota 100) :mapper mapper)
                      (pmap (cut * <> 3) (iota 100) :mapper mapper))
            (terminate-all! pool))))
+(test* "pmap (adaptive, cheap)"
+       (map (cut * <> 2) (iota 1000))
+       (pmap (cut * <> 2) (iota 1000) :mapper (make-adaptive-mapper)))
+(test* "pmap (adaptive, uneven)"
+       (map (^n (fold + 0 (iota (* (modulo n 7) 3000)))) (iota 200))
+       (pmap (^n (fold + 0 (iota (* (modulo n 7) 3000)))) (iota 200)
+             :mapper (make-adaptive-mapper 4)))
+(test* "pmap (adaptive, vector)"
+       (map (cut + <> 1) (iota 5000))
+       (pmap (cut + <> 1) (list->vector (iota 5000))
+             :mapper (make-adaptive-mapper 3)))
+(test* "pmap (adaptive, uvector)"
+       (map (cut * <> 3) (iota 5000))
+       (pmap (cut * <> 3) (list->u32vector (iota 5000))
+             :mapper (make-adaptive-mapper 3)))
+(test* "pmap (adaptive, empty)" '()
+       (pmap (cut * <> 3) '() :mapper (make-adaptive-mapper)))
+(test* "pmap (adaptive, error)" (test-error <error> "bang")
+       (pmap (^n (if (= n 3000) (error "bang") (fold + 0 (iota 100))))
+             (iota 5000)
+             :mapper (make-adaptive-mapper 4)))
 (test* "pmap (fully concurrent)"
        (map (cut * <> 2) (iota 25))
        (pmap (cut * <> 2) (iota 25) :mapper (make-fully-concurrent-mapper)))
@@ -322,6 +356,11 @@
                       42))
              (iota 20)
              :mapper (make-static-mapper)))
+(test* "pfind (adaptive)"
+       (find (cut = <> 4321) (iota 10000))
+       (pfind (cut = <> 4321) (iota 10000) :mapper (make-adaptive-mapper 4)))
+(test* "pany (adaptive)" #f
+       (pany (^x (and (< x 0) x)) (iota 10000) :mapper (make-adaptive-mapper 4)))
 (test* "pfind (pool)"
        (find (cut = <> 1) (iota 20))
        (pfind (^x (and (sys-sleep (quotient x 2))
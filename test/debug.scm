@@ -75,4 +75,71 @@
   (test-debug-info `(12345 123456789 123456789012345 ,@xs #0=(1234567) . #0#)
                    "big data"))
 
+(test-section "allocation profiler")
+
+(use gauche.vm.profiler)
+
+(define (alloc-vectors n)
+  (let loop ([i 0] [r '()])
+    (if (= i n)
+      (length r)
+      (loop (+ i 1) (cons (make-vector 3 i) r)))))
+
+(define (alloc-site? name)
+  (or (eq? name 'alloc-vectors)
+      (and (pair? name) (memq 'alloc-vectors name))))
+
+(test* "alloc-profiler-start/stop" #t
+       (begin
+         (alloc-profiler-reset)
+         (alloc-profiler-start :interval 1)
+         (alloc-vectors 1000)
+         (>= (alloc-profiler-stop) 2000)))
+
+(test* "alloc-profiler-get-result" '(#t #t)
+       (match (alloc-profiler-get-result)
+         [(total-count total-bytes . samples)
+          (let1 vecs (filter (match-lambda
+                               [(stack _ klass _ _)
+                                (and (eq? klass '<vector>)
+                                     (alloc-site? (last stack)))])
+                             samples)
+            (list (>= total-count 2000)
+                  (>= (fold (^[s n] (+ n (list-ref s 3))) 0 vecs) 1000)))]
+         [_ #f]))
+
+(test* "alloc-profiler-write-flamegraph" #t
+       (boolean
+        (any #/\;<vector> [0-9]+$/
+             (string-split (with-output-to-string
+                             (cut alloc-profiler-write-flamegraph
+                                  :weight 'count))
+                           #\newline))))
+
+(test* "alloc-profiler-write-flamegraph :port" #t
+       (let1 out (open-output-string)
+         (alloc-profiler-write-flamegraph :port out)
+         (boolean (#/\;<vector> [0-9]+\n/ (get-output-string out)))))
+
+;; A thread created while profiling shares the profiler structure, but
+;; can't touch the creator's allocation profiler.
+(cond-expand
+ [gauche.sys.threads
+  (test* "alloc profiler and other threads" '(0 #f #t)
+         (begin
+           (alloc-profiler-reset)
+           (alloc-profiler-start :interval 1)
+           (alloc-vectors 100)
+           (let1 r (thread-join!
+                    (thread-start!
+                     (make-thread (^[] (list (alloc-profiler-stop)
+                                             (alloc-profiler-raw-result))))))
+             (alloc-vectors 100)
+             (append r (list (>= (alloc-profiler-stop) 200))))))]
+ [else])
+
+(test* "alloc-profiler-reset" #f
+       (begin (alloc-profiler-reset)
+              (alloc-profiler-get-result)))
+
 (test-end)
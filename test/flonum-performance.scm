@@ -0,0 +1,41 @@
+;;
+;; Measure flonum printing and reading performance.  The first and the
+;; third use the shortest representation; the second uses the precision.
+;; The last two read back the shortest representation and a 19-digit
+;; mantissa, respectively.
+;;
+;;   gosh test/flonum-performance.scm [count]
+;;
+
+(use gauche.time)
+(use srfi.27)
+
+(define (main args)
+  (define count (if (pair? (cdr args)) (x->integer (cadr args)) 1000000))
+  (random-source-randomize! default-random-source)
+  (let ([vals (list->vector
+               (map (^_ (* (- (random-real) 0.5)
+                           (expt 10.0 (- (random-integer 40) 20))))
+                    (iota 1000)))]
+        [out (open-output-string)]
+        [strs (make-vector 1000)]
+        [longs (make-vector 1000)])
+    (define (run label proc)
+      (let1 r (time-this 1 (^[] (dotimes [i count]
+                                  (proc (vector-ref vals (modulo i 1000))))))
+        (format #t "~20a ~8,3f sec (~,0f ns/call)\n" label
+                (time-result-real r)
+                (/ (* 1e9 (time-result-real r)) count))))
+    (run "number->string" number->string)
+    (run "number->string prec" (cut number->string <> 10 #f 6))
+    (run "write" (cut write <> out))
+    (dotimes [i 1000]
+      (vector-set! strs i (number->string (vector-ref vals i)))
+      (vector-set! longs i (format "~de~d"
+                                   (+ (expt 10 18) (random-integer (expt 10 18)))
+                                   (- (random-integer 600) 300))))
+    (set! vals strs)
+    (run "string->number" string->number)
+    (set! vals longs)
+    (run "string->number long" string->number))
+  0)
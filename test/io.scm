@@ -280,6 +280,31 @@
                (and (eof-object? s3)
                     (list (string-size s1) (string-size s2)))))))
 
+;; Lines and multibyte chars crossing the port buffer boundary
+(let ([lines (map (^n (make-string n (if (odd? n) #\a #\u3042)))
+                  '(0 1 4095 4096 4097 8191 8192 8193 20000 3))])
+  (with-output-to-file "tmp1.o"
+    (^[] (for-each (^[l] (display l) (display "\r\n")) lines)))
+  (test* "read-line (long lines, CRLF)" lines
+         (call-with-input-file "tmp1.o" (cut port->list read-line <>)))
+  (test* "read-line (line count)" (+ (length lines) 1)
+         (call-with-input-file "tmp1.o"
+           (^p (port-for-each identity (cut read-line p))
+               (port-current-line p))))
+  (test* "read-string (across buffer)"
+         (apply string-append (map (cut string-append <> "\r\n") lines))
+         (call-with-input-file "tmp1.o"
+           (^p (let loop ([r '()])
+                 (let1 s (read-string 4099 p)
+                   (if (eof-object? s)
+                     (apply string-append (reverse r))
+                     (loop (cons s r))))))))
+  (test* "read-string (string port)" '("\u3042\u3042a" "b" #t)
+         (let1 p (open-input-string "\u3042\u3042ab")
+           (list (read-string 3 p) (read-string 3 p)
+                 (eof-object? (read-string 3 p)))))
+  (test* "read-string (zero)" "" (read-string 0 (open-input-string ""))))
+
 (with-output-to-file "tmp1.o"
   (cut display "a b c \"d e\" f g\n(0 1 2\n3 4 5)\n"))
 
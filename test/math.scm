@@ -3,6 +3,7 @@
 (use gauche.test)
 (use srfi.27)
 (use srfi.42)
+(use gauche.uvector)
 
 (test-start "math.* modules")
 
@@ -39,6 +40,39 @@
        (map (^p (cons (miller-rabin-prime? (cdr p)) (cdr p)))
             *prime-test-samples*))
 
+;; strong pseudoprimes to base 2, and numbers around 2^64
+(define *hard-prime-test-samples*
+  '((#f . 3215031751)
+    (#f . 3825123056546413051)
+    (#t . 18446744073709551557)
+    (#f . 18446744073709551615)
+    (#f . 318665857834031151167461)
+    (#t . 618970019642690137449562111)
+    (#f . 618970019642690137449562113)))
+
+(test* "small-prime?" '(#f #f #t #f #f #f #f)
+       (map (^p (small-prime? (cdr p))) *hard-prime-test-samples*))
+(test* "bpsw test (hard cases)" *hard-prime-test-samples*
+       (map (^p (cons (bpsw-prime? (cdr p)) (cdr p)))
+            *hard-prime-test-samples*))
+
+;; The native sieve past 2^31 and 2^32, where long may overflow
+(let ([sieve! (with-module gauche.internal %prime-sieve-segment!)]
+      [ps (let loop ([ps (cdr *primes*)] [r '()])
+            (if (> (car ps) 70000)
+              (list->u32vector (reverse r))
+              (loop (cdr ps) (cons (car ps) r))))])
+  (dolist [start (list (+ (expt 2 31) 1) (+ (expt 2 32) 1))]
+    (test* #"prime sieve from ~start"
+           (filter small-prime? (iota 1000 start 2))
+           (let1 v (make-u8vector 1000)
+             (sieve! v start ps)
+             (filter-map (^[i] (and (= (u8vector-ref v i) 1) (+ start (* i 2))))
+                         (iota 1000))))))
+(test* "prime sieve out of range" (test-error)
+       ((with-module gauche.internal %prime-sieve-segment!)
+        (make-u8vector 10) (- (expt 2 64) 1) '#u32(3)))
+
 (define *random-prime-test-count* 500)
 ;(define *random-prime-test-count* 1000000) ;takes 5min on 2.4GHz Core2 machine
 
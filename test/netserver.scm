@@ -0,0 +1,94 @@
+;;
+;; testing net.server
+;;
+
+(use gauche.test)
+(use gauche.net)
+(use gauche.threads)
+(use control.fiber)
+
+(test-start "net.server")
+
+(use net.server)
+(test-module 'net.server)
+
+;; Replies a line with the worker's pid and the request upcased.
+(define (handler sock)
+  (let ([in (socket-input-port sock)]
+        [out (socket-output-port sock)])
+    (fiber-wait-readable in)
+    (write (list (sys-getpid) (string-upcase (read-line in))) out)
+    (newline out)
+    (flush out)))
+
+(define (request port msg)
+  (call-with-client-socket (make-client-socket 'inet "127.0.0.1" port)
+    (^[in out]
+      (display msg out) (newline out) (flush out)
+      (read in))))
+
+(define (wait-for-ports server)
+  (let loop ([n 0])
+    (or (guard (e [(error? e) #f]) (server-ports server))
+        (and (< n 100) (begin (sys-nanosleep #e1e7) (loop (+ n 1)))))))
+
+;;-----------------------------------------------------------------
+(test-section "threads mode")
+
+(let* ([server (make-server handler :host "127.0.0.1" :port 0
+                            :mode 'threads :workers 2 :grace-period 2)]
+       [th (thread-start! (make-thread (^[] (server-run! server))))]
+       [port (car (wait-for-ports server))])
+  (test* "request" "HELLO" (cadr (request port "hello")))
+  (test* "many requests" (map (^i #"MSG~i") (iota 50))
+         (map (^i (cadr (request port #"msg~i"))) (iota 50)))
+  (test* "concurrent requests" (map (^i #"C~i") (iota 20))
+         (map thread-join!
+              (map (^i (thread-start!
+                        (make-thread (^[] (cadr (request port #"c~i"))))))
+                   (iota 20))))
+  (test* "served in this process" (sys-getpid) (car (request port "x")))
+  (server-stop! server)
+  (test* "stop" #t (begin (thread-join! th) #t))
+  (test* "not listening after stop" (test-error)
+         (request port "x")))
+
+;;-----------------------------------------------------------------
+(test-section "prefork mode")
+
+(cond-expand
+ [(and (not gauche.os.windows) (not gauche.os.cygwin))
+  (receive (pin pout) (sys-pipe)
+    (let* ([master (sys-fork)])
+      (when (zero? master)
+        (close-input-port pin)
+        (let1 server #f
+          (set! server
+                (make-server handler :host "127.0.0.1" :port 0
+                             :mode 'prefork :workers 2 :grace-period 2
+                             :worker-init (^[]
+                                            (write (server-ports server) pout)
+                                            (newline pout)
+                                            (flush pout))))
+          (server-run! server)
+          (sys-exit 0)))
+      (close-output-port pout)
+      (let* ([port (car (read pin))]
+             [pids (delete-duplicates
+                    (map (^i (car (request port #"a~i"))) (iota 20)))])
+        (test* "request" "HELLO" (cadr (request port "hello")))
+        (test* "served by workers" #t
+               (every (^p (not (memv p (list (sys-getpid) master)))) pids))
+        (sys-kill master SIGHUP)
+        (sys-sleep 2)
+        (test* "restart replaces workers" #t
+               (let1 pids2 (map (^i (car (request port #"b~i"))) (iota 20))
+                 (every (^p (not (memv p pids))) pids2)))
+        (sys-kill master SIGTERM)
+        (test* "stop" '(#t 0)
+               (receive (_ status) (sys-waitpid master)
+                 (list (sys-wait-exited? status)
+                       (sys-wait-exit-status status)))))))]
+ [else])
+
+(test-end)
@@ -400,6 +400,54 @@
        (list (= 0.0 (string->number "0e324"))
              (= 0.0 (string->number "0e325"))))
 
+;; Cases that need correct rounding beyond what the double arithmetic
+;; gives: halfway points, subnormals, and up to 20 digit mantissas.
+(let ()
+  (define (t str m e)
+    (test* #"flonum reader (rounding) ~str" (ldexp m e)
+           (string->number str)))
+  (t "9007199254740993" 1 53)
+  (t "9007199254740995" 2251799813685249 2)
+  (t "9.007199254740993e-3" 1298074214633707 -57)
+  (t "7.3177701707893310e15" 7317770170789331 0)
+  (t "1.00000000000000011102230246251565404236316680908203125" 1 0)
+  (t "1.00000000000000011102230246251565404236316680908203126"
+     4503599627370497 -52)
+  (t "2.4703282292062328e-324" 1 -1074)
+  (t "2.4703282292062327e-324" 0 0)
+  (t "9.5e-322" 3 -1068)
+  (t "4.35679914958e-320" 4409 -1073)
+  (t "2.2250738585072011e-308" 4503599627370495 -1074)
+  (t "1.8446744073709551615e-300" 1390897693746571 -1046)
+  (t "18446744073709551615" 1 64)
+  (t "5e-20" 2076918743413931 -115)
+  (t "3.0e200" 8825390130992007 613)
+  (t "8.98846567431158e307" 1 1023)
+  (t "1.7976931348623158e308" 9007199254740991 971)
+  (t "-1.7976931348623158e308" -9007199254740991 971))
+
+(test* "flonum reader (1.7976931348623159e308)" +inf.0
+       (string->number "1.7976931348623159e308"))
+
+;; Check the result against exact arithmetic: the error must be within
+;; a half ulp.
+(test* "flonum reader (correct rounding)" '()
+       (let loop ([k 0] [seed 12345] [r '()])
+         (if (= k 2000)
+           r
+           (let* ([seed (modulo (+ (* seed 6364136223846793005) 1442695040888963407)
+                                (expt 2 64))]
+                  [mant (quotient seed (expt 10 (modulo k 4)))]
+                  [exp10 (- (modulo (quotient seed 7) 600) 320)]
+                  [str (format "~de~d" mant exp10)]
+                  [x (string->number str)]
+                  [v (decode-float x)]
+                  [err (abs (- (exact x) (* mant (expt 10 exp10))))])
+             (loop (+ k 1) seed
+                   (if (<= err (/ (expt 2 (vector-ref v 1)) 2))
+                     r
+                     (cons str r)))))))
+
 ;; We used to allow 1#1 to be read as a symbol.  As of 0.9.4, it is an error.
 (test* "padding" '(10.0 #t) (flonum-test "1#"))
 (test* "padding" '(10.0 #t) (flonum-test "1#."))
@@ -636,6 +684,29 @@
 (test* "number->string radix error 2" (test-error) (number->string 42 1))
 (test* "number->string radix error 3" (test-error) (number->string 42 37))
 
+;; Long numbers are converted by divide-and-conquer; the low halves must
+;; be padded with zeros.
+(test* "number->string 10^20000" (string-append "1" (make-string 20000 #\0))
+       (number->string (expt 10 20000)))
+(test* "number->string 10^20000-1" (make-string 20000 #\9)
+       (number->string (- (expt 10 20000) 1)))
+(test* "number->string -(16^5000-1)" (string-append "-" (make-string 5000 #\f))
+       (number->string (- 1 (expt 16 5000)) 16))
+(test* "number->string 3^50000 (radix 3)"
+       (string-append "1" (make-string 50000 #\0))
+       (number->string (expt 3 50000) 3))
+(test* "string->number 10^20000"
+       (expt 10 20000)
+       (string->number (string-append "1" (make-string 20000 #\0))))
+(test* "string->number 36^3000-1"
+       (- (expt 36 3000) 1)
+       (string->number (make-string 3000 #\z) 36))
+(let1 x (* (expt 3 40000) (expt 7 30000))
+  (test* "number->string round trip" '(#t #t #t #t #t #t)
+         (map (^r (and (= x (string->number (number->string x r) r))
+                       (= (- x) (string->number (number->string (- x) r) r))))
+              '(2 3 8 10 16 36))))
+
 ;;------------------------------------------------------------------
 (test-section "number->string customization")
 
@@ -691,6 +762,30 @@
          (map (cut number->string (car data) 10 '(notational) <>)
               (cadr data))))
 
+;; Shortest representation.  When the value is exactly halfway between
+;; two shortest candidates, we round up iff the mantissa is odd.
+(test* "shortest flonum representation"
+       '("1.1258999068426243e15" "1.1258999068426248e15"
+         "2.8147497671065625e14" "5.0e-324" "1.5e-323"
+         "2.2250738585072014e-308" "1.7976931348623157e308"
+         "1.0e23" "0.3333333333333333" "1.152921504606847e18"
+         "1.0e-7" "0.001" "123.0" "1.0e10" "-0.1")
+       (map number->string
+            (list 1125899906842624.25 1125899906842624.75
+                  281474976710656.25 5e-324 1.5e-323
+                  2.2250738585072014e-308 1.7976931348623157e308
+                  1e23 (/ 1.0 3) (expt 2.0 60)
+                  1e-7 0.001 123.0 1e10 -0.1)))
+
+(test* "flonum write/read round trip" '()
+       (let loop ([x 1.2345e-305] [r '()])
+         (if (> x 1e305)
+           r
+           (loop (* x 1.1234567)
+                 (if (eqv? x (string->number (number->string x)))
+                   r
+                   (cons x r))))))
+
 ;;==================================================================
 ;; Conversions
 ;;
@@ -757,6 +852,23 @@
 (test-expt-mod 915151975010144550184898988758 1775619891701751758948583493979350)
 (test-expt-mod -324574950475018750175057087501 100184859387038471089598349534598)
 (test-expt-mod 324574950475018750175057087501 -100184859387038471089598349534598)
+(test-expt-mod 915151975010144550184898988758 1775619891701751758948583493979351)
+(test-expt-mod -324574950475018750175057087501 100184859387038471089598349534597)
+(test-expt-mod 324574950475018750175057087501 -100184859387038471089598349534597)
+(test-expt-mod 7 -4294967291)
+
+(test* "expt-mod (edge cases)" '(1 0 0 1 -4 0 1)
+       (list (expt-mod 5 0 7) (expt-mod 5 0 1) (expt-mod 5 3 -1)
+             (expt-mod 0 0 5) (expt-mod 1 0 -5) (expt-mod 0 7 5)
+             (expt-mod -1 (expt 2 100) 3)))
+
+;; Fermat's little theorem with a Mersenne prime
+(let1 p (- (expt 2 521) 1)
+  (test* "expt-mod (Fermat)" '(1 1 12345678901234567890 0)
+         (list (expt-mod 3 (- p 1) p)
+               (expt-mod (+ p 2) (- p 1) p)
+               (expt-mod 12345678901234567890 p p)
+               (expt-mod (* p 3) 5 p))))
 
 (define (test-inverse-mod q mod)
   (test* (format "inverse-mod(~a, ~a)" q mod) 1
@@ -1538,6 +1650,28 @@
            173462447179147555430258970864309778377421844723664084649347019061363579192879108857591038330408837177983810868451546421940712978306134189864280826014542758708589243873685563973118948869399158545506611147420216132557017260564139394366945793220968665108959685482705388072645828554151936401912464931182546092879815733057795573358504982279280090942872567591518912118622751714319229788100979251036035496917279912663527358783236647193154777091427745377038294584918917590325110939381322486044298573971650711059244462177542540706913047034664643603491382441723306598834177
            ))
 
+;; Karatsuba, Toom-3 and NTT multiplication must agree with schoolbook.
+;; Operand sizes are chosen around the thresholds in bignum.c.
+(let ([mul (with-module gauche.internal %bignum-mul)]
+      [ones (^n (- (ash 1 n) 1))])
+  (define (test-mul name x y)
+    (let1 expected (mul x y 'schoolbook)
+      (test* name '(#t #t #t #t)
+             (map (^[algo] (= expected (mul x y algo)))
+                  '(#f karatsuba toom3 ntt)))
+      (test* #"~name (sign)" (list (- expected) expected)
+             (list (* (- x) y) (* (- x) (- y))))))
+  (test-mul "3^2000 * 7^1500" (expt 3 2000) (expt 7 1500))
+  (test-mul "3^40000 * 7^20000" (expt 3 40000) (expt 7 20000))
+  (test-mul "3^130000 * 7^60000" (expt 3 130000) (expt 7 60000))
+  (test-mul "3^130000 * 7^3000" (expt 3 130000) (expt 7 3000))
+  (test-mul "(2^150000-1) * (2^200000-1)" (ones 150000) (ones 200000))
+  (let1 x (ones 120000)
+    (test-mul "(2^120000-1)^2" x x)
+    (test-mul "(2^120000-1)^2 (copy)" x (- (+ x 1) 1)))
+  (let1 x (expt 3 130000)
+    (test-mul "(3^130000)^2" x x)))
+
 ;;------------------------------------------------------------------
 (test-section "multiplication short cuts")
 
@@ -1878,6 +2012,24 @@
   (do-exactness 7 9)
   )
 
+;; Recursive division must agree with schoolbook division.  Operand sizes
+;; are chosen around DIV_DC_THRESHOLD in bignum.c.
+(let1 div-rem (with-module gauche.internal %bignum-div-rem)
+  (define (test-div name x y)
+    (test* name '(#t #t)
+           (receive (q r) (div-rem x y)
+             (list (equal? (values->list (div-rem x y 'schoolbook)) (list q r))
+                   (and (= x (+ (* q y) r))
+                        (< (abs r) (abs y))
+                        (or (zero? r) (eqv? (sign r) (sign x)))))))))
+  (define (sign n) (if (negative? n) -1 1))
+  (test-div "3^30000 / 7^5000" (expt 3 30000) (expt 7 5000))
+  (test-div "3^30000 / (7^10000+1)" (expt 3 30000) (+ (expt 7 10000) 1))
+  (test-div "3^100000 / 7^9000" (expt 3 100000) (expt 7 9000))
+  (test-div "-3^100000 / 7^30000" (- (expt 3 100000)) (expt 7 30000))
+  (test-div "(2^80000-1) / -(2^30000-1)"
+            (- (ash 1 80000) 1) (- 1 (ash 1 30000))))
+
 ;;------------------------------------------------------------------
 (test-section "div and mod")
 
@@ -1928,6 +2080,62 @@
   )
 
 
+;;------------------------------------------------------------------
+(test-section "gcd and lcm")
+
+(let ()
+  (define (euclid x y)
+    (let loop ([x (abs x)] [y (abs y)])
+      (if (zero? y) x (loop y (modulo x y)))))
+  (define (test-gcd name x y)
+    (test* #"gcd ~name" (euclid x y) (gcd x y))
+    (test* #"gcd ~name (swapped, negated)" (euclid x y) (gcd (- y) x)))
+  (test-gcd "fixnum" 1071 462)
+  (test-gcd "fixnum coprime" 1000003 999983)
+  (test-gcd "fixnum power of 2" (expt 2 40) (* 3 (expt 2 17)))
+  (test-gcd "fixnum 0" 0 12)
+  (test-gcd "fixnum 1" 1 (greatest-fixnum))
+  (test-gcd "least fixnum" (least-fixnum) (* 3 (expt 2 20)))
+  (test-gcd "bignum fixnum" (+ (expt 3 100) 1) 1000000)
+  (test-gcd "bignum bignum" (* (expt 3 200) (expt 7 50)) (* (expt 7 80) (expt 11 30)))
+  (test-gcd "bignum coprime" (- (expt 2 521) 1) (- (expt 2 607) 1))
+  (test-gcd "bignum power of 2" (ash 1 300) (ash 5 200))
+  (test-gcd "bignum shared factor"
+            (* (+ (expt 10 60) 7) (expt 13 40) 9)
+            (* (+ (expt 10 60) 7) (expt 17 30) 6))
+  (test-gcd "bignum adjacent" (expt 7 1000) (+ (expt 7 1000) 1))
+  (test-gcd "bignum fibonacci"
+            (let loop ([a 0] [b 1] [n 3000]) (if (zero? n) b (loop b (+ a b) (- n 1))))
+            (let loop ([a 0] [b 1] [n 2999]) (if (zero? n) b (loop b (+ a b) (- n 1)))))
+  (test-gcd "bignum long"
+            (* (- (expt 3 5000) 1) (+ (expt 2 3001) 5))
+            (* (- (expt 3 4000) 1) (+ (expt 2 3001) 5)))
+  (test* "lcm" (* (expt 2 100) (expt 3 50) 5)
+         (lcm (* (expt 2 100) 5) (* (expt 2 60) (expt 3 50))))
+  )
+
+(test* "ratnum + same denominator" 1/2 (+ 1/4 1/4))
+(test* "ratnum + same denominator" 1 (+ 3/7 4/7))
+(test* "ratnum - same denominator" 0 (- 3/7 3/7))
+(test* "ratnum + coprime denominators" 41/35 (+ 3/5 4/7))
+(test* "ratnum + common factor" 1/2 (+ 1/6 1/3))
+(test* "ratnum + common factor" 7/12 (+ 1/4 1/3))
+(test* "ratnum + common factor" 1/5 (- 7/10 1/2))
+(test* "ratnum + integer" 25/7 (+ 4/7 3))
+(test* "integer - ratnum" 17/7 (- 3 4/7))
+(test* "ratnum * ratnum" 1/3 (* 2/9 3/2))
+(test* "ratnum * integer" 10/3 (* 5/6 4))
+(test* "ratnum * integer" 3 (* 3/4 4))
+(test* "ratnum / ratnum" -3/2 (/ 3/4 -1/2))
+(test* "ratnum / integer" 3/8 (/ 3/4 2))
+(test* "ratnum / integer" -1/6 (/ 2/3 -4))
+(test* "integer / ratnum" -21/2 (/ 6 -4/7))
+(test* "ratnum / bignum" (/ 1 (* 3 (expt 2 99))) (/ 2/3 (expt 2 100)))
+(test* "bignum / ratnum" (* 3 (expt 2 99)) (/ (expt 2 100) 2/3))
+(test* "ratnum sum" 1
+       (let loop ([i 1] [s 0])
+         (if (> i 99) (+ s 1/100) (loop (+ i 1) (+ s (/ 1 (* i (+ i 1))))))))
+
 ;;------------------------------------------------------------------
 (test-section "absolute values")
 
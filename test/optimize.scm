@@ -411,6 +411,65 @@
               [_ #f]))
           (proc->insn/split (module-binding-ref m 'bar)))))
 
+;; fixnum specialization in loops (type/specialize-loops)
+(test-section "fixnum specialization")
+
+(define (has-insn? proc rx)
+  (boolean (any (^i (rx (symbol->string (caar i)))) (proc->insn/split proc))))
+
+(let ()
+  (define (vsum v)
+    (let1 s 0
+      (dotimes [i (vector-length v)] (set! s (+ s (vector-ref v i))))
+      s))
+  (define (vsum2 v)
+    (let loop ([i 0] [s 0])
+      (if (= i (vector-length v))
+        s
+        (loop (+ i 1) (+ s (vector-ref v i))))))
+  (define (vfill! v x)
+    (do ([i 0 (+ i 1)])
+        [(>= i (vector-length v)) v]
+      (vector-set! v i x)))
+  (define (vsum-bad v)          ;index can reach (vector-length v)
+    (let loop ([i 0] [s 0])
+      (if (<= i (vector-length v))
+        (loop (+ i 1) (+ s (vector-ref v i)))
+        s)))
+  (define (vsum-step2 v)        ;stepping by 2 isn't handled
+    (let loop ([i 0] [s 0])
+      (if (< i (vector-length v))
+        (loop (+ i 2) (+ s (vector-ref v i)))
+        s)))
+
+  (test* "dotimes over vector" '(#t 45)
+         (list (has-insn? vsum #/^VEC-REF-NC$/) (vsum (list->vector (iota 10)))))
+  (test* "named let over vector" '(#t 45)
+         (list (has-insn? vsum2 #/^VEC-REF-NC$/)
+               (vsum2 (list->vector (iota 10)))))
+  (test* "named let over vector (empty)" 0 (vsum2 #()))
+  (test* "do loop with vector-set!" '(#t #(z z z))
+         (list (has-insn? vfill! #/^VEC-SET-NC$/) (vfill! (make-vector 3) 'z)))
+  (when (vector-immutable? '#(1 2 3))
+    (test* "vector-set! to literal" (test-error)
+           (vfill! '#(1 2 3) 'z)))
+  (test* "loop counter increment" #t (has-insn? vsum2 #/FXADDI/))
+  (test* "unprovable index" '(#f #f)
+         (list (has-insn? vsum-bad #/^VEC-REF-NC$/)
+               (has-insn? vsum-step2 #/^VEC-REF-NC$/)))
+  (test* "unprovable index" (test-error)
+         (vsum-bad (list->vector (iota 10))))
+  (test* "stepping by 2" 20 (vsum-step2 (list->vector (iota 10))))
+  (test* "not a vector" (test-error) (vsum '(1 2 3)))
+  )
+
+(test* "fixnum overflow" (+ (greatest-fixnum) 1)
+       ((eval `(^[] (let loop ([i 0] [n 0])
+                      (if (= n 0)
+                        (loop ,(greatest-fixnum) 1)
+                        (+ i 1))))
+              (current-module))))
+
 ;; generic function pre-dispatch
 ;; NB: We're still not sure how to expose this feature in general.
 ;; For the time being, we test the inlining logic (it's in pass 3)
@@ -168,6 +168,173 @@
  boolean<?
  '((1 3 1 2 4 2) (1 3 1 2 4 2)))
 
+;; fast paths
+(test-section "radix sort and parallel sort")
+
+(use gauche.uvector)
+
+;; deterministic pseudo random numbers
+(define (pseudo-random-list n range :optional (seed 1))
+  (let loop ([i 0] [x seed] [r '()])
+    (if (= i n)
+      r
+      (let1 x (modulo (+ (* x 1103515245) 12345) 2147483648)
+        (loop (+ i 1) x (cons (- (modulo x range) (quotient range 2)) r))))))
+
+(let ([ints (pseudo-random-list 500 2000)]
+      [edge (list (greatest-fixnum) (least-fixnum) 0 -1 1)])
+  (define (ref lis) (list->vector (stable-sort lis <)))
+  (test* "radix sort (fixnum)" (ref ints) (sort (list->vector ints)))
+  (test* "radix sort (fixnum, edge)" (ref (append edge ints edge))
+         (sort (list->vector (append edge ints edge))))
+  (test* "radix sort! (fixnum)" (ref ints) (sort! (list->vector ints)))
+  (test* "radix stable-sort (fixnum)" (ref ints)
+         (stable-sort (list->vector ints) default-comparator))
+  (let1 flos (append '(+inf.0 -inf.0 1e300 -1e-300)
+                     (map (cut / <> 7.0) ints))
+    (test* "radix sort (flonum)" (ref flos) (sort (list->vector flos))))
+  (let1 mixed (cons 0.5 ints)
+    (test* "mixed fixnum and flonum" (ref mixed) (sort (list->vector mixed)))))
+
+(test* "radix stable-sort keeps -0.0 and 0.0 order"
+       '((0.0 -0.0) (-0.0 0.0))
+       (let1 pos (^v (filter zero? (vector->list v)))
+         (list (pos (stable-sort (list->vector (cons* 0.0 -0.0 (iota 100 1.0)))))
+               (pos (stable-sort (list->vector (cons* -0.0 0.0 (iota 100 1.0))))))))
+
+(let1 src (pseudo-random-list 300 256)
+  (define (uv-test class list->uv uv->list xs)
+    (test* #"uvector sort (~|class|)" (stable-sort xs <)
+           (uv->list (sort (list->uv xs))))
+    (test* #"uvector sort! (~|class|)" (stable-sort xs <)
+           (let1 v (list->uv xs) (sort! v) (uv->list v))))
+  (uv-test 's8 list->s8vector s8vector->list (map (cut clamp <> -128 127) src))
+  (uv-test 'u8 list->u8vector u8vector->list (map (cut + 128 <>) src))
+  (uv-test 's16 list->s16vector s16vector->list (map (cut * 100 <>) src))
+  (uv-test 'u16 list->u16vector u16vector->list (map (cut * 200 <>) (map abs src)))
+  (uv-test 's32 list->s32vector s32vector->list (map (cut * 1000003 <>) src))
+  (uv-test 'u32 list->u32vector u32vector->list (map (cut * 100003 <>) (map abs src)))
+  (uv-test 's64 list->s64vector s64vector->list (map (cut * 10000000019 <>) src))
+  (uv-test 'u64 list->u64vector u64vector->list (map (cut * 10000000019 <>) (map abs src)))
+  (uv-test 'f16 list->f16vector f16vector->list (map (cut / <> 4.0) src))
+  (uv-test 'f32 list->f32vector f32vector->list (map (cut / <> 8.0) src))
+  (uv-test 'f64 list->f64vector f64vector->list
+           (cons* +inf.0 -inf.0 (map (cut / <> 3.0) src))))
+
+(test* "uvector sort with comparator" '#s32(3 2 1 0)
+       (sort '#s32(0 3 1 2) >))
+(test* "uvector sort is non-destructive" '(#u8(1 2 3) #u8(3 1 2))
+       (let1 v (u8vector 3 1 2) (list (sort v) v)))
+(test* "uvector sort! on immutable" (test-error) (sort! '#u8(3 1 2)))
+(test* "complex uvector sort" (test-error) (sort (c64vector 1+i 0)))
+
+(let* ([n 200000]
+       [xs (pseudo-random-list n 1000000 7)])
+  (define (sorted-vector? v less?)
+    (let loop ([i 1])
+      (or (= i (vector-length v))
+          (and (not (less? (vector-ref v i) (vector-ref v (- i 1))))
+               (loop (+ i 1))))))
+  (test* "parallel sort (default)" (stable-sort (cons 0.5 xs) <)
+         (vector->list (sort (list->vector (cons 0.5 xs)))))
+  (test* "parallel sort (less?)" #t
+         (let1 v (sort (list->vector xs) >)
+           (and (= (vector-length v) n) (sorted-vector? v >))))
+  (test* "parallel stable-sort stability" #t
+         (let* ([v (list->vector (map cons (map (cut modulo <> 100) xs)
+                                     (iota n)))]
+                [r (stable-sort! v (^[a b] (< (car a) (car b))))])
+           (sorted-vector? r (^[a b] (or (< (car a) (car b))
+                                         (and (= (car a) (car b))
+                                              (< (cdr a) (cdr b))))))))
+  (test* "parallel sort (uvector)" (stable-sort (map abs xs) <)
+         (u32vector->list (sort (list->u32vector (map abs xs)))))
+  (test* "parallel sort (strings)" #t
+         (sorted-vector? (sort (list->vector (map number->string xs)))
+                         string<?))
+  ;; A user comparator is never called from other threads.
+  (test* "large sort with comparator is serial" '(#t #t)
+         (let* ([me (current-thread)]
+                [ok #t]
+                [less? (^[a b]
+                         (unless (eq? (current-thread) me) (set! ok #f))
+                         (< a b))])
+           (sort (list->vector xs) less?)
+           (stable-sort! (list->vector xs) less?)
+           (list ok (sorted-vector? (sort (list->vector xs) less?) <)))))
+
+;; adaptive merge sort
+(test-section "adaptive merge sort")
+
+(let* ([n 5000]
+       [noisy (map (^[i r] (if (zero? (modulo i 97)) (+ i r) i))
+                   (iota n) (pseudo-random-list n 200 3))]
+       ;; reference: vectors are sorted by a different algorithm
+       [ref (^[xs] (vector->list (sort (list->vector xs))))])
+  (define (cnt-less)
+    (let1 n 0
+      (values (^[a b] (inc! n) (< a b)) (^[] n))))
+  (test* "presorted list" (iota n) (stable-sort (iota n) <))
+  (test* "presorted list takes n-1 comparisons" (- n 1)
+         (receive (less count) (cnt-less)
+           (stable-sort (iota n) less)
+           (count)))
+  (test* "reversed list takes n-1 comparisons" (list (iota n) (- n 1))
+         (receive (less count) (cnt-less)
+           (list (stable-sort (reverse (iota n)) less) (count))))
+  (test* "nearly sorted list" (ref noisy) (sort noisy <))
+  (test* "nearly sorted vector" (list->vector (ref noisy))
+         (sort (list->vector noisy) <))
+  (test* "nearly sorted list (default order)" (ref noisy) (sort noisy)))
+
+(test* "stability with runs" '((1 . a) (1 . b) (1 . c) (2 . a) (2 . b) (3 . a))
+       (stable-sort '((2 . a) (3 . a) (1 . a) (1 . b) (2 . b) (1 . c))
+                    (^[x y] (< (car x) (car y)))))
+
+(test* "stability (large)" #t
+       (let* ([xs (map cons (pseudo-random-list 3000 20 5) (iota 3000))]
+              [r (stable-sort xs (^[x y] (< (car x) (car y))))])
+         (every (^[x y] (or (< (car x) (car y))
+                            (and (= (car x) (car y)) (< (cdr x) (cdr y)))))
+                r (cdr r))))
+
+;; The comparator raises in the middle of merging runs.
+(test* "stable-sort! keeps a permutation when comparator raises" #t
+       (let* ([xs (pseudo-random-list 3000 1000 11)]
+              [v (list->vector xs)]
+              [n 0])
+         (guard (e [(equal? e 'stop) #t])
+           (stable-sort! v (^[a b]
+                             (inc! n)
+                             (when (= n 20000) (raise 'stop))
+                             (< a b))))
+         (equal? (sort (vector->list v)) (sort xs))))
+
+(test* "sort on list with non-boolean true" '(1 2 3)
+       (sort '(3 1 2) (^[a b] (and (< a b) 'yes))))
+
+(let ([a (filter even? (iota 1000))]
+      [b (append (iota 300 1 2) (iota 200 2000))])
+  (test* "merge (galloping)" (sort (append a b)) (merge a b <))
+  (test* "merge (default)" (sort (append a b)) (merge a b))
+  (test* "merge stability" '((1 . a) (1 . b) (2 . a) (2 . b) (3 . b))
+         (merge '((1 . a) (2 . a)) '((1 . b) (2 . b) (3 . b))
+                (^[x y] (< (car x) (car y)))))
+  (test* "merge!" (sort (append a b))
+         (merge! (list-copy a) (list-copy b) <))
+  (test* "merge! reuses cells" #t
+         (let* ([a (list 1 3 5)] [b (list 2 4)]
+                [r (merge! a b)])
+           (and (equal? r '(1 2 3 4 5))
+                (or (eq? r a) (eq? r b))))))
+
+(test* "generic sort" "        aabcdeefghijklmnoooopqrrstuuvwxyz"
+       (sort "the quick brown fox jumps over a lazy dog" char<?))
+(test* "generic sort!" "zyxwvuutsrrqpoooonmlkjihgfeedcbaa        "
+       (let1 s (string-copy "the quick brown fox jumps over a lazy dog")
+         (sort! s char>?)
+         s))
+
 ;; ensure in-place list sort
 ;; https://twitter.com/kmizu/status/1192614125647482882
 (let ()
@@ -239,6 +239,47 @@
               (list r0 r1 (mutex-state m)))))
         ))
 
+;; contention statistics
+(test* "mutex-stats-enable!" '(#f #t)
+       (let1 prev (mutex-stats-enable! #t)
+         (list prev (mutex-stats-enabled?))))
+
+(test* "mutex-stats uncontended" '(3 0 0.0 0.0)
+       (let1 m (make-mutex)
+         (dotimes [i 3] (mutex-lock! m) (mutex-unlock! m))
+         (map cdr (mutex-stats m))))
+
+(test* "mutex-stats contended" '(2 1 #t)
+       (let1 m (make-mutex)
+         (mutex-lock! m)
+         (let1 t (thread-start! (make-thread (^[] (mutex-lock! m)
+                                                  (mutex-unlock! m))))
+           (sys-nanosleep #e5e7)
+           (mutex-unlock! m)
+           (thread-join! t)
+           (let1 st (mutex-stats m)
+             (list (assq-ref st 'acquired)
+                   (assq-ref st 'contended)
+                   (<= 0.01 (assq-ref st 'max-wait)
+                       (assq-ref st 'wait-time)))))))
+
+(test* "mutex-stats timeout" '(1 1)
+       (let1 m (make-mutex)
+         (mutex-lock! m)
+         (mutex-lock! m 0.01)
+         (mutex-unlock! m)
+         (let1 st (mutex-stats m)
+           (list (assq-ref st 'acquired) (assq-ref st 'contended)))))
+
+(test* "mutex-stats-reset!/disable" '(0 0)
+       (let1 m (make-mutex)
+         (mutex-lock! m) (mutex-unlock! m)
+         (mutex-stats-reset! m)
+         (mutex-stats-enable! #f)
+         (mutex-lock! m) (mutex-unlock! m)
+         (let1 st (mutex-stats m)
+           (list (assq-ref st 'acquired) (assq-ref st 'contended)))))
+
 ;;---------------------------------------------------------------------
 (test-section "condition variables")
 
@@ -426,6 +467,31 @@
            (cut port-test-on-error <> #t))
          (call-with-input-file "test.out" port->string)))
 
+;; Thread-confined ports
+(define (in-other-thread thunk)
+  (thread-join!
+   (thread-start!
+    (make-thread (^[] (guard (e [(<port-error> e) 'port-error])
+                        (thunk)))))))
+
+(let1 p (open-output-string)
+  (test* "port-confined-thread (not confined)" #f (port-confined-thread p))
+  (port-confine! p)
+  (test* "port-confined-thread (confined)" (current-thread)
+         (port-confined-thread p))
+  (test* "confined port (owner)" "abc"
+         (begin (write-char #\a p) (display "bc" p) (get-output-string p)))
+  (test* "confined port (other thread)" 'port-error
+         (in-other-thread (^[] (write-char #\x p))))
+  (test* "port-confine! (release from other thread)" 'port-error
+         (in-other-thread (^[] (port-confine! p #f))))
+  (port-confine! p #f)
+  (test* "port-confined-thread (released)" #f (port-confined-thread p))
+  (test* "released port (other thread)" "abcx"
+         (begin
+           (in-other-thread (^[] (write-char #\x p)))
+           (get-output-string p))))
+
 ;;---------------------------------------------------------------------
 ;(test-section "thread and signal")
 
@@ -788,6 +854,102 @@
          (let1 rs (map thread-join! ts)
            (cons (barrier-broken? b) rs))))
 
+;;---------------------------------------------------------------------
+(test-section "reader-writer lock")
+
+(test* "make-rwlock" '(#t foo unlocked)
+       (let1 rw (make-rwlock 'foo)
+         (list (rwlock? rw) (rwlock-name rw) (rwlock-state rw))))
+
+(test* "rwlock state" `(read-locked read-locked unlocked ,(current-thread)
+                        not-owned unlocked)
+       (let ([rw (make-rwlock)]
+             [r '()])
+         (rwlock-read-lock! rw)
+         (push! r (rwlock-state rw))
+         (rwlock-read-lock! rw)
+         (push! r (rwlock-state rw))
+         (rwlock-unlock! rw)
+         (rwlock-unlock! rw)
+         (push! r (rwlock-state rw))
+         (rwlock-write-lock! rw)
+         (push! r (rwlock-state rw))
+         (rwlock-unlock! rw)
+         (rwlock-write-lock! rw #f #f)
+         (push! r (rwlock-state rw))
+         (rwlock-unlock! rw)
+         (push! r (rwlock-state rw))
+         (reverse r)))
+
+(test* "rwlock unlocking unlocked" (test-error)
+       (rwlock-unlock! (make-rwlock)))
+
+(test* "rwlock timeout" '(#t #t #f #f #t #t #f)
+       (let1 rw (make-rwlock)
+         (let* ([r0 (rwlock-read-lock! rw)]
+                ;; other readers can enter, but writers can't
+                [r1 (thread-join!
+                     (thread-start!
+                      (make-thread (^[] (begin0 (rwlock-read-lock! rw 0)
+                                          (rwlock-unlock! rw))))))]
+                [r2 (rwlock-write-lock! rw 0.01)]
+                [_  (rwlock-unlock! rw)]
+                [r3 (begin (rwlock-write-lock! rw)
+                           (thread-join!
+                            (thread-start!
+                             (make-thread (^[] (rwlock-read-lock! rw 0.01))))))]
+                [r4 (rwlock-unlock! rw)]
+                [r5 (rwlock-read-lock! rw 0)]
+                [r6 (rwlock-write-lock! rw 0)])
+           (rwlock-unlock! rw)
+           (list r0 r1 r2 r3 r4 r5 r6))))
+
+;; A waiting writer blocks new readers, and a writer that gives up
+;; lets them go again.
+(test* "rwlock writer preference" '(#f #t)
+       (let* ([rw (make-rwlock)]
+              [_ (rwlock-read-lock! rw)]
+              [w (thread-start!
+                  (make-thread (^[] (rwlock-write-lock! rw 0.5))))])
+         (sys-nanosleep #e1e8)
+         (let1 r0 (thread-join!
+                   (thread-start! (make-thread (^[] (rwlock-read-lock! rw 0)))))
+           (thread-join! w)
+           (let1 r1 (rwlock-read-lock! rw 0)
+             (rwlock-unlock! rw)
+             (rwlock-unlock! rw)
+             (list r0 r1)))))
+
+(test* "rwlock readers and writers" '(0 400)
+       (let* ([rw (make-rwlock)]
+              [x 0] [y 0]
+              [bad (atom 0)]
+              [readers (map (^_ (make-thread
+                                 (^[] (dotimes [i 100]
+                                        (with-rwlock-read rw
+                                          (^[] (unless (= x y)
+                                                 (atomic-update! bad (cut + <> 1)))))))))
+                            (iota 4))]
+              [writers (map (^_ (make-thread
+                                 (^[] (dotimes [i 100]
+                                        (with-rwlock-write rw
+                                          (^[] (inc! x)
+                                            (thread-yield!)
+                                            (inc! y)))))))
+                            (iota 4))])
+         (for-each thread-start! (append readers writers))
+         (for-each thread-join! (append readers writers))
+         (list (atom-ref bad) y)))
+
+(test* "rwlock abandoned" (list 'abandoned <abandoned-mutex-exception> #t)
+       (let1 rw (make-rwlock)
+         (thread-join! (thread-start! (make-thread (^[] (rwlock-write-lock! rw)))))
+         (let1 s (rwlock-state rw)
+           (guard (e [(abandoned-mutex-exception? e)
+                      (rwlock-unlock! rw)
+                      (list s (class-of e) (eq? (rwlock-state rw) 'unlocked))])
+             (rwlock-write-lock! rw)))))
+
 ;;---------------------------------------------------------------------
 (test-section "threads and promise")
 
@@ -883,8 +1045,45 @@
                         (make-mtqueue :max-length 0)
                         100 3)
 
+(test-producer-consumer "(mpmc, unbound queue length)"
+                        (make-mpmc-queue)
+                        100 3)
+
+(test-producer-consumer "(mpmc, bound queue length)"
+                        (make-mpmc-queue :max-length 5)
+                        100 3)
+
+;; Many producers and consumers without delay, to exercise the lock-free
+;; paths and segment boundaries of <mpmc-queue>.
+(define (test-mpmc-stress name q nproducers nconsumers ndata)
+  (test* #"mpmc stress ~name" (* nproducers (/ (* ndata (- ndata 1)) 2))
+         (let* ([ps (map (^_ (make-thread
+                              (^[] (dotimes [n ndata] (enqueue/wait! q n)))))
+                         (iota nproducers))]
+                [cs (map (^_ (make-thread
+                              (^[] (let loop ([sum 0])
+                                     (let1 x (dequeue/wait! q)
+                                       (if (eof-object? x)
+                                         sum
+                                         (loop (+ sum x))))))))
+                         (iota nconsumers))])
+           (for-each thread-start! cs)
+           (for-each thread-start! ps)
+           (for-each thread-join! ps)
+           (dotimes [k nconsumers] (enqueue/wait! q (eof-object)))
+           (apply + (map thread-join! cs)))))
+
+(test-mpmc-stress "(unbound)" (make-mpmc-queue) 4 4 5000)
+(test-mpmc-stress "(bound)" (make-mpmc-queue :max-length 16) 4 4 5000)
+
 (test* "dequeue/wait! timeout" "timed out!"
        (dequeue/wait! (make-mtqueue) 0.01 "timed out!"))
+(test* "dequeue/wait! timeout (mpmc)" "timed out!"
+       (dequeue/wait! (make-mpmc-queue) 0.01 "timed out!"))
+(test* "enqueue/wait! timeout (mpmc)" "timed out!"
+       (let1 q (make-mpmc-queue :max-length 1)
+         (enqueue! q 'a)
+         (enqueue/wait! q 'b 0.01 "timed out!")))
 (test* "enqueue/wait! timeout" "timed out!"
        (let1 q (make-mtqueue :max-length 1)
          (enqueue! q 'a)
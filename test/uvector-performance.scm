@@ -0,0 +1,61 @@
+;;
+;; Measure element-wise arithmetic and reductions on uniform vectors,
+;; with each variant of the vectorized kernels and with the scalar
+;; loops (shown as #f).
+;;
+;;   gosh test/uvector-performance.scm [length] [count]
+;;
+
+(use gauche.uvector)
+(use gauche.time)
+
+(define %uvector-kernels (with-module gauche.uvector %uvector-kernels))
+(define %uvector-reduce (with-module gauche.uvector %uvector-reduce))
+
+(define (main args)
+  (define len (if (pair? (cdr args)) (x->integer (cadr args)) 10000))
+  (define count (if (and (pair? (cdr args)) (pair? (cddr args)))
+                  (x->integer (caddr args))
+                  10000))
+  (define best (%uvector-kernels))
+  (define variants
+    (delete-duplicates
+     (filter (^v (guard (e [else #f]) (%uvector-kernels v) #t))
+             `(#f generic sse2 avx2 ,best))))
+  (let ([s16a (make-s16vector len 0)] [s16b (make-s16vector len 0)]
+        [u8a (make-u8vector len 0)]
+        [f32a (make-f32vector len 0)] [f32b (make-f32vector len 0)]
+        [f64a (make-f64vector len 0)] [f64b (make-f64vector len 0)])
+    (define (run label proc)
+      (dolist [v variants]
+        (%uvector-kernels v)
+        (let1 r (time-this 1 (^[] (dotimes [_ count] (proc))))
+          (format #t "~20a ~8a ~8,3f sec (~,2f ns/elt)\n" label v
+                  (time-result-real r)
+                  (/ (* 1e9 (time-result-real r)) count len)))))
+    (dotimes [i len]
+      (s16vector-set! s16a i (- (modulo (* i 7919) 2001) 1000))
+      (s16vector-set! s16b i (- (modulo (* i 31) 201) 100))
+      (u8vector-set! u8a i (modulo (* i 7) 256))
+      (f32vector-set! f32a i (/. (modulo (* i 7919) 1000) 7))
+      (f32vector-set! f32b i (/. (modulo (* i 31) 1000) 3))
+      (f64vector-set! f64a i (/. (modulo (* i 7919) 1000) 7))
+      (f64vector-set! f64b i (/. (modulo (* i 31) 1000) 3)))
+    (run "s16 add!" (^[] (s16vector-add! s16a s16b)
+                         (s16vector-sub! s16a s16b)))
+    (run "s16 add! clamp" (^[] (s16vector-add! s16a s16b 'both)))
+    (run "s16 mul const" (^[] (s16vector-mul s16a 3)))
+    (run "f32 mul" (^[] (f32vector-mul f32a f32b)))
+    (run "f64 add!" (^[] (f64vector-add! f64a f64b)
+                         (f64vector-sub! f64a f64b)))
+    (run "f64 div const" (^[] (f64vector-div f64a 3.0)))
+    (run "s16 dot" (^[] (s16vector-dot s16a s16b)))
+    (run "f32 dot" (^[] (f32vector-dot f32a f32b)))
+    (run "f64 dot" (^[] (f64vector-dot f64a f64b)))
+    (run "u8 sum" (^[] (%uvector-reduce u8a 'sum)))
+    (run "f64 sum" (^[] (%uvector-reduce f64a 'sum)))
+    (run "s16 max" (^[] (%uvector-reduce s16a 'max)))
+    (run "f32 min" (^[] (%uvector-reduce f32a 'min)))
+    (run "f64 clamp" (^[] (f64vector-clamp f64a 10.0 100.0))))
+  (%uvector-kernels #t)
+  0)